@@ -0,0 +1,169 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <atomic>
+#include "log-token.h"
+
+// ==================== LOG ASINKRON ====================
+// Serial.print di 115200 baud memblok pemanggil begitu FIFO UART penuh:
+// satu body POST ~300 byte menahan loop() ~26 ms. LOG_x hanya memformat ke
+// ring buffer lalu kembali; task prioritas rendah yang menulis ke UART.
+// Ring penuh -> pesan dibuang dan dihitung, pemanggil tidak pernah menunggu.
+// - Level per modul, bisa diubah saat jalan (setLevel)
+// - Level di atas LOG_MAX_LEVEL hilang saat kompilasi (cabang if (false):
+//   format tetap dicek, tapi string dan pemanggilannya tidak masuk binary):
+//   -DLOG_MAX_LEVEL=2 hanya ERR + WARN
+// - Banyak produsen (loop, task pre-warm, callback WiFi): slot direservasi
+//   dengan CAS, satu konsumen (task log). Bukan untuk ISR.
+//
+// Format baris: "[detik.ms] L modul: pesan\n"
+// Dengan -DLOG_TOKENIZED baris diganti frame biner "$<base64>\n" (lihat
+// log-token.h); format string tidak masuk flash.
+
+enum class LogLevel : uint8_t { NONE = 0, ERR, WARN, INFO, DEBUG };
+
+enum class LogModule : uint8_t { SYS, NET, MQTT, HTTP, COAP, RELAY, TIME, SCALE, METRICS, COUNT };
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 3   // INFO
+#endif
+
+class LogSink {
+public:
+  virtual ~LogSink() {}
+  virtual size_t write(const uint8_t* data, size_t len) = 0;
+};
+
+struct LogStats {
+  uint32_t lines;        // baris yang masuk ring
+  uint32_t dropped;      // ring penuh
+  uint32_t truncated;    // lebih panjang dari LINE_MAX
+  uint32_t highWater;    // isi ring tertinggi (byte)
+};
+
+class AsyncLog {
+public:
+  static constexpr size_t RING_SIZE = 4096;
+  static constexpr size_t LINE_MAX = 256;
+  static constexpr size_t FRAME_MAX = 96;    // frame token (sebelum base64)
+
+  typedef uint32_t (*ClockMs)();
+
+  explicit AsyncLog(ClockMs clock);
+
+  void setLevel(LogModule module, LogLevel level);
+  void setLevelAll(LogLevel level);
+  LogLevel level(LogModule module) const { return levels[(uint8_t)module]; }
+  bool enabled(LogModule module, LogLevel lvl) const { return lvl <= levels[(uint8_t)module]; }
+
+  void write(LogLevel lvl, LogModule module, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+  void vwrite(LogLevel lvl, LogModule module, const char* fmt, va_list args);
+
+  // Frame token + argumen biner; dipanggil makro LOG_x saat LOG_TOKENIZED
+  template <typename... Args>
+  void writeTokenized(LogLevel lvl, LogModule module, uint32_t token, Args... args) {
+    uint8_t frame[FRAME_MAX];
+    LogArgWriter w(frame, sizeof(frame));
+    w.byte((uint8_t)((uint8_t)lvl << 4 | ((uint8_t)module & 0x0F)));
+    w.varint(clock());
+    w.u32(token);
+    w.args(args...);
+    if (w.overflow()) truncated.fetch_add(1, std::memory_order_relaxed);
+    push(frame, w.size(), true);
+  }
+
+  // Sisi konsumen (satu pemanggil saja): kirim satu baris ke sink.
+  // false jika ring kosong atau baris terdepan belum selesai ditulis.
+  bool drainOne(LogSink& sink);
+  void drain(LogSink& sink) { while (drainOne(sink)) {} }
+
+  LogStats stats() const;
+
+#ifdef ARDUINO
+  // Task konsumen prioritas rendah di core 0; sebelum ini log hanya antre
+  bool startTask(LogSink& sink);
+#endif
+
+  static const char* moduleName(LogModule module);
+  // "[detik.ms] L modul: " (juga dipakai detokenizer); return panjang
+  static size_t formatPrefix(char* out, size_t cap, uint32_t timeMs, uint8_t level, uint8_t module);
+
+private:
+  void push(const void* data, size_t len, bool binary);
+  void copyIn(uint32_t pos, const uint8_t* data, size_t len);
+  void copyOut(uint32_t pos, uint8_t* data, size_t len) const;
+  void emitDropNotice(LogSink& sink);
+
+  ClockMs clock;
+  LogLevel levels[(uint8_t)LogModule::COUNT];
+
+  alignas(4) uint8_t ring[RING_SIZE];
+  std::atomic<uint32_t> head{0};   // reservasi produsen
+  std::atomic<uint32_t> tail{0};   // sudah dikirim konsumen
+
+  std::atomic<uint32_t> lines{0};
+  std::atomic<uint32_t> dropped{0};
+  std::atomic<uint32_t> truncated{0};
+  std::atomic<uint32_t> highWater{0};
+  uint32_t reportedDropped = 0;
+};
+
+#ifdef ARDUINO
+class Print;
+
+// Sink ke Serial (atau Print lain); dipanggil hanya dari task log
+class PrintLogSink : public LogSink {
+public:
+  explicit PrintLogSink(Print& out) : out(out) {}
+  size_t write(const uint8_t* data, size_t len) override;
+
+private:
+  Print& out;
+};
+#endif
+
+// Instance global dipakai makro LOG_x (didefinisikan di main.cpp)
+extern AsyncLog logger;
+
+#ifdef LOG_TOKENIZED
+// Cabang if (false) hanya untuk cek tipe printf; string-nya dibuang compiler
+#define LOG_EMIT(lvl, mod, fmt, ...)                                                 \
+  do {                                                                               \
+    if (false) logger.write(lvl, LogModule::mod, fmt, ##__VA_ARGS__);                \
+    logger.writeTokenized(lvl, LogModule::mod,                                       \
+        std::integral_constant<uint32_t, LogToken::hash(fmt)>::value, ##__VA_ARGS__); \
+  } while (0)
+#else
+#define LOG_EMIT(lvl, mod, ...) logger.write(lvl, LogModule::mod, __VA_ARGS__)
+#endif
+
+#define LOG_AT(lvl, mod, ...)                                                        \
+  do {                                                                               \
+    if (logger.enabled(LogModule::mod, lvl)) LOG_EMIT(lvl, mod, __VA_ARGS__);        \
+  } while (0)
+#define LOG_OFF(lvl, mod, ...)                                                       \
+  do {                                                                               \
+    if (false) logger.write(lvl, LogModule::mod, __VA_ARGS__);                       \
+  } while (0)
+
+#if LOG_MAX_LEVEL >= 1
+#define LOG_E(mod, ...) LOG_AT(LogLevel::ERR, mod, __VA_ARGS__)
+#else
+#define LOG_E(mod, ...) LOG_OFF(LogLevel::ERR, mod, __VA_ARGS__)
+#endif
+#if LOG_MAX_LEVEL >= 2
+#define LOG_W(mod, ...) LOG_AT(LogLevel::WARN, mod, __VA_ARGS__)
+#else
+#define LOG_W(mod, ...) LOG_OFF(LogLevel::WARN, mod, __VA_ARGS__)
+#endif
+#if LOG_MAX_LEVEL >= 3
+#define LOG_I(mod, ...) LOG_AT(LogLevel::INFO, mod, __VA_ARGS__)
+#else
+#define LOG_I(mod, ...) LOG_OFF(LogLevel::INFO, mod, __VA_ARGS__)
+#endif
+#if LOG_MAX_LEVEL >= 4
+#define LOG_D(mod, ...) LOG_AT(LogLevel::DEBUG, mod, __VA_ARGS__)
+#else
+#define LOG_D(mod, ...) LOG_OFF(LogLevel::DEBUG, mod, __VA_ARGS__)
+#endif
@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#define BUTTON_ISR_ATTR IRAM_ATTR
+#else
+#define BUTTON_ISR_ATTR
+#endif
+
+// ==================== TOMBOL BERBASIS INTERRUPT ====================
+// Setiap perubahan level pin ditangkap ISR bersama timestamp (us) ke antrian
+// tepi. update() di loop() men-debounce tepi tersebut berdasarkan timestamp
+// aslinya, jadi tekanan saat loop tertahan (kirim HTTP, connect WiFi, ping)
+// tetap terdeteksi dengan waktu yang benar, lalu dijadikan event:
+//   PRESS  : tombol ditekan (waktu = tepi pertama, sebelum bouncing)
+//   DOUBLE : tekanan kedua dalam doublePressUs setelah tekanan sebelumnya
+//   LONG   : tombol masih ditahan setelah longPressUs (sekali per tekanan)
+// Event yang terlalu tua saat diambil (maxEventAgeUs) dibuang dan dihitung.
+
+enum class ButtonEventType : uint8_t { PRESS, DOUBLE, LONG };
+
+struct ButtonEvent {
+  uint8_t button;
+  ButtonEventType type;
+  uint32_t at;            // micros() kejadian fisik
+};
+
+struct ButtonPolicy {
+  uint32_t debounceUs = 20000;
+  uint32_t longPressUs = 1000000;
+  uint32_t doublePressUs = 350000;
+  uint32_t maxEventAgeUs = 3000000;
+};
+
+struct ButtonStats {
+  uint32_t edges;
+  uint32_t edgesDropped;    // antrian tepi penuh (ISR lebih cepat dari update)
+  uint32_t events;
+  uint32_t eventsDropped;   // antrian event penuh
+  uint32_t stale;           // event kedaluwarsa saat diambil
+  uint32_t handled;
+  uint32_t latencyMaxUs;    // kejadian fisik -> diambil next()
+  uint64_t latencyTotalUs;
+};
+
+class ButtonEvents {
+public:
+  static constexpr uint8_t MAX_BUTTONS = 4;
+  static constexpr uint8_t EDGE_QUEUE = 32;
+  static constexpr uint8_t EVENT_QUEUE = 16;
+
+  // Level pin saat ini (true = ditekan); dipakai untuk sinkron ulang
+  // setelah antrian tepi penuh
+  typedef bool (*LevelReader)(uint8_t button);
+
+  explicit ButtonEvents(const ButtonPolicy& policy = ButtonPolicy()) : policy(policy) {}
+
+  void begin(uint8_t count, LevelReader reader, uint32_t nowUs);
+
+  // Konteks ISR: satu produsen per core, hanya menulis edgeHead
+  void BUTTON_ISR_ATTR onEdge(uint8_t button, bool pressed, uint32_t atUs) {
+    uint8_t h = edgeHead;
+    if ((uint8_t)(h - edgeTail) >= EDGE_QUEUE) { counters.edgesDropped++; return; }
+    edges[h % EDGE_QUEUE] = { button, pressed, atUs };
+    edgeHead = h + 1;
+  }
+
+  // Debounce tepi yang masuk dan cek timer long-press
+  void update(uint32_t nowUs);
+  // Ambil event tertua yang belum kedaluwarsa; mencatat latensi
+  bool next(ButtonEvent& ev, uint32_t nowUs);
+  bool pending() const { return eventHead != eventTail; }
+
+  const ButtonStats& stats() const { return counters; }
+
+private:
+  struct Edge { uint8_t button; bool pressed; uint32_t at; };
+  struct State {
+    bool stable;            // level setelah debounce
+    bool raw;               // level tepi terakhir
+    uint32_t rawSince;      // tepi terakhir (awal jendela tenang)
+    uint32_t firstEdge;     // tepi pertama sejak level stabil terakhir
+    bool bouncing;
+    bool longSent;
+    uint32_t pressedAt;
+    uint32_t lastPressAt;
+    bool hasLastPress;
+  };
+
+  void applyEdge(uint8_t button, bool pressed, uint32_t at);
+  void settle(uint8_t button, uint32_t nowUs);
+  void commit(uint8_t button, bool pressed, uint32_t at);
+  void emit(uint8_t button, ButtonEventType type, uint32_t at);
+
+  ButtonPolicy policy;
+  LevelReader reader = nullptr;
+  uint8_t count = 0;
+  State states[MAX_BUTTONS] = {};
+  uint32_t seenDropped = 0;
+
+  Edge edges[EDGE_QUEUE];
+  volatile uint8_t edgeHead = 0;
+  volatile uint8_t edgeTail = 0;
+
+  ButtonEvent events[EVENT_QUEUE];
+  uint8_t eventHead = 0;
+  uint8_t eventTail = 0;
+
+  ButtonStats counters = {};
+};
+
+#ifdef ARDUINO
+// INPUT_PULLUP + interrupt CHANGE per pin (aktif LOW, seperti ezButton)
+bool attachButtonInterrupts(ButtonEvents& events, const int* pins, uint8_t count);
+#endif
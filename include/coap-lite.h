@@ -0,0 +1,204 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CoAP LITE (RFC 7252 + RFC 7959) ====================
+// Transport upload alternatif untuk lokasi dengan link kampus lambat: satu
+// datagram UDP per record (atau per blok batch) alih-alih handshake TLS.
+// - Pesan Confirmable dengan retransmisi eksponensial
+// - Block1 untuk batch yang lebih besar dari satu blok
+// - Autentikasi PSK: tag HMAC-SHA256 (16 byte) di opsi privat, menutupi
+//   message id, token, key id, Block1 dan payload. Isi tidak dienkripsi;
+//   api_key tidak pernah dikirim, receiver yang menambahkannya.
+// Skema record sama dengan body HTTP (form-urlencoded), satu record per
+// baris. Codec dipakai bersama oleh firmware dan tools/coap-receiver.cpp.
+
+enum class CoapType : uint8_t { CON = 0, NON = 1, ACK = 2, RST = 3 };
+
+namespace CoapCode {
+  constexpr uint8_t make(uint8_t cls, uint8_t detail) { return (uint8_t)((cls << 5) | detail); }
+  constexpr uint8_t EMPTY        = 0;
+  constexpr uint8_t POST         = make(0, 2);
+  constexpr uint8_t CREATED      = make(2, 1);
+  constexpr uint8_t CHANGED      = make(2, 4);
+  constexpr uint8_t CONTINUE     = make(2, 31);
+  constexpr uint8_t BAD_REQUEST  = make(4, 0);
+  constexpr uint8_t UNAUTHORIZED = make(4, 1);
+  constexpr uint8_t INCOMPLETE   = make(4, 8);
+  constexpr uint8_t TOO_LARGE    = make(4, 13);
+  constexpr uint8_t SERVER_ERROR = make(5, 0);
+  inline uint8_t cls(uint8_t code) { return code >> 5; }
+}
+
+namespace CoapOption {
+  constexpr uint16_t URI_PATH       = 11;
+  constexpr uint16_t CONTENT_FORMAT = 12;
+  constexpr uint16_t BLOCK1         = 27;
+  constexpr uint16_t AUTH_TAG       = 65001; // privat, critical: server lama menolak
+  constexpr uint16_t KEY_ID         = 65003; // deviceId, untuk memilih PSK
+}
+
+constexpr uint16_t COAP_DEFAULT_PORT = 5683;
+constexpr size_t COAP_AUTH_TAG_SIZE = 16;
+constexpr size_t COAP_MAX_TOKEN = 8;
+
+// --- Block1: NUM | M | SZX (ukuran blok = 2^(SZX+4)) ---
+inline uint32_t coapBlockValue(uint32_t num, bool more, uint8_t szx) { return (num << 4) | (more ? 0x08 : 0) | (szx & 0x07); }
+inline uint32_t coapBlockNum(uint32_t value) { return value >> 4; }
+inline bool coapBlockMore(uint32_t value) { return value & 0x08; }
+inline size_t coapBlockSize(uint32_t value) { return (size_t)16 << (value & 0x07); }
+
+class CoapWriter {
+public:
+  CoapWriter(uint8_t* buf, size_t cap) : buf(buf), cap(cap) {}
+
+  bool header(CoapType type, uint8_t code, uint16_t messageId, const uint8_t* token, uint8_t tokenLen);
+  // Opsi harus ditulis dengan nomor naik (encoding delta)
+  bool option(uint16_t number, const uint8_t* value, size_t len);
+  bool optionUint(uint16_t number, uint32_t value);
+  bool optionString(uint16_t number, const char* value);
+  bool payload(const uint8_t* data, size_t len);
+
+  size_t length() const { return ok ? len : 0; }
+
+private:
+  bool put(const uint8_t* data, size_t n);
+  bool putByte(uint8_t b) { return put(&b, 1); }
+
+  uint8_t* buf;
+  size_t cap;
+  size_t len = 0;
+  uint16_t lastOption = 0;
+  bool ok = true;
+};
+
+struct CoapOptionView {
+  uint16_t number;
+  const uint8_t* value;
+  uint16_t length;
+};
+
+struct CoapMessage {
+  static constexpr uint8_t MAX_OPTIONS = 12;
+
+  CoapType type;
+  uint8_t code;
+  uint16_t messageId;
+  uint8_t token[COAP_MAX_TOKEN];
+  uint8_t tokenLen;
+  CoapOptionView options[MAX_OPTIONS];
+  uint8_t optionCount;
+  const uint8_t* payload;
+  size_t payloadLen;
+
+  // Parse datagram; pointer opsi/payload menunjuk ke buf (tidak disalin)
+  bool parse(const uint8_t* buf, size_t len);
+  const CoapOptionView* find(uint16_t number) const;
+  uint32_t optionUint(uint16_t number, uint32_t fallback) const;
+};
+
+// Tag HMAC-SHA256 terpotong 16 byte untuk satu pesan request
+void coapAuthTag(const uint8_t* psk, size_t pskLen, uint8_t code, uint16_t messageId,
+                 const uint8_t* token, uint8_t tokenLen, const char* keyId,
+                 uint32_t block1, const uint8_t* payload, size_t payloadLen,
+                 uint8_t out[COAP_AUTH_TAG_SIZE]);
+
+// ==================== UPLOADER (CLIENT) ====================
+
+class CoapTransport {
+public:
+  virtual ~CoapTransport() {}
+  virtual bool open(const char* host, uint16_t port) = 0;
+  virtual void close() {}
+  virtual bool send(const uint8_t* data, size_t len) = 0;
+  // Jumlah byte satu datagram, 0 jika belum ada
+  virtual int receive(uint8_t* buf, size_t cap) = 0;
+};
+
+enum class CoapResult : uint8_t { IDLE, BUSY, DONE, REJECTED, FAILED };
+
+struct CoapPolicy {
+  uint32_t ackTimeoutMs = 1000;   // RFC: 2000; link lambat tapi RTT kecil
+  uint8_t maxRetransmit = 3;      // worst case ~1.5 * (1+2+4+8) s
+  uint8_t blockSzx = 5;           // 512 byte per blok, muat di MTU minimum
+};
+
+class CoapUploader {
+public:
+  static constexpr size_t BODY_MAX = 2048;
+  static constexpr size_t DATAGRAM_MAX = 640;
+
+  explicit CoapUploader(CoapTransport& transport, const CoapPolicy& policy = CoapPolicy())
+    : transport(transport), policy(policy) {}
+
+  void setServer(const char* host, uint16_t port) { this->host = host; this->port = port; }
+  void setPath(const char* path) { this->path = path; }
+  void setKey(const char* keyId, const uint8_t* psk, size_t pskLen);
+  void seed(uint32_t entropy);
+
+  // Mulai transfer body (disalin). Return false jika masih sibuk / terlalu besar.
+  bool start(const uint8_t* body, size_t len, uint32_t now);
+  // Non-blocking; BUSY selama transfer berjalan
+  CoapResult poll(uint32_t now);
+  // Alamat server di-resolve ulang dan socket dibuka lagi di start()
+  // berikutnya (WiFi reconnect / roaming). Transfer yang berjalan tidak diputus.
+  void reopen() { opened = false; }
+
+  uint8_t responseCode() const { return lastCode; }
+  uint32_t bytesSent() const { return txBytes; }
+  uint32_t bytesReceived() const { return rxBytes; }
+  uint32_t retransmitCount() const { return retransmits; }
+
+private:
+  uint32_t nextRandom();
+  bool sendBlock(uint32_t now);
+  void arm(uint32_t now, uint32_t timeout);
+  CoapResult finish(CoapResult result);
+  void handle(const CoapMessage& msg, uint32_t now);
+
+  CoapTransport& transport;
+  CoapPolicy policy;
+  const char* host = nullptr;
+  uint16_t port = COAP_DEFAULT_PORT;
+  const char* path = "ingest";
+  const char* keyId = "";
+  const uint8_t* psk = nullptr;
+  size_t pskLen = 0;
+  bool opened = false;
+
+  uint32_t rng = 0x9E3779B9;
+  uint16_t messageId = 0;
+  uint8_t token[4];
+
+  uint8_t body[BODY_MAX];
+  size_t bodyLen = 0;
+  uint32_t blockNum = 0;
+
+  uint8_t datagram[DATAGRAM_MAX];
+  size_t datagramLen = 0;
+  CoapResult state = CoapResult::IDLE;
+  bool awaitingAck = false;     // false setelah empty ACK: tunggu response terpisah
+  uint32_t deadline = 0;
+  uint32_t currentTimeout = 0;
+  uint8_t attempts = 0;
+
+  uint8_t lastCode = 0;
+  uint32_t txBytes = 0, rxBytes = 0, retransmits = 0;
+};
+
+#ifdef ARDUINO
+#include <WiFiUdp.h>
+
+class WiFiUdpTransport : public CoapTransport {
+public:
+  bool open(const char* host, uint16_t port) override;
+  void close() override;
+  bool send(const uint8_t* data, size_t len) override;
+  int receive(uint8_t* buf, size_t cap) override;
+
+private:
+  WiFiUDP udp;
+  IPAddress remote;
+  uint16_t remotePort = 0;
+};
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+
+// ==================== PROFIL PERANGKAT ====================
+// DIBUAT OLEH tools/gen-profiles.py DARI faktor-kalibrasi.txt, JANGAN DIEDIT.
+// Profil dipilih saat kompilasi lewat -DECOSCALE_PROFILE="<fakultas>" (satu
+// env PlatformIO per profil); backend ikut flag env yang sama.
+
+struct DeviceProfile {
+  const char* fakultas;
+  float calibration;
+};
+
+namespace DeviceProfiles {
+constexpr DeviceProfile TABLE[] = {
+  { "FIB", 12.1604963f },
+  { "FT", 12.244260f },
+  { "FISIP", 12.2066126f },
+  { "FPsi", 12.3382398f },
+  { "TPST", 12.259820f },
+  { "FKM", 12.01f },
+  { "FSM", 12.162798f },
+  { "FK", 12.065749f },
+  { "FEB", 12.006349f },
+};
+constexpr size_t COUNT = sizeof(TABLE) / sizeof(TABLE[0]);
+
+// Rekursif agar tetap constexpr di C++11 (toolchain ESP32)
+constexpr bool equal(const char* a, const char* b) {
+  return *a == *b && (*a == '\0' || equal(a + 1, b + 1));
+}
+
+// Indeks profil bernama name, COUNT jika tidak ada
+constexpr size_t find(const char* name, size_t i = 0) {
+  return i == COUNT ? COUNT : equal(TABLE[i].fakultas, name) ? i : find(name, i + 1);
+}
+}
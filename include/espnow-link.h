@@ -0,0 +1,227 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "record-outbox.h"
+
+// ==================== ESP-NOW RELAY ====================
+// Timbangan tanpa jangkauan WiFi (TPST, titik kumpul outdoor) mengirim
+// record lewat ESP-NOW ke gateway: ESP32 lain yang punya WiFi. Gateway
+// mengumpulkan record dari banyak node, meng-upload per batch, lalu
+// mengirim ACK ke node asal setelah backend mengonfirmasi (end-to-end).
+//
+// Frame (maks 250 byte, little-endian):
+//   u8 magic | u8 type | u32 id | payload | tag[8]
+// tag = HMAC-SHA256(PSK, mac pengirim | isi frame) terpotong 8 byte.
+// Node yang belum tahu channel gateway berburu: PROBE broadcast di tiap
+// channel, gateway menjawab PROBE_REPLY dengan nonce yang sama.
+// Retransmisi aman karena (mac, seq) = kunci idempotensi di backend.
+
+namespace EspNowFrame {
+  constexpr uint8_t MAGIC       = 0xED;   // 0xEC: jenis sebagai string
+  constexpr uint8_t PROBE       = 1;
+  constexpr uint8_t PROBE_REPLY = 2;
+  constexpr uint8_t RECORD      = 3;
+  constexpr uint8_t ACK         = 4;
+
+  constexpr size_t MAX_SIZE = 250;
+  constexpr size_t HEADER_SIZE = 6;
+  constexpr size_t TAG_SIZE = 8;
+  constexpr uint8_t ACK_MAX_ENTRIES = 24;
+}
+
+extern const uint8_t ESPNOW_BROADCAST[6];
+
+class EspNowRadio {
+public:
+  virtual ~EspNowRadio() {}
+  // Kirim ke peer (ESPNOW_BROADCAST untuk broadcast). false jika gagal diantrekan.
+  virtual bool send(const uint8_t mac[6], const uint8_t* data, size_t len) = 0;
+  virtual bool setChannel(uint8_t channel) = 0;
+};
+
+// Record dari node, seperti yang dibawa di frame RECORD
+struct EspNowRecord {
+  uint32_t seq;
+  float weight;          // kg
+  uint32_t ageMs;        // umur record saat frame dikirim / diterima
+  char fakultas[8];
+  WasteCategory category;
+};
+
+// Record yang ditampung gateway, lengkap dengan asal
+struct RelayedRecord {
+  uint8_t mac[6];
+  EspNowRecord rec;
+  uint32_t receivedAt;   // ms gateway; umur saat upload = rec.ageMs + (now - receivedAt)
+};
+
+// --- Codec (dipakai node, gateway, dan simulasi host) ---
+size_t espNowEncode(uint8_t* out, uint8_t type, uint32_t id, const uint8_t* payload, size_t len,
+                    const uint8_t senderMac[6], const uint8_t* psk, size_t pskLen);
+// Verifikasi tag; payload menunjuk ke dalam frame. false jika rusak / tag salah.
+bool espNowDecode(const uint8_t* frame, size_t len, const uint8_t senderMac[6],
+                  const uint8_t* psk, size_t pskLen,
+                  uint8_t& type, uint32_t& id, const uint8_t*& payload, size_t& payloadLen);
+size_t espNowPackRecord(uint8_t* out, size_t cap, const EspNowRecord& rec);
+bool espNowUnpackRecord(const uint8_t* in, size_t len, EspNowRecord& rec);
+
+struct EspNowStats {
+  uint32_t framesSent;
+  uint32_t framesReceived;
+  uint32_t badFrames;       // tag salah / format rusak
+  uint32_t retransmits;
+  uint32_t hunts;           // sapuan channel (node)
+  uint32_t duplicates;      // record yang sudah ditampung / sudah di-ACK (gateway)
+  uint32_t dropped;         // tampungan gateway penuh
+};
+
+// ==================== NODE (TIMBANGAN TANPA WIFI) ====================
+
+struct EspNowNodePolicy {
+  uint32_t probeWaitMs = 60;        // tunggu PROBE_REPLY per channel
+  uint32_t huntBackoffMs = 10000;   // jeda antar sapuan jika gateway tidak ditemukan
+  uint32_t ackTimeoutMs = 8000;     // gateway menunggu batch + upload sebelum ACK
+  uint8_t maxSilentTimeouts = 3;    // gateway diam selama N x ackTimeout -> berburu lagi
+  uint8_t maxChannel = 13;
+};
+
+class EspNowNode {
+public:
+  static constexpr int WINDOW = 8;
+
+  typedef void (*ResultCallback)(uint32_t seq, SendResult result);
+
+  EspNowNode(EspNowRadio& radio, const EspNowNodePolicy& policy = EspNowNodePolicy())
+    : radio(radio), policy(policy) {}
+
+  void setIdentity(const uint8_t mac[6]);
+  void setKey(const uint8_t* psk, size_t len) { this->psk = psk; pskLen = len; }
+  void setResultCallback(ResultCallback cb) { onResult = cb; }
+
+  // Record masuk window dan dikirim sampai ada ACK. createdAt = ms lokal
+  // saat penimbangan (umur dihitung ulang di tiap transmisi).
+  bool submit(const EspNowRecord& rec, uint32_t createdAt, uint32_t now);
+  bool hasRoom() const { return pendingCount() < WINDOW; }
+  bool contains(uint32_t seq) const;
+  int pendingCount() const;
+
+  void onFrame(const uint8_t mac[6], const uint8_t* data, size_t len, uint32_t now);
+  void loop(uint32_t now);
+
+  bool linked() const { return state == State::LINKED; }
+  uint8_t channel() const { return currentChannel; }
+  const uint8_t* gateway() const { return gatewayMac; }
+  const EspNowStats& stats() const { return counters; }
+
+private:
+  enum class State : uint8_t { IDLE, HUNTING, LINKED };
+  struct Pending {
+    bool used;
+    uint32_t createdAt;
+    uint32_t sentAt;
+    uint8_t attempts;
+    EspNowRecord rec;
+  };
+
+  void startHunt(uint32_t now);
+  void probe(uint32_t now);
+  bool transmit(Pending& p, uint32_t now);
+
+  EspNowRadio& radio;
+  EspNowNodePolicy policy;
+  uint8_t selfMac[6] = {};
+  const uint8_t* psk = nullptr;
+  size_t pskLen = 0;
+  ResultCallback onResult = nullptr;
+
+  State state = State::IDLE;
+  uint8_t currentChannel = 1;
+  uint8_t gatewayMac[6] = {};
+  uint32_t probeNonce = 0;
+  uint32_t stateSince = 0;
+  uint32_t lastHeardAt = 0;       // frame valid terakhir dari gateway
+
+  Pending pending[WINDOW] = {};
+  EspNowStats counters = {};
+};
+
+// ==================== GATEWAY ====================
+
+struct EspNowGatewayPolicy {
+  uint8_t batchSize = 16;           // upload segera jika tampungan mencapai ini
+  uint32_t maxWaitMs = 2000;        // atau record tertua sudah menunggu selama ini
+  uint32_t retryBackoffMs = 5000;   // jeda setelah upload gagal (backend / WiFi bermasalah)
+};
+
+class EspNowGateway {
+public:
+  static constexpr int MAX_PENDING = 64;
+  static constexpr int MAX_NODES = 24;
+  static constexpr int RECENT_PER_NODE = 16;  // hasil ACK terakhir per node untuk retransmisi
+
+  EspNowGateway(EspNowRadio& radio, const EspNowGatewayPolicy& policy = EspNowGatewayPolicy())
+    : radio(radio), policy(policy) {}
+
+  void setIdentity(const uint8_t mac[6]);
+  void setKey(const uint8_t* psk, size_t len) { this->psk = psk; pskLen = len; }
+
+  void onFrame(const uint8_t mac[6], const uint8_t* data, size_t len, uint32_t now);
+
+  // Ambil batch jika sudah waktunya (penuh atau tertua >= maxWaitMs).
+  // Record yang diambil ditandai sedang di-upload sampai complete().
+  size_t takeBatch(RelayedRecord* out, size_t max, uint32_t now);
+  // Hasil upload per record; ACKED/REJECTED diteruskan ke node, RETRY
+  // dikembalikan ke tampungan untuk batch berikutnya. Di frame ACK, entri
+  // RETRY berarti "sudah ditampung / tunggu", bukan hasil akhir.
+  void complete(const RelayedRecord* recs, const SendResult* results, size_t count, uint32_t now);
+
+  int pendingCount() const;
+  int nodeCount() const;
+  const EspNowStats& stats() const { return counters; }
+
+private:
+  struct Slot {
+    bool used;
+    bool uploading;
+    RelayedRecord item;
+  };
+  struct Node {
+    bool used;
+    uint8_t mac[6];
+    uint32_t lastSeen;
+    uint32_t recentSeq[RECENT_PER_NODE];
+    uint8_t recentResult[RECENT_PER_NODE];  // 0 = kosong, 1 + SendResult
+    uint8_t recentNext;
+  };
+
+  Node* findNode(const uint8_t mac[6], bool create, uint32_t now);
+  void remember(Node& node, uint32_t seq, SendResult result);
+  void sendAck(const uint8_t mac[6], const uint32_t* seqs, const SendResult* results, size_t count);
+
+  EspNowRadio& radio;
+  EspNowGatewayPolicy policy;
+  uint8_t selfMac[6] = {};
+  const uint8_t* psk = nullptr;
+  size_t pskLen = 0;
+
+  Slot slots[MAX_PENDING] = {};
+  Node nodes[MAX_NODES] = {};
+  bool retryHold = false;
+  uint32_t retryAfter = 0;
+  EspNowStats counters = {};
+};
+
+#ifdef ARDUINO
+// ESP-NOW di atas WiFi STA. Callback terima berjalan di task WiFi, jadi
+// frame disalin ke antrian dan diproses di loop() lewat poll().
+class Esp32EspNowRadio : public EspNowRadio {
+public:
+  typedef void (*FrameHandler)(const uint8_t mac[6], const uint8_t* data, size_t len);
+
+  bool begin();
+  bool send(const uint8_t mac[6], const uint8_t* data, size_t len) override;
+  bool setChannel(uint8_t channel) override;
+  // Proses frame yang masuk sejak panggilan sebelumnya
+  void poll(FrameHandler handler);
+};
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+#include "upload-backend.h"
+
+// ==================== BACKEND FIRESTORE ====================
+// Policy upload untuk profil dengan backend firebase (-DECOSCALE_BACKEND_FIREBASE,
+// env dibuat tools/gen-profiles.py). Butuh API_KEY dan FIREBASE_PROJECT_ID
+// di credentials.h; library Firebase hanya ada di lib_deps env tersebut.
+// - Dokumen sampah/<deviceId>-<seq>: kirim ulang record yang sama ditolak
+//   Firestore (409 ALREADY_EXISTS) dan dianggap ACKED, jadi retry outbox aman
+// - Token auth disimpan di NVS (namespace "fb_auth"): reboot tidak membuat
+//   user anonim baru, cukup refresh
+// - Timestamp dokumen wajib waktu dinding: sebelum jam sinkron record
+//   tetap di outbox (RETRY)
+// - Jumlah boot/signUp/refresh disimpan di NVS yang sama; dibandingkan
+//   antar boot, signUp seharusnya jauh lebih kecil dari boots
+
+struct FirebaseAuthStats {
+  uint32_t boots;
+  uint32_t signUps;
+  uint32_t refreshes;
+  uint32_t readyMs;     // millis() saat auth siap sejak boot, 0 = belum
+  bool fromCache;       // token dari NVS (tanpa signUp)
+};
+
+struct FirebaseBackend {
+  static const char* name() { return "firebase"; }
+  static constexpr uint8_t MAX_BATCH = 1;
+  static constexpr bool MQTT_RECORDS = false;
+  static constexpr bool PREWARM = false;   // koneksi dikelola library Firebase
+  static constexpr bool ASYNC = false;
+
+  static void begin(const BackendContext& ctx);
+  static SendResult send(WeighingRecord* const* recs, size_t count);
+  // Login (sekali, setelah WiFi tersambung) dan refresh token
+  static void service(unsigned long now);
+  static const FirebaseAuthStats& authStats();
+};
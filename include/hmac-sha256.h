@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== SHA-256 / HMAC ====================
+// Implementasi portabel (FIPS 180-4, RFC 2104) tanpa dependensi mbedTLS,
+// supaya firmware dan tool host (penerima CoAP) memakai kode yang sama.
+
+class Sha256 {
+public:
+  static constexpr size_t DIGEST_SIZE = 32;
+  static constexpr size_t BLOCK_SIZE = 64;
+
+  Sha256() { reset(); }
+  void reset();
+  void update(const uint8_t* data, size_t len);
+  void finish(uint8_t out[DIGEST_SIZE]);
+
+private:
+  void compress(const uint8_t block[BLOCK_SIZE]);
+
+  uint32_t state[8];
+  uint8_t buffer[BLOCK_SIZE];
+  size_t bufferLen;
+  uint64_t totalLen;
+};
+
+class HmacSha256 {
+public:
+  HmacSha256(const uint8_t* key, size_t keyLen);
+  void update(const uint8_t* data, size_t len) { inner.update(data, len); }
+  void finish(uint8_t out[Sha256::DIGEST_SIZE]);
+
+private:
+  Sha256 inner;
+  uint8_t outerKey[Sha256::BLOCK_SIZE];
+};
+
+// Bandingkan tag tanpa bocor waktu (tidak berhenti di byte pertama yang beda)
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len);
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== HTTP/1.1 LITE ====================
+// Penulis request dan parser response HTTP/1.1 minimal untuk jalur upload.
+// Tidak ada alokasi heap: blok header statis dibangun sekali saat boot,
+// response diparse inkremental (byte per byte, boleh terpotong di mana saja)
+// dan hanya status, beberapa header penting serta awal body yang disimpan.
+// Mendukung keep-alive, Content-Length dan Transfer-Encoding: chunked.
+
+struct HttpEndpoint {
+  char host[64];
+  char path[96];
+  uint16_t port;
+  bool tls;
+
+  // "https://host[:port]/path" -> komponen. Return false jika tidak valid.
+  bool parse(const char* url);
+};
+
+class HttpRequestWriter {
+public:
+  // Bangun blok header statis: request line, Host, Content-Type, keep-alive
+  bool begin(const char* method, const HttpEndpoint& endpoint, const char* contentType);
+
+  // Tulis request lengkap ke out. extraHeaders berisi baris "Nama: nilai\r\n"
+  // (boleh nullptr). Return panjang request, 0 jika tidak muat.
+  size_t build(char* out, size_t cap, const char* extraHeaders, const char* body, size_t bodyLen) const;
+
+  size_t staticHeaderLength() const { return staticLen; }
+
+private:
+  char staticBlock[256];
+  size_t staticLen = 0;
+};
+
+class HttpResponseParser {
+public:
+  static constexpr size_t BODY_PREFIX_MAX = 128;
+  static constexpr size_t LINE_MAX = 96;
+  static constexpr size_t DATE_MAX = 40;
+
+  void reset();
+
+  // Proses data masuk. Return jumlah byte yang dikonsumsi (sisanya milik
+  // response berikutnya pada koneksi keep-alive), atau -1 jika format rusak.
+  int feed(const uint8_t* data, size_t len);
+  // Server menutup koneksi: body tanpa Content-Length dianggap selesai
+  void connectionClosed();
+
+  bool failed() const { return state == State::ERROR; }
+  bool headersDone() const { return state >= State::BODY_IDENTITY && state != State::ERROR; }
+  // Status + header + awal body sudah tersedia; cukup untuk menentukan hasil
+  bool prefixReady() const { return done() || (headersDone() && prefixLen >= BODY_PREFIX_MAX); }
+  // Seluruh response (termasuk body) sudah terbaca
+  bool done() const { return state == State::DONE; }
+
+  int statusCode() const { return status; }
+  bool keepAlive() const { return persistent; }
+  bool chunked() const { return isChunked; }
+  const char* date() const { return dateValue; }
+  const char* bodyPrefix() const { return prefix; }
+  size_t bodyPrefixLength() const { return prefixLen; }
+  bool bodyContains(const char* needle) const;
+
+private:
+  enum class State : uint8_t {
+    STATUS_LINE, HEADER_LINE,
+    BODY_IDENTITY, BODY_UNTIL_CLOSE, CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER,
+    DONE, ERROR
+  };
+
+  bool onLine();
+  void onHeader(char* name, char* value);
+  void onBody(const uint8_t* data, size_t len);
+
+  State state = State::STATUS_LINE;
+  char line[LINE_MAX];
+  size_t lineLen = 0;
+
+  int status = 0;
+  bool httpMinor1 = true;
+  bool persistent = true;
+  bool isChunked = false;
+  bool hasLength = false;
+  uint32_t remaining = 0;
+
+  char dateValue[DATE_MAX];
+  char prefix[BODY_PREFIX_MAX + 1];
+  size_t prefixLen = 0;
+};
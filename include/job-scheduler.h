@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== JOB SCHEDULER ====================
+// Pengganti timer millis() yang tersebar: setiap pekerjaan berkala / sekali
+// jalan didaftarkan dengan periode, deadline, dan budget durasi. run()
+// menjalankan job yang jatuh tempo urut deadline (min-heap), mencatat
+// jitter (mulai - deadline), durasi, dan overrun (durasi > budget).
+// Jam disuntikkan (micros() di ESP32, jam virtual di host) sehingga
+// perilakunya deterministik dan bisa diuji.
+// Job berkala fixed-rate: deadline berikut = deadline + periode. Jika loop
+// tertahan lebih dari satu periode, periode yang terlewat dilompati (tidak
+// dijalankan beruntun) dan dihitung sebagai skipped.
+// Waktu internal dalam us (uint32_t, wrap-safe); periode maks ~35 menit.
+
+struct JobStats {
+  uint32_t runs;
+  uint32_t overruns;        // durasi > budget
+  uint32_t skipped;         // periode terlewat karena loop tertahan
+  uint32_t jitterMaxUs;
+  uint64_t jitterTotalUs;
+  uint32_t durationMaxUs;
+  uint32_t lastDurationUs;
+};
+
+class JobScheduler {
+public:
+  static constexpr uint8_t MAX_JOBS = 16;
+
+  typedef void (*JobFn)();
+  typedef uint32_t (*ClockUs)();
+
+  explicit JobScheduler(ClockUs clock) : clock(clock) {}
+
+  // Job berkala; jalan pertama setelah firstDelayMs. Return id, -1 jika penuh.
+  int8_t every(const char* name, uint32_t periodMs, JobFn fn, uint32_t budgetUs,
+               uint32_t firstDelayMs = 0);
+  // Job sekali jalan, belum aktif sampai arm()
+  int8_t oneShot(const char* name, JobFn fn, uint32_t budgetUs);
+
+  // (Re)jadwalkan job mulai delayMs dari sekarang; job berkala melanjutkan
+  // periodenya dari titik itu
+  void arm(int8_t id, uint32_t delayMs);
+  void disarm(int8_t id);
+  // Ganti periode job berkala (konfigurasi jarak jauh); deadline berikut =
+  // sekarang + periode baru
+  void setPeriod(int8_t id, uint32_t periodMs);
+  // Jalankan pada run() berikutnya
+  void trigger(int8_t id) { arm(id, 0); }
+  bool armed(int8_t id) const;
+
+  // Jalankan semua job yang sudah jatuh tempo. Return jumlah job dijalankan.
+  uint8_t run();
+  // us sampai deadline terdekat (0 jika sudah lewat), UINT32_MAX jika tidak ada
+  uint32_t untilNext() const;
+
+  uint8_t jobCount() const { return count; }
+  const char* name(int8_t id) const { return jobs[id].name; }
+  uint32_t budget(int8_t id) const { return jobs[id].budgetUs; }
+  const JobStats& stats(int8_t id) const { return jobs[id].stats; }
+  // true sekali setelah job overrun (untuk log), lalu direset
+  bool takeOverrunFlag(int8_t id);
+
+private:
+  struct Job {
+    const char* name;
+    JobFn fn;
+    uint32_t periodUs;      // 0 = sekali jalan
+    uint32_t budgetUs;
+    uint32_t deadline;
+    int8_t heapPos;         // -1 = tidak terjadwal
+    bool overrunFlag;
+    JobStats stats;
+  };
+
+  int8_t add(const char* name, JobFn fn, uint32_t periodUs, uint32_t budgetUs);
+  bool before(uint8_t a, uint8_t b) const;
+  void push(uint8_t id);
+  void remove(uint8_t id);
+  void siftUp(uint8_t pos);
+  void siftDown(uint8_t pos);
+  void swapHeap(uint8_t a, uint8_t b);
+
+  ClockUs clock;
+  Job jobs[MAX_JOBS] = {};
+  uint8_t count = 0;
+  uint8_t heap[MAX_JOBS] = {};
+  uint8_t heapSize = 0;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== JSON LITE ====================
+// Pull parser JSON tanpa alokasi dan tanpa salinan: next() maju satu token
+// dan text() menunjuk langsung ke dokumen (misalnya payload MQTT di buffer
+// RX). Grammar dicek penuh (koma, titik dua, pasangan kurung, literal),
+// tapi angka hanya dicek bentuknya; konversi lewat number().
+// Escape string tidak didekode di tempat: copyString() yang mendekode
+// (\uXXXX di luar ASCII ditolak, cukup untuk konfigurasi).
+
+enum class JsonToken : uint8_t {
+  END,            // dokumen selesai dan valid
+  ERROR,          // sintaks rusak; token berikutnya tetap ERROR
+  OBJECT_BEGIN, OBJECT_END,
+  ARRAY_BEGIN, ARRAY_END,
+  KEY,            // nama field; nilainya token berikutnya
+  STRING, NUMBER, TRUE, FALSE, NUL
+};
+
+struct JsonSlice {
+  const char* ptr;
+  size_t len;
+
+  bool equals(const char* s) const;
+};
+
+class JsonReader {
+public:
+  static constexpr uint8_t MAX_DEPTH = 8;
+
+  JsonReader(const char* doc, size_t len) : p(doc), end(doc + len) {}
+
+  JsonToken next();
+  // Lewati nilai milik KEY terakhir (termasuk objek/array bersarang)
+  bool skipValue();
+
+  // Token terakhir: isi KEY/STRING tanpa tanda kutip (escape masih mentah),
+  // teks NUMBER
+  JsonSlice text() const { return { tokStart, tokLen }; }
+  bool number(double& out) const;
+  // Dekode escape; false jika bukan KEY/STRING atau tidak muat (termasuk '\0')
+  bool copyString(char* out, size_t cap) const;
+
+  uint8_t depth() const { return level; }
+
+private:
+  enum class Expect : uint8_t { VALUE, KEY_OR_CLOSE, KEY, COMMA_OR_CLOSE, VALUE_OR_CLOSE, DONE };
+
+  JsonToken fail() { expect = Expect::DONE; failed = true; return JsonToken::ERROR; }
+  JsonToken value();
+  JsonToken afterValue(JsonToken t);
+  bool scanString();
+  void skipSpace();
+
+  const char* p;
+  const char* end;
+  const char* tokStart = nullptr;
+  size_t tokLen = 0;
+  JsonToken last = JsonToken::END;
+  Expect expect = Expect::VALUE;
+  bool failed = false;
+  uint8_t level = 0;
+  bool inArray[MAX_DEPTH] = {};
+};
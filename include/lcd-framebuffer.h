@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== LCD FRAMEBUFFER ====================
+// Semua tampilan digambar ke shadow 20x4 di RAM, lalu flush() hanya mengirim
+// sel yang berbeda dari isi LCD saat ini. Tidak ada lcd.clear() (2 ms +
+// kedip) dan angka besar tidak dikirim ulang utuh setiap berat berubah.
+// Urutan DDRAM HD44780 20x4 adalah baris 0, 2, 1, 3 dan alamatnya
+// bersambung, jadi sel yang berurutan di urutan itu cukup satu setCursor.
+// Biaya: 1 byte LCD per karakter atau perpindahan kursor (driver: pcf8574-lcd.h).
+
+class LcdSink {
+public:
+  virtual ~LcdSink() {}
+  virtual void setCursor(uint8_t col, uint8_t row) = 0;
+  // Karakter berurutan mulai dari posisi kursor
+  virtual void write(const uint8_t* data, size_t len) = 0;
+  virtual void createChar(uint8_t slot, const uint8_t rows[8]) = 0;
+  // Sisa kapasitas dalam byte LCD (driver berantrian); flush tidak melebihinya
+  virtual size_t room() const { return SIZE_MAX; }
+  // Akhir satu flush: driver boleh mengirim yang masih ditampung
+  virtual void commit() {}
+};
+
+// Angka besar 3x3 sel (titik desimal 1 kolom) dari 5 karakter CGRAM.
+// Slot 0..4 dipakai font; slot 5..7 bebas untuk ikon.
+namespace LcdBigDigits {
+  constexpr uint8_t FIRST_SLOT = 0;
+  constexpr uint8_t SLOT_COUNT = 5;
+  constexpr uint8_t WIDTH = 3;
+  constexpr uint8_t HEIGHT = 3;
+}
+
+// Unggah font angka besar ke CGRAM (sekali di setup)
+void lcdLoadBigDigits(LcdSink& sink);
+
+struct LcdStats {
+  uint32_t flushes;      // flush yang mengirim sesuatu
+  uint32_t bytes;        // byte LCD (karakter + perintah kursor)
+  uint32_t cursorMoves;
+};
+
+class LcdFramebuffer {
+public:
+  static constexpr uint8_t COLS = 20;
+  static constexpr uint8_t ROWS = 4;
+
+  LcdFramebuffer();
+
+  // --- Menggambar (hanya shadow, tanpa I/O) ---
+  void clear();
+  void clearRow(uint8_t row);
+  void put(uint8_t col, uint8_t row, uint8_t ch);
+  // Teks dipotong di tepi kanan; return kolom setelah karakter terakhir
+  uint8_t print(uint8_t col, uint8_t row, const char* text);
+  // Teks lalu spasi sampai `width` kolom (menimpa sisa teks sebelumnya)
+  void printPadded(uint8_t col, uint8_t row, const char* text, uint8_t width);
+  // Angka besar dari teks berisi '0'-'9', '.', '-', ' '. (col,row) = sudut
+  // kiri atas. Return lebar dalam kolom.
+  uint8_t bigNumber(uint8_t col, uint8_t row, const char* text);
+
+  // --- Sinkronisasi dengan LCD ---
+  // Kirim sel yang berubah. maxBytes membatasi byte LCD per panggilan agar
+  // redraw besar tersebar di beberapa loop; sisanya terkirim di flush berikutnya.
+  size_t flush(LcdSink& sink, size_t maxBytes = SIZE_MAX);
+  bool dirty() const;
+  // LCD baru di-init / di-clear langsung: isinya spasi, posisi kursor tidak diketahui
+  void markCleared();
+  // Isi LCD tidak diketahui: flush berikutnya menulis ulang semua sel
+  void invalidate();
+
+  uint8_t at(uint8_t col, uint8_t row) const { return shadow[row][col]; }
+  const LcdStats& stats() const { return counters; }
+
+private:
+  static constexpr uint16_t UNKNOWN = 0x100;   // isi sel LCD tidak diketahui
+
+  uint8_t shadow[ROWS][COLS];
+  uint16_t shown[ROWS][COLS];                  // yang terakhir dikirim ke LCD
+  int16_t cursor = -1;           // indeks urutan DDRAM (0..79), -1 = tidak diketahui
+  LcdStats counters = {};
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+// ==================== HALAMAN LIVE VIEW ====================
+// Dilayani WsServer di GET /. Frame biner dari /ws (little-endian, 13 byte):
+//   u32 seq | u32 millis | f32 berat (kg) | u8 flags (bit0 stabil, bit1 ada beban)
+// Loncatan seq = frame yang dibuang karena browser tertinggal.
+
+static const char LIVE_VIEW_PAGE[] = R"HTML(<!DOCTYPE html>
+<html lang="id"><head><meta charset="utf-8"><meta name="viewport" content="width=device-width,initial-scale=1">
+<title>EcoScale Live</title>
+<style>
+body{font-family:system-ui,sans-serif;background:#111827;color:#f9fafb;margin:0;padding:16px;text-align:center}
+#w{font-size:22vw;font-weight:700;line-height:1.1}#w.s{color:#34d399}
+#info{color:#9ca3af;font-size:14px}canvas{width:100%;height:160px;background:#1f2937;border-radius:8px}
+</style></head><body>
+<div id="w">-</div><div id="info">menghubungkan...</div>
+<canvas id="c" width="600" height="160"></canvas>
+<script>
+const w=document.getElementById('w'),info=document.getElementById('info'),cv=document.getElementById('c'),g=cv.getContext('2d');
+const hist=[];let lastSeq=-1,gaps=0,count=0,rate=0;
+setInterval(()=>{rate=count;count=0},1000);
+function draw(){g.clearRect(0,0,cv.width,cv.height);if(hist.length<2)return;
+const max=Math.max(1,...hist);g.strokeStyle='#34d399';g.beginPath();
+hist.forEach((v,i)=>{const x=i*cv.width/(hist.length-1),y=cv.height-v/max*(cv.height-8)-4;i?g.lineTo(x,y):g.moveTo(x,y)});g.stroke()}
+function connect(){const ws=new WebSocket(`ws://${location.host}/ws`);ws.binaryType='arraybuffer';
+ws.onopen=()=>{info.textContent='terhubung'};
+ws.onmessage=e=>{const d=new DataView(e.data);if(d.byteLength<13)return;
+const seq=d.getUint32(0,true),kg=d.getFloat32(8,true),flags=d.getUint8(12);
+if(lastSeq>=0&&seq!==lastSeq+1)gaps+=seq-lastSeq-1;lastSeq=seq;count++;
+w.textContent=kg.toFixed(2)+' kg';w.className=flags&1?'s':'';
+hist.push(kg);if(hist.length>300)hist.shift();
+info.textContent=`${rate} sampel/s, terlewat ${gaps}`};
+ws.onclose=()=>{info.textContent='terputus, mencoba lagi...';lastSeq=-1;setTimeout(connect,2000)}}
+(function frame(){draw();requestAnimationFrame(frame)})();connect();
+</script></body></html>
+)HTML";
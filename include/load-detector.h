@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+// ==================== LOAD DETECTOR ====================
+// Mendeteksi beban yang baru diletakkan lalu stabil. Ini petunjuk kuat bahwa
+// operator sebentar lagi menekan tombol kirim, sehingga jaringan bisa
+// disiapkan lebih dulu (DNS + TCP + TLS). Hanya satu petunjuk per beban;
+// detektor siap lagi setelah timbangan kosong.
+
+struct LoadDetectorConfig {
+  float emptyKg        = 0.05f;  // di bawah ini timbangan dianggap kosong
+  float minLoadKg      = 0.10f;  // beban minimal untuk dianggap "ada barang"
+  float settleBandKg   = 0.02f;  // variasi maksimal selama fase stabil
+  unsigned long settleMs = 600;  // lama harus stabil
+};
+
+class LoadDetector {
+public:
+  explicit LoadDetector(const LoadDetectorConfig& config = LoadDetectorConfig()) : config(config) {}
+
+  // Masukkan sampel berat (kg). Return true tepat sekali saat beban baru stabil.
+  bool update(float weightKg, unsigned long now);
+
+  bool loaded() const { return state != State::EMPTY; }
+  bool settled() const { return state == State::SETTLED; }
+
+private:
+  enum class State : uint8_t { EMPTY, SETTLING, SETTLED };
+
+  LoadDetectorConfig config;
+  State state = State::EMPTY;
+  float settleRef = 0;
+  unsigned long settleStart = 0;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+// ==================== LOG TERTOKENISASI ====================
+// Build dengan -DLOG_TOKENIZED: format string LOG_x diganti hash FNV-1a
+// 32-bit saat kompilasi (string tidak masuk flash), argumen dikirim biner:
+//   integer -> varint zigzag, float/double -> f32, string -> u8 len + isi
+// Frame: u8 (level << 4 | modul) | varint waktu ms | u32 token | argumen
+// Di UART satu frame = satu baris "$<base64>\n", jadi tetap bisa bercampur
+// dengan teks biasa (bootloader, panic). tools/log-tokens.py membuat
+// database token dari source; tools/log-detokenize.cpp mengembalikan teks.
+
+namespace LogToken {
+  constexpr uint32_t FNV_OFFSET = 2166136261u;
+  constexpr uint32_t FNV_PRIME = 16777619u;
+  constexpr size_t STRING_MAX = 63;   // argumen %s lebih panjang dipotong
+  constexpr char FRAME_PREFIX = '$';
+
+  // Rekursif agar tetap constexpr di C++11
+  constexpr uint32_t hash(const char* s, uint32_t h = FNV_OFFSET) {
+    return *s ? hash(s + 1, (h ^ (uint8_t)*s) * FNV_PRIME) : h;
+  }
+}
+
+class LogArgWriter {
+public:
+  LogArgWriter(uint8_t* buf, size_t cap) : buf(buf), cap(cap) {}
+
+  void byte(uint8_t v);
+  void varint(uint64_t v);
+  void u32(uint32_t v);
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type arg(T v) {
+    int64_t s = (int64_t)v;
+    varint(((uint64_t)s << 1) ^ (uint64_t)(s >> 63));
+  }
+  void arg(double v);
+  void arg(const char* s);
+
+  void args() {}
+  template <typename T, typename... Rest>
+  void args(T first, Rest... rest) { arg(first); args(rest...); }
+
+  size_t size() const { return len; }
+  bool overflow() const { return overflowed; }
+
+private:
+  uint8_t* buf;
+  size_t cap;
+  size_t len = 0;
+  bool overflowed = false;
+};
+
+// --- Sisi pembaca (detokenizer host, tes) ---
+
+struct LogFrame {
+  uint8_t level;
+  uint8_t module;
+  uint32_t timeMs;
+  uint32_t token;
+  const uint8_t* args;
+  size_t argsLen;
+};
+
+bool logFrameDecode(const uint8_t* in, size_t len, LogFrame& frame);
+
+// printf ulang dengan argumen biner. Mendukung flag/lebar/presisi/panjang
+// dan konversi d i u x X o c s f F e E g G %%. Return panjang (terpotong ke cap).
+size_t logFormatArgs(char* out, size_t cap, const char* fmt, const uint8_t* args, size_t argsLen);
+
+// Tanpa padding; out >= ceil(len * 4 / 3)
+size_t base64Encode(const uint8_t* in, size_t len, char* out);
+// 0 jika karakter tidak valid atau tidak muat
+size_t base64Decode(const char* in, size_t len, uint8_t* out, size_t cap);
@@ -0,0 +1,168 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== MQTT ASYNC (QoS 1) ====================
+// Client MQTT 3.1.1 minimal pengganti PubSubClient:
+// - connect TCP non-blocking (tidak pernah menahan loop())
+// - publish QoS 1 dengan in-flight window yang bisa diatur
+// - clean-session = false + clientId tetap per perangkat, sehingga broker
+//   menyimpan sesi dan paket yang belum di-ACK dikirim ulang saat reconnect
+// Semua I/O lewat MqttTransport, jadi bisa diuji di host dengan broker stub.
+
+class MqttTransport {
+public:
+  virtual ~MqttTransport() {}
+  // Mulai koneksi tanpa menunggu. Return false jika gagal seketika.
+  virtual bool open(const char* host, uint16_t port) = 0;
+  // 1 = tersambung, 0 = masih proses, -1 = gagal / terputus
+  virtual int poll() = 0;
+  // Jumlah byte yang diterima socket (bisa sebagian), -1 jika error
+  virtual int write(const uint8_t* data, size_t len) = 0;
+  // Jumlah byte terbaca, 0 jika belum ada data, -1 jika koneksi tertutup
+  virtual int read(uint8_t* buf, size_t len) = 0;
+  virtual void close() = 0;
+};
+
+enum class MqttState : uint8_t { DISCONNECTED, CONNECTING, WAIT_CONNACK, CONNECTED };
+
+class MqttAsyncClient {
+public:
+  static constexpr int MAX_INFLIGHT = 8;
+  static constexpr int MAX_SUBSCRIPTIONS = 4;
+  static constexpr size_t TOPIC_SIZE = 80;
+  static constexpr size_t PAYLOAD_SIZE = 256;
+  static constexpr size_t TX_BUFFER_SIZE = 1024;
+  static constexpr size_t RX_BUFFER_SIZE = 768;
+
+  typedef void (*MessageCallback)(const char* topic, const uint8_t* payload, size_t len);
+  typedef void (*AckCallback)(uint16_t packetId);
+  // Dipanggil setiap CONNACK diterima (sambungan pertama maupun reconnect)
+  typedef void (*ConnectCallback)();
+
+  explicit MqttAsyncClient(MqttTransport& transport) : transport(transport) {}
+
+  void setServer(const char* host, uint16_t port) { this->host = host; this->port = port; }
+  void setClientId(const char* id) { clientId = id; }
+  void setKeepAlive(uint16_t seconds) { keepAliveSec = seconds; }
+  void setCleanSession(bool clean) { cleanSession = clean; }
+  void setInflightWindow(uint8_t window);
+  void setWill(const char* topic, const char* payload, uint8_t qos, bool retain);
+  void setCallback(MessageCallback cb) { onMessage = cb; }
+  void setAckCallback(AckCallback cb) { onAck = cb; }
+  void setConnectCallback(ConnectCallback cb) { onConnect = cb; }
+
+  // Publish. QoS 0 hanya saat tersambung; QoS 1 tetap diterima saat terputus
+  // selama window belum penuh dan dikirim begitu koneksi kembali.
+  // Return packetId (> 0) untuk QoS 1, 1 untuk QoS 0 yang terkirim, 0 jika ditolak.
+  uint16_t publish(const char* topic, const uint8_t* payload, size_t len, uint8_t qos, bool retain);
+  uint16_t publish(const char* topic, const char* payload, uint8_t qos = 1, bool retain = false);
+  bool subscribe(const char* topic, uint8_t qos = 1);
+
+  // Dipanggil tiap loop(); menjalankan state machine koneksi, TX, RX dan keepalive.
+  void loop(unsigned long now);
+  void disconnect();
+
+  bool connected() const { return state == MqttState::CONNECTED; }
+  MqttState getState() const { return state; }
+  uint8_t inflightCount() const;
+  bool windowFull() const { return inflightCount() >= window; }
+  uint32_t retransmitCount() const { return retransmits; }
+  uint32_t reconnectCount() const { return reconnects; }
+
+private:
+  struct Inflight {
+    bool used;
+    bool needsSend;
+    bool sentOnce;
+    bool retain;
+    uint16_t packetId;
+    unsigned long sentAt;
+    uint16_t payloadLen;
+    char topic[TOPIC_SIZE];
+    uint8_t payload[PAYLOAD_SIZE];
+  };
+  // Tahap membuang paket terlalu besar; PUBLISH QoS 1 melewati
+  // TOPIC_LEN -> TOPIC -> PACKET_ID (PUBACK) sebelum BODY
+  enum class RxDiscard : uint8_t { BODY, TOPIC_LEN, TOPIC, PACKET_ID };
+  struct Subscription {
+    bool used;
+    uint8_t qos;
+    char topic[TOPIC_SIZE];
+  };
+
+  void startConnect(unsigned long now);
+  void dropConnection(unsigned long now, const char* reason);
+  bool sendConnect();
+  void sendSubscriptions();
+  void pumpInflight(unsigned long now);
+  void flushTx(unsigned long now);
+  void readIncoming(unsigned long now);
+  void discardOversized();
+  void handlePacket(uint8_t header, const uint8_t* body, size_t len, unsigned long now);
+  bool queueTx(const uint8_t* data, size_t len);
+  bool queuePublish(const char* topic, const uint8_t* payload, size_t len,
+                    uint8_t qos, bool retain, bool dup, uint16_t packetId);
+  bool queueAck(uint8_t type, uint16_t packetId);
+  uint16_t nextPacketId();
+
+  MqttTransport& transport;
+  const char* host = nullptr;
+  uint16_t port = 1883;
+  const char* clientId = "ESP32Scale";
+  uint16_t keepAliveSec = 30;
+  bool cleanSession = false;
+  uint8_t window = 4;
+
+  const char* willTopic = nullptr;
+  const char* willPayload = nullptr;
+  uint8_t willQos = 0;
+  bool willRetain = false;
+
+  MessageCallback onMessage = nullptr;
+  AckCallback onAck = nullptr;
+  ConnectCallback onConnect = nullptr;
+
+  MqttState state = MqttState::DISCONNECTED;
+  unsigned long stateSince = 0;
+  unsigned long lastTxTime = 0;
+  unsigned long lastRxTime = 0;
+  unsigned long retryDelay = 1000;
+  bool everAttempted = false;
+  bool pingOutstanding = false;
+  uint16_t lastPacketId = 0;
+  uint32_t retransmits = 0;
+  uint32_t reconnects = 0;
+
+  Inflight inflight[MAX_INFLIGHT] = {};
+  Subscription subs[MAX_SUBSCRIPTIONS] = {};
+
+  uint8_t txBuf[TX_BUFFER_SIZE];
+  size_t txLen = 0;
+  uint8_t rxBuf[RX_BUFFER_SIZE];
+  size_t rxLen = 0;
+  size_t rxSkip = 0; // sisa byte paket terlalu besar yang sedang dibuang
+  RxDiscard rxDiscard = RxDiscard::BODY;
+  size_t rxTopicLeft = 0;
+};
+
+#ifdef ARDUINO
+// Transport TCP di atas socket lwIP mode non-blocking (DNS juga async)
+class LwipTcpTransport : public MqttTransport {
+public:
+  bool open(const char* host, uint16_t port) override;
+  int poll() override;
+  int write(const uint8_t* data, size_t len) override;
+  int read(uint8_t* buf, size_t len) override;
+  void close() override;
+
+private:
+  bool startSocket();
+
+  int fd = -1;
+  uint16_t port = 0;
+  const char* host = nullptr;
+  bool resolving = false;
+  bool socketConnected = false;
+};
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "lcd-framebuffer.h"
+
+// ==================== DRIVER LCD PCF8574 ====================
+// HD44780 mode 4-bit lewat backpack PCF8574 (P0 RS, P1 RW, P2 EN, P3
+// backlight, P4..P7 = D4..D7). LiquidCrystal_I2C mengirim tiap nibble
+// sebagai 3 transaksi I2C terpisah + delay 50 us. Di sini setiap byte LCD
+// = 4 byte expander (nibble|EN, nibble), dan satu run karakter dikirim
+// dalam satu transaksi I2C (maks MAX_TRANSFER byte). Pada 400 kHz satu byte
+// LCD makan 90 us di bus, lebih lama dari waktu eksekusi HD44780 (37 us),
+// jadi tidak perlu delay di antaranya.
+// Byte expander ditampung di ring buffer: mode sinkron dikirim saat
+// commit(), mode async dikuras task terpisah sehingga loop() tidak menunggu.
+
+class I2cBus {
+public:
+  virtual ~I2cBus() {}
+  // Satu transaksi (start, alamat, data, stop). false jika NACK / error.
+  virtual bool write(uint8_t address, const uint8_t* data, size_t len) = 0;
+};
+
+struct LcdBusStats {
+  uint32_t transfers;
+  uint32_t bytes;       // byte expander terkirim
+  uint32_t errors;
+};
+
+class Pcf8574Lcd : public LcdSink {
+public:
+  static constexpr size_t RING_SIZE = 1024;       // > redraw penuh terburuk (160 byte LCD x 4)
+  static constexpr size_t MAX_TRANSFER = 128;     // buffer Wire ESP32
+  static constexpr uint8_t BYTES_PER_LCD_BYTE = 4;
+
+  typedef void (*DelayUsFn)(uint32_t us);
+
+  Pcf8574Lcd(I2cBus& bus, uint8_t address = 0x27) : bus(bus), address(address) {}
+
+  // Urutan init HD44780 4-bit, 2 baris, display on, clear. Blocking
+  // (~50 ms), dipanggil sekali sebelum startAsync().
+  bool begin(DelayUsFn delayUs);
+  void setBacklight(bool on);
+
+  // --- LcdSink ---
+  void setCursor(uint8_t col, uint8_t row) override;
+  void write(const uint8_t* data, size_t len) override;
+  void createChar(uint8_t slot, const uint8_t rows[8]) override;
+  size_t room() const override;
+  void commit() override;
+
+  // Kirim isi ring ke bus, maks satu transaksi. Return byte terkirim.
+  size_t pump();
+  bool idle() const { return head == tail; }
+  const LcdBusStats& stats() const { return counters; }
+
+#ifdef ARDUINO
+  // Task pengirim (core 0). Setelah ini commit() hanya membangunkan task.
+  bool startAsync();
+#endif
+
+private:
+  void command(uint8_t value);
+  void sendByte(uint8_t value, uint8_t mode);
+  void waitRoom(size_t expanderBytes);
+  void push(uint8_t expanderByte);
+  void pumpAll();
+
+  I2cBus& bus;
+  uint8_t address;
+  uint8_t backlight = 0x08;
+  uint8_t lastMode = 0xFF;           // RS byte terakhir; berubah = perlu byte setup
+
+  // SPSC: loop() menulis head, pengirim menulis tail (satu word volatile per sisi)
+  uint8_t ring[RING_SIZE];
+  volatile uint32_t head = 0;
+  volatile uint32_t tail = 0;
+  void* task = nullptr;              // TaskHandle_t jika async
+  LcdBusStats counters = {};
+};
+
+#ifdef ARDUINO
+class TwoWire;
+
+class WireI2cBus : public I2cBus {
+public:
+  explicit WireI2cBus(TwoWire& wire) : wire(wire) {}
+  bool begin(uint32_t clockHz);
+  bool write(uint8_t address, const uint8_t* data, size_t len) override;
+
+private:
+  TwoWire& wire;
+};
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== PROTOTHREAD (FLOW) ====================
+// Urutan panjang (stabilisasi + tare, connect WiFi, layar status) ditulis
+// berurutan seperti kode dengan delay(), tetapi tiap "tunggu" mengembalikan
+// kendali ke loop() alih-alih tidur. Stackless gaya Dunkels (switch +
+// __LINE__): toolchain ESP32 (GCC 8) belum punya coroutine C++20, dan
+// protothread tidak butuh stack/heap per flow.
+//
+//   PtState contohFlow(Pt& pt, uint32_t now) {
+//     static uint8_t i;              // state lintas yield: static / global
+//     PT_BEGIN(pt);
+//     for (i = 0; i < 3; i++) {
+//       bunyi();
+//       PT_SLEEP(pt, now, 500);      // loop() tetap jalan selama 500 ms
+//     }
+//     PT_WAIT_UNTIL(pt, siap());
+//     PT_END(pt);
+//   }
+//
+// Batasan:
+// - Variabel lokal TIDAK bertahan melewati yield; pakai static atau global.
+// - Satu makro PT_* per baris (label case memakai __LINE__).
+// - PT_* tidak boleh berada di dalam switch milik flow itu sendiri.
+// - `now` adalah parameter flow (millis() saat run), dievaluasi ulang
+//   setiap kali flow dilanjutkan.
+
+enum class PtState : uint8_t { WAITING, ENDED };
+
+struct Pt {
+  uint16_t line;    // titik lanjut, 0 = awal
+  uint32_t mark;    // awal timer PT_SLEEP / PT_TIMER_START (ms)
+};
+
+typedef PtState (*PtFn)(Pt& pt, uint32_t nowMs);
+
+#define PT_BEGIN(pt) switch ((pt).line) { case 0:
+#define PT_END(pt) } (pt).line = 0; return PtState::ENDED
+
+#define PT_WAIT_UNTIL(pt, cond)                       \
+  do {                                                \
+    (pt).line = __LINE__;                             \
+    [[fallthrough]]; case __LINE__:                   \
+    if (!(cond)) return PtState::WAITING;             \
+  } while (0)
+
+#define PT_YIELD(pt)                                  \
+  do {                                                \
+    (pt).line = __LINE__;                             \
+    return PtState::WAITING;                          \
+    case __LINE__:;                                   \
+  } while (0)
+
+#define PT_EXIT(pt) do { (pt).line = 0; return PtState::ENDED; } while (0)
+
+#define PT_TIMER_START(pt, now) ((pt).mark = (now))
+#define PT_ELAPSED(pt, now) ((uint32_t)((now) - (pt).mark))
+
+#define PT_SLEEP(pt, now, ms)                         \
+  do {                                                \
+    PT_TIMER_START(pt, now);                          \
+    PT_WAIT_UNTIL(pt, PT_ELAPSED(pt, now) >= (uint32_t)(ms)); \
+  } while (0)
+
+// Periode loop() (us): tanpa flow, dan selama ada flow berjalan
+struct LoopStats {
+  uint32_t loops;
+  uint32_t lastPeriodUs;
+  uint32_t maxPeriodUs;
+  uint32_t maxPeriodFlowUs;   // maks selama minimal satu flow aktif
+};
+
+// Penjadwal flow kooperatif di atas loop(): run() melanjutkan setiap flow
+// aktif satu langkah (sampai yield / tunggu berikutnya).
+class PtRunner {
+public:
+  static constexpr uint8_t MAX_FLOWS = 4;
+
+  // Dipanggil saat flow selesai: lama flow dan periode loop terpanjang
+  // selama flow tersebut berjalan
+  typedef void (*DoneFn)(const char* name, uint32_t elapsedMs, uint32_t maxLoopUs);
+
+  void onDone(DoneFn fn) { done = fn; }
+
+  // false jika penuh atau flow yang sama masih berjalan
+  bool start(const char* name, PtFn fn, uint32_t nowMs);
+  bool running(PtFn fn) const;
+  bool busy() const { return active > 0; }
+
+  void run(uint32_t nowMs);
+  // Panggil sekali di awal setiap loop()
+  void markLoop(uint32_t nowUs);
+
+  const LoopStats& loopStats() const { return stats; }
+
+private:
+  struct Flow {
+    const char* name;
+    PtFn fn;
+    Pt pt;
+    uint32_t startedAt;
+    uint32_t maxLoopUs;
+  };
+
+  Flow flows[MAX_FLOWS] = {};
+  uint8_t active = 0;
+  DoneFn done = nullptr;
+
+  LoopStats stats = {};
+  uint32_t lastLoopUs = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+
+// ==================== RADIO-QUIET WINDOW ====================
+// Burst TX WiFi menimbulkan ripple catu daya yang terbaca sebagai spike di
+// HX711. Dua mekanisme:
+//  1. Jendela senyap: jalur akuisisi meminta radio diam saat berat dikunci
+//     untuk pengiriman; kode jaringan menunda kirim selama jendela aktif.
+//  2. Penandaan: setiap TX dicatat (hook netif), sampel yang konversinya
+//     bersinggungan dengan TX ditandai dan dibuang oleh CleanWeightFilter.
+
+class RadioQuiet {
+public:
+  static constexpr uint32_t TX_GUARD_MS = 15; // ripple masih terasa sesaat setelah TX
+  static constexpr uint8_t TX_HISTORY = 16;    // pangkat 2; cukup untuk burst MQTT+TLS dalam satu konversi
+
+  void requestQuiet(uint32_t now, uint32_t durationMs);
+  void release() { quietActive = false; }
+  // Dipakai kode jaringan: false = tunda kirim
+  bool mayTransmit(uint32_t now) const { return !quietActive || (int32_t)(now - quietUntil) >= 0; }
+
+  // Dipanggil di setiap TX dari satu task (tcpip): slot ditulis dulu, baru
+  // penghitung dinaikkan, sehingga pembaca di task lain selalu melihat slot terisi
+  void noteTx(uint32_t now) {
+    uint32_t i = txEvents;
+    txRing[i % TX_HISTORY] = now;
+    txEvents = i + 1;
+  }
+  // true jika ada TX di [sampleAt - conversionMs - guard, sampleAt]. Jika
+  // TX di jendela itu mungkin sudah tertimpa (lebih dari TX_HISTORY TX
+  // sesudahnya), sampel juga dianggap kena.
+  bool txNear(uint32_t sampleAt, uint32_t conversionMs) const;
+  uint32_t txCount() const { return txEvents; }
+
+private:
+  volatile uint32_t txRing[TX_HISTORY] = {};
+  volatile uint32_t txEvents = 0;
+  bool quietActive = false;
+  uint32_t quietUntil = 0;
+};
+
+// Rata-rata geser sampel bersih. Sampel bertanda TX dilewati; jika terlalu
+// banyak berturut-turut (radio sibuk terus), sampel tetap dipakai agar
+// tampilan tidak membeku.
+class CleanWeightFilter {
+public:
+  static constexpr uint8_t WINDOW = 2;
+  static constexpr uint8_t MAX_CONSECUTIVE_SKIP = 5;
+
+  float update(float value, bool tagged);
+  float value() const { return output; }
+  uint32_t skippedCount() const { return skipped; }
+
+private:
+  float window[WINDOW] = {};
+  uint8_t index = 0;
+  uint8_t filled = 0;
+  uint8_t skipRun = 0;
+  uint32_t skipped = 0;
+  float output = 0;
+};
+
+#ifdef ARDUINO
+// Pasang hook di netif STA: setiap frame keluar memanggil noteTx().
+// Idempoten; panggil lagi setelah WiFi (re)start.
+bool installTxHook(RadioQuiet& radioQuiet);
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "waste-category.h"
+
+// ==================== RECORD & OUTBOX ====================
+// Setiap penimbangan menjadi satu WeighingRecord dengan nomor urut (seq)
+// per perangkat yang naik terus walau reboot. Kunci idempotensi
+// "<deviceId>-<seq>" dikirim ke semua backend, sehingga retry (otomatis
+// maupun dari outbox) tidak pernah membuat baris ganda di server.
+
+struct WeighingRecord {
+  uint32_t seq;
+  uint64_t monoMs;    // waktu penimbangan, ms monoton sejak boot (lihat TimeService)
+  float weight;       // kg
+  WasteCategory category;   // kategori final; nama payload dari tabel kategori
+  uint8_t attempts;
+};
+
+// Hasil pengiriman ke backend
+enum class SendResult : uint8_t {
+  ACKED,     // server mengonfirmasi (baru disimpan atau duplikat yang sudah ada)
+  RETRY,     // timeout / error jaringan / 5xx / respon tidak dikenal -> kirim ulang
+  REJECTED,  // 4xx: payload ditolak, retry tidak akan membantu
+  PENDING    // backend async: transfer masih berjalan (tidak pernah disimpan/dikirim ke node)
+};
+
+// Penyimpanan permanen untuk counter (NVS di ESP32, memori biasa di host)
+class CounterStorage {
+public:
+  virtual ~CounterStorage() {}
+  virtual uint32_t load() = 0;
+  virtual void save(uint32_t value) = 0;
+};
+
+// Counter monoton yang dicadangkan per blok: flash hanya ditulis sekali tiap
+// SEQ_BLOCK record. Setelah reboot nomor lanjut dari batas blok berikutnya
+// (boleh ada celah, tidak pernah mundur atau terulang).
+class SequenceCounter {
+public:
+  static constexpr uint32_t SEQ_BLOCK = 32;
+
+  explicit SequenceCounter(CounterStorage& storage) : storage(storage) {}
+  void begin();
+  uint32_t next();
+  uint32_t peek() const { return nextSeq; }
+
+private:
+  CounterStorage& storage;
+  uint32_t nextSeq = 1;
+  uint32_t reservedUpTo = 0;
+};
+
+// Antrian record yang belum di-ACK server, dikirim ulang dengan backoff
+class RecordOutbox {
+public:
+  static constexpr size_t CAPACITY = 16;
+  static constexpr unsigned long RETRY_MIN = 5000;
+  static constexpr unsigned long RETRY_MAX = 60000;
+
+  bool push(const WeighingRecord& rec);
+  bool empty() const { return count == 0; }
+  size_t size() const { return count; }
+  WeighingRecord& front() { return items[head]; }
+  WeighingRecord& at(size_t i) { return items[(head + i) % CAPACITY]; }
+  void pop();
+  // Hapus record dengan seq tertentu (ACK datang tidak berurutan, mis. lewat relay)
+  bool remove(uint32_t seq);
+
+  // Jadwal retry: true jika record terdepan sudah boleh dicoba lagi
+  bool due(unsigned long now) const { return count > 0 && (long)(now - nextAttemptAt) >= 0; }
+  void onSuccess(unsigned long now);
+  void onFailure(unsigned long now);
+
+private:
+  WeighingRecord items[CAPACITY];
+  size_t head = 0;
+  size_t count = 0;
+  unsigned long nextAttemptAt = 0;
+  unsigned long retryDelay = RETRY_MIN;
+};
+
+#ifdef ARDUINO
+// Counter di NVS (Preferences), namespace "ecoscale"
+class NvsCounterStorage : public CounterStorage {
+public:
+  explicit NvsCounterStorage(const char* key) : key(key) {}
+  uint32_t load() override;
+  void save(uint32_t value) override;
+
+private:
+  const char* key;
+};
+#endif
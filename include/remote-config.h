@@ -0,0 +1,140 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "async-log.h"
+
+// ==================== KONFIGURASI JARAK JAUH ====================
+// Nilai tuning yang dulu constexpr (interval baca/LCD/WiFi, ambang berat,
+// pre-warm upload, broker & topik MQTT, fakultas, level log) dikirim sebagai dokumen JSON
+// berversi di topik config per perangkat, misalnya:
+//   {"version":7,"weight_read_ms":100,"lcd_update_ms":200,
+//    "mqtt_server":"10.0.0.5","log":{"mqtt":"debug"}}
+// - Field yang tidak ada = default firmware (dokumen selalu lengkap secara
+//   makna, jadi bisa disimpan apa adanya dan diparse ulang saat boot)
+// - version harus naik; dokumen retained yang sama saat reconnect diabaikan
+// - Satu field tidak valid / tidak dikenal -> seluruh dokumen ditolak
+// - Parse langsung dari payload MQTT (json-lite, tanpa salinan); yang
+//   disalin hanya dokumen yang diterima, untuk disimpan ke NVS
+// - offer() hanya menyiapkan (staging); active() baru berganti saat
+//   activate(), dipanggil di luar callback MQTT karena klien MQTT memegang
+//   pointer ke active().mqttServer
+// Efek per field: LIVE langsung berlaku, RECONNECT lewat reconnect MQTT
+// (dicoba dulu, commit ke NVS setelah broker baru tersambung), REBOOT
+// disimpan dan berlaku setelah restart.
+// Autentikasi (broker publik, siapa saja bisa publish): payload = dokumen,
+// '\n', lalu 64 hex HMAC-SHA256(PSK, keyId | '\n' | dokumen). keyId =
+// deviceId, jadi dokumen untuk satu perangkat tidak bisa diputar ulang ke
+// perangkat lain; backend memilih PSK dari deviceId seperti penerima CoAP.
+// Tanpa tag / tag salah -> REJECTED. Dokumen di NVS disimpan tanpa tag.
+
+struct RuntimeConfig {
+  uint32_t version;
+  uint32_t weightReadMs;
+  uint32_t lcdUpdateMs;
+  uint32_t statusRowMs;
+  uint32_t wifiCheckMs;
+  uint32_t pingCheckMs;
+  uint32_t metricsMs;
+  uint32_t weightPublishMs;
+  float minWeightKg;
+  bool prewarmUpload;
+  char mqttServer[64];
+  uint16_t mqttPort;
+  char mqttTopic[64];
+  char fakultas[8];
+  LogLevel logLevels[(uint8_t)LogModule::COUNT];
+};
+
+enum ConfigEffect : uint8_t {
+  CONFIG_LIVE      = 0x01,
+  CONFIG_RECONNECT = 0x02,
+  CONFIG_REBOOT    = 0x04,
+};
+
+enum class ConfigStatus : uint8_t { APPLIED, UNCHANGED, STALE, REJECTED, ROLLED_BACK };
+
+struct ConfigResult {
+  ConfigStatus status;
+  uint32_t version;        // versi dokumen yang ditawarkan
+  uint8_t effects;         // gabungan ConfigEffect field yang berubah
+  char error[48];          // alasan penolakan ("weight_read_ms: di luar batas")
+};
+
+class ConfigStore {
+public:
+  virtual ~ConfigStore() {}
+  // Return panjang dokumen tersimpan, 0 jika tidak ada
+  virtual size_t load(char* buf, size_t cap) = 0;
+  virtual bool save(const char* doc, size_t len) = 0;
+};
+
+class RemoteConfig {
+public:
+  static constexpr size_t DOC_MAX = 512;
+  static constexpr size_t TAG_HEX = 64;
+
+  RemoteConfig(const RuntimeConfig& defaults, ConfigStore& store)
+    : defaults(defaults), store(store), activeCfg(defaults), committedCfg(defaults) {}
+
+  // Muat dokumen dari NVS; rusak/tidak ada -> default firmware
+  bool begin();
+  // Kunci verifikasi offer(); pointer disimpan, bukan disalin
+  void setKey(const char* keyId, const uint8_t* psk, size_t pskLen);
+
+  // Verifikasi tag dan validasi dokumen baru. APPLIED: diterima dan
+  // disiapkan, active() belum berubah sampai activate()
+  ConfigResult offer(const char* payload, size_t len);
+  // Jadikan dokumen yang disiapkan aktif (APPLIED + efek terhadap config
+  // sebelumnya, UNCHANGED jika tidak ada); NVS baru ditulis saat commit()
+  ConfigResult activate();
+  bool staged() const { return stagedLen > 0; }
+  bool commit();
+  // Kembali ke konfigurasi terakhir yang di-commit. Versi yang gagal
+  // diingat (RAM saja): offer() menolak versi <= itu sampai ada yang lebih baru
+  ConfigResult rollback();
+  bool uncommitted() const { return pendingLen > 0; }
+
+  const RuntimeConfig& active() const { return activeCfg; }
+
+  // Parse tanpa efek samping: field tidak ada = defaults
+  static bool parse(const char* doc, size_t len, const RuntimeConfig& defaults,
+                    RuntimeConfig& out, char* error, size_t errorCap);
+  static uint8_t diff(const RuntimeConfig& a, const RuntimeConfig& b);
+  // Tag hex (64 karakter) untuk doc, seperti yang diharapkan offer()
+  static void sign(const char* keyId, const uint8_t* psk, size_t pskLen,
+                   const char* doc, size_t len, char out[TAG_HEX]);
+
+private:
+  bool authenticate(const char* payload, size_t len, size_t& docLen) const;
+
+  const RuntimeConfig defaults;
+  ConfigStore& store;
+  RuntimeConfig activeCfg;
+  RuntimeConfig committedCfg;
+  RuntimeConfig stagedCfg;
+  char stagedDoc[DOC_MAX];
+  size_t stagedLen = 0;
+  char pendingDoc[DOC_MAX];
+  size_t pendingLen = 0;
+  uint32_t failedVersion = 0;
+  const char* keyId = "";
+  const uint8_t* psk = nullptr;
+  size_t pskLen = 0;
+};
+
+const char* configStatusName(ConfigStatus s);
+// Ack ke backend: {"version":7,"status":"applied","effects":["live"],"error":""}
+size_t formatConfigAck(char* out, size_t cap, const ConfigResult& r);
+
+#ifdef ARDUINO
+// Dokumen di NVS (Preferences), namespace "ecoscale"
+class NvsConfigStore : public ConfigStore {
+public:
+  explicit NvsConfigStore(const char* key) : key(key) {}
+  size_t load(char* buf, size_t cap) override;
+  bool save(const char* doc, size_t len) override;
+
+private:
+  const char* key;
+};
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+// ==================== RTT ESTIMATOR ====================
+// Estimasi waktu respon backend gaya Jacobson/Karels (seperti RTO TCP):
+//   SRTT   <- 7/8 SRTT + 1/8 R
+//   RTTVAR <- 3/4 RTTVAR + 1/4 |SRTT - R|
+//   RTO    =  SRTT + 4 RTTVAR   (dibatasi minRto..maxRto)
+// Ditambah histogram logaritmik kecil untuk persentil (p95), dipakai sebagai
+// ambang hedged retry. Histogram meluruh (semua bin dibagi dua) supaya
+// mengikuti perubahan kondisi jaringan.
+
+struct RttPolicy {
+  uint32_t minRtoMs     = 1500;
+  uint32_t maxRtoMs     = 15000;  // batas lama (timeout tetap sebelumnya)
+  uint32_t initialRtoMs = 15000;  // sebelum ada sampel: konservatif
+  uint16_t decayAfter   = 256;    // jumlah sampel sebelum histogram diluruhkan
+};
+
+class RttEstimator {
+public:
+  static constexpr uint8_t BUCKETS = 24;
+
+  explicit RttEstimator(const RttPolicy& policy = RttPolicy());
+
+  // Sampel hanya dari pertukaran yang tidak ambigu (Karn): jangan masukkan
+  // waktu respon dari request yang sudah dikirim ulang di koneksi yang sama.
+  void sample(uint32_t rttMs);
+  // Timeout: RTO digandakan sampai sampel valid berikutnya (backoff)
+  void onTimeout();
+
+  uint32_t rto() const;
+  uint32_t srtt() const { return srtt8 >> 3; }
+  uint32_t rttvar() const { return rttvar4 >> 2; }
+  // Persentil dari histogram (batas atas bin); 0 jika belum ada sampel
+  uint32_t percentile(uint8_t pct) const;
+  uint32_t sampleCount() const { return samples; }
+  uint32_t timeoutCount() const { return timeouts; }
+
+private:
+  static uint32_t bucketUpper(uint8_t i);
+  static uint8_t bucketFor(uint32_t ms);
+
+  RttPolicy policy;
+  uint32_t srtt8 = 0;    // SRTT * 8
+  uint32_t rttvar4 = 0;  // RTTVAR * 4
+  uint8_t backoffShift = 0;
+  uint32_t samples = 0;
+  uint32_t timeouts = 0;
+  uint16_t hist[BUCKETS] = {};
+  uint16_t sinceDecay = 0;
+};
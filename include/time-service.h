@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== TIME SERVICE ====================
+// Record dicap dengan waktu monoton lokal (ms sejak boot). Offset ke UTC
+// dipelajari secara oportunistik dari SNTP, header HTTP `Date` atau pesan
+// MQTT, tanpa pernah menunggu. Karena record menyimpan waktu monoton,
+// record yang sudah mengantri otomatis mendapat timestamp yang benar begitu
+// offset tersedia (back-correct saat dikirim).
+
+enum class TimeSource : uint8_t { NONE, MQTT, HTTP_DATE, SNTP };
+
+class TimeService {
+public:
+  // Drift kristal ESP32 diasumsikan <= 50 ppm (0.05 ms per detik)
+  static constexpr uint32_t DRIFT_PPM = 50;
+
+  // Tawarkan sampel: pada waktu monoton monoMs, waktu UTC = epochMs +- uncertaintyMs.
+  // Sampel dipakai jika ketidakpastiannya tidak lebih besar dari estimasi saat ini
+  // pada monoMs (termasuk drift sejak sampel tersimpan), sehingga sampel kurang
+  // presisi tetap menang setelah estimasi lama cukup tua. Return true jika dipakai.
+  bool offer(TimeSource source, int64_t epochMs, uint64_t monoMs, uint32_t uncertaintyMs);
+
+  bool synced() const { return source != TimeSource::NONE; }
+  TimeSource currentSource() const { return source; }
+
+  // Konversi waktu monoton ke epoch ms (UTC). Hanya valid jika synced().
+  int64_t toEpochMs(uint64_t monoMs) const { return (int64_t)monoMs + offsetMs; }
+  // Ketidakpastian (ms) timestamp untuk waktu monoton tertentu, termasuk drift
+  uint32_t uncertaintyAt(uint64_t monoMs) const;
+
+private:
+  TimeSource source = TimeSource::NONE;
+  int64_t offsetMs = 0;
+  uint64_t syncMonoMs = 0;
+  uint32_t baseUncertaintyMs = 0;
+};
+
+// "Sun, 06 Nov 1994 08:49:37 GMT" -> detik epoch. Return false jika format salah.
+bool parseHttpDate(const char* text, int64_t& epochSec);
+// epoch ms -> "2024-05-01T07:30:12.345Z"
+void formatIso8601(char* dest, size_t destSize, int64_t epochMs);
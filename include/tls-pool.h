@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== TLS MEMORY POOL ====================
+// Setiap handshake mbedTLS mengalokasikan ~40 KB (buffer record + state
+// handshake) lalu membebaskannya lagi. Setelah berhari-hari, churn ini
+// memecah heap sampai blok bebas terbesar terlalu kecil untuk handshake
+// berikutnya. Semua alokasi mbedTLS dialihkan ke pool statis ini sehingga
+// heap utama tidak pernah ikut terfragmentasi. Jika pool penuh, alokasi
+// jatuh ke heap biasa (dihitung di statistik fallback).
+
+class StaticPool {
+public:
+  StaticPool(uint8_t* buffer, size_t size);
+
+  void* allocate(size_t size);
+  // Return false jika ptr bukan milik pool (misalnya hasil fallback heap)
+  bool release(void* ptr);
+  bool owns(const void* ptr) const { return (const uint8_t*)ptr >= base && (const uint8_t*)ptr < base + capacity; }
+
+  size_t capacityBytes() const { return capacity; }
+  size_t usedBytes() const { return used; }
+  size_t peakBytes() const { return peak; }
+  size_t largestFreeBlock() const;
+  uint32_t failedAllocations() const { return failures; }
+
+private:
+  struct Block {
+    size_t size;   // termasuk header
+    Block* next;   // hanya valid saat blok bebas
+  };
+  static constexpr size_t HEADER = sizeof(size_t) * 2;
+  static constexpr size_t ALIGN = 8;
+  static constexpr size_t MIN_SPLIT = HEADER + 16;
+
+  uint8_t* base;
+  size_t capacity;
+  Block* freeList;
+  size_t used = 0;
+  size_t peak = 0;
+  uint32_t failures = 0;
+};
+
+#ifdef ARDUINO
+struct TlsPoolStats {
+  size_t capacity;
+  size_t used;
+  size_t peak;
+  size_t largestFree;
+  uint32_t heapFallbacks;
+};
+
+// Pasang pool sebagai allocator mbedTLS. Panggil sekali di awal setup(),
+// sebelum koneksi TLS pertama.
+bool installTlsMemoryPool();
+TlsPoolStats tlsPoolStats();
+#endif
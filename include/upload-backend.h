@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "record-outbox.h"
+
+// ==================== BACKEND UPLOAD (POLICY) ====================
+// Backend dipilih saat kompilasi, satu per env PlatformIO:
+//   (default)                   HTTPS Laravel + salinan record di MQTT
+//   -DECOSCALE_COAP             CoAP/UDP batch ke tools/coap-receiver.cpp
+//   -DECOSCALE_BACKEND_FIREBASE Firestore (library Firebase hanya di env ini)
+// Policy = struct dengan anggota static:
+//   name()                       untuk log
+//   MAX_BATCH                    record per send() (1 = satu per request)
+//   MQTT_RECORDS                 record juga dipublish ke topik MQTT record
+//   PREWARM                      buka koneksi TLS saat beban stabil
+//   ASYNC                        send() tidak menunggu jawaban server
+//   begin(const BackendContext&) sekali saat boot
+//   send(recs, count)            kirim count <= MAX_BATCH record
+//   service(nowMs)               tiap loop (refresh token, transfer async, dsb.)
+// Backend ASYNC: send() pertama memulai transfer dan mengembalikan PENDING;
+// service() menjalankannya, dan send() berikutnya dengan batch yang sama
+// mengembalikan PENDING sampai hasil akhirnya siap.
+// Flag policy adalah konstanta, jadi cabangnya hilang saat kompilasi dan
+// fungsi backend lain tidak pernah direferensikan (dibuang gc-sections).
+
+struct BackendContext {
+  const char* fakultas;
+  const char* deviceId;
+  // Waktu dinding ISO 8601 untuk record (false jika jam belum sinkron)
+  bool (*wallClock)(uint64_t monoMs, char* iso, size_t cap);
+};
+
+struct DrainStep {
+  SendResult result;
+  uint8_t count;      // record yang dicoba pada langkah ini
+  uint32_t lastSeq;   // seq record terakhir di batch (valid jika count > 0)
+};
+
+template <class Backend>
+class RecordUploader {
+public:
+  static_assert(Backend::MAX_BATCH >= 1 && Backend::MAX_BATCH <= RecordOutbox::CAPACITY,
+                "MAX_BATCH harus 1..CAPACITY outbox");
+
+  static SendResult sendOne(const WeighingRecord& rec) {
+    WeighingRecord* recs[] = { const_cast<WeighingRecord*>(&rec) };
+    return Backend::send(recs, 1);
+  }
+
+  // Kirim record terdepan outbox (maks min(limit, MAX_BATCH)) sebagai satu
+  // batch. ACKED/REJECTED -> dikeluarkan dari outbox, RETRY -> backoff,
+  // PENDING -> batch yang sama ditanyakan lagi di langkah berikutnya.
+  static DrainStep drainStep(RecordOutbox& outbox, uint8_t limit, unsigned long now) {
+    WeighingRecord* batch[Backend::MAX_BATCH];
+    size_t count = inFlight ? inFlight : outbox.size();
+    if (count > outbox.size()) count = outbox.size();
+    if (!inFlight && count > limit) count = limit;
+    if (count > Backend::MAX_BATCH) count = Backend::MAX_BATCH;
+    if (count == 0) { inFlight = 0; return { SendResult::RETRY, 0, 0 }; }
+
+    for (size_t i = 0; i < count; i++) {
+      batch[i] = &outbox.at(i);
+      if (!inFlight) batch[i]->attempts++;
+    }
+    DrainStep step = { Backend::send(batch, count), (uint8_t)count, batch[count - 1]->seq };
+    if (step.result == SendResult::PENDING) {
+      inFlight = (uint8_t)count;
+      return step;
+    }
+    inFlight = 0;
+    if (step.result == SendResult::RETRY) {
+      outbox.onFailure(now);
+    } else {
+      for (size_t i = 0; i < count; i++) outbox.pop();
+      outbox.onSuccess(now);
+    }
+    return step;
+  }
+
+  // Batch backend async yang belum selesai (0 = tidak ada)
+  static uint8_t pending() { return inFlight; }
+
+private:
+  static uint8_t inFlight;
+};
+
+template <class Backend>
+uint8_t RecordUploader<Backend>::inFlight = 0;
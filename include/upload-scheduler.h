@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== UPLOAD SCHEDULER ====================
+// Menentukan kapan outbox dikuras dan berapa record per batch berdasarkan
+// kualitas link: RSSI (dirata-rata), tingkat gagal terakhir (EWMA), dan
+// kedalaman antrian. Link bagus -> burst; link buruk -> tunda, hanya satu
+// record "probe" sesekali supaya perbaikan link tetap terdeteksi.
+// Murni logika, tanpa WiFi.h, sehingga bisa diuji dengan model link di host.
+
+enum class LinkQuality : uint8_t { GOOD, FAIR, POOR };
+
+struct SchedulerPolicy {
+  int goodRssi              = -67;    // dBm
+  int fairRssi              = -75;    // di bawah ini upload sering timeout
+  float goodFailRate        = 0.2f;
+  float fairFailRate        = 0.5f;
+  float interactiveMaxFailRate = 0.8f; // di atas ini kirim manual langsung diantrikan
+  uint8_t burstBatch        = 8;
+  uint8_t fairBatch         = 2;
+  unsigned long poorProbeInterval = 30000;
+};
+
+class UploadScheduler {
+public:
+  explicit UploadScheduler(const SchedulerPolicy& policy = SchedulerPolicy()) : policy(policy) {}
+
+  // Sampel RSSI periodik (~1 Hz)
+  void observeRssi(int dbm);
+  // Hasil setiap upload; ok = server menjawab (diterima atau ditolak)
+  void observeResult(bool ok);
+
+  LinkQuality quality() const;
+  // Jumlah record yang boleh dikirim sekarang (0 = tunda)
+  uint8_t drainBudget(unsigned long now, size_t queueDepth, size_t capacity);
+  // Kirim manual (operator menunggu) layak dicoba, atau langsung ke outbox?
+  bool interactiveAllowed() const;
+
+  float smoothedRssi() const { return rssi; }
+  float failureRate() const { return failRate; }
+
+private:
+  SchedulerPolicy policy;
+  float rssi = 0;
+  bool haveRssi = false;
+  float failRate = 0;
+  unsigned long lastProbe = 0;
+  bool probed = false;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== KATEGORI SAMPAH ====================
+// Satu tabel constexpr untuk semua kategori. Yang disimpan di record,
+// outbox, dan frame ESP-NOW hanya kode 1 byte; nama untuk payload backend,
+// teks "Jenis: ..." di LCD, dan label menu sub-jenis diambil dari tabel.
+// Kode ikut format frame ESP-NOW: kategori baru hanya ditambah di akhir.
+
+enum class WasteCategory : uint8_t {
+  NONE = 0,     // belum dipilih
+  ORGANIK,
+  ANORGANIK,    // anorganik umum
+  BOTOL,
+  KERTAS,
+  RESIDU,
+  COUNT
+};
+
+struct WasteCategoryInfo {
+  const char* name;        // dikirim ke backend dan tampil di LCD
+  const char* menuLabel;   // label di menu sub-jenis
+  WasteCategory group;     // kategori utama (state perangkat)
+};
+
+namespace WasteCategories {
+  constexpr WasteCategoryInfo TABLE[] = {
+    { "--",        "--",      WasteCategory::NONE },
+    { "Organik",   "Organik", WasteCategory::ORGANIK },
+    { "Anorganik", "Umum",    WasteCategory::ANORGANIK },
+    { "Botol",     "Botol",   WasteCategory::ANORGANIK },
+    { "Kertas",    "Kertas",  WasteCategory::ANORGANIK },
+    { "Residu",    "Residu",  WasteCategory::RESIDU },
+  };
+  static_assert(sizeof(TABLE) / sizeof(TABLE[0]) == (size_t)WasteCategory::COUNT,
+                "TABLE harus berisi satu baris per kode");
+
+  // Tombol 1-3: di tampilan utama (NONE = buka menu sub-jenis anorganik)
+  // dan di menu sub-jenis
+  constexpr uint8_t KEY_COUNT = 3;
+  constexpr WasteCategory MAIN_KEYS[KEY_COUNT] = {
+    WasteCategory::ORGANIK, WasteCategory::NONE, WasteCategory::RESIDU
+  };
+  constexpr WasteCategory SUBTYPE_KEYS[KEY_COUNT] = {
+    WasteCategory::ANORGANIK, WasteCategory::BOTOL, WasteCategory::KERTAS
+  };
+
+  constexpr bool valid(uint8_t code) { return code < (uint8_t)WasteCategory::COUNT; }
+  constexpr const WasteCategoryInfo& info(WasteCategory c) {
+    return TABLE[valid((uint8_t)c) ? (uint8_t)c : 0];
+  }
+  constexpr const char* name(WasteCategory c) { return info(c).name; }
+
+  static_assert(info(WasteCategory::BOTOL).group == WasteCategory::ANORGANIK, "");
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+
+// ==================== MULTI-AP ROAMING ====================
+// Pemilihan AP berdasarkan RSSI untuk lokasi dengan beberapa AP ber-SSID sama.
+// Logika di sini tidak menyentuh WiFi.h sama sekali; semua akses radio lewat
+// RoamingRadio, sehingga kelas ini bisa dijalankan di host dengan radio simulasi.
+
+struct ApInfo {
+  uint8_t bssid[6];
+  int32_t channel;
+  int32_t rssi;
+};
+
+class RoamingRadio {
+public:
+  virtual ~RoamingRadio() {}
+  virtual bool isConnected() = 0;
+  virtual int32_t rssi() = 0;
+  virtual const uint8_t* bssid() = 0;
+  // Scan non-blocking. Return false jika scan tidak bisa dimulai.
+  virtual bool startScan() = 0;
+  // -1 = scan masih berjalan, >= 0 = jumlah AP (SSID yang sama) yang ditulis ke out.
+  virtual int scanResult(ApInfo* out, int maxCount) = 0;
+  virtual void roamTo(const ApInfo& ap) = 0;
+};
+
+struct RoamingPolicy {
+  int32_t weakRssi            = -75;    // dBm, di bawah ini link dianggap lemah
+  int32_t hysteresisDb        = 8;      // kandidat harus lebih kuat minimal sekian dB
+  uint8_t weakSamplesRequired = 5;      // jumlah sampel lemah berturut-turut
+  unsigned long sampleInterval = 1000;  // ms
+  unsigned long scanInterval   = 30000; // jeda minimal antar scan saat lemah
+  unsigned long roamCooldown   = 60000; // jeda minimal setelah roam (anti flapping)
+};
+
+class WifiRoaming {
+public:
+  static constexpr int MAX_CANDIDATES = 8;
+
+  explicit WifiRoaming(RoamingRadio& radio, const RoamingPolicy& policy = RoamingPolicy())
+    : radio(radio), policy(policy) {}
+
+  // Dipanggil tiap loop. `idle` = boleh roam (tidak sedang menimbang/mengirim).
+  void tick(unsigned long now, bool idle);
+
+  bool isWeak() const { return weak; }
+  bool isScanning() const { return scanning; }
+  int32_t lastRssi() const { return rssiSample; }
+  uint32_t roamCount() const { return roams; }
+  uint32_t scanCount() const { return scans; }
+
+private:
+  void sampleRssi(unsigned long now);
+  void finishScan(unsigned long now, bool idle);
+
+  RoamingRadio& radio;
+  RoamingPolicy policy;
+
+  bool weak = false;
+  bool scanning = false;
+  uint8_t weakSamples = 0;
+  int32_t rssiSample = 0;
+  bool hasScanned = false;
+  bool hasRoamed = false;
+  unsigned long lastSampleTime = 0;
+  unsigned long lastScanTime = 0;
+  unsigned long lastRoamTime = 0;
+  uint32_t roams = 0;
+  uint32_t scans = 0;
+  ApInfo candidates[MAX_CANDIDATES];
+};
+
+#ifdef ARDUINO
+// Implementasi RoamingRadio di atas WiFiClass (STA, SSID dari credentials.h)
+class WifiStaRadio : public RoamingRadio {
+public:
+  // Batas tunggu asosiasi ke AP tujuan roam sebelum pin BSSID dilepas
+  static constexpr unsigned long PIN_TIMEOUT_MS = 10000;
+
+  bool isConnected() override;
+  int32_t rssi() override;
+  const uint8_t* bssid() override;
+  bool startScan() override;
+  int scanResult(ApInfo* out, int maxCount) override;
+  void roamTo(const ApInfo& ap) override;
+
+private:
+  bool unpinBssid();
+
+  bool pinned = false;
+  unsigned long pinnedAt = 0;
+};
+#endif
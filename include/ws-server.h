@@ -0,0 +1,106 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== WEBSOCKET LIVE VIEW ====================
+// Server HTTP + WebSocket (RFC 6455) minimal untuk operator di jaringan
+// lokal: GET / melayani halaman dashboard, GET /ws di-upgrade lalu setiap
+// sampel berat di-push sebagai frame biner. Tanpa kabel USB dan tanpa
+// broker publik.
+// Backpressure: setiap klien punya buffer TX terbatas. Frame yang tidak muat
+// dibuang utuh (dihitung), tidak pernah menunggu socket, sehingga browser yang
+// lambat tidak bisa menahan loop(). Klien yang macet terlalu lama diputus.
+// Semua I/O lewat WsListener, jadi logika server bisa dijalankan di host.
+
+class WsListener {
+public:
+  virtual ~WsListener() {}
+  // Handle koneksi baru (>= 0) atau -1 jika tidak ada
+  virtual int accept() = 0;
+  // Byte yang diterima socket (bisa sebagian, 0 jika penuh), -1 jika error
+  virtual int write(int handle, const uint8_t* data, size_t len) = 0;
+  // Byte terbaca, 0 jika belum ada data, -1 jika koneksi tertutup
+  virtual int read(int handle, uint8_t* buf, size_t len) = 0;
+  virtual void close(int handle) = 0;
+};
+
+// Sec-WebSocket-Accept = base64(SHA-1(key + GUID)), out minimal 29 byte
+bool wsAcceptKey(const char* clientKey, char* out, size_t outSize);
+
+struct WsStats {
+  uint32_t framesSent;
+  uint32_t framesDropped;  // dibuang karena buffer klien penuh
+  uint32_t stalledClosed;  // klien diputus karena tidak menguras buffer
+  uint32_t handshakes;
+};
+
+class WsServer {
+public:
+  static constexpr int MAX_CLIENTS = 3;
+  static constexpr size_t RX_BUFFER_SIZE = 768;   // request HTTP / frame kontrol
+  static constexpr size_t TX_BUFFER_SIZE = 1024;  // ~60 frame berat per klien
+  static constexpr unsigned long STALL_TIMEOUT = 10000;
+  static constexpr unsigned long REQUEST_TIMEOUT = 5000;
+
+  explicit WsServer(WsListener& listener) : listener(listener) {}
+
+  // Halaman untuk GET / (tidak disalin, harus hidup selama server jalan)
+  void setPage(const char* html, size_t len) { page = html; pageLen = len; }
+
+  // Accept, baca request/frame masuk, kuras buffer TX. Tidak pernah blocking.
+  void loop(unsigned long now);
+  // Antrekan frame biner ke semua klien WebSocket; klien yang buffernya
+  // penuh dilewati. Return jumlah klien yang menerima frame.
+  int broadcastBinary(const uint8_t* data, size_t len);
+  void closeAll();
+
+  int clientCount() const;
+  const WsStats& stats() const { return counters; }
+
+private:
+  enum class Phase : uint8_t { FREE, REQUEST, PAGE, WEBSOCKET, CLOSING };
+
+  struct Client {
+    Phase phase;
+    int handle;
+    unsigned long since;        // awal fase / terakhir buffer TX berkurang
+    size_t pageSent;
+    uint16_t rxLen;
+    uint16_t txLen;
+    uint8_t rx[RX_BUFFER_SIZE];
+    uint8_t tx[TX_BUFFER_SIZE];
+  };
+
+  void acceptClients(unsigned long now);
+  void readClient(Client& c, unsigned long now);
+  void handleRequest(Client& c, unsigned long now);
+  void handleFrames(Client& c);
+  void flushClient(Client& c, unsigned long now);
+  bool queue(Client& c, const uint8_t* data, size_t len);
+  bool queueFrame(Client& c, uint8_t opcode, const uint8_t* payload, size_t len);
+  void drop(Client& c);
+
+  WsListener& listener;
+  const char* page = nullptr;
+  size_t pageLen = 0;
+  Client clients[MAX_CLIENTS] = {};
+  WsStats counters = {};
+};
+
+#ifdef ARDUINO
+// Listener TCP non-blocking di atas socket lwIP
+class LwipWsListener : public WsListener {
+public:
+  bool begin(uint16_t port);
+  void end();
+  bool listening() const { return fd >= 0; }
+
+  int accept() override;
+  int write(int handle, const uint8_t* data, size_t len) override;
+  int read(int handle, uint8_t* buf, size_t len) override;
+  void close(int handle) override;
+
+private:
+  int fd = -1;
+};
+#endif
@@ -0,0 +1,205 @@
+#include "async-log.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace {
+constexpr uint32_t RING_MASK = AsyncLog::RING_SIZE - 1;
+constexpr size_t HEADER_SIZE = 4;
+static_assert((AsyncLog::RING_SIZE & RING_MASK) == 0, "RING_SIZE harus pangkat 2");
+
+const char* const MODULE_NAMES[(uint8_t)LogModule::COUNT] = {
+  "sys", "net", "mqtt", "http", "coap", "relay", "time", "scale", "metrics"
+};
+const char LEVEL_CHARS[] = { '-', 'E', 'W', 'I', 'D' };
+
+// Header = panjang baris (| BINARY untuk frame token); 0 = slot sudah
+// direservasi tapi belum selesai ditulis
+constexpr uint32_t HEADER_BINARY = 0x8000;
+constexpr uint32_t HEADER_LEN_MASK = 0x7FFF;
+uint32_t* headerAt(uint8_t* ring, uint32_t pos) {
+  return reinterpret_cast<uint32_t*>(ring + (pos & RING_MASK));
+}
+}
+
+AsyncLog::AsyncLog(ClockMs clock) : clock(clock) {
+  setLevelAll(LogLevel::INFO);
+  memset(ring, 0, sizeof(ring));
+}
+
+void AsyncLog::setLevel(LogModule module, LogLevel lvl) {
+  if (module < LogModule::COUNT) levels[(uint8_t)module] = lvl;
+}
+
+void AsyncLog::setLevelAll(LogLevel lvl) {
+  for (LogLevel& l : levels) l = lvl;
+}
+
+const char* AsyncLog::moduleName(LogModule module) {
+  return module < LogModule::COUNT ? MODULE_NAMES[(uint8_t)module] : "?";
+}
+
+size_t AsyncLog::formatPrefix(char* out, size_t cap, uint32_t timeMs, uint8_t level, uint8_t module) {
+  int n = snprintf(out, cap, "[%lu.%03lu] %c %s: ", (unsigned long)(timeMs / 1000),
+                   (unsigned long)(timeMs % 1000), LEVEL_CHARS[level <= 4 ? level : 0],
+                   moduleName((LogModule)module));
+  if (n < 0) return 0;
+  return (size_t)n < cap ? n : cap - 1;
+}
+
+// ==================== PRODUSEN ====================
+
+void AsyncLog::write(LogLevel lvl, LogModule module, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vwrite(lvl, module, fmt, args);
+  va_end(args);
+}
+
+void AsyncLog::vwrite(LogLevel lvl, LogModule module, const char* fmt, va_list args) {
+  // Format di stack pemanggil: biaya CPU-nya kecil dibanding menunggu UART
+  char line[LINE_MAX];
+  size_t p = formatPrefix(line, sizeof(line), clock(), (uint8_t)lvl, (uint8_t)module);
+  int m = vsnprintf(line + p, sizeof(line) - p, fmt, args);
+  size_t len = p + (m > 0 ? m : 0);
+  if (len > sizeof(line) - 2) { len = sizeof(line) - 2; truncated.fetch_add(1, std::memory_order_relaxed); }
+  line[len++] = '\n';
+  push(line, len, false);
+}
+
+void AsyncLog::push(const void* data, size_t len, bool binary) {
+  uint32_t total = (HEADER_SIZE + len + 3) & ~3u;
+  uint32_t h = head.load(std::memory_order_relaxed);
+  uint32_t used;
+  do {
+    used = h - tail.load(std::memory_order_acquire);
+    if (total > RING_SIZE - used) { dropped.fetch_add(1, std::memory_order_relaxed); return; }
+  } while (!head.compare_exchange_weak(h, h + total, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+  copyIn(h + HEADER_SIZE, static_cast<const uint8_t*>(data), len);
+  // Header terakhir (release): konsumen tidak pernah melihat baris setengah jadi
+  __atomic_store_n(headerAt(ring, h), (uint32_t)len | (binary ? HEADER_BINARY : 0), __ATOMIC_RELEASE);
+
+  lines.fetch_add(1, std::memory_order_relaxed);
+  // Perkiraan (tanpa CAS); cukup untuk memilih RING_SIZE
+  if (used + total > highWater.load(std::memory_order_relaxed)) {
+    highWater.store(used + total, std::memory_order_relaxed);
+  }
+}
+
+void AsyncLog::copyIn(uint32_t pos, const uint8_t* data, size_t len) {
+  size_t offset = pos & RING_MASK;
+  size_t first = RING_SIZE - offset;
+  if (first > len) first = len;
+  memcpy(ring + offset, data, first);
+  if (len > first) memcpy(ring, data + first, len - first);
+}
+
+void AsyncLog::copyOut(uint32_t pos, uint8_t* data, size_t len) const {
+  size_t offset = pos & RING_MASK;
+  size_t first = RING_SIZE - offset;
+  if (first > len) first = len;
+  memcpy(data, ring + offset, first);
+  if (len > first) memcpy(data + first, ring, len - first);
+}
+
+// ==================== KONSUMEN ====================
+
+bool AsyncLog::drainOne(LogSink& sink) {
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  if (t == head.load(std::memory_order_acquire)) {
+    emitDropNotice(sink);
+    return false;
+  }
+  uint32_t header = __atomic_load_n(headerAt(ring, t), __ATOMIC_ACQUIRE);
+  if (header == 0) return false;
+  uint32_t len = header & HEADER_LEN_MASK;
+
+  if (header & HEADER_BINARY) {
+    // "$" + base64 + "\n" dalam satu write
+    uint8_t frame[FRAME_MAX];
+    char text[2 + (FRAME_MAX * 4 + 2) / 3];
+    copyOut(t + HEADER_SIZE, frame, len);
+    size_t n = 0;
+    text[n++] = LogToken::FRAME_PREFIX;
+    n += base64Encode(frame, len, text + n);
+    text[n++] = '\n';
+    sink.write((const uint8_t*)text, n);
+  } else {
+    size_t offset = (t + HEADER_SIZE) & RING_MASK;
+    size_t first = RING_SIZE - offset;
+    if (first > len) first = len;
+    sink.write(ring + offset, first);
+    if (len > first) sink.write(ring, len - first);
+  }
+
+  // Area dinolkan sebelum dilepas: header baris berikutnya bisa jatuh di
+  // posisi mana pun di area ini dan harus terbaca 0 sampai selesai ditulis
+  uint32_t total = (HEADER_SIZE + len + 3) & ~3u;
+  size_t start = t & RING_MASK;
+  size_t firstClear = RING_SIZE - start;
+  if (firstClear > total) firstClear = total;
+  memset(ring + start, 0, firstClear);
+  if (total > firstClear) memset(ring, 0, total - firstClear);
+  tail.store(t + total, std::memory_order_release);
+  return true;
+}
+
+// Ditulis saat ring sudah kosong, jadi pemberitahuan ini sendiri tidak hilang
+void AsyncLog::emitDropNotice(LogSink& sink) {
+  uint32_t d = dropped.load(std::memory_order_relaxed);
+  if (d == reportedDropped) return;
+  char line[64];
+  uint32_t now = clock();
+  int n = snprintf(line, sizeof(line), "[%lu.%03lu] W log: %lu baris dibuang (ring penuh)\n",
+                   (unsigned long)(now / 1000), (unsigned long)(now % 1000),
+                   (unsigned long)(d - reportedDropped));
+  reportedDropped = d;
+  if (n > 0) sink.write((const uint8_t*)line, (size_t)n < sizeof(line) ? n : sizeof(line) - 1);
+}
+
+LogStats AsyncLog::stats() const {
+  LogStats s;
+  s.lines = lines.load(std::memory_order_relaxed);
+  s.dropped = dropped.load(std::memory_order_relaxed);
+  s.truncated = truncated.load(std::memory_order_relaxed);
+  s.highWater = highWater.load(std::memory_order_relaxed);
+  return s;
+}
+
+// ==================== ADAPTER ESP32 ====================
+#ifdef ARDUINO
+
+namespace {
+struct LogTaskArgs { AsyncLog* log; LogSink* sink; };
+LogTaskArgs logTaskArgs;
+
+void logTask(void* param) {
+  LogTaskArgs* args = static_cast<LogTaskArgs*>(param);
+  for (;;) {
+    // Boleh blocking di UART: hanya task ini yang menunggu
+    if (!args->log->drainOne(*args->sink)) vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+}
+
+bool AsyncLog::startTask(LogSink& sink) {
+  if (logTaskArgs.log != nullptr) return true;
+  logTaskArgs = { this, &sink };
+  if (xTaskCreatePinnedToCore(logTask, "log", 3072, &logTaskArgs, tskIDLE_PRIORITY + 1, nullptr, 0) != pdPASS) {
+    logTaskArgs = {};
+    return false;
+  }
+  return true;
+}
+
+size_t PrintLogSink::write(const uint8_t* data, size_t len) {
+  return out.write(data, len);
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "button-events.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+void ButtonEvents::begin(uint8_t buttonCount, LevelReader levelReader, uint32_t nowUs) {
+  count = buttonCount > MAX_BUTTONS ? MAX_BUTTONS : buttonCount;
+  reader = levelReader;
+  for (uint8_t b = 0; b < count; b++) {
+    State& s = states[b];
+    s = State{};
+    s.stable = s.raw = reader ? reader(b) : false;
+    s.rawSince = nowUs;
+    s.longSent = s.stable;  // sudah ditahan saat boot: bukan long-press
+  }
+  seenDropped = counters.edgesDropped;
+}
+
+void ButtonEvents::update(uint32_t nowUs) {
+  while (edgeTail != edgeHead) {
+    Edge e = edges[edgeTail % EDGE_QUEUE];
+    edgeTail = edgeTail + 1;
+    if (e.button >= count) continue;
+    counters.edges++;
+    applyEdge(e.button, e.pressed, e.at);
+  }
+
+  // Ada tepi yang hilang: level sebenarnya bisa beda dari yang kita kira
+  uint32_t dropped = counters.edgesDropped;
+  if (dropped != seenDropped) {
+    seenDropped = dropped;
+    if (reader) {
+      for (uint8_t b = 0; b < count; b++) applyEdge(b, reader(b), nowUs);
+    }
+  }
+
+  for (uint8_t b = 0; b < count; b++) settle(b, nowUs);
+}
+
+bool ButtonEvents::next(ButtonEvent& ev, uint32_t nowUs) {
+  while (eventTail != eventHead) {
+    ButtonEvent e = events[eventTail % EVENT_QUEUE];
+    eventTail++;
+    uint32_t age = nowUs - e.at;
+    if (age > policy.maxEventAgeUs) { counters.stale++; continue; }
+    counters.handled++;
+    counters.latencyTotalUs += age;
+    if (age > counters.latencyMaxUs) counters.latencyMaxUs = age;
+    ev = e;
+    return true;
+  }
+  return false;
+}
+
+// ==================== DEBOUNCE ====================
+
+void ButtonEvents::applyEdge(uint8_t button, bool pressed, uint32_t at) {
+  State& s = states[button];
+  // Jendela tenang sebelum tepi ini mungkin sudah cukup untuk level sebelumnya
+  settle(button, at);
+  if (!s.bouncing) {
+    if (pressed == s.stable) return;
+    s.bouncing = true;
+    s.firstEdge = at;
+  }
+  s.raw = pressed;
+  s.rawSince = at;
+}
+
+void ButtonEvents::settle(uint8_t button, uint32_t nowUs) {
+  State& s = states[button];
+  if (s.bouncing && (int32_t)(nowUs - s.rawSince) >= (int32_t)policy.debounceUs) {
+    s.bouncing = false;
+    if (s.raw != s.stable) commit(button, s.raw, s.firstEdge);
+  }
+  if (s.stable && s.raw && !s.longSent && (int32_t)(nowUs - s.pressedAt) >= (int32_t)policy.longPressUs) {
+    s.longSent = true;
+    emit(button, ButtonEventType::LONG, s.pressedAt + policy.longPressUs);
+  }
+}
+
+void ButtonEvents::commit(uint8_t button, bool pressed, uint32_t at) {
+  State& s = states[button];
+  s.stable = pressed;
+  if (!pressed) return;
+
+  s.pressedAt = at;
+  s.longSent = false;
+  bool isDouble = s.hasLastPress && at - s.lastPressAt <= policy.doublePressUs;
+  emit(button, isDouble ? ButtonEventType::DOUBLE : ButtonEventType::PRESS, at);
+  // Tekanan ketiga memulai pasangan baru
+  s.hasLastPress = !isDouble;
+  s.lastPressAt = at;
+}
+
+void ButtonEvents::emit(uint8_t button, ButtonEventType type, uint32_t at) {
+  if ((uint8_t)(eventHead - eventTail) >= EVENT_QUEUE) { counters.eventsDropped++; return; }
+  events[eventHead % EVENT_QUEUE] = { button, type, at };
+  eventHead++;
+  counters.events++;
+}
+
+// ==================== ADAPTER ESP32 ====================
+#ifdef ARDUINO
+
+namespace {
+struct IsrSlot { ButtonEvents* events; uint8_t button; uint8_t pin; };
+IsrSlot isrSlots[ButtonEvents::MAX_BUTTONS];
+
+void IRAM_ATTR buttonIsr(void* arg) {
+  IsrSlot* slot = static_cast<IsrSlot*>(arg);
+  slot->events->onEdge(slot->button, digitalRead(slot->pin) == LOW, micros());
+}
+
+bool readButtonLevel(uint8_t button) {
+  return digitalRead(isrSlots[button].pin) == LOW;
+}
+}
+
+bool attachButtonInterrupts(ButtonEvents& events, const int* pins, uint8_t count) {
+  if (count > ButtonEvents::MAX_BUTTONS) return false;
+  for (uint8_t i = 0; i < count; i++) {
+    pinMode(pins[i], INPUT_PULLUP);
+    isrSlots[i] = { &events, i, (uint8_t)pins[i] };
+  }
+  events.begin(count, readButtonLevel, micros());
+  for (uint8_t i = 0; i < count; i++) {
+    attachInterruptArg(pins[i], buttonIsr, &isrSlots[i], CHANGE);
+  }
+  return true;
+}
+
+#endif
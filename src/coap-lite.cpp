@@ -0,0 +1,331 @@
+#include "coap-lite.h"
+#include "hmac-sha256.h"
+#include <string.h>
+
+// ==================== WRITER ====================
+
+bool CoapWriter::put(const uint8_t* data, size_t n) {
+  if (!ok || len + n > cap) { ok = false; return false; }
+  memcpy(buf + len, data, n);
+  len += n;
+  return true;
+}
+
+bool CoapWriter::header(CoapType type, uint8_t code, uint16_t messageId, const uint8_t* token, uint8_t tokenLen) {
+  if (tokenLen > COAP_MAX_TOKEN) { ok = false; return false; }
+  uint8_t hdr[4] = {
+    (uint8_t)(0x40 | ((uint8_t)type << 4) | tokenLen), code,
+    (uint8_t)(messageId >> 8), (uint8_t)messageId
+  };
+  return put(hdr, 4) && (tokenLen == 0 || put(token, tokenLen));
+}
+
+bool CoapWriter::option(uint16_t number, const uint8_t* value, size_t valueLen) {
+  if (number < lastOption || valueLen > 0xFFFF) { ok = false; return false; }
+  uint32_t delta = number - lastOption;
+  lastOption = number;
+
+  // Nibble: 0-12 langsung, 13 = +1 byte (-13), 14 = +2 byte (-269)
+  uint8_t ext[4];
+  size_t extLen = 0;
+  auto nibble = [&](uint32_t v) -> uint8_t {
+    if (v < 13) return (uint8_t)v;
+    if (v < 269) { ext[extLen++] = (uint8_t)(v - 13); return 13; }
+    v -= 269;
+    ext[extLen++] = (uint8_t)(v >> 8);
+    ext[extLen++] = (uint8_t)v;
+    return 14;
+  };
+  uint8_t d = nibble(delta);
+  uint8_t l = nibble((uint32_t)valueLen);
+  return putByte((uint8_t)((d << 4) | l)) && (extLen == 0 || put(ext, extLen)) &&
+         (valueLen == 0 || put(value, valueLen));
+}
+
+bool CoapWriter::optionUint(uint16_t number, uint32_t value) {
+  // Panjang minimal: nilai 0 dikodekan tanpa byte
+  uint8_t bytes[4];
+  size_t n = 0;
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    uint8_t b = (uint8_t)(value >> shift);
+    if (n == 0 && b == 0) continue;
+    bytes[n++] = b;
+  }
+  return option(number, bytes, n);
+}
+
+bool CoapWriter::optionString(uint16_t number, const char* value) {
+  return option(number, (const uint8_t*)value, strlen(value));
+}
+
+bool CoapWriter::payload(const uint8_t* data, size_t n) {
+  if (n == 0) return ok;
+  return putByte(0xFF) && put(data, n);
+}
+
+// ==================== PARSER ====================
+
+bool CoapMessage::parse(const uint8_t* buf, size_t len) {
+  if (len < 4 || (buf[0] >> 6) != 1) return false;
+  type = (CoapType)((buf[0] >> 4) & 0x03);
+  tokenLen = buf[0] & 0x0F;
+  code = buf[1];
+  messageId = (uint16_t)((buf[2] << 8) | buf[3]);
+  if (tokenLen > COAP_MAX_TOKEN || 4 + (size_t)tokenLen > len) return false;
+  memcpy(token, buf + 4, tokenLen);
+
+  size_t i = 4 + tokenLen;
+  uint16_t number = 0;
+  optionCount = 0;
+  payload = nullptr;
+  payloadLen = 0;
+
+  while (i < len) {
+    if (buf[i] == 0xFF) {
+      if (i + 1 >= len) return false; // marker tanpa payload
+      payload = buf + i + 1;
+      payloadLen = len - i - 1;
+      return true;
+    }
+    uint32_t delta = buf[i] >> 4, optLen = buf[i] & 0x0F;
+    i++;
+    auto extend = [&](uint32_t& v) -> bool {
+      if (v == 13) { if (i >= len) return false; v = 13 + buf[i++]; }
+      else if (v == 14) { if (i + 1 >= len) return false; v = 269 + ((buf[i] << 8) | buf[i + 1]); i += 2; }
+      else if (v == 15) return false;
+      return true;
+    };
+    if (!extend(delta) || !extend(optLen) || i + optLen > len) return false;
+    if (number + delta > 0xFFFF) return false;
+    number += delta;
+    if (optionCount < MAX_OPTIONS) {
+      options[optionCount++] = { number, buf + i, (uint16_t)optLen };
+    }
+    i += optLen;
+  }
+  return true;
+}
+
+const CoapOptionView* CoapMessage::find(uint16_t number) const {
+  for (uint8_t i = 0; i < optionCount; i++) {
+    if (options[i].number == number) return &options[i];
+  }
+  return nullptr;
+}
+
+uint32_t CoapMessage::optionUint(uint16_t number, uint32_t fallback) const {
+  const CoapOptionView* opt = find(number);
+  if (!opt || opt->length > 4) return fallback;
+  uint32_t v = 0;
+  for (uint16_t i = 0; i < opt->length; i++) v = (v << 8) | opt->value[i];
+  return v;
+}
+
+void coapAuthTag(const uint8_t* psk, size_t pskLen, uint8_t code, uint16_t messageId,
+                 const uint8_t* token, uint8_t tokenLen, const char* keyId,
+                 uint32_t block1, const uint8_t* payload, size_t payloadLen,
+                 uint8_t out[COAP_AUTH_TAG_SIZE]) {
+  HmacSha256 mac(psk, pskLen);
+  uint8_t fixed[4] = { code, (uint8_t)(messageId >> 8), (uint8_t)messageId, tokenLen };
+  mac.update(fixed, sizeof(fixed));
+  mac.update(token, tokenLen);
+  uint8_t keyLen = (uint8_t)strlen(keyId);
+  mac.update(&keyLen, 1);
+  mac.update((const uint8_t*)keyId, keyLen);
+  uint8_t block[4] = { (uint8_t)(block1 >> 24), (uint8_t)(block1 >> 16), (uint8_t)(block1 >> 8), (uint8_t)block1 };
+  mac.update(block, sizeof(block));
+  mac.update(payload, payloadLen);
+
+  uint8_t digest[Sha256::DIGEST_SIZE];
+  mac.finish(digest);
+  memcpy(out, digest, COAP_AUTH_TAG_SIZE);
+}
+
+// ==================== UPLOADER ====================
+
+void CoapUploader::setKey(const char* keyId, const uint8_t* psk, size_t pskLen) {
+  this->keyId = keyId;
+  this->psk = psk;
+  this->pskLen = pskLen;
+}
+
+void CoapUploader::seed(uint32_t entropy) {
+  rng ^= entropy;
+  if (rng == 0) rng = 0x9E3779B9;
+  messageId = (uint16_t)nextRandom();
+}
+
+uint32_t CoapUploader::nextRandom() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+bool CoapUploader::start(const uint8_t* data, size_t len, uint32_t now) {
+  if (state == CoapResult::BUSY || len == 0 || len > BODY_MAX || !host) return false;
+  if (!opened) {
+    transport.close();
+    opened = transport.open(host, port);
+  }
+  if (!opened) return false;
+
+  memcpy(body, data, len);
+  bodyLen = len;
+  blockNum = 0;
+  uint32_t t = nextRandom();
+  memcpy(token, &t, sizeof(token));
+  lastCode = 0;
+  state = CoapResult::BUSY;
+  if (!sendBlock(now)) { finish(CoapResult::FAILED); return false; }
+  return true;
+}
+
+bool CoapUploader::sendBlock(uint32_t now) {
+  size_t blockSize = (size_t)16 << policy.blockSzx;
+  size_t offset = blockNum * blockSize;
+  size_t chunk = bodyLen - offset < blockSize ? bodyLen - offset : blockSize;
+  bool multi = bodyLen > blockSize;
+  uint32_t block1 = multi ? coapBlockValue(blockNum, offset + chunk < bodyLen, policy.blockSzx) : 0;
+
+  messageId++;
+  uint8_t tag[COAP_AUTH_TAG_SIZE];
+  coapAuthTag(psk, pskLen, CoapCode::POST, messageId, token, sizeof(token), keyId,
+              block1, body + offset, chunk, tag);
+
+  CoapWriter w(datagram, sizeof(datagram));
+  w.header(CoapType::CON, CoapCode::POST, messageId, token, sizeof(token));
+  for (const char* seg = path; *seg; ) {
+    const char* end = strchr(seg, '/');
+    size_t n = end ? (size_t)(end - seg) : strlen(seg);
+    if (n) w.option(CoapOption::URI_PATH, (const uint8_t*)seg, n);
+    if (!end) break;
+    seg = end + 1;
+  }
+  w.optionUint(CoapOption::CONTENT_FORMAT, 0); // text/plain: baris form-urlencoded
+  if (multi) w.optionUint(CoapOption::BLOCK1, block1);
+  w.option(CoapOption::AUTH_TAG, tag, sizeof(tag));
+  w.optionString(CoapOption::KEY_ID, keyId);
+  w.payload(body + offset, chunk);
+  datagramLen = w.length();
+  if (datagramLen == 0) return false;
+
+  attempts = 0;
+  awaitingAck = true;
+  // RFC 7252: timeout awal acak di [ACK_TIMEOUT, 1.5 * ACK_TIMEOUT]
+  currentTimeout = policy.ackTimeoutMs + nextRandom() % (policy.ackTimeoutMs / 2 + 1);
+  if (!transport.send(datagram, datagramLen)) return false;
+  txBytes += datagramLen;
+  arm(now, currentTimeout);
+  return true;
+}
+
+void CoapUploader::arm(uint32_t now, uint32_t timeout) {
+  deadline = now + timeout;
+}
+
+CoapResult CoapUploader::finish(CoapResult result) {
+  state = result;
+  awaitingAck = false;
+  // Server tidak menjawab: bisa jadi alamatnya berubah, resolve ulang di start()
+  if (result == CoapResult::FAILED) opened = false;
+  return result;
+}
+
+CoapResult CoapUploader::poll(uint32_t now) {
+  if (state != CoapResult::BUSY) return state;
+
+  uint8_t rx[DATAGRAM_MAX];
+  int n;
+  while ((n = transport.receive(rx, sizeof(rx))) > 0) {
+    rxBytes += n;
+    CoapMessage msg;
+    if (!msg.parse(rx, n)) continue;
+    handle(msg, now);
+    if (state != CoapResult::BUSY) return state;
+  }
+
+  if ((int32_t)(now - deadline) < 0) return state;
+  // Setelah empty ACK tidak ada retransmisi; response terpisah tidak datang
+  if (!awaitingAck || attempts >= policy.maxRetransmit) return finish(CoapResult::FAILED);
+  attempts++;
+  retransmits++;
+  currentTimeout *= 2;
+  if (transport.send(datagram, datagramLen)) txBytes += datagramLen;
+  arm(now, currentTimeout);
+  return state;
+}
+
+void CoapUploader::handle(const CoapMessage& msg, uint32_t now) {
+  bool sameId = msg.messageId == messageId;
+  if (msg.type == CoapType::RST) {
+    if (sameId) finish(CoapResult::FAILED);
+    return;
+  }
+  if (msg.type == CoapType::ACK && msg.code == CoapCode::EMPTY) {
+    // Server sudah terima, response menyusul (separate response)
+    if (sameId && awaitingAck) { awaitingAck = false; arm(now, policy.ackTimeoutMs * 4); }
+    return;
+  }
+  if (msg.tokenLen != sizeof(token) || memcmp(msg.token, token, sizeof(token)) != 0) return;
+  if (msg.type == CoapType::ACK && !sameId) return; // ACK basi dari blok sebelumnya
+
+  if (msg.type == CoapType::CON) {
+    uint8_t ack[4];
+    CoapWriter w(ack, sizeof(ack));
+    w.header(CoapType::ACK, CoapCode::EMPTY, msg.messageId, nullptr, 0);
+    if (transport.send(ack, w.length())) txBytes += w.length();
+  }
+
+  lastCode = msg.code;
+  size_t blockSize = (size_t)16 << policy.blockSzx;
+  bool moreToSend = (blockNum + 1) * blockSize < bodyLen;
+
+  if (msg.code == CoapCode::CONTINUE) {
+    if (!moreToSend) { finish(CoapResult::FAILED); return; }
+    blockNum++;
+    if (!sendBlock(now)) finish(CoapResult::FAILED);
+    return;
+  }
+  if (CoapCode::cls(msg.code) == 2) {
+    finish(moreToSend ? CoapResult::FAILED : CoapResult::DONE);
+    return;
+  }
+  // 4.01 (kunci salah/belum terdaftar), 4.08 dan 4.13 bisa pulih: jangan buang record
+  bool permanent = CoapCode::cls(msg.code) == 4 && msg.code != CoapCode::UNAUTHORIZED &&
+                   msg.code != CoapCode::INCOMPLETE && msg.code != CoapCode::TOO_LARGE;
+  finish(permanent ? CoapResult::REJECTED : CoapResult::FAILED);
+}
+
+// ==================== TRANSPORT UDP (ESP32) ====================
+#ifdef ARDUINO
+#include <WiFi.h>
+
+bool WiFiUdpTransport::open(const char* host, uint16_t port) {
+  if (!WiFi.hostByName(host, remote)) return false;
+  remotePort = port;
+  return udp.begin(COAP_DEFAULT_PORT) == 1;
+}
+
+void WiFiUdpTransport::close() {
+  udp.stop();
+}
+
+bool WiFiUdpTransport::send(const uint8_t* data, size_t len) {
+  if (!udp.beginPacket(remote, remotePort)) return false;
+  udp.write(data, len);
+  return udp.endPacket() == 1;
+}
+
+// Datagram yang lebih besar dari buffer dibuang dan datagram berikutnya
+// dibaca: return 0 di sini menghentikan loop poll() sebelum ACK yang
+// mungkin sudah mengantri di belakangnya
+int WiFiUdpTransport::receive(uint8_t* buf, size_t cap) {
+  for (;;) {
+    int size = udp.parsePacket();
+    if (size <= 0) return 0;
+    if ((size_t)size <= cap) return udp.read(buf, cap);
+    udp.flush();
+  }
+}
+#endif
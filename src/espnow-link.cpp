@@ -0,0 +1,482 @@
+#include "espnow-link.h"
+#include "hmac-sha256.h"
+#include <string.h>
+
+const uint8_t ESPNOW_BROADCAST[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+namespace {
+  void putU32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+  uint32_t getU32(const uint8_t* p) { return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+
+  void computeTag(const uint8_t* frame, size_t len, const uint8_t senderMac[6],
+                  const uint8_t* psk, size_t pskLen, uint8_t out[EspNowFrame::TAG_SIZE]) {
+    HmacSha256 mac(psk, pskLen);
+    mac.update(senderMac, 6);
+    mac.update(frame, len);
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    mac.finish(digest);
+    memcpy(out, digest, EspNowFrame::TAG_SIZE);
+  }
+
+  size_t putString(uint8_t* p, const char* s, size_t maxLen) {
+    size_t n = strnlen(s, maxLen);
+    p[0] = n;
+    memcpy(p + 1, s, n);
+    return n + 1;
+  }
+
+  bool getString(const uint8_t*& p, const uint8_t* end, char* out, size_t outSize) {
+    if (p >= end) return false;
+    size_t n = *p++;
+    if (n >= outSize || p + n > end) return false;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    p += n;
+    return true;
+  }
+
+  bool sameMac(const uint8_t* a, const uint8_t* b) { return memcmp(a, b, 6) == 0; }
+}
+
+// ==================== CODEC ====================
+
+size_t espNowEncode(uint8_t* out, uint8_t type, uint32_t id, const uint8_t* payload, size_t len,
+                    const uint8_t senderMac[6], const uint8_t* psk, size_t pskLen) {
+  using namespace EspNowFrame;
+  if (HEADER_SIZE + len + TAG_SIZE > MAX_SIZE) return 0;
+  out[0] = MAGIC;
+  out[1] = type;
+  putU32(out + 2, id);
+  if (len) memcpy(out + HEADER_SIZE, payload, len);
+  computeTag(out, HEADER_SIZE + len, senderMac, psk, pskLen, out + HEADER_SIZE + len);
+  return HEADER_SIZE + len + TAG_SIZE;
+}
+
+bool espNowDecode(const uint8_t* frame, size_t len, const uint8_t senderMac[6],
+                  const uint8_t* psk, size_t pskLen,
+                  uint8_t& type, uint32_t& id, const uint8_t*& payload, size_t& payloadLen) {
+  using namespace EspNowFrame;
+  if (len < HEADER_SIZE + TAG_SIZE || len > MAX_SIZE || frame[0] != MAGIC) return false;
+  uint8_t expected[TAG_SIZE];
+  computeTag(frame, len - TAG_SIZE, senderMac, psk, pskLen, expected);
+  if (!constantTimeEqual(expected, frame + len - TAG_SIZE, TAG_SIZE)) return false;
+  type = frame[1];
+  id = getU32(frame + 2);
+  payload = frame + HEADER_SIZE;
+  payloadLen = len - HEADER_SIZE - TAG_SIZE;
+  return true;
+}
+
+// f32 berat | u32 umur | fakultas (u8 len + isi) | u8 kode kategori
+size_t espNowPackRecord(uint8_t* out, size_t cap, const EspNowRecord& rec) {
+  if (cap < 8 + 1 + sizeof(rec.fakultas) + 1) return 0;
+  uint32_t weightBits;
+  memcpy(&weightBits, &rec.weight, 4);
+  putU32(out, weightBits);
+  putU32(out + 4, rec.ageMs);
+  size_t n = 8;
+  n += putString(out + n, rec.fakultas, sizeof(rec.fakultas) - 1);
+  out[n++] = (uint8_t)rec.category;
+  return n;
+}
+
+bool espNowUnpackRecord(const uint8_t* in, size_t len, EspNowRecord& rec) {
+  if (len < 10) return false;
+  uint32_t weightBits = getU32(in);
+  memcpy(&rec.weight, &weightBits, 4);
+  rec.ageMs = getU32(in + 4);
+  const uint8_t* p = in + 8;
+  const uint8_t* end = in + len;
+  if (!getString(p, end, rec.fakultas, sizeof(rec.fakultas)) || p >= end) return false;
+  // Kode tak dikenal (firmware node lebih baru): ditolak, bukan diupload salah
+  if (!WasteCategories::valid(*p) || *p == (uint8_t)WasteCategory::NONE) return false;
+  rec.category = (WasteCategory)*p;
+  return true;
+}
+
+// ==================== NODE ====================
+
+void EspNowNode::setIdentity(const uint8_t mac[6]) {
+  memcpy(selfMac, mac, 6);
+  probeNonce = getU32(mac + 2) ^ 0x9E3779B9;
+}
+
+int EspNowNode::pendingCount() const {
+  int n = 0;
+  for (int i = 0; i < WINDOW; i++) if (pending[i].used) n++;
+  return n;
+}
+
+bool EspNowNode::contains(uint32_t seq) const {
+  for (int i = 0; i < WINDOW; i++) {
+    if (pending[i].used && pending[i].rec.seq == seq) return true;
+  }
+  return false;
+}
+
+bool EspNowNode::submit(const EspNowRecord& rec, uint32_t createdAt, uint32_t now) {
+  if (contains(rec.seq)) return true;
+  // Window kosong sebelumnya: diamnya gateway baru dihitung mulai sekarang
+  if (pendingCount() == 0) lastHeardAt = now;
+  for (int i = 0; i < WINDOW; i++) {
+    Pending& p = pending[i];
+    if (p.used) continue;
+    p.used = true;
+    p.createdAt = createdAt;
+    p.attempts = 0;
+    p.rec = rec;
+    if (state == State::LINKED) transmit(p, now);
+    return true;
+  }
+  return false;
+}
+
+bool EspNowNode::transmit(Pending& p, uint32_t now) {
+  uint8_t payload[64];
+  p.rec.ageMs = now - p.createdAt;
+  size_t len = espNowPackRecord(payload, sizeof(payload), p.rec);
+  uint8_t frame[EspNowFrame::MAX_SIZE];
+  size_t frameLen = espNowEncode(frame, EspNowFrame::RECORD, p.rec.seq, payload, len, selfMac, psk, pskLen);
+  if (p.attempts > 0) counters.retransmits++;
+  p.sentAt = now;
+  p.attempts++;
+  if (!frameLen || !radio.send(gatewayMac, frame, frameLen)) return false;
+  counters.framesSent++;
+  return true;
+}
+
+void EspNowNode::startHunt(uint32_t now) {
+  state = State::HUNTING;
+  currentChannel = 1;
+  counters.hunts++;
+  probe(now);
+}
+
+void EspNowNode::probe(uint32_t now) {
+  // xorshift: nonce baru tiap probe supaya reply lama tidak bisa diputar ulang
+  probeNonce ^= probeNonce << 13; probeNonce ^= probeNonce >> 17; probeNonce ^= probeNonce << 5;
+  radio.setChannel(currentChannel);
+  uint8_t frame[EspNowFrame::MAX_SIZE];
+  size_t len = espNowEncode(frame, EspNowFrame::PROBE, probeNonce, nullptr, 0, selfMac, psk, pskLen);
+  if (radio.send(ESPNOW_BROADCAST, frame, len)) counters.framesSent++;
+  stateSince = now;
+}
+
+void EspNowNode::loop(uint32_t now) {
+  switch (state) {
+    case State::IDLE:
+      // Berburu hanya jika ada yang perlu dikirim; jeda antar sapuan yang gagal
+      if (pendingCount() > 0 && (counters.hunts == 0 || now - stateSince >= policy.huntBackoffMs)) startHunt(now);
+      break;
+
+    case State::HUNTING:
+      if (now - stateSince < policy.probeWaitMs) break;
+      if (currentChannel >= policy.maxChannel) {
+        state = State::IDLE;
+        stateSince = now;
+        break;
+      }
+      currentChannel++;
+      probe(now);
+      break;
+
+    case State::LINKED:
+      for (int i = 0; i < WINDOW; i++) {
+        Pending& p = pending[i];
+        if (!p.used) continue;
+        if (p.attempts == 0) { transmit(p, now); continue; }
+        if (now - p.sentAt < policy.ackTimeoutMs) continue;
+        if (now - lastHeardAt > policy.ackTimeoutMs * policy.maxSilentTimeouts) {
+          // Gateway diam (mati / pindah channel): cari ulang, semua dikirim lagi setelah link
+          startHunt(now);
+          return;
+        }
+        transmit(p, now);
+      }
+      break;
+  }
+}
+
+void EspNowNode::onFrame(const uint8_t mac[6], const uint8_t* data, size_t len, uint32_t now) {
+  uint8_t type;
+  uint32_t id;
+  const uint8_t* payload;
+  size_t payloadLen;
+  if (!espNowDecode(data, len, mac, psk, pskLen, type, id, payload, payloadLen)) {
+    counters.badFrames++;
+    return;
+  }
+  counters.framesReceived++;
+
+  if (type == EspNowFrame::PROBE_REPLY) {
+    if (state != State::HUNTING || id != probeNonce) return;
+    memcpy(gatewayMac, mac, 6);
+    state = State::LINKED;
+    stateSince = now;
+    lastHeardAt = now;
+    for (int i = 0; i < WINDOW; i++) if (pending[i].used) transmit(pending[i], now);
+    return;
+  }
+
+  if (type != EspNowFrame::ACK || payloadLen < 1) return;
+  if (sameMac(mac, gatewayMac)) lastHeardAt = now;
+  size_t count = payload[0];
+  if (payloadLen < 1 + count * 5) return;
+  for (size_t e = 0; e < count; e++) {
+    uint32_t seq = getU32(payload + 1 + e * 5);
+    uint8_t result = payload[5 + e * 5];
+    for (int i = 0; i < WINDOW; i++) {
+      Pending& p = pending[i];
+      if (!p.used || p.rec.seq != seq) continue;
+      if (result == (uint8_t)SendResult::RETRY) {
+        // Sudah ditampung gateway (atau tampungan penuh): tunggu satu timeout lagi
+        p.sentAt = now;
+        continue;
+      }
+      p.used = false;
+      if (onResult) onResult(seq, result == (uint8_t)SendResult::REJECTED ? SendResult::REJECTED : SendResult::ACKED);
+    }
+  }
+}
+
+// ==================== GATEWAY ====================
+
+void EspNowGateway::setIdentity(const uint8_t mac[6]) {
+  memcpy(selfMac, mac, 6);
+}
+
+EspNowGateway::Node* EspNowGateway::findNode(const uint8_t mac[6], bool create, uint32_t now) {
+  Node* freeSlot = nullptr;
+  Node* oldest = nullptr;
+  for (int i = 0; i < MAX_NODES; i++) {
+    Node& n = nodes[i];
+    if (n.used && sameMac(n.mac, mac)) { n.lastSeen = now; return &n; }
+    if (!n.used && !freeSlot) freeSlot = &n;
+    if (n.used && (!oldest || (int32_t)(n.lastSeen - oldest->lastSeen) < 0)) oldest = &n;
+  }
+  if (!create) return nullptr;
+  // Tabel penuh: node yang paling lama diam digantikan
+  Node* n = freeSlot ? freeSlot : oldest;
+  memset(n, 0, sizeof(*n));
+  n->used = true;
+  memcpy(n->mac, mac, 6);
+  n->lastSeen = now;
+  return n;
+}
+
+void EspNowGateway::remember(Node& node, uint32_t seq, SendResult result) {
+  node.recentSeq[node.recentNext] = seq;
+  node.recentResult[node.recentNext] = 1 + (uint8_t)result;
+  node.recentNext = (node.recentNext + 1) % RECENT_PER_NODE;
+}
+
+void EspNowGateway::sendAck(const uint8_t mac[6], const uint32_t* seqs, const SendResult* results, size_t count) {
+  uint8_t payload[1 + EspNowFrame::ACK_MAX_ENTRIES * 5];
+  payload[0] = count;
+  for (size_t i = 0; i < count; i++) {
+    putU32(payload + 1 + i * 5, seqs[i]);
+    payload[5 + i * 5] = (uint8_t)results[i];
+  }
+  uint8_t frame[EspNowFrame::MAX_SIZE];
+  size_t len = espNowEncode(frame, EspNowFrame::ACK, 0, payload, 1 + count * 5, selfMac, psk, pskLen);
+  if (len && radio.send(mac, frame, len)) counters.framesSent++;
+}
+
+void EspNowGateway::onFrame(const uint8_t mac[6], const uint8_t* data, size_t len, uint32_t now) {
+  uint8_t type;
+  uint32_t id;
+  const uint8_t* payload;
+  size_t payloadLen;
+  if (!espNowDecode(data, len, mac, psk, pskLen, type, id, payload, payloadLen)) {
+    counters.badFrames++;
+    return;
+  }
+  counters.framesReceived++;
+
+  if (type == EspNowFrame::PROBE) {
+    findNode(mac, true, now);
+    uint8_t frame[EspNowFrame::MAX_SIZE];
+    size_t n = espNowEncode(frame, EspNowFrame::PROBE_REPLY, id, nullptr, 0, selfMac, psk, pskLen);
+    if (radio.send(mac, frame, n)) counters.framesSent++;
+    return;
+  }
+  if (type != EspNowFrame::RECORD) return;
+
+  EspNowRecord rec;
+  if (!espNowUnpackRecord(payload, payloadLen, rec)) { counters.badFrames++; return; }
+  rec.seq = id;
+
+  // Sudah selesai di-upload (ACK kita hilang): jawab ulang tanpa upload lagi
+  Node* node = findNode(mac, true, now);
+  for (int i = 0; i < RECENT_PER_NODE; i++) {
+    if (node->recentResult[i] && node->recentSeq[i] == rec.seq) {
+      SendResult result = (SendResult)(node->recentResult[i] - 1);
+      counters.duplicates++;
+      sendAck(mac, &rec.seq, &result, 1);
+      return;
+    }
+  }
+
+  // Retransmisi record yang masih menunggu upload, atau tampungan penuh:
+  // jawab RETRY supaya node menahan diri satu timeout lagi (dan tahu
+  // gateway masih hidup, tidak perlu berburu channel)
+  SendResult hold = SendResult::RETRY;
+  Slot* freeSlot = nullptr;
+  for (int i = 0; i < MAX_PENDING; i++) {
+    Slot& s = slots[i];
+    if (s.used && s.item.rec.seq == rec.seq && sameMac(s.item.mac, mac)) {
+      counters.duplicates++;
+      sendAck(mac, &rec.seq, &hold, 1);
+      return;
+    }
+    if (!s.used && !freeSlot) freeSlot = &s;
+  }
+  if (!freeSlot) {
+    counters.dropped++;
+    sendAck(mac, &rec.seq, &hold, 1);
+    return;
+  }
+  freeSlot->used = true;
+  freeSlot->uploading = false;
+  memcpy(freeSlot->item.mac, mac, 6);
+  freeSlot->item.rec = rec;
+  freeSlot->item.receivedAt = now;
+}
+
+size_t EspNowGateway::takeBatch(RelayedRecord* out, size_t max, uint32_t now) {
+  if (retryHold && (int32_t)(now - retryAfter) < 0) return 0;
+  retryHold = false;
+
+  size_t ready = 0;
+  uint32_t oldestAge = 0;
+  for (int i = 0; i < MAX_PENDING; i++) {
+    const Slot& s = slots[i];
+    if (!s.used || s.uploading) continue;
+    ready++;
+    uint32_t age = now - s.item.receivedAt;
+    if (age > oldestAge) oldestAge = age;
+  }
+  if (ready == 0 || (ready < policy.batchSize && oldestAge < policy.maxWaitMs)) return 0;
+
+  size_t n = 0;
+  for (int i = 0; i < MAX_PENDING && n < max; i++) {
+    Slot& s = slots[i];
+    if (!s.used || s.uploading) continue;
+    s.uploading = true;
+    out[n++] = s.item;
+  }
+  return n;
+}
+
+void EspNowGateway::complete(const RelayedRecord* recs, const SendResult* results, size_t count, uint32_t now) {
+  if (count > MAX_PENDING) count = MAX_PENDING;
+  bool acked[MAX_PENDING] = {};
+  bool anyRetry = false;
+
+  for (size_t r = 0; r < count; r++) {
+    for (int i = 0; i < MAX_PENDING; i++) {
+      Slot& s = slots[i];
+      if (!s.used || !s.uploading || s.item.rec.seq != recs[r].rec.seq || !sameMac(s.item.mac, recs[r].mac)) continue;
+      if (results[r] == SendResult::RETRY) {
+        s.uploading = false;
+        anyRetry = true;
+      } else {
+        s.used = false;
+        acked[r] = true;
+      }
+      break;
+    }
+  }
+  if (anyRetry) {
+    retryHold = true;
+    retryAfter = now + policy.retryBackoffMs;
+  }
+
+  // Satu frame ACK per node asal
+  bool sent[MAX_PENDING] = {};
+  for (size_t r = 0; r < count; r++) {
+    if (!acked[r] || sent[r]) continue;
+    uint32_t seqs[EspNowFrame::ACK_MAX_ENTRIES];
+    SendResult res[EspNowFrame::ACK_MAX_ENTRIES];
+    size_t n = 0;
+    Node* node = findNode(recs[r].mac, true, now);
+    for (size_t k = r; k < count && n < EspNowFrame::ACK_MAX_ENTRIES; k++) {
+      if (!acked[k] || sent[k] || !sameMac(recs[k].mac, recs[r].mac)) continue;
+      seqs[n] = recs[k].rec.seq;
+      res[n] = results[k];
+      remember(*node, seqs[n], res[n]);
+      sent[k] = true;
+      n++;
+    }
+    sendAck(recs[r].mac, seqs, res, n);
+  }
+}
+
+int EspNowGateway::pendingCount() const {
+  int n = 0;
+  for (int i = 0; i < MAX_PENDING; i++) if (slots[i].used) n++;
+  return n;
+}
+
+int EspNowGateway::nodeCount() const {
+  int n = 0;
+  for (int i = 0; i < MAX_NODES; i++) if (nodes[i].used) n++;
+  return n;
+}
+
+// ==================== RADIO ESP32 ====================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+
+namespace {
+  struct RxFrame {
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[EspNowFrame::MAX_SIZE];
+  };
+  QueueHandle_t rxQueue = nullptr;
+
+  void onEspNowReceive(const uint8_t* mac, const uint8_t* data, int len) {
+    if (!rxQueue || len <= 0 || len > (int)EspNowFrame::MAX_SIZE) return;
+    RxFrame f;
+    memcpy(f.mac, mac, 6);
+    f.len = len;
+    memcpy(f.data, data, len);
+    xQueueSend(rxQueue, &f, 0);  // antrian penuh: frame dibuang, pengirim retransmit
+  }
+
+  bool ensurePeer(const uint8_t mac[6]) {
+    if (esp_now_is_peer_exist(mac)) return true;
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, mac, 6);
+    peer.channel = 0;  // channel yang sedang aktif
+    peer.ifidx = WIFI_IF_STA;
+    peer.encrypt = false;
+    return esp_now_add_peer(&peer) == ESP_OK;
+  }
+}
+
+bool Esp32EspNowRadio::begin() {
+  if (!rxQueue) rxQueue = xQueueCreate(8, sizeof(RxFrame));
+  if (!rxQueue || esp_now_init() != ESP_OK) return false;
+  return esp_now_register_recv_cb(onEspNowReceive) == ESP_OK && ensurePeer(ESPNOW_BROADCAST);
+}
+
+bool Esp32EspNowRadio::send(const uint8_t mac[6], const uint8_t* data, size_t len) {
+  return ensurePeer(mac) && esp_now_send(mac, data, len) == ESP_OK;
+}
+
+// Hanya untuk node: STA tidak tersambung sehingga channel bebas dipindah
+bool Esp32EspNowRadio::setChannel(uint8_t channel) {
+  return esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE) == ESP_OK;
+}
+
+void Esp32EspNowRadio::poll(FrameHandler handler) {
+  RxFrame f;
+  while (rxQueue && xQueueReceive(rxQueue, &f, 0) == pdTRUE) handler(f.mac, f.data, f.len);
+}
+#endif
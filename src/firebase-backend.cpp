@@ -0,0 +1,171 @@
+#include "firebase-backend.h"
+
+// Hanya dikompilasi di env profil firebase; env lain tidak menyentuh
+// library Firebase sama sekali
+#if defined(ARDUINO) && defined(ECOSCALE_BACKEND_FIREBASE)
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include <Firebase_ESP_Client.h>
+#include <time.h>
+#include "credentials.h"
+#include "async-log.h"
+#include "waste-category.h"
+
+namespace {
+constexpr unsigned long SIGNUP_RETRY_MS = 60000;
+
+FirebaseData fbdo;
+FirebaseAuth auth;
+FirebaseConfig firebaseConfig;
+BackendContext context = {};
+bool started = false;
+unsigned long lastStartAttempt = 0;
+unsigned long lastTokenExpires = 0;
+FirebaseAuthStats stats = {};
+
+void loadAuthStats() {
+  Preferences prefs;
+  prefs.begin("fb_auth", true);
+  stats.boots = prefs.getULong("boots", 0);
+  stats.signUps = prefs.getULong("signups", 0);
+  stats.refreshes = prefs.getULong("refreshes", 0);
+  prefs.end();
+}
+
+void saveAuthStats() {
+  Preferences prefs;
+  prefs.begin("fb_auth", false);
+  prefs.putULong("boots", stats.boots);
+  prefs.putULong("signups", stats.signUps);
+  prefs.putULong("refreshes", stats.refreshes);
+  prefs.end();
+}
+
+// Token dari boot sebelumnya: tidak ada signUp, tidak ada user anonim baru
+bool restoreTokens() {
+  Preferences prefs;
+  prefs.begin("fb_auth", true);
+  String idToken = prefs.getString("id", "");
+  String refreshToken = prefs.getString("refresh", "");
+  unsigned long expiresAt = prefs.getULong("exp", 0);
+  prefs.end();
+  if (refreshToken.length() == 0) return false;
+
+  // Sisa umur hanya bisa dihitung jika jam sudah sync. Jika belum, token
+  // dianggap kedaluwarsa dan library cukup me-refresh (satu request ringan).
+  time_t now = time(nullptr);
+  size_t remaining = 0;
+  if (idToken.length() > 0 && now > 1600000000 && expiresAt > (unsigned long)now) {
+    remaining = expiresAt - now;
+  }
+  Firebase.setIdToken(&firebaseConfig, idToken.c_str(), remaining, refreshToken.c_str());
+  lastTokenExpires = firebaseConfig.signer.tokens.expires;
+  return true;
+}
+
+// Dipanggil setiap token siap; NVS hanya ditulis jika token benar-benar baru
+void saveTokens() {
+  unsigned long expires = firebaseConfig.signer.tokens.expires;
+  if (expires == lastTokenExpires) return;
+  lastTokenExpires = expires;
+
+  // Tanpa jam yang valid, expires bukan epoch: simpan 0 (refresh saat boot)
+  bool clockValid = time(nullptr) > 1600000000;
+  Preferences prefs;
+  prefs.begin("fb_auth", false);
+  prefs.putString("id", Firebase.getToken());
+  prefs.putString("refresh", Firebase.getRefreshToken());
+  prefs.putULong("exp", clockValid ? expires : 0);
+  prefs.end();
+}
+
+void onTokenStatus(TokenInfo info) {
+  if (info.status == token_status_on_refresh) {
+    stats.refreshes++;
+    saveAuthStats();
+  } else if (info.status == token_status_ready) saveTokens();
+  else if (info.status == token_status_error) LOG_W(HTTP, "⚠️ Token Firebase: %s", info.error.message.c_str());
+}
+}
+
+void FirebaseBackend::begin(const BackendContext& ctx) {
+  context = ctx;
+  firebaseConfig.api_key = API_KEY;
+  firebaseConfig.token_status_callback = onTokenStatus;
+  firebaseConfig.signer.preRefreshSeconds = 5 * 60;
+  loadAuthStats();
+  stats.boots++;
+  saveAuthStats();
+}
+
+void FirebaseBackend::service(unsigned long now) {
+  if (WiFi.status() != WL_CONNECTED) return;
+  if (!started) {
+    if (lastStartAttempt != 0 && now - lastStartAttempt < SIGNUP_RETRY_MS) return;
+    lastStartAttempt = now;
+    bool cached = restoreTokens();
+    if (!cached && !Firebase.signUp(&firebaseConfig, &auth, "", "")) {
+      LOG_W(HTTP, "❌ Login Firebase gagal, dicoba lagi");
+      return;
+    }
+    if (!cached) {
+      stats.signUps++;
+      saveAuthStats();
+    }
+    Firebase.begin(&firebaseConfig, &auth);
+    Firebase.reconnectWiFi(false);   // WiFi dikelola manageWifiConnection/roaming
+    started = true;
+    stats.readyMs = millis();
+    stats.fromCache = cached;
+    LOG_I(HTTP, "🔑 Firebase siap dalam %lu ms (%s) | boot ke-%lu, signUp %lu, refresh %lu",
+          (unsigned long)stats.readyMs, cached ? "token dari NVS" : "signUp baru", (unsigned long)stats.boots,
+          (unsigned long)stats.signUps, (unsigned long)stats.refreshes);
+  }
+  Firebase.ready();   // refresh token di background, hanya menjelang kedaluwarsa
+}
+
+const FirebaseAuthStats& FirebaseBackend::authStats() {
+  return stats;
+}
+
+SendResult FirebaseBackend::send(WeighingRecord* const* recs, size_t count) {
+  const WeighingRecord& rec = *recs[0];
+  if (!started || !Firebase.ready()) {
+    LOG_W(HTTP, "❌ Firebase belum siap, record ditunda");
+    return SendResult::RETRY;
+  }
+  char timestamp[32];
+  if (!context.wallClock(rec.monoMs, timestamp, sizeof(timestamp))) {
+    LOG_W(HTTP, "❌ Jam belum sinkron, record ditunda");
+    return SendResult::RETRY;
+  }
+
+  FirebaseJson content;
+  content.set("fields/berat/doubleValue", String(rec.weight, 2));
+  content.set("fields/jenis/stringValue", WasteCategories::name(rec.category));
+  content.set("fields/fakultas/stringValue", context.fakultas);
+  content.set("fields/device_id/stringValue", context.deviceId);
+  content.set("fields/seq/integerValue", String((unsigned long)rec.seq));
+  content.set("fields/timestamp/timestampValue", timestamp);
+
+  char path[48];
+  snprintf(path, sizeof(path), "sampah/%s-%lu", context.deviceId, (unsigned long)rec.seq);
+  LOG_I(HTTP, "📤 Firestore %s: %.2f kg, %s", path, rec.weight, WasteCategories::name(rec.category));
+
+  if (Firebase.Firestore.createDocument(&fbdo, FIREBASE_PROJECT_ID, "", path, content.raw())) {
+    LOG_I(HTTP, "✅ Firestore OK");
+    return SendResult::ACKED;
+  }
+  int code = fbdo.httpCode();
+  if (code == 409) {
+    LOG_I(HTTP, "✅ Sudah tersimpan (duplikat seq=%lu)", (unsigned long)rec.seq);
+    return SendResult::ACKED;
+  }
+  LOG_W(HTTP, "❌ Firestore gagal (%d): %s", code, fbdo.errorReason().c_str());
+  // 401/403 = token (di-refresh library), 408/429 = sementara
+  bool permanent = code >= 400 && code < 500 && code != 401 && code != 403 && code != 408 && code != 429;
+  return permanent ? SendResult::REJECTED : SendResult::RETRY;
+}
+
+#endif
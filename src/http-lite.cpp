@@ -0,0 +1,222 @@
+#include "http-lite.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace {
+  // strcasestr tidak dijamin ada di semua libc
+  bool containsIgnoreCase(const char* haystack, const char* needle) {
+    size_t n = strlen(needle);
+    for (; *haystack; haystack++) {
+      if (strncasecmp(haystack, needle, n) == 0) return true;
+    }
+    return false;
+  }
+}
+
+// ==================== ENDPOINT ====================
+
+bool HttpEndpoint::parse(const char* url) {
+  const char* p = url;
+  if (strncmp(p, "https://", 8) == 0) { tls = true; port = 443; p += 8; }
+  else if (strncmp(p, "http://", 7) == 0) { tls = false; port = 80; p += 7; }
+  else return false;
+
+  const char* hostEnd = p;
+  while (*hostEnd && *hostEnd != '/' && *hostEnd != ':') hostEnd++;
+  size_t hostLen = hostEnd - p;
+  if (hostLen == 0 || hostLen >= sizeof(host)) return false;
+  memcpy(host, p, hostLen); host[hostLen] = '\0';
+
+  p = hostEnd;
+  if (*p == ':') {
+    port = (uint16_t)strtoul(p + 1, (char**)&p, 10);
+    if (port == 0) return false;
+  }
+  const char* pathStart = *p ? p : "/";
+  if (strlen(pathStart) >= sizeof(path)) return false;
+  strcpy(path, pathStart);
+  return true;
+}
+
+// ==================== REQUEST WRITER ====================
+
+bool HttpRequestWriter::begin(const char* method, const HttpEndpoint& endpoint, const char* contentType) {
+  char hostHeader[72];
+  bool defaultPort = (endpoint.tls && endpoint.port == 443) || (!endpoint.tls && endpoint.port == 80);
+  if (defaultPort) snprintf(hostHeader, sizeof(hostHeader), "%s", endpoint.host);
+  else snprintf(hostHeader, sizeof(hostHeader), "%s:%u", endpoint.host, endpoint.port);
+
+  int n = snprintf(staticBlock, sizeof(staticBlock),
+                   "%s %s HTTP/1.1\r\n"
+                   "Host: %s\r\n"
+                   "User-Agent: EcoScale-ESP32\r\n"
+                   "Content-Type: %s\r\n"
+                   "Connection: keep-alive\r\n",
+                   method, endpoint.path, hostHeader, contentType);
+  if (n < 0 || (size_t)n >= sizeof(staticBlock)) { staticLen = 0; return false; }
+  staticLen = n;
+  return true;
+}
+
+size_t HttpRequestWriter::build(char* out, size_t cap, const char* extraHeaders,
+                                const char* body, size_t bodyLen) const {
+  if (staticLen == 0 || staticLen >= cap) return 0;
+  memcpy(out, staticBlock, staticLen);
+  size_t len = staticLen;
+
+  int n = snprintf(out + len, cap - len, "%sContent-Length: %u\r\n\r\n",
+                   extraHeaders ? extraHeaders : "", (unsigned)bodyLen);
+  if (n < 0 || (size_t)n >= cap - len) return 0;
+  len += n;
+
+  if (bodyLen > cap - len) return 0;
+  memcpy(out + len, body, bodyLen);
+  return len + bodyLen;
+}
+
+// ==================== RESPONSE PARSER ====================
+
+void HttpResponseParser::reset() {
+  state = State::STATUS_LINE;
+  lineLen = 0;
+  status = 0;
+  httpMinor1 = true;
+  persistent = true;
+  isChunked = false;
+  hasLength = false;
+  remaining = 0;
+  dateValue[0] = '\0';
+  prefix[0] = '\0';
+  prefixLen = 0;
+}
+
+bool HttpResponseParser::bodyContains(const char* needle) const {
+  return strstr(prefix, needle) != nullptr;
+}
+
+void HttpResponseParser::connectionClosed() {
+  if (state == State::BODY_UNTIL_CLOSE) state = State::DONE;
+}
+
+int HttpResponseParser::feed(const uint8_t* data, size_t len) {
+  size_t i = 0;
+  while (i < len && state != State::DONE && state != State::ERROR) {
+    switch (state) {
+      case State::STATUS_LINE:
+      case State::HEADER_LINE:
+      case State::CHUNK_SIZE:
+      case State::CHUNK_DATA_END:
+      case State::CHUNK_TRAILER: {
+        char c = (char)data[i++];
+        if (c == '\r') break;
+        if (c != '\n') {
+          // Baris terlalu panjang dipotong; header yang kita perlukan pendek
+          if (lineLen < LINE_MAX - 1) line[lineLen++] = c;
+          break;
+        }
+        line[lineLen] = '\0';
+        bool ok = onLine();
+        lineLen = 0;
+        if (!ok) state = State::ERROR;
+        break;
+      }
+
+      case State::BODY_IDENTITY:
+      case State::CHUNK_DATA: {
+        size_t take = len - i < remaining ? len - i : remaining;
+        onBody(data + i, take);
+        i += take; remaining -= take;
+        if (remaining == 0) state = state == State::CHUNK_DATA ? State::CHUNK_DATA_END : State::DONE;
+        break;
+      }
+
+      case State::BODY_UNTIL_CLOSE:
+        onBody(data + i, len - i);
+        i = len;
+        break;
+
+      default:
+        break;
+    }
+  }
+  return state == State::ERROR ? -1 : (int)i;
+}
+
+bool HttpResponseParser::onLine() {
+  switch (state) {
+    case State::STATUS_LINE: {
+      // "HTTP/1.1 200 OK"
+      if (strncmp(line, "HTTP/1.", 7) != 0 || lineLen < 12) return false;
+      httpMinor1 = line[7] != '0';
+      persistent = httpMinor1;
+      status = atoi(line + 9);
+      if (status < 100 || status > 599) return false;
+      state = State::HEADER_LINE;
+      return true;
+    }
+
+    case State::HEADER_LINE: {
+      if (lineLen == 0) {
+        // Akhir header: tentukan cara membaca body
+        if (status < 200 || status == 204 || status == 304) state = State::DONE;
+        else if (isChunked) state = State::CHUNK_SIZE;
+        else if (hasLength) state = remaining > 0 ? State::BODY_IDENTITY : State::DONE;
+        else { state = State::BODY_UNTIL_CLOSE; persistent = false; }
+        return true;
+      }
+      char* colon = strchr(line, ':');
+      if (!colon) return true; // baris rusak diabaikan
+      *colon = '\0';
+      char* value = colon + 1;
+      while (*value == ' ' || *value == '\t') value++;
+      onHeader(line, value);
+      return true;
+    }
+
+    case State::CHUNK_SIZE: {
+      char* end;
+      unsigned long size = strtoul(line, &end, 16);
+      if (end == line) return false;
+      remaining = size;
+      state = size == 0 ? State::CHUNK_TRAILER : State::CHUNK_DATA;
+      return true;
+    }
+
+    case State::CHUNK_DATA_END:
+      if (lineLen != 0) return false;
+      state = State::CHUNK_SIZE;
+      return true;
+
+    case State::CHUNK_TRAILER:
+      if (lineLen == 0) state = State::DONE;
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+void HttpResponseParser::onHeader(char* name, char* value) {
+  if (strcasecmp(name, "Content-Length") == 0) {
+    hasLength = true;
+    remaining = strtoul(value, nullptr, 10);
+  } else if (strcasecmp(name, "Transfer-Encoding") == 0) {
+    isChunked = containsIgnoreCase(value, "chunked");
+  } else if (strcasecmp(name, "Connection") == 0) {
+    if (containsIgnoreCase(value, "close")) persistent = false;
+    else if (containsIgnoreCase(value, "keep-alive")) persistent = true;
+  } else if (strcasecmp(name, "Date") == 0) {
+    strncpy(dateValue, value, DATE_MAX - 1);
+    dateValue[DATE_MAX - 1] = '\0';
+  }
+}
+
+void HttpResponseParser::onBody(const uint8_t* data, size_t len) {
+  size_t room = BODY_PREFIX_MAX - prefixLen;
+  size_t take = len < room ? len : room;
+  memcpy(prefix + prefixLen, data, take);
+  prefixLen += take;
+  prefix[prefixLen] = '\0';
+}
@@ -0,0 +1,153 @@
+#include "job-scheduler.h"
+
+int8_t JobScheduler::add(const char* name, JobFn fn, uint32_t periodUs, uint32_t budgetUs) {
+  if (count >= MAX_JOBS || fn == nullptr) return -1;
+  Job& job = jobs[count];
+  job = Job{};
+  job.name = name;
+  job.fn = fn;
+  job.periodUs = periodUs;
+  job.budgetUs = budgetUs;
+  job.heapPos = -1;
+  return (int8_t)count++;
+}
+
+int8_t JobScheduler::every(const char* name, uint32_t periodMs, JobFn fn, uint32_t budgetUs,
+                           uint32_t firstDelayMs) {
+  if (periodMs == 0) return -1;
+  int8_t id = add(name, fn, periodMs * 1000, budgetUs);
+  if (id >= 0) arm(id, firstDelayMs);
+  return id;
+}
+
+int8_t JobScheduler::oneShot(const char* name, JobFn fn, uint32_t budgetUs) {
+  return add(name, fn, 0, budgetUs);
+}
+
+void JobScheduler::arm(int8_t id, uint32_t delayMs) {
+  if (id < 0 || id >= count) return;
+  if (jobs[id].heapPos >= 0) remove(id);
+  jobs[id].deadline = clock() + delayMs * 1000;
+  push(id);
+}
+
+void JobScheduler::disarm(int8_t id) {
+  if (id < 0 || id >= count || jobs[id].heapPos < 0) return;
+  remove(id);
+}
+
+void JobScheduler::setPeriod(int8_t id, uint32_t periodMs) {
+  if (id < 0 || id >= count || jobs[id].periodUs == 0 || periodMs == 0) return;
+  uint32_t periodUs = periodMs * 1000;
+  if (jobs[id].periodUs == periodUs) return;
+  jobs[id].periodUs = periodUs;
+  // Periode lama bisa jauh lebih panjang: jalankan berikutnya dengan periode baru
+  if (jobs[id].heapPos >= 0) arm(id, periodMs);
+}
+
+bool JobScheduler::armed(int8_t id) const {
+  return id >= 0 && id < count && jobs[id].heapPos >= 0;
+}
+
+bool JobScheduler::takeOverrunFlag(int8_t id) {
+  if (id < 0 || id >= count || !jobs[id].overrunFlag) return false;
+  jobs[id].overrunFlag = false;
+  return true;
+}
+
+uint32_t JobScheduler::untilNext() const {
+  if (heapSize == 0) return UINT32_MAX;
+  int32_t wait = (int32_t)(jobs[heap[0]].deadline - clock());
+  return wait > 0 ? (uint32_t)wait : 0;
+}
+
+uint8_t JobScheduler::run() {
+  uint8_t ran = 0;
+  uint32_t now = clock();
+  // Batas: tiap job paling banyak sekali per run() walau deadline berikutnya
+  // sudah lewat lagi (job berkala yang lebih lama dari periodenya)
+  while (heapSize > 0 && ran < count) {
+    uint8_t id = heap[0];
+    Job& job = jobs[id];
+    if ((int32_t)(now - job.deadline) < 0) break;
+    remove(id);
+
+    uint32_t start = clock();
+    uint32_t late = start - job.deadline;
+    job.fn();
+    uint32_t end = clock();
+    uint32_t duration = end - start;
+
+    JobStats& st = job.stats;
+    st.runs++;
+    st.jitterTotalUs += late;
+    if (late > st.jitterMaxUs) st.jitterMaxUs = late;
+    st.lastDurationUs = duration;
+    if (duration > st.durationMaxUs) st.durationMaxUs = duration;
+    if (job.budgetUs > 0 && duration > job.budgetUs) { st.overruns++; job.overrunFlag = true; }
+    ran++;
+
+    // Job bisa di-arm ulang dari dalam fn (mis. one-shot yang menjadwal dirinya)
+    if (job.periodUs > 0 && job.heapPos < 0) {
+      job.deadline += job.periodUs;
+      if ((int32_t)(end - job.deadline) >= 0) {
+        uint32_t missed = (end - job.deadline) / job.periodUs + 1;
+        st.skipped += missed;
+        job.deadline += missed * job.periodUs;
+      }
+      push(id);
+    }
+    now = end;
+  }
+  return ran;
+}
+
+// ==================== MIN-HEAP ====================
+
+bool JobScheduler::before(uint8_t a, uint8_t b) const {
+  int32_t diff = (int32_t)(jobs[a].deadline - jobs[b].deadline);
+  return diff < 0 || (diff == 0 && a < b);   // seri: urut pendaftaran
+}
+
+void JobScheduler::swapHeap(uint8_t a, uint8_t b) {
+  uint8_t t = heap[a]; heap[a] = heap[b]; heap[b] = t;
+  jobs[heap[a]].heapPos = a;
+  jobs[heap[b]].heapPos = b;
+}
+
+void JobScheduler::siftUp(uint8_t pos) {
+  while (pos > 0) {
+    uint8_t parent = (pos - 1) / 2;
+    if (!before(heap[pos], heap[parent])) break;
+    swapHeap(pos, parent);
+    pos = parent;
+  }
+}
+
+void JobScheduler::siftDown(uint8_t pos) {
+  for (;;) {
+    uint8_t left = pos * 2 + 1, right = left + 1, best = pos;
+    if (left < heapSize && before(heap[left], heap[best])) best = left;
+    if (right < heapSize && before(heap[right], heap[best])) best = right;
+    if (best == pos) break;
+    swapHeap(pos, best);
+    pos = best;
+  }
+}
+
+void JobScheduler::push(uint8_t id) {
+  heap[heapSize] = id;
+  jobs[id].heapPos = heapSize;
+  siftUp(heapSize++);
+}
+
+void JobScheduler::remove(uint8_t id) {
+  uint8_t pos = jobs[id].heapPos;
+  jobs[id].heapPos = -1;
+  heapSize--;
+  if (pos == heapSize) return;
+  heap[pos] = heap[heapSize];
+  jobs[heap[pos]].heapPos = pos;
+  siftDown(pos);
+  siftUp(pos);
+}
@@ -0,0 +1,214 @@
+#include "json-lite.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+  int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  bool isDigit(char c) { return c >= '0' && c <= '9'; }
+}
+
+bool JsonSlice::equals(const char* s) const {
+  size_t n = strlen(s);
+  return n == len && memcmp(ptr, s, n) == 0;
+}
+
+// ==================== TOKENIZER ====================
+
+void JsonReader::skipSpace() {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+}
+
+JsonToken JsonReader::next() {
+  if (failed) return JsonToken::ERROR;
+  skipSpace();
+
+  switch (expect) {
+    case Expect::DONE:
+      // Setelah nilai teratas hanya boleh spasi
+      return p < end ? fail() : (last = JsonToken::END);
+
+    case Expect::VALUE:
+      return last = value();
+
+    case Expect::VALUE_OR_CLOSE:
+      if (p < end && *p == ']') { p++; level--; return last = afterValue(JsonToken::ARRAY_END); }
+      return last = value();
+
+    case Expect::KEY_OR_CLOSE:
+      if (p < end && *p == '}') { p++; level--; return last = afterValue(JsonToken::OBJECT_END); }
+      // fallthrough
+    case Expect::KEY:
+      if (p >= end || *p != '"' || !scanString()) return fail();
+      skipSpace();
+      if (p >= end || *p != ':') return fail();
+      p++;
+      expect = Expect::VALUE;
+      return last = JsonToken::KEY;
+
+    case Expect::COMMA_OR_CLOSE: {
+      if (p >= end) return fail();
+      bool array = inArray[level - 1];
+      if (*p == ',') {
+        p++;
+        skipSpace();
+        if (array) return last = value();
+        expect = Expect::KEY;
+        return next();
+      }
+      if (*p == (array ? ']' : '}')) {
+        p++;
+        level--;
+        return last = afterValue(array ? JsonToken::ARRAY_END : JsonToken::OBJECT_END);
+      }
+      return fail();
+    }
+
+    default:
+      return fail();
+  }
+}
+
+JsonToken JsonReader::afterValue(JsonToken t) {
+  expect = level == 0 ? Expect::DONE : Expect::COMMA_OR_CLOSE;
+  return t;
+}
+
+JsonToken JsonReader::value() {
+  if (p >= end) return fail();
+  tokStart = p;
+  tokLen = 0;
+
+  char c = *p;
+  if (c == '{' || c == '[') {
+    if (level >= MAX_DEPTH) return fail();
+    inArray[level++] = (c == '[');
+    p++;
+    expect = c == '[' ? Expect::VALUE_OR_CLOSE : Expect::KEY_OR_CLOSE;
+    return c == '[' ? JsonToken::ARRAY_BEGIN : JsonToken::OBJECT_BEGIN;
+  }
+  if (c == '"') return scanString() ? afterValue(JsonToken::STRING) : fail();
+
+  static const struct { const char* text; JsonToken token; } LITERALS[] = {
+    { "true", JsonToken::TRUE }, { "false", JsonToken::FALSE }, { "null", JsonToken::NUL }
+  };
+  for (const auto& lit : LITERALS) {
+    size_t n = strlen(lit.text);
+    if (c == lit.text[0]) {
+      if ((size_t)(end - p) < n || memcmp(p, lit.text, n) != 0) return fail();
+      p += n;
+      tokLen = n;
+      return afterValue(lit.token);
+    }
+  }
+
+  // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+  if (c != '-' && !isDigit(c)) return fail();
+  if (*p == '-') p++;
+  if (p >= end || !isDigit(*p)) return fail();
+  if (*p == '0') p++;
+  else while (p < end && isDigit(*p)) p++;
+  if (p < end && *p == '.') {
+    p++;
+    if (p >= end || !isDigit(*p)) return fail();
+    while (p < end && isDigit(*p)) p++;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    p++;
+    if (p < end && (*p == '+' || *p == '-')) p++;
+    if (p >= end || !isDigit(*p)) return fail();
+    while (p < end && isDigit(*p)) p++;
+  }
+  tokLen = p - tokStart;
+  return afterValue(JsonToken::NUMBER);
+}
+
+// p di tanda kutip pembuka; hasil: tokStart/tokLen = isi tanpa kutip
+bool JsonReader::scanString() {
+  p++;
+  tokStart = p;
+  while (p < end) {
+    char c = *p;
+    if (c == '"') {
+      tokLen = p - tokStart;
+      p++;
+      return true;
+    }
+    if ((uint8_t)c < 0x20) return false;
+    if (c == '\\') {
+      if (++p >= end) return false;
+      if (*p == 'u') {
+        if (end - p < 5) return false;
+        for (int i = 1; i <= 4; i++) if (hexValue(p[i]) < 0) return false;
+        p += 4;
+      } else if (!strchr("\"\\/bfnrt", *p)) {
+        return false;
+      }
+    }
+    p++;
+  }
+  return false;
+}
+
+bool JsonReader::skipValue() {
+  uint8_t base = level;
+  JsonToken t = next();
+  if (t == JsonToken::OBJECT_BEGIN || t == JsonToken::ARRAY_BEGIN) {
+    while (level > base) {
+      t = next();
+      if (t == JsonToken::ERROR || t == JsonToken::END) return false;
+    }
+    return true;
+  }
+  return t != JsonToken::ERROR && t != JsonToken::END && t != JsonToken::KEY &&
+         t != JsonToken::OBJECT_END && t != JsonToken::ARRAY_END;
+}
+
+// ==================== NILAI ====================
+
+bool JsonReader::number(double& out) const {
+  // Satu-satunya salinan: strtod butuh string ber-'\0'
+  char buf[32];
+  if (last != JsonToken::NUMBER || tokLen >= sizeof(buf)) return false;
+  memcpy(buf, tokStart, tokLen);
+  buf[tokLen] = '\0';
+  char* endPtr;
+  out = strtod(buf, &endPtr);
+  return endPtr == buf + tokLen;
+}
+
+bool JsonReader::copyString(char* out, size_t cap) const {
+  if ((last != JsonToken::KEY && last != JsonToken::STRING) || cap == 0) return false;
+  size_t n = 0;
+  for (size_t i = 0; i < tokLen; i++) {
+    char c = tokStart[i];
+    if (c == '\\') {
+      char e = tokStart[++i];
+      switch (e) {
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': {
+          int v = 0;
+          for (int k = 1; k <= 4; k++) v = v * 16 + hexValue(tokStart[i + k]);
+          if (v == 0 || v >= 0x80) return false;
+          c = (char)v;
+          i += 4;
+          break;
+        }
+        default: c = e; break;   // \" \\ \/
+      }
+    }
+    if (n + 1 >= cap) return false;
+    out[n++] = c;
+  }
+  out[n] = '\0';
+  return true;
+}
@@ -0,0 +1,176 @@
+#include "lcd-framebuffer.h"
+#include <string.h>
+
+// ==================== FONT ANGKA BESAR ====================
+// Gaya 7-segmen: garis horizontal di kolom tengah, garis vertikal di sisi
+// dalam kolom kiri/kanan sehingga antar digit ada celah.
+
+namespace {
+
+constexpr uint8_t TOP    = LcdBigDigits::FIRST_SLOT + 0;
+constexpr uint8_t MID    = LcdBigDigits::FIRST_SLOT + 1;
+constexpr uint8_t BOTTOM = LcdBigDigits::FIRST_SLOT + 2;
+constexpr uint8_t LEFT   = LcdBigDigits::FIRST_SLOT + 3;
+constexpr uint8_t RIGHT  = LcdBigDigits::FIRST_SLOT + 4;
+constexpr uint8_t BLANK  = ' ';
+
+const uint8_t GLYPH_ROWS[LcdBigDigits::SLOT_COUNT][8] = {
+  { 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // TOP
+  { 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x00, 0x00, 0x00 },  // MID
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F },  // BOTTOM
+  { 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03 },  // LEFT (vertikal kiri, rapat ke tengah)
+  { 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 },  // RIGHT
+};
+
+// Per digit: 3 baris x 3 kolom
+const uint8_t DIGITS[10][9] = {
+  { LEFT,  TOP,   RIGHT,  LEFT,  BLANK, RIGHT,  LEFT,  BOTTOM, RIGHT },  // 0
+  { BLANK, BLANK, RIGHT,  BLANK, BLANK, RIGHT,  BLANK, BLANK,  RIGHT },  // 1
+  { BLANK, TOP,   RIGHT,  BLANK, MID,   BLANK,  LEFT,  BOTTOM, BLANK },  // 2
+  { BLANK, TOP,   RIGHT,  BLANK, MID,   RIGHT,  BLANK, BOTTOM, RIGHT },  // 3
+  { LEFT,  BLANK, RIGHT,  BLANK, MID,   RIGHT,  BLANK, BLANK,  RIGHT },  // 4
+  { LEFT,  TOP,   BLANK,  BLANK, MID,   BLANK,  BLANK, BOTTOM, RIGHT },  // 5
+  { LEFT,  TOP,   BLANK,  LEFT,  MID,   BLANK,  LEFT,  BOTTOM, RIGHT },  // 6
+  { BLANK, TOP,   RIGHT,  BLANK, BLANK, RIGHT,  BLANK, BLANK,  RIGHT },  // 7
+  { LEFT,  TOP,   RIGHT,  LEFT,  MID,   RIGHT,  LEFT,  BOTTOM, RIGHT },  // 8
+  { LEFT,  TOP,   RIGHT,  BLANK, MID,   RIGHT,  BLANK, BOTTOM, RIGHT },  // 9
+};
+const uint8_t MINUS[9] = { BLANK, BLANK, BLANK, BLANK, MID, BLANK, BLANK, BLANK, BLANK };
+const uint8_t SPACE[9] = { BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK };
+
+// Urutan DDRAM: 0x00 baris 0, 0x14 baris 2, 0x40 baris 1, 0x54 baris 3.
+// Setelah kolom terakhir satu baris, kursor HD44780 lanjut ke baris berikut
+// di urutan ini tanpa setCursor.
+const uint8_t ROW_ORDER[LcdFramebuffer::ROWS] = { 0, 2, 1, 3 };
+constexpr int16_t CELL_COUNT = LcdFramebuffer::COLS * LcdFramebuffer::ROWS;
+
+}
+
+void lcdLoadBigDigits(LcdSink& sink) {
+  for (uint8_t i = 0; i < LcdBigDigits::SLOT_COUNT; i++) {
+    sink.createChar(LcdBigDigits::FIRST_SLOT + i, GLYPH_ROWS[i]);
+  }
+  sink.commit();
+}
+
+// ==================== FRAMEBUFFER ====================
+
+LcdFramebuffer::LcdFramebuffer() {
+  memset(shadow, ' ', sizeof(shadow));
+  invalidate();
+}
+
+void LcdFramebuffer::clear() {
+  memset(shadow, ' ', sizeof(shadow));
+}
+
+void LcdFramebuffer::clearRow(uint8_t row) {
+  if (row < ROWS) memset(shadow[row], ' ', COLS);
+}
+
+void LcdFramebuffer::put(uint8_t col, uint8_t row, uint8_t ch) {
+  if (col < COLS && row < ROWS) shadow[row][col] = ch;
+}
+
+uint8_t LcdFramebuffer::print(uint8_t col, uint8_t row, const char* text) {
+  if (row >= ROWS) return col;
+  while (*text && col < COLS) shadow[row][col++] = (uint8_t)*text++;
+  return col;
+}
+
+void LcdFramebuffer::printPadded(uint8_t col, uint8_t row, const char* text, uint8_t width) {
+  uint8_t end = col + width;
+  uint8_t next = print(col, row, text);
+  while (next < end && next < COLS) put(next++, row, ' ');
+}
+
+uint8_t LcdFramebuffer::bigNumber(uint8_t col, uint8_t row, const char* text) {
+  uint8_t start = col;
+  for (; *text; text++) {
+    if (*text == '.') {
+      put(col, row, ' ');
+      put(col, row + 1, ' ');
+      put(col, row + 2, '.');
+      col += 1;
+      continue;
+    }
+    const uint8_t* glyph = SPACE;
+    if (*text >= '0' && *text <= '9') glyph = DIGITS[*text - '0'];
+    else if (*text == '-') glyph = MINUS;
+    for (uint8_t r = 0; r < LcdBigDigits::HEIGHT; r++) {
+      for (uint8_t c = 0; c < LcdBigDigits::WIDTH; c++) {
+        put(col + c, row + r, glyph[r * LcdBigDigits::WIDTH + c]);
+      }
+    }
+    col += LcdBigDigits::WIDTH;
+  }
+  return col - start;
+}
+
+bool LcdFramebuffer::dirty() const {
+  for (uint8_t r = 0; r < ROWS; r++) {
+    for (uint8_t c = 0; c < COLS; c++) {
+      if (shown[r][c] != shadow[r][c]) return true;
+    }
+  }
+  return false;
+}
+
+void LcdFramebuffer::markCleared() {
+  for (uint8_t r = 0; r < ROWS; r++) {
+    for (uint8_t c = 0; c < COLS; c++) shown[r][c] = ' ';
+  }
+  cursor = -1;
+}
+
+void LcdFramebuffer::invalidate() {
+  for (uint8_t r = 0; r < ROWS; r++) {
+    for (uint8_t c = 0; c < COLS; c++) shown[r][c] = UNKNOWN;
+  }
+  cursor = -1;
+}
+
+size_t LcdFramebuffer::flush(LcdSink& sink, size_t maxBytes) {
+  size_t sent = 0;
+  size_t room = sink.room();
+  if (room < maxBytes) maxBytes = room;
+  uint8_t run[COLS];
+  uint8_t runLen = 0;
+
+  // Run = sel berubah yang bersebelahan di satu baris, dikirim sekali write().
+  // Sel tak berubah di antaranya dilewati dengan setCursor (1 byte), yang
+  // tidak pernah lebih mahal daripada menulis ulang sel tersebut.
+  auto emit = [&]() {
+    if (runLen == 0) return;
+    sink.write(run, runLen);
+    runLen = 0;
+  };
+
+  for (int16_t k = 0; k < CELL_COUNT; k++) {
+    uint8_t row = ROW_ORDER[k / COLS];
+    uint8_t col = k % COLS;
+    uint8_t ch = shadow[row][col];
+    if (shown[row][col] == ch) continue;
+
+    size_t cost = (cursor == k) ? 1 : 2;
+    if (sent + cost > maxBytes) break;
+
+    if (cursor != k || col == 0) emit();
+    if (cursor != k) {
+      sink.setCursor(col, row);
+      counters.cursorMoves++;
+    }
+    run[runLen++] = ch;
+    shown[row][col] = ch;
+    cursor = (k + 1) % CELL_COUNT;
+    sent += cost;
+  }
+  emit();
+
+  if (sent > 0) {
+    sink.commit();
+    counters.flushes++;
+    counters.bytes += sent;
+  }
+  return sent;
+}
@@ -0,0 +1,33 @@
+#include "load-detector.h"
+
+bool LoadDetector::update(float weightKg, unsigned long now) {
+  if (weightKg < config.emptyKg) {
+    state = State::EMPTY;
+    return false;
+  }
+
+  switch (state) {
+    case State::EMPTY:
+      if (weightKg < config.minLoadKg) return false;
+      state = State::SETTLING;
+      settleRef = weightKg; settleStart = now;
+      return false;
+
+    case State::SETTLING: {
+      float diff = weightKg - settleRef;
+      if (diff < 0) diff = -diff;
+      if (diff > config.settleBandKg) {
+        // Masih naik/bergoyang: mulai ulang jendela stabil dari nilai ini
+        settleRef = weightKg; settleStart = now;
+        return false;
+      }
+      if (now - settleStart < config.settleMs) return false;
+      state = State::SETTLED;
+      return true;
+    }
+
+    case State::SETTLED:
+    default:
+      return false;
+  }
+}
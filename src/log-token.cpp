@@ -0,0 +1,176 @@
+#include "log-token.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int base64Value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 64 && p < end; shift += 7) {
+    uint8_t b = *p++;
+    v |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+}
+
+// ==================== ENCODER ====================
+
+void LogArgWriter::byte(uint8_t v) {
+  if (len < cap) buf[len++] = v;
+  else overflowed = true;
+}
+
+void LogArgWriter::varint(uint64_t v) {
+  while (v >= 0x80) { byte((uint8_t)v | 0x80); v >>= 7; }
+  byte((uint8_t)v);
+}
+
+void LogArgWriter::u32(uint32_t v) {
+  byte(v); byte(v >> 8); byte(v >> 16); byte(v >> 24);
+}
+
+void LogArgWriter::arg(double v) {
+  float f = (float)v;
+  uint32_t bits;
+  memcpy(&bits, &f, 4);
+  u32(bits);
+}
+
+void LogArgWriter::arg(const char* s) {
+  size_t n = s ? strnlen(s, LogToken::STRING_MAX) : 0;
+  byte((uint8_t)n);
+  for (size_t i = 0; i < n; i++) byte((uint8_t)s[i]);
+}
+
+// ==================== DECODER ====================
+
+bool logFrameDecode(const uint8_t* in, size_t len, LogFrame& frame) {
+  const uint8_t* p = in;
+  const uint8_t* end = in + len;
+  if (p >= end) return false;
+  frame.level = *p >> 4;
+  frame.module = *p & 0x0F;
+  p++;
+  uint64_t t;
+  if (!readVarint(p, end, t) || end - p < 4) return false;
+  frame.timeMs = (uint32_t)t;
+  frame.token = p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+  p += 4;
+  frame.args = p;
+  frame.argsLen = end - p;
+  return true;
+}
+
+size_t logFormatArgs(char* out, size_t cap, const char* fmt, const uint8_t* args, size_t argsLen) {
+  const uint8_t* p = args;
+  const uint8_t* end = args + argsLen;
+  size_t n = 0;
+  auto append = [&](const char* s, size_t len) {
+    for (size_t i = 0; i < len && n + 1 < cap; i++) out[n++] = s[i];
+  };
+
+  while (*fmt) {
+    if (*fmt != '%') { append(fmt++, 1); continue; }
+    if (fmt[1] == '%') { append("%", 1); fmt += 2; continue; }
+
+    // Salin spesifikasi tanpa modifier panjang, lalu tambah yang sesuai tipe
+    char spec[24];
+    size_t s = 0;
+    spec[s++] = *fmt++;
+    while (*fmt && strchr("-+ #0123456789.", *fmt) && s < sizeof(spec) - 4) spec[s++] = *fmt++;
+    while (*fmt && strchr("hljztL", *fmt)) fmt++;
+    char conv = *fmt ? *fmt++ : '\0';
+    char text[96];
+    int len = 0;
+
+    if (conv && strchr("diuxXoc", conv)) {
+      uint64_t raw;
+      if (!readVarint(p, end, raw)) { append("<?>", 3); continue; }
+      int64_t v = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+      if (conv == 'c') {
+        spec[s++] = 'c'; spec[s] = '\0';
+        len = snprintf(text, sizeof(text), spec, (int)v);
+      } else {
+        spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = conv; spec[s] = '\0';
+        if (conv == 'd' || conv == 'i') {
+          len = snprintf(text, sizeof(text), spec, (long long)v);
+        } else {
+          // int negatif yang dicetak %u/%x: tampil seperti int 32-bit di perangkat
+          uint64_t u = (v < 0 && v >= INT32_MIN) ? (uint32_t)v : (uint64_t)v;
+          len = snprintf(text, sizeof(text), spec, (unsigned long long)u);
+        }
+      }
+    } else if (conv && strchr("fFeEgG", conv)) {
+      if (end - p < 4) { append("<?>", 3); continue; }
+      uint32_t bits = p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+      p += 4;
+      float f;
+      memcpy(&f, &bits, 4);
+      spec[s++] = conv; spec[s] = '\0';
+      len = snprintf(text, sizeof(text), spec, (double)f);
+    } else if (conv == 's') {
+      if (p >= end || (size_t)(end - p) < 1u + *p) { append("<?>", 3); continue; }
+      char str[LogToken::STRING_MAX + 1];
+      size_t sl = *p++;
+      memcpy(str, p, sl);
+      str[sl] = '\0';
+      p += sl;
+      spec[s++] = 's'; spec[s] = '\0';
+      len = snprintf(text, sizeof(text), spec, str);
+    } else {
+      append("<?>", 3);
+      continue;
+    }
+    if (len > 0) append(text, (size_t)len < sizeof(text) ? len : sizeof(text) - 1);
+  }
+  if (cap) out[n] = '\0';
+  return n;
+}
+
+// ==================== BASE64 ====================
+
+size_t base64Encode(const uint8_t* in, size_t len, char* out) {
+  size_t n = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16;
+    if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+    if (i + 2 < len) v |= in[i + 2];
+    out[n++] = BASE64[(v >> 18) & 0x3F];
+    out[n++] = BASE64[(v >> 12) & 0x3F];
+    // Tanpa padding '=': panjang frame sudah diketahui dari akhir baris
+    if (i + 1 < len) out[n++] = BASE64[(v >> 6) & 0x3F];
+    if (i + 2 < len) out[n++] = BASE64[v & 0x3F];
+  }
+  return n;
+}
+
+size_t base64Decode(const char* in, size_t len, uint8_t* out, size_t cap) {
+  size_t n = 0;
+  uint32_t acc = 0;
+  int bits = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (in[i] == '=') break;
+    int v = base64Value(in[i]);
+    if (v < 0) return 0;
+    acc = (acc << 6) | v;
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      if (n >= cap) return 0;
+      out[n++] = (uint8_t)(acc >> bits);
+    }
+  }
+  return n;
+}
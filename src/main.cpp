@@ -1,25 +1,112 @@
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <PubSubClient.h> 
-#include <ezButton.h>
 #include <HX711_ADC.h>
 #include <EEPROM.h>
 #include <ESP32Ping.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <esp_sntp.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "credentials.h" 
+#include "wifi-roaming.h"
+#include "mqtt-async.h"
+#include "record-outbox.h"
+#include "time-service.h"
+#include "http-lite.h"
+#include "load-detector.h"
+#include "tls-pool.h"
+#include "rtt-estimator.h"
+#include "upload-scheduler.h"
+#include "radio-quiet.h"
+#include "ws-server.h"
+#include "live-view-page.h"
+#include "lcd-framebuffer.h"
+#include "pcf8574-lcd.h"
+#include "button-events.h"
+#include "job-scheduler.h"
+#include "protothread.h"
+#include "async-log.h"
+#include "remote-config.h"
+#include "device-profiles.h"
+#include "upload-backend.h"
+#ifdef ECOSCALE_BACKEND_FIREBASE
+#include "firebase-backend.h"
+#endif
+#ifdef ECOSCALE_COAP
+#include "coap-lite.h"
+#endif
+#ifdef ECOSCALE_ESPNOW
+#include "espnow-link.h"
+#endif
 
-// --- Include library LCDBigNumbers ---
-#define USE_SERIAL_2004_LCD
-#include "LCDBigNumbers.hpp"
+#include <Wire.h>
+#include <stdarg.h>
+
+// ==================== PROFIL PERANGKAT ====================
+// Fakultas + faktor kalibrasi dari faktor-kalibrasi.txt, satu env PlatformIO
+// per profil (tools/gen-profiles.py). Build tanpa profil (Arduino IDE) = FEB.
+#ifndef ECOSCALE_PROFILE
+#define ECOSCALE_PROFILE "FEB"
+#endif
+constexpr size_t PROFILE_INDEX = DeviceProfiles::find(ECOSCALE_PROFILE);
+static_assert(PROFILE_INDEX < DeviceProfiles::COUNT, "ECOSCALE_PROFILE tidak ada di faktor-kalibrasi.txt");
+constexpr DeviceProfile PROFILE = DeviceProfiles::TABLE[PROFILE_INDEX];
+
+#if defined(ECOSCALE_BACKEND_FIREBASE) && (defined(ECOSCALE_COAP) || defined(ECOSCALE_ESPNOW))
+#error "Backend firebase tidak bisa digabung dengan -DECOSCALE_COAP / -DECOSCALE_ESPNOW"
+#endif
+
+// Jalur HTTPS Laravel (klien TLS keep-alive + hedge, pre-warm, metrics RTT)
+// hanya ada di backend laravel. CoAP tidak memakai TLS sama sekali; Firebase
+// membawa klien TLS library sendiri, jadi hanya butuh pool mbedTLS.
+#if defined(ECOSCALE_BACKEND_FIREBASE)
+#define ECOSCALE_HTTPS_UPLOAD 0
+#define ECOSCALE_TLS_POOL 1
+#elif defined(ECOSCALE_COAP)
+#define ECOSCALE_HTTPS_UPLOAD 0
+#define ECOSCALE_TLS_POOL 0
+#else
+#define ECOSCALE_HTTPS_UPLOAD 1
+#define ECOSCALE_TLS_POOL 1
+#endif
+#if ECOSCALE_HTTPS_UPLOAD
+#include <WiFiClientSecure.h>
+#endif
 
 // ==================== KONFIGURASI SISTEM ====================
 namespace Config {
   constexpr unsigned long WEIGHT_READ_INTERVAL    = 50;
   constexpr unsigned long LCD_UPDATE_INTERVAL     = 100;
+  constexpr size_t LCD_FLUSH_BUDGET = 24;                  // byte LCD per loop (~2 ms bus jika sinkron)
+  constexpr uint32_t LCD_I2C_CLOCK = 400000;
+  constexpr bool LCD_ASYNC = true;                         // kirim ke LCD dari task, loop() tidak menunggu bus
   constexpr unsigned long WIFI_CHECK_INTERVAL     = 15000;
   constexpr unsigned long STATUS_MSG_DURATION     = 2000; 
-  constexpr unsigned long CALIBRATION_VALUE       = 12.00000000000001;
+  constexpr unsigned long STABILIZING_TIME        = 2000;  // HX711 dibiarkan stabil sebelum tare
+  constexpr unsigned long TARE_TIMEOUT            = 5000;
+  constexpr unsigned long WIFI_CONNECT_TIMEOUT    = 10000;
+  constexpr float CALIBRATION_VALUE = PROFILE.calibration;
   constexpr float MIN_WEIGHT_THRESHOLD = 0.01f;
+  constexpr unsigned long HX711_CONVERSION_MS     = 100;   // 10 SPS (pin RATE ke GND)
+  constexpr unsigned long LATCH_QUIET_MS          = 400;   // batas jendela senyap saat kunci berat
+  constexpr uint8_t LATCH_SAMPLES = 2;
+  constexpr bool PREWARM_UPLOAD = true;                  // default; bisa dimatikan lewat config (prewarm_upload)
+  constexpr unsigned long WARM_IDLE_TIMEOUT       = 20000; // koneksi hangat tak terpakai ditutup
+  constexpr unsigned long HEAP_SAMPLE_INTERVAL    = 250;
+  constexpr unsigned long HEAP_LOG_INTERVAL       = 60000;
+  constexpr unsigned long METRICS_INTERVAL        = 60000;
+  constexpr unsigned long DRAIN_BURST_MS          = 1500;  // batas loop tertahan oleh satu burst
+  constexpr unsigned long INTERACTIVE_WAIT_MS     = 3000;  // layar "Mengirim..." backend async; sisanya di background
+  constexpr unsigned long WEIGHT_PUBLISH_INTERVAL = 1000;  // berat live (retained) maks 1x per detik
+  constexpr unsigned long STATE_CHECK_INTERVAL    = 250;
+  constexpr unsigned long STATE_REFRESH_INTERVAL  = 300000; // state retained dikirim ulang walau tidak berubah
+  constexpr unsigned long STATUS_ROW_INTERVAL     = 1000;  // RSSI + indikator MQTT di baris 3
+  constexpr unsigned long PING_CHECK_INTERVAL     = 10000;
+  constexpr uint16_t LIVE_VIEW_PORT = 80;                  // dashboard lokal http://<ip>/
+  constexpr unsigned long RELAY_WIFI_RETRY_INTERVAL = 120000; // saat ter-link ESP-NOW, scan WiFi mengganggu channel
+  constexpr unsigned long BROKER_PROBATION_MS     = 120000; // broker baru dari config harus tersambung sebelum disimpan
 
   constexpr int PIN_TOMBOL_1 = 27;
   constexpr int PIN_TOMBOL_2 = 26;
@@ -34,359 +121,1466 @@ namespace Config {
 // URL Laravel
 const char* serverName = "https://ecoscale.undip.us/api/receive-sampah"; 
 
-// Konfigurasi MQTT
+constexpr unsigned long HTTP_TIMEOUT = 15000;     // batas atas; timeout aktual dari RttEstimator
+constexpr uint32_t HEDGE_MIN_SAMPLES = 8;         // p95 belum bermakna sebelum ini
+constexpr size_t HEDGE_MIN_FREE_HEAP = 60000;     // sesi TLS kedua jatuh ke heap (pool hanya 1 sesi)
+constexpr size_t HTTP_MAX_RESPONSE_BYTES = 4096; // lebih dari ini koneksi ditutup, tidak dikuras
+
+// Kode error transport (negatif, kode HTTP selalu positif)
+constexpr int HTTP_ERR_CONNECT = -1;
+constexpr int HTTP_ERR_SEND    = -2;
+constexpr int HTTP_ERR_CLOSED  = -3;
+constexpr int HTTP_ERR_TIMEOUT = -4;
+constexpr int HTTP_ERR_PARSE   = -5;
+
+// Konfigurasi MQTT (server, port, topik = default; bisa diganti lewat topik config)
 const char* mqtt_server = "broker.hivemq.com";
 const int mqtt_port = 1883;
 const char* mqtt_topic = "undip/scale/new";
+const char* mqtt_time_topic = "undip/time"; // epoch ms dari server, tidak retained
+const char* mqtt_metrics_topic = "undip/scale/metrics";
+// Topik per perangkat: undip/<fakultas>/<deviceId>/{status,state,weight},
+// semuanya retained sehingga dashboard langsung dapat kondisi terakhir.
+// status = "online"/"offline" (LWT dari broker saat koneksi putus tanpa pamit).
+char mqtt_status_topic[64];
+char mqtt_state_topic[64];
+char mqtt_weight_topic[64];
+// Dokumen konfigurasi (retained, dari backend) dan ack hasil penerapannya
+char mqtt_config_topic[64];
+char mqtt_config_ack_topic[72];
+constexpr uint8_t MQTT_INFLIGHT_WINDOW = 4;
+
+#ifdef ECOSCALE_COAP
+// Transport CoAP (build flag -DECOSCALE_COAP). COAP_SERVER dan COAP_PSK
+// didefinisikan di credentials.h; PSK yang sama dipasang di coap-receiver.
+const char* coap_path = "ingest";
+#endif
 
 // ==================== GLOBAL OBJECTS ====================
-LiquidCrystal_I2C lcd(0x27, LCD_COLUMNS, LCD_ROWS);
-LCDBigNumbers bigNumbers(&lcd, BIG_NUMBERS_FONT_2_COLUMN_3_ROWS_VARIANT_2);
+WireI2cBus lcdBus(Wire);
+Pcf8574Lcd lcd(lcdBus, 0x27);
+LcdFramebuffer screen;   // semua tampilan lewat shadow ini, LCD hanya menerima sel yang berubah
 HX711_ADC LoadCell(Config::HX711_DOUT, Config::HX711_SCK);
 
-ezButton tombol[] = {
-    ezButton(Config::PIN_TOMBOL_1), 
-    ezButton(Config::PIN_TOMBOL_2), 
-    ezButton(Config::PIN_TOMBOL_3), 
-    ezButton(Config::PIN_TOMBOL_4)
-};
+// Tombol 1-3 = Organik / Anorganik / Residu, tombol 4 = Kirim
+const int PIN_TOMBOL[] = { Config::PIN_TOMBOL_1, Config::PIN_TOMBOL_2, Config::PIN_TOMBOL_3, Config::PIN_TOMBOL_4 };
+constexpr uint8_t TOMBOL_KIRIM = 3;
+ButtonEvents buttons;
 
 // Network Objects
-WiFiClient wifiClient;            
-PubSubClient mqttClient(wifiClient); 
+LwipTcpTransport mqttTransport;
+MqttAsyncClient mqttClient(mqttTransport);
+WifiStaRadio staRadio;
+WifiRoaming wifiRoaming(staRadio);
+
+// Submission identity & retry
+NvsCounterStorage seqStorage("seq_hi");
+SequenceCounter seqCounter(seqStorage);
+RecordOutbox outbox;
+UploadScheduler uploadScheduler;
+TimeService timeService;
+
+#if ECOSCALE_HTTPS_UPLOAD
+// Upload Laravel: satu koneksi TLS keep-alive + codec HTTP tanpa heap
+WiFiClientSecure uploadClient;
+HttpEndpoint laravelEndpoint;
+HttpRequestWriter laravelRequest;
+HttpResponseParser laravelResponse;
+
+// Timeout adaptif: waktu respon (tulis request -> response) dan waktu
+// connect (TCP + TLS) diukur terpisah. Hedge = request yang sama dikirim di
+// koneksi baru saat respon lebih lambat dari p95; aman karena idempoten.
+RttEstimator uploadRtt;
+RttEstimator connectRtt(RttPolicy{3000, 15000, 10000, 256}); // handshake TLS butuh ruang lebih
+WiFiClientSecure hedgeClient;
+HttpResponseParser hedgeResponse;
+uint32_t hedgeCount = 0, hedgeWins = 0;
+uint32_t httpTxBytes = 0, httpRxBytes = 0; // lapisan aplikasi, tanpa overhead TLS
+#endif
+
+#ifdef ECOSCALE_ESPNOW
+// Relay ESP-NOW (build flag -DECOSCALE_ESPNOW, ESPNOW_PSK di credentials.h).
+// Peran mengikuti konektivitas: online = gateway untuk timbangan lain,
+// offline = node yang mengirim isi outbox ke gateway terdekat.
+Esp32EspNowRadio espNowRadio;
+EspNowNode espNowNode(espNowRadio);
+EspNowGateway espNowGateway(espNowRadio);
+#endif
+
+// Live view lokal: setiap sampel berat di-push ke browser via WebSocket
+LwipWsListener liveListener;
+WsServer liveView(liveListener);
+uint32_t liveSeq = 0;
+
+#ifdef ECOSCALE_COAP
+WiFiUdpTransport coapTransport;
+CoapUploader coapUploader(coapTransport);
+RttEstimator coapRtt;
+
+// Satu transfer CoAP berjalan di background (CoapBackend::service tiap
+// loop); outbox dan relay ESP-NOW bergantian memakai uploader yang sama,
+// pemiliknya mengambil hasil lewat takeCoapResult()
+enum class CoapOwner : uint8_t { NONE, OUTBOX, RELAY };
+struct CoapExchange {
+  CoapOwner owner;
+  uint32_t key;            // seq record pertama (outbox) untuk mengenali batch
+  size_t count;
+  unsigned long sentAt;
+  bool done;
+  SendResult result;
+};
+CoapExchange coapExchange = {};
+#endif
+
+// Pre-warming: koneksi dibuka di task terpisah saat beban stabil.
+// uploadMutex melindungi uploadClient dari akses bersamaan.
+LoadDetector loadDetector;
+RadioQuiet radioQuiet;
+CleanWeightFilter weightFilter;
+#if ECOSCALE_HTTPS_UPLOAD
+SemaphoreHandle_t uploadMutex = nullptr;
+volatile unsigned long lastUploadUse = 0;
+#endif
+volatile bool prewarmRunning = false;
+volatile bool connectionWarm = false;
+
+struct LatencyStats { uint32_t count; uint32_t totalMs; uint32_t maxMs; };
+LatencyStats latencyWarm = {}, latencyCold = {};
+
+// Kesehatan heap: minimum free & blok terbesar terendah sejak boot
+struct HeapWatermark { size_t minFree; size_t minLargestBlock; };
+HeapWatermark heapWatermark = { SIZE_MAX, SIZE_MAX };
+uint32_t metricsDropped = 0;   // payload metrics yang tidak muat buffer
 
 // ==================== GLOBAL VARIABLES ====================
-enum class AppState { IDLE, SELECTING_SUBTYPE, SENDING_DATA, SHOWING_STATUS };
-AppState currentState = AppState::IDLE;
+enum class AppState { BOOTING, IDLE, SELECTING_SUBTYPE, SENDING_DATA, SHOWING_STATUS };
+AppState currentState = AppState::BOOTING;
 
-struct SampahType { char jenis[16]; char subJenis[16]; };
-SampahType sampah;
+WasteCategory selectedCategory = WasteCategory::NONE;
 
-char fakultas[8] = "FEB"; 
+char fakultas[8] = "";    // PROFILE.fakultas, bisa diganti lewat topik config
+char deviceId[24];  // ESP32Scale-<MAC>, tetap antar reboot (clientId MQTT)
 bool isOnline = false;
 bool offlineMode = false;
 
 float currentWeight = 0.0;
 float lastDisplayedWeight = -1.00;
-float weightBuffer[2] = {0.0f, 0.0f};
-int bufferIndex = 0;
 bool newDataReady = false;
+unsigned long lastConversionAt = 0;
+
+// Semua pekerjaan berkala lewat scheduler: jitter, durasi, dan overrun per
+// job dilaporkan di metrics. Budget = durasi wajar; lebih dari itu ditandai.
+JobScheduler scheduler([]() -> uint32_t { return micros(); });
+int8_t jobDeviceState = -1;
+int8_t jobStatusMessage = -1;
+
+// Urutan panjang (boot: tare + WiFi, kirim backend async) sebagai flow;
+// loop() tetap berputar
+PtRunner flows;
+struct PendingSend { uint32_t seq; unsigned long pressedAt; };
+PendingSend pendingSend = {};   // record tombol kirim yang ditunggu flow "kirim"
 
-// Timers
-unsigned long lastWeightReadTime = 0;
-unsigned long lastLCDUpdateTime = 0;
-unsigned long lastWifiCheckTime = 0;
-unsigned long statusMsgTimestamp = 0;
-
-// --- ASET IKON ---
-#define ICON_IDX_SIGNAL_1   0
-#define ICON_IDX_SIGNAL_2   1
-#define ICON_IDX_SIGNAL_3   2
-#define ICON_IDX_SIGNAL_4   3
-#define ICON_IDX_NO_INTERNET 4
-byte wifiSignal_1[] = { B00000, B00000, B00000, B00000, B00000, B00000, B11000, B11000 }; 
-byte wifiSignal_2[] = { B00000, B00000, B00000, B00000, B00011, B00011, B11011, B11011 }; 
-byte wifiSignal_3[] = { B00000, B00000, B11000, B11000, B11000, B11000, B11000, B11000 }; 
-byte wifiSignal_4[] = { B00011, B00011, B11011, B11011, B11011, B11011, B11011, B11011 }; 
+// Semua log lewat ring buffer + task prioritas rendah (async-log.h)
+AsyncLog logger([]() -> uint32_t { return millis(); });
+PrintLogSink serialLog(Serial);
+
+// Nilai tuning yang bisa diubah dari backend (remote-config.h); default =
+// konstanta di atas, cfg selalu menunjuk konfigurasi yang sedang aktif.
+// Dokumen wajib bertag HMAC dengan CONFIG_PSK dari credentials.h
+RuntimeConfig defaultRuntimeConfig();
+NvsConfigStore configStore("config");
+RemoteConfig remoteConfig(defaultRuntimeConfig(), configStore);
+const RuntimeConfig& cfg = remoteConfig.active();
+ConfigResult configResult;
+bool configResultPending = false;
+bool configCommitPending = false;   // broker baru tersambung: simpan di job config
+int8_t jobWeight = -1, jobLcd = -1, jobStatusRow = -1, jobPing = -1, jobWifi = -1, jobMetrics = -1;
+int8_t jobConfig = -1;
+int8_t jobBrokerProbation = -1;
+
+// --- ASET IKON --- (slot CGRAM 0..4 dipakai font angka besar)
+#define ICON_IDX_NO_INTERNET 5
 byte noInternetIcon[] = { B10100, B01000, B10100, B00000, B00000, B00000, B11000, B11000 }; 
 
 // ==================== FUNCTION DECLARATIONS ====================
-void prosesTombol();
-void handleKirimData();
-bool sendToLaravel(); // Kirim ke Server (Server handle waktu)
-bool sendToMQTT();    
+void handleButtonEvents();
+void prosesTombol(const ButtonEvent& ev);
+void handleKirimData(const ButtonEvent& ev);
+void showSendResult(SendResult result, bool queued);
+bool pendingSendSettled(SendResult& result);
+PtState sendFlow(Pt& pt, uint32_t now);
+#if ECOSCALE_HTTPS_UPLOAD
+SendResult sendToLaravel(const WeighingRecord& rec); // Kirim ke Server (Server handle waktu)
+SendResult postFormToLaravel(const char* fields, const char* idemKey);
+int postOverKeepAlive(const char* request, size_t len);
+int readHttpResponse(const char* request, size_t len);
+bool connectUpload(WiFiClientSecure& client, uint32_t timeoutMs);
+const char* httpErrorText(int code);
+void prewarmUploadConnection();
+void prewarmTask(void* param);
+void expireWarmConnection();
+#endif
+size_t formatRecordForm(char* dest, size_t destSize, const WeighingRecord& rec);
+size_t formatRecordFormAs(char* dest, size_t destSize, const WeighingRecord& rec,
+                          const char* fakultasName, const char* originId);
+#ifdef ECOSCALE_COAP
+SendResult sendViaCoap(WeighingRecord* const* recs, size_t count);
+bool startCoapExchange(CoapOwner owner, uint32_t key, const uint8_t* body, size_t len, size_t count);
+void serviceCoapExchange(unsigned long now);
+SendResult takeCoapResult(CoapOwner owner);
+#endif
+bool sendToMQTT(const WeighingRecord& rec);    
+void buildRecord(WeighingRecord& rec);
+void formatIdempotencyKey(char* dest, size_t destSize, uint32_t seq);
+void drainOutbox();
+uint64_t monoMillis();
+void startTimeSync();
+void serviceTimeSync();
+void learnTimeFromHttpDate(const char* dateHeader, uint64_t sentAt, uint64_t recvAt);
+size_t formatTimeFields(char* dest, size_t destSize, const WeighingRecord& rec);
+void initUploadPath();
+void publishMetrics();
+void appendf(char* buf, size_t cap, size_t& len, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+void recordPressToAck(unsigned long latencyMs, bool warm);
+void onMqttMessage(const char* topic, const uint8_t* payload, size_t len);
 float readSmoothedWeight();
+float latchWeightQuiet();
 
 void initializeSystem();
-bool connectWiFi();
+PtState bootFlow(Pt& pt, uint32_t now);
+void onFlowDone(const char* name, uint32_t elapsedMs, uint32_t maxLoopUs);
 void connectMQTT();   
+void initDeviceId();
+void initDeviceTopics();
+void onMqttConnected();
+void publishDeviceState();
+void publishLiveWeight();
+void startLiveView();
+void pushLiveSample();
+#ifdef ECOSCALE_ESPNOW
+void initEspNow();
+void serviceEspNow();
+void onEspNowFrame(const uint8_t mac[6], const uint8_t* data, size_t len);
+void onRelayResult(uint32_t seq, SendResult result);
+void feedRelayNode();
+void uploadRelayBatch();
+#endif
 bool checkNetworkHealth(); 
 void manageWifiConnection();
+bool isScaleIdle();
 
 void updateWeightDisplay(float weight);
 void restoreDefaultDisplay();
 void tampilkanSubJenisAnorganik();
 void updateStatusIndicators();
+void registerJobs();
+void readWeightJob();
+void refreshWeightDisplay();
+void checkInternetJob();
+void sampleHeap();
+void logHeap();
+void endStatusMessage();
+void showStatusMessage();
 void safeStringCopy(char* dest, const char* src, size_t destSize);
+void loadRemoteConfig();
+void applyRuntimeConfig(uint8_t effects);
+void applyConfigJob();
+void brokerProbationExpired();
+void commitRemoteConfig();
+void publishConfigAck(const ConfigResult& r);
+bool recordWallClock(uint64_t monoMs, char* iso, size_t cap);
+
+// ==================== BACKEND UPLOAD ====================
+// Policy dipilih saat kompilasi (upload-backend.h); fungsi backend lain
+// tidak direferensikan sehingga dibuang linker dari image
+#if ECOSCALE_HTTPS_UPLOAD
+struct LaravelBackend {
+  static const char* name() { return "laravel"; }
+  static constexpr uint8_t MAX_BATCH = 1;      // POST berurutan di koneksi keep-alive
+  static constexpr bool MQTT_RECORDS = true;
+  static constexpr bool PREWARM = true;
+  static constexpr bool ASYNC = false;
+  static void begin(const BackendContext& ctx) { initUploadPath(); }
+  static SendResult send(WeighingRecord* const* recs, size_t count) { return sendToLaravel(*recs[0]); }
+  static void service(unsigned long now) {}
+};
+#endif
+
+#ifdef ECOSCALE_COAP
+struct CoapBackend {
+  static const char* name() { return "coap"; }
+  static constexpr uint8_t MAX_BATCH = RecordOutbox::CAPACITY;   // satu transfer Block1
+  static constexpr bool MQTT_RECORDS = true;
+  static constexpr bool PREWARM = false;       // UDP, tidak ada handshake yang bisa dihemat
+  static constexpr bool ASYNC = true;          // retransmisi sampai ~22 s, loop tidak boleh tertahan
+  static void begin(const BackendContext& ctx) { initUploadPath(); }
+  static SendResult send(WeighingRecord* const* recs, size_t count) { return sendViaCoap(recs, count); }
+  static void service(unsigned long now) { serviceCoapExchange(now); }
+};
+#endif
+
+#if defined(ECOSCALE_BACKEND_FIREBASE)
+typedef FirebaseBackend Backend;
+#elif defined(ECOSCALE_COAP)
+typedef CoapBackend Backend;
+#else
+typedef LaravelBackend Backend;
+#endif
+typedef RecordUploader<Backend> Uploader;
 
 // ==================== SETUP ====================
 void setup() {
   Serial.begin(115200);
-  Serial.println("\nStarting Firmware (No NTP Version)...");
+  logger.startTask(serialLog);
+  LOG_I(SYS, "Starting Firmware %s (backend %s)...", PROFILE.fakultas, Backend::name());
+#if ECOSCALE_TLS_POOL
+  // Harus sebelum koneksi TLS pertama agar semua buffer mbedTLS dari pool
+  if (!installTlsMemoryPool()) LOG_W(SYS, "⚠️ TLS pool gagal dipasang, pakai heap");
+#endif
   
   esp_task_wdt_init(60, true); 
   esp_task_wdt_add(NULL);
 
   initializeSystem();
 
-  // Setup MQTT Server
-  mqttClient.setServer(mqtt_server, mqtt_port);
-
-  offlineMode = false; 
-  char statusMsg[16] = "Online Mode";
-
-  // --- LOGIKA SETUP BARU (TANPA NTP) ---
-  
-  // 1. Cek WiFi
-  if (!connectWiFi()) {
-    offlineMode = true;
-    safeStringCopy(statusMsg, "WiFi Gagal!", sizeof(statusMsg));
-  } else {
-    // Jika WiFi Connected, langsung coba MQTT (Indikator Internet)
-    // Tidak perlu cek syncTime() lagi
-    connectMQTT();
-    if (!mqttClient.connected()) {
-       Serial.println("Warning: MQTT Gagal, tapi lanjut HTTP...");
-    }
-  }
-
-  // --- SELESAI SETUP KONEKSI ---
-
-  lcd.clear();
-  if (offlineMode) {
-    lcd.setCursor(0, 1); lcd.print("Mode Offline");
-    lcd.setCursor(0, 2); lcd.print(statusMsg);
-    tone(Config::PIN_BUZZER, 500, 1000);
-    delay(2000); 
-  } else {
-    lcd.setCursor(0, 1); lcd.print("Setup Sukses");
-    lcd.setCursor(0, 2); lcd.print("System Ready");
-    delay(1000);
-  }
+  // Setup MQTT Server (sesi persisten, clientId tetap)
+  initDeviceId();
+  loadRemoteConfig();
+  initDeviceTopics();
+  seqCounter.begin();
+  BackendContext backendContext = { fakultas, deviceId, recordWallClock };
+  Backend::begin(backendContext);
+  mqttClient.setClientId(deviceId);
+  mqttClient.setCleanSession(false);
+  mqttClient.setInflightWindow(MQTT_INFLIGHT_WINDOW);
+  mqttClient.setWill(mqtt_status_topic, "offline", 1, true);
+  mqttClient.setCallback(onMqttMessage);
+  mqttClient.setConnectCallback(onMqttConnected);
+  mqttClient.subscribe(mqtt_time_topic, 0);
+  mqttClient.subscribe(mqtt_config_topic, 1);
 
-  lcd.clear();
-  restoreDefaultDisplay();
-  updateWeightDisplay(0.0);
-  lastWeightReadTime = millis();
-  lastLCDUpdateTime = millis();
+  // Stabilisasi + tare, WiFi, dan layar status jalan sebagai flow (dulu
+  // delay() di sini menahan boot ~15 s tanpa loop)
+  offlineMode = true;
+  flows.onDone(onFlowDone);
+  flows.start("boot", bootFlow, millis());
+  registerJobs();
 }
 
 // ==================== MAIN LOOP ====================
 void loop() {
   esp_task_wdt_reset();
+  flows.markLoop(micros());
   
-  // Input Handling
-  for (int i = 0; i < 4; i++) tombol[i].loop();
+  // Input Handling: tepi ditangkap interrupt, di sini hanya debounce -> event
+  buttons.update(micros());
   
   // Network Maintenance
-  manageWifiConnection();
+  serviceTimeSync();
+  if (!offlineMode) wifiRoaming.tick(millis(), isScaleIdle());
+  if (!offlineMode) Backend::service(millis());
   
   // MQTT Loop (Hanya jika tidak mode offline total)
-  if (!offlineMode) {
-      if (!mqttClient.connected()) {
-        static unsigned long lastMqttRetry = 0;
-        if (millis() - lastMqttRetry > 5000) {
-           connectMQTT();
-           lastMqttRetry = millis();
-        }
-      }
-      mqttClient.loop();
+  // Reconnect + backoff ditangani MqttAsyncClient, tidak pernah blocking
+  if (!offlineMode && radioQuiet.mayTransmit(millis())) {
+    mqttClient.loop(millis());
+    liveView.loop(millis());
   }
+#ifdef ECOSCALE_ESPNOW
+  if (currentState != AppState::BOOTING) serviceEspNow();  // radio aktif di akhir bootFlow
+#endif
+  flows.run(millis());
+  // Berat, LCD, status, WiFi, heap, metrics (lihat registerJobs)
+  scheduler.run();
 
   switch (currentState) {
+    case AppState::BOOTING: { break; }  // dikerjakan bootFlow
     case AppState::IDLE: {
-      unsigned long currentMillis = millis();
-      if (LoadCell.update()) newDataReady = true;
-      
-      if (newDataReady && currentMillis - lastWeightReadTime >= Config::WEIGHT_READ_INTERVAL) {
-        currentWeight = readSmoothedWeight();
-        lastWeightReadTime = currentMillis;
-        newDataReady = false;
-      }
-      
-      if (currentMillis - lastLCDUpdateTime >= Config::LCD_UPDATE_INTERVAL) {
-        if (abs(currentWeight - lastDisplayedWeight) > Config::MIN_WEIGHT_THRESHOLD || lastDisplayedWeight == -1.00) {
-          updateWeightDisplay(currentWeight);
-          lastDisplayedWeight = currentWeight;
-        }
-        lastLCDUpdateTime = currentMillis;
-      }
-      prosesTombol();
-      handleKirimData();
-      updateStatusIndicators();
+      if (LoadCell.update()) { newDataReady = true; lastConversionAt = millis(); }
+      handleButtonEvents();
+      drainOutbox();
+#if ECOSCALE_HTTPS_UPLOAD
+      expireWarmConnection();
+#endif
       break;
     }
-    case AppState::SELECTING_SUBTYPE: { prosesTombol(); break; }
+    case AppState::SELECTING_SUBTYPE: { handleButtonEvents(); break; }
     case AppState::SENDING_DATA: { break; }
-    case AppState::SHOWING_STATUS: {
-      if (millis() - statusMsgTimestamp > Config::STATUS_MSG_DURATION) {
-        restoreDefaultDisplay();
-        currentState = AppState::IDLE;
-      }
-      break;
-    }
+    case AppState::SHOWING_STATUS: { break; }  // selesai lewat job one-shot endStatusMessage
   }
+
+  // Hanya sel yang berubah; redraw besar tersebar di beberapa loop
+  screen.flush(lcd, Config::LCD_FLUSH_BUDGET);
 }
 
-// ==================== NETWORK FUNCTIONS ====================
+// ==================== JOBS ====================
 
-bool connectWiFi() {
-  WiFi.mode(WIFI_STA); 
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD); 
-  
-  lcd.clear(); lcd.setCursor(0, 1); lcd.print("Connecting WiFi...");
-  
-  int retry = 0;
-  // Timeout sekitar 10 detik
-  while (WiFi.status() != WL_CONNECTED && retry < 20) {
-    lcd.setCursor(retry % 20, 2); lcd.print("."); 
-    delay(500); retry++; esp_task_wdt_reset();
+void registerJobs() {
+  // Periode dari cfg: bisa diganti saat jalan lewat applyRuntimeConfig()
+  jobWeight = scheduler.every("weight", cfg.weightReadMs, readWeightJob, 3000);
+  jobLcd = scheduler.every("lcd", cfg.lcdUpdateMs, refreshWeightDisplay, 500);
+  jobStatusRow = scheduler.every("status", cfg.statusRowMs, updateStatusIndicators, 2000);
+  // Ping dan cek WiFi memang blocking (~1 s saat internet putus); budget
+  // menandai jika lebih lama dari itu
+  jobPing = scheduler.every("ping", cfg.pingCheckMs, checkInternetJob, 1200000);
+  jobWifi = scheduler.every("wifi", cfg.wifiCheckMs, manageWifiConnection, 1200000, cfg.wifiCheckMs);
+  scheduler.every("heap", Config::HEAP_SAMPLE_INTERVAL, sampleHeap, 500);
+  scheduler.every("heap-log", Config::HEAP_LOG_INTERVAL, logHeap, 5000, Config::HEAP_LOG_INTERVAL);
+  jobMetrics = scheduler.every("metrics", cfg.metricsMs, publishMetrics, 20000, cfg.metricsMs);
+  jobDeviceState = scheduler.every("state", Config::STATE_CHECK_INTERVAL, publishDeviceState, 5000);
+  jobStatusMessage = scheduler.oneShot("status-msg", endStatusMessage, 5000);
+  // Tulis NVS bisa puluhan ms: budget longgar
+  jobConfig = scheduler.oneShot("config", applyConfigJob, 50000);
+  jobBrokerProbation = scheduler.oneShot("broker-probation", brokerProbationExpired, 5000);
+}
+
+// Sampel baru dari HX711 (LoadCell.update() tetap dipoll tiap loop)
+void readWeightJob() {
+  if (currentState != AppState::IDLE || !newDataReady) return;
+  currentWeight = readSmoothedWeight();
+  newDataReady = false;
+#if ECOSCALE_HTTPS_UPLOAD
+  if (loadDetector.update(currentWeight, millis())) prewarmUploadConnection();
+#endif
+  publishLiveWeight();
+  pushLiveSample();
+}
+
+void refreshWeightDisplay() {
+  if (currentState != AppState::IDLE) return;
+  if (abs(currentWeight - lastDisplayedWeight) > cfg.minWeightKg || lastDisplayedWeight == -1.00) {
+    updateWeightDisplay(currentWeight);
+    lastDisplayedWeight = currentWeight;
+  }
+}
+
+// Pesan status di baris 0 tampil STATUS_MSG_DURATION lalu kembali ke tampilan utama
+void showStatusMessage() {
+  currentState = AppState::SHOWING_STATUS;
+  scheduler.arm(jobStatusMessage, Config::STATUS_MSG_DURATION);
+}
+
+void endStatusMessage() {
+  if (currentState != AppState::SHOWING_STATUS) return;
+  restoreDefaultDisplay();
+  currentState = AppState::IDLE;
+}
+
+// ==================== FLOWS ====================
+
+// Boot berurutan seperti dulu (tare sebelum radio aktif, lalu WiFi, lalu
+// layar status), tetapi setiap tunggu kembali ke loop(): tombol, LCD, dan
+// scheduler tetap dilayani.
+PtState bootFlow(Pt& pt, uint32_t now) {
+  static uint8_t dots;
+  static uint32_t splashMs;
+  PT_BEGIN(pt);
+
+  // 1. Stabilisasi + tare (pengganti LoadCell.start(2000, true))
+  screen.clear(); screen.print(0, 1, "Stabilisasi...");
+  PT_TIMER_START(pt, now);
+  PT_WAIT_UNTIL(pt, (LoadCell.update(), PT_ELAPSED(pt, now) >= Config::STABILIZING_TIME));
+  LoadCell.tareNoDelay();
+  PT_TIMER_START(pt, now);
+  PT_WAIT_UNTIL(pt, (LoadCell.update(), LoadCell.getTareStatus()) || PT_ELAPSED(pt, now) >= Config::TARE_TIMEOUT);
+  if (PT_ELAPSED(pt, now) >= Config::TARE_TIMEOUT) {
+    screen.clear(); screen.print(0, 0, "HX711 Error!");
+    PT_WAIT_UNTIL(pt, false);  // berhenti di sini; loop() tetap memberi makan WDT
   }
+  LoadCell.setCalFactor(Config::CALIBRATION_VALUE);
+  LoadCell.setSamplesInUse(1);
 
+  // 2. WiFi, timeout sekitar 10 detik
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  screen.clear(); screen.print(0, 1, "Connecting WiFi...");
+  for (dots = 0; dots < Config::WIFI_CONNECT_TIMEOUT / 500 && WiFi.status() != WL_CONNECTED; dots++) {
+    screen.put(dots % 20, 2, '.');
+    PT_SLEEP(pt, now, 500);
+  }
+
+  screen.clear();
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\n✅ WiFi Connected");
-    Serial.print("IP: "); Serial.println(WiFi.localIP());
-    return true;
+    IPAddress ip = WiFi.localIP();
+    LOG_I(NET, "✅ WiFi Connected, IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    offlineMode = false;
+    if (!installTxHook(radioQuiet)) LOG_W(NET, "⚠️ Hook TX gagal, sampel tidak ditandai");
+    startLiveView();
+    screen.print(0, 1, "Setup Sukses");
+    screen.print(0, 2, "System Ready");
+    splashMs = 1000;
+  } else {
+    screen.print(0, 1, "Mode Offline");
+    screen.print(0, 2, "WiFi Gagal!");
+    tone(Config::PIN_BUZZER, 500, 1000);
+    splashMs = 2000;
   }
-  return false;
+#ifdef ECOSCALE_ESPNOW
+  initEspNow();
+#endif
+  // SNTP jalan di background, tidak menunggu sync (record pakai waktu monoton)
+  startTimeSync();
+  // MQTT di background (tidak menunggu CONNACK)
+  if (!offlineMode) connectMQTT();
+
+  // 3. Layar status, lalu tampilan utama
+  PT_SLEEP(pt, now, splashMs);
+  restoreDefaultDisplay();
+  currentState = AppState::IDLE;
+  PT_END(pt);
+}
+
+void onFlowDone(const char* name, uint32_t elapsedMs, uint32_t maxLoopUs) {
+  LOG_I(SYS, "🧵 Flow %s selesai dalam %lu ms, periode loop maks %lu us",
+        name, (unsigned long)elapsedMs, (unsigned long)maxLoopUs);
 }
 
+// ==================== NETWORK FUNCTIONS ====================
+
 void connectMQTT() {
   if (mqttClient.connected()) return;
   
-  Serial.print("🔗 Connecting MQTT...");
-  String clientId = "ESP32Scale-" + String(random(0xffff), HEX);
-  
-  if (mqttClient.connect(clientId.c_str())) {
-    Serial.println("Success!");
+  // Hanya memulai koneksi; TCP + CONNACK diproses di mqttClient.loop()
+  LOG_I(MQTT, "🔗 Connecting MQTT as %s", deviceId);
+  mqttClient.setServer(cfg.mqttServer, cfg.mqttPort);
+}
+
+void initDeviceId() {
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  snprintf(deviceId, sizeof(deviceId), "ESP32Scale-%02X%02X%02X%02X%02X%02X",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+// Segmen fakultas di topik: huruf kecil, karakter wildcard/pemisah diganti '-'
+void initDeviceTopics() {
+  char fak[sizeof(fakultas)];
+  size_t i = 0;
+  for (; fakultas[i] && i < sizeof(fak) - 1; i++) {
+    char c = fakultas[i];
+    fak[i] = (c == '/' || c == '+' || c == '#' || c == ' ') ? '-' : tolower((unsigned char)c);
+  }
+  fak[i] = '\0';
+  snprintf(mqtt_status_topic, sizeof(mqtt_status_topic), "undip/%s/%s/status", fak, deviceId);
+  snprintf(mqtt_state_topic, sizeof(mqtt_state_topic), "undip/%s/%s/state", fak, deviceId);
+  snprintf(mqtt_weight_topic, sizeof(mqtt_weight_topic), "undip/%s/%s/weight", fak, deviceId);
+  snprintf(mqtt_config_topic, sizeof(mqtt_config_topic), "undip/%s/%s/config", fak, deviceId);
+  snprintf(mqtt_config_ack_topic, sizeof(mqtt_config_ack_topic), "undip/%s/%s/config/ack", fak, deviceId);
+}
+
+// --- PRESENCE & STATE RETAINED ---
+bool forceStatePublish = false;
+float lastPublishedWeight = -1.0f;
+uint32_t lastRecordSeq = 0;
+float lastRecordWeight = 0;
+
+// Setiap (re)connect: timpa LWT "offline" yang mungkin tertinggal di broker,
+// lalu kirim ulang state dan berat agar retained selalu terbaru
+void onMqttConnected() {
+  if (!mqttClient.publish(mqtt_status_topic, "online", 1, true)) mqttClient.publish(mqtt_status_topic, "online", 0, true);
+  forceStatePublish = true;
+  scheduler.trigger(jobDeviceState);
+  lastPublishedWeight = -1.0f;
+  LOG_I(MQTT, "🟢 MQTT online: %s", mqtt_status_topic);
+  // Broker dari config terbukti bisa dipakai: disimpan ke NVS oleh job
+  // config, bukan di dalam callback CONNACK
+  if (scheduler.armed(jobBrokerProbation)) {
+    scheduler.disarm(jobBrokerProbation);
+    configCommitPending = true;
+    scheduler.trigger(jobConfig);
+  }
+}
+
+const char* appStateName(AppState s) {
+  switch (s) {
+    case AppState::BOOTING:           return "booting";
+    case AppState::IDLE:              return "idle";
+    case AppState::SELECTING_SUBTYPE: return "selecting";
+    case AppState::SENDING_DATA:      return "sending";
+    case AppState::SHOWING_STATUS:    return "status";
+    default:                          return "unknown";
+  }
+}
+
+// State perangkat (retained, QoS 0): dikirim saat berubah, saat reconnect,
+// dan tiap STATE_REFRESH_INTERVAL sebagai penyegar jika satu publish hilang
+void publishDeviceState() {
+  static char lastPayload[224] = "";
+  static unsigned long lastPublish = 0;
+  if (offlineMode || !mqttClient.connected()) return;
+
+  char payload[224];
+  int n = snprintf(payload, sizeof(payload),
+                   "{\"device_id\":\"%s\",\"fakultas\":\"%s\",\"state\":\"%s\",\"jenis\":\"%s\","
+                   "\"queued\":%u,\"last_seq\":%lu,\"last_weight\":%.2f,\"link\":%u,\"config\":%lu}",
+                   deviceId, fakultas, appStateName(currentState),
+                   WasteCategories::name(WasteCategories::info(selectedCategory).group),
+                   (unsigned)outbox.size(), (unsigned long)lastRecordSeq, lastRecordWeight,
+                   (unsigned)uploadScheduler.quality(), (unsigned long)cfg.version);
+  if (n <= 0 || (size_t)n >= sizeof(payload)) return;
+
+  unsigned long now = millis();
+  bool changed = strcmp(payload, lastPayload) != 0;
+  if (!changed && !forceStatePublish && now - lastPublish < Config::STATE_REFRESH_INTERVAL) return;
+  if (mqttClient.publish(mqtt_state_topic, (const uint8_t*)payload, n, 0, true)) {
+    memcpy(lastPayload, payload, n + 1);
+    lastPublish = now;
+    forceStatePublish = false;
+  }
+}
+
+// Berat live (retained, QoS 0): hanya saat berubah melewati ambang, maks
+// 1x per cfg.weightPublishMs
+void publishLiveWeight() {
+  static unsigned long lastPublish = 0;
+  if (offlineMode || !mqttClient.connected()) return;
+  unsigned long now = millis();
+  if (now - lastPublish < cfg.weightPublishMs) return;
+  if (lastPublishedWeight >= 0 && fabsf(currentWeight - lastPublishedWeight) <= cfg.minWeightKg) return;
+
+  char payload[64];
+  int n = snprintf(payload, sizeof(payload), "{\"weight\":%.2f,\"stable\":%s}",
+                   currentWeight, loadDetector.settled() ? "true" : "false");
+  if (n > 0 && mqttClient.publish(mqtt_weight_topic, (const uint8_t*)payload, n, 0, true)) {
+    lastPublishedWeight = currentWeight;
+    lastPublish = now;
+  }
+}
+
+// --- LIVE VIEW LOKAL ---
+void startLiveView() {
+  liveView.setPage(LIVE_VIEW_PAGE, sizeof(LIVE_VIEW_PAGE) - 1);
+  if (liveListener.begin(Config::LIVE_VIEW_PORT)) {
+    IPAddress ip = WiFi.localIP();
+    LOG_I(NET, "🖥️ Live view: http://%u.%u.%u.%u/", ip[0], ip[1], ip[2], ip[3]);
   } else {
-    Serial.print("Failed, rc="); Serial.println(mqttClient.state());
+    LOG_W(NET, "⚠️ Live view gagal listen");
   }
 }
 
-// --- PENGIRIMAN KE LARAVEL (Tanpa Timestamp dari ESP) ---
-bool sendToLaravel() {
-  if (WiFi.status() != WL_CONNECTED) return false;
+// Frame 13 byte (format di live-view-page.h). Hanya diantrekan; klien yang
+// tertinggal kehilangan frame, loop tidak pernah menunggu browser.
+void pushLiveSample() {
+  if (liveView.clientCount() == 0) return;
+  uint8_t frame[13];
+  uint32_t seq = liveSeq++;
+  uint32_t at = millis();
+  float kg = currentWeight;
+  memcpy(frame, &seq, 4);       // ESP32 little-endian, sama dengan DataView(..., true)
+  memcpy(frame + 4, &at, 4);
+  memcpy(frame + 8, &kg, 4);
+  frame[12] = (loadDetector.settled() ? 0x01 : 0) | (loadDetector.loaded() ? 0x02 : 0);
+  liveView.broadcastBinary(frame, sizeof(frame));
+}
 
-  WiFiClientSecure clientSecure;
-  clientSecure.setInsecure(); // Wajib jika tidak pakai NTP/Cert validation
-  
-  HTTPClient http;
-  
-  Serial.println("\n--- 📦 LARAVEL POST ---");
-  
-  // Timeout 15 Detik
-  if (!http.begin(clientSecure, serverName)) {
-    Serial.println("❌ Gagal inisialisasi HTTP!");
-    return false;
+#ifdef ECOSCALE_ESPNOW
+// --- RELAY ESP-NOW ---
+void initEspNow() {
+  static const uint8_t* psk = (const uint8_t*)ESPNOW_PSK;
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  if (!espNowRadio.begin()) {
+    LOG_W(RELAY, "⚠️ ESP-NOW gagal diinisialisasi");
+    return;
   }
-  
-  http.setTimeout(15000); 
-  http.addHeader("Content-Type", "application/x-www-form-urlencoded");
-  http.addHeader("Connection", "close"); 
-
-  // Format Data
-  String jenisFinal;
-  if (strcmp(sampah.jenis, "Anorganik") == 0 && strcmp(sampah.subJenis, "--") != 0) {
-    if (strcmp(sampah.subJenis, "Umum") == 0) jenisFinal = "Anorganik";
-    else jenisFinal = String(sampah.subJenis);
+  espNowNode.setIdentity(mac);
+  espNowNode.setKey(psk, strlen(ESPNOW_PSK));
+  espNowNode.setResultCallback(onRelayResult);
+  espNowGateway.setIdentity(mac);
+  espNowGateway.setKey(psk, strlen(ESPNOW_PSK));
+}
+
+void onEspNowFrame(const uint8_t mac[6], const uint8_t* data, size_t len) {
+  if (offlineMode) espNowNode.onFrame(mac, data, len, millis());
+  else espNowGateway.onFrame(mac, data, len, millis());
+}
+
+void serviceEspNow() {
+  espNowRadio.poll(onEspNowFrame);
+  if (!radioQuiet.mayTransmit(millis())) return;
+  if (offlineMode) {
+    feedRelayNode();
+    espNowNode.loop(millis());
   } else {
-    jenisFinal = String(sampah.jenis);
+    uploadRelayBatch();
+  }
+}
+
+// Isi outbox masuk window node; tetap di outbox sampai gateway meneruskan ACK
+// backend, sehingga jika WiFi kembali duluan record dikirim langsung (idempoten)
+void feedRelayNode() {
+  for (size_t i = 0; i < outbox.size() && espNowNode.hasRoom(); i++) {
+    WeighingRecord& rec = outbox.at(i);
+    if (espNowNode.contains(rec.seq)) continue;
+    EspNowRecord relay = {};
+    relay.seq = rec.seq;
+    relay.weight = rec.weight;
+    safeStringCopy(relay.fakultas, fakultas, sizeof(relay.fakultas));
+    relay.category = rec.category;
+    uint32_t createdAt = millis() - (uint32_t)(monoMillis() - rec.monoMs);
+    espNowNode.submit(relay, createdAt, millis());
+  }
+}
+
+void onRelayResult(uint32_t seq, SendResult result) {
+  outbox.remove(seq);
+  LOG_I(RELAY, "%s seq=%lu", result == SendResult::ACKED ? "✅ Relay OK" : "⛔ Relay ditolak", (unsigned long)seq);
+}
+
+// Gateway: upload record titipan dengan identitas perangkat asalnya
+void uploadRelayBatch() {
+  static RelayedRecord batch[16];
+  static SendResult results[16];
+#ifdef ECOSCALE_COAP
+  // Batch sebelumnya masih di udara: selesaikan dulu sebelum mengambil yang baru
+  static size_t inFlight = 0;
+  if (inFlight) {
+    SendResult result = takeCoapResult(CoapOwner::RELAY);
+    if (result == SendResult::PENDING) return;
+    for (size_t i = 0; i < inFlight; i++) if (results[i] == SendResult::PENDING) results[i] = result;
+    espNowGateway.complete(batch, results, inFlight, millis());
+    inFlight = 0;
+    return;
+  }
+#endif
+  if (!isScaleIdle()) return;
+#ifdef ECOSCALE_COAP
+  const size_t maxBatch = 16;   // satu transfer Block1
+#else
+  const size_t maxBatch = 4;    // POST berurutan di koneksi keep-alive, loop tidak tertahan lama
+#endif
+  size_t count = espNowGateway.takeBatch(batch, maxBatch, millis());
+  if (count == 0) return;
+
+  static char fields[320];
+  char origin[24];
+#ifdef ECOSCALE_COAP
+  static uint8_t body[CoapUploader::BODY_MAX];
+  size_t len = 0, included = 0;
+#endif
+  for (size_t i = 0; i < count; i++) {
+    const RelayedRecord& r = batch[i];
+    snprintf(origin, sizeof(origin), "ESP32Scale-%02X%02X%02X%02X%02X%02X",
+             r.mac[0], r.mac[1], r.mac[2], r.mac[3], r.mac[4], r.mac[5]);
+    WeighingRecord rec = {};
+    rec.seq = r.rec.seq;
+    rec.weight = r.rec.weight;
+    uint64_t age = r.rec.ageMs + (uint32_t)(millis() - r.receivedAt);
+    rec.monoMs = age < monoMillis() ? monoMillis() - age : 0;  // lebih tua dari uptime gateway: umur terpotong
+    rec.category = r.rec.category;
+    size_t n = formatRecordFormAs(fields, sizeof(fields), rec, r.rec.fakultas, origin);
+    if (n && (size_t)snprintf(fields + n, sizeof(fields) - n, "&via=%s", deviceId) >= sizeof(fields) - n) n = 0;
+    results[i] = n ? SendResult::RETRY : SendResult::REJECTED;
+    if (n == 0) continue;
+#ifdef ECOSCALE_COAP
+    size_t lineLen = strlen(fields);
+    if (len + lineLen + 1 >= sizeof(body)) continue;  // tidak muat: batch berikutnya
+    if (len) body[len++] = '\n';
+    memcpy(body + len, fields, lineLen);
+    len += lineLen;
+    included |= (size_t)1 << i;
+#else
+    char idemKey[40];
+    snprintf(idemKey, sizeof(idemKey), "%s-%lu", origin, (unsigned long)r.rec.seq);
+    results[i] = postFormToLaravel(fields, idemKey);
+    if (results[i] == SendResult::RETRY) {
+      for (size_t k = i + 1; k < count; k++) results[k] = SendResult::RETRY;
+      break;
+    }
+    esp_task_wdt_reset();
+#endif
+  }
+#ifdef ECOSCALE_COAP
+  if (included) {
+    size_t recs = 0;
+    for (size_t i = 0; i < count; i++) if (included & ((size_t)1 << i)) recs++;
+    if (WiFi.status() == WL_CONNECTED && startCoapExchange(CoapOwner::RELAY, 0, body, len, recs)) {
+      for (size_t i = 0; i < count; i++) if (included & ((size_t)1 << i)) results[i] = SendResult::PENDING;
+      inFlight = count;
+      return;
+    }
+  }
+#endif
+  espNowGateway.complete(batch, results, count, millis());
+}
+#endif
+
+#if ECOSCALE_HTTPS_UPLOAD
+// --- PENGIRIMAN KE LARAVEL ---
+// Server wajib dedup berdasarkan idempotency key, sehingga RETRY selalu aman.
+SendResult sendToLaravel(const WeighingRecord& rec) {
+  char idemKey[40];
+  formatIdempotencyKey(idemKey, sizeof(idemKey), rec.seq);
+  char fields[320];
+  if (formatRecordForm(fields, sizeof(fields), rec) == 0) {
+    LOG_E(HTTP, "❌ Request terlalu besar!");
+    return SendResult::REJECTED;
   }
+  return postFormToLaravel(fields, idemKey);
+}
+
+// POST satu record (field form tanpa api_key) lewat koneksi keep-alive
+SendResult postFormToLaravel(const char* fields, const char* idemKey) {
+  if (WiFi.status() != WL_CONNECTED) return SendResult::RETRY;
 
-  // Payload hanya data timbangan. Server akan handle 'created_at' = NOW()
-  String postData = "api_key=" + String(API_KEY) +
-                    "&berat=" + String(currentWeight, 2) +
-                    "&fakultas=" + String(fakultas) +
-                    "&jenis=" + jenisFinal;
+  static char body[384];
+  int bodyLen = snprintf(body, sizeof(body), "api_key=%s&%s", API_KEY, fields);
+  if (bodyLen <= 0 || (size_t)bodyLen >= sizeof(body)) bodyLen = 0;
+
+  char extraHeaders[64];
+  snprintf(extraHeaders, sizeof(extraHeaders), "Idempotency-Key: %s\r\n", idemKey);
+  static char request[768];
+  size_t requestLen = bodyLen > 0
+                      ? laravelRequest.build(request, sizeof(request), extraHeaders, body, bodyLen) : 0;
+  if (requestLen == 0) {
+    LOG_E(HTTP, "❌ Request terlalu besar!");
+    return SendResult::REJECTED;
+  }
 
-  Serial.println("Data: " + postData);
+  // Body lengkap (tanpa api_key) hanya di build debug
+  LOG_I(HTTP, "📦 Laravel POST %s", idemKey);
+  LOG_D(HTTP, "Data: %s", fields);
   
-  int httpResponseCode = http.POST(postData);
-  bool success = false;
+  // Tunggu jika task pre-warm sedang membuka koneksi (handshake tidak diulang).
+  // Handshake-nya sendiri dibatasi connectRtt.rto(); lebih lama dari itu
+  // berarti macet, record kembali ke outbox daripada loop tertahan
+  if (xSemaphoreTake(uploadMutex, pdMS_TO_TICKS(connectRtt.rto())) != pdTRUE) {
+    LOG_W(HTTP, "⚠️ Koneksi upload masih dipakai pre-warm, dicoba lagi nanti");
+    return SendResult::RETRY;
+  }
+  uint64_t sentAt = monoMillis();
+  int httpResponseCode = postOverKeepAlive(request, requestLen);
+  uint64_t recvAt = monoMillis();
+  connectionWarm = uploadClient.connected();
+  lastUploadUse = millis();
+  xSemaphoreGive(uploadMutex);
+  SendResult result = SendResult::RETRY;
+  uploadScheduler.observeResult(httpResponseCode > 0);
 
   if (httpResponseCode > 0) {
-     Serial.print("HTTP Code: "); Serial.println(httpResponseCode);
-     String response = http.getString();
-     if (httpResponseCode == 200 || httpResponseCode == 201 || response.indexOf("berhasil") >= 0) {
-        Serial.println("✅ Database OK (Saved with Server Time)");
-        success = true;
+     LOG_I(HTTP, "HTTP Code: %d", httpResponseCode);
+     learnTimeFromHttpDate(laravelResponse.date(), sentAt, recvAt);
+     if (httpResponseCode == 200 || httpResponseCode == 201 || laravelResponse.bodyContains("berhasil")) {
+        LOG_I(HTTP, "✅ Database OK");
+        result = SendResult::ACKED;
+     } else if (httpResponseCode == 409 || laravelResponse.bodyContains("duplikat")) {
+        // Record dengan key ini sudah tersimpan dari percobaan sebelumnya
+        LOG_I(HTTP, "✅ Sudah tersimpan (duplikat diabaikan server)");
+        result = SendResult::ACKED;
+     } else if (httpResponseCode >= 400 && httpResponseCode < 500 &&
+                httpResponseCode != 408 && httpResponseCode != 429) {
+        LOG_W(HTTP, "⛔ Ditolak server, tidak dikirim ulang");
+        result = SendResult::REJECTED;
      } else {
-        Serial.println("⚠️ Terkirim tapi response aneh");
-        success = true; 
+        // Tidak ada konfirmasi -> belum dianggap tersimpan, kirim ulang dengan key sama
+        LOG_W(HTTP, "⚠️ Terkirim tapi response aneh, akan dikirim ulang");
+        result = SendResult::RETRY;
      }
   } else {
-     Serial.print("❌ HTTP Error: "); 
-     Serial.print(httpResponseCode);
-     Serial.print(" - ");
-     Serial.println(http.errorToString(httpResponseCode));
-     success = false;
+     LOG_W(HTTP, "❌ HTTP Error: %d - %s", httpResponseCode, httpErrorText(httpResponseCode));
   }
   
-  http.end();
-  clientSecure.stop();
-  return success;
+  return result;
 }
+#endif
 
-// --- PENGIRIMAN KE MQTT ---
-bool sendToMQTT() {
-  if (!mqttClient.connected()) {
-     connectMQTT();
-     if (!mqttClient.connected()) return false;
+// "berat=..&fakultas=..&...&idempotency_key=..[time fields]", skema yang
+// sama untuk body HTTP dan baris batch CoAP. Return 0 jika tidak muat.
+// created_at dari jam perangkat jika sudah sync; jika belum, server
+// memakai NOW() - age_ms
+size_t formatRecordForm(char* dest, size_t destSize, const WeighingRecord& rec) {
+  return formatRecordFormAs(dest, destSize, rec, fakultas, deviceId);
+}
+
+// Sama seperti di atas untuk perangkat lain (record relay ESP-NOW)
+size_t formatRecordFormAs(char* dest, size_t destSize, const WeighingRecord& rec,
+                          const char* fakultasName, const char* originId) {
+  int n = snprintf(dest, destSize, "berat=%.2f&fakultas=%s&jenis=%s&device_id=%s&seq=%lu&idempotency_key=%s-%lu",
+                   rec.weight, fakultasName, WasteCategories::name(rec.category), originId, (unsigned long)rec.seq,
+                   originId, (unsigned long)rec.seq);
+  if (n <= 0 || (size_t)n >= destSize) return 0;
+  size_t timeLen = formatTimeFields(dest + n, destSize - n, rec);
+  return timeLen ? n + timeLen : 0;
+}
+
+#ifdef ECOSCALE_COAP
+// Satu transfer CoAP untuk count record (satu baris per record, Block1 jika
+// lebih dari satu blok). Server meng-ACK seluruh batch atau tidak sama sekali;
+// retry aman karena setiap baris membawa idempotency key. Tidak menunggu:
+// PENDING selama transfer berjalan, hasilnya diambil di panggilan berikutnya.
+SendResult sendViaCoap(WeighingRecord* const* recs, size_t count) {
+  if (coapExchange.owner == CoapOwner::OUTBOX) {
+    // Isi outbox berubah selama transfer: hasilnya tidak berlaku untuk batch ini
+    bool sameBatch = coapExchange.key == recs[0]->seq && coapExchange.count == count;
+    SendResult result = takeCoapResult(CoapOwner::OUTBOX);
+    return sameBatch || result == SendResult::PENDING ? result : SendResult::RETRY;
   }
+  if (coapExchange.owner != CoapOwner::NONE) return SendResult::PENDING;  // dipakai relay
+  if (WiFi.status() != WL_CONNECTED) return SendResult::RETRY;
 
-  char jenisLengkap[20];
-  if (strcmp(sampah.jenis, "Anorganik") == 0 && strcmp(sampah.subJenis, "--") != 0) {
-    if (strcmp(sampah.subJenis, "Umum") == 0) safeStringCopy(jenisLengkap, "Anorganik", sizeof(jenisLengkap));
-    else safeStringCopy(jenisLengkap, sampah.subJenis, sizeof(jenisLengkap));
-  } else {
-    safeStringCopy(jenisLengkap, sampah.jenis, sizeof(jenisLengkap));
+  static uint8_t body[CoapUploader::BODY_MAX];
+  size_t len = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) body[len++] = '\n';
+    size_t n = formatRecordForm((char*)body + len, sizeof(body) - len, *recs[i]);
+    if (n == 0 || len + n >= sizeof(body)) {
+      LOG_E(COAP, "❌ Batch CoAP terlalu besar!");
+      return count > 1 ? SendResult::RETRY : SendResult::REJECTED;
+    }
+    len += n;
+  }
+  return startCoapExchange(CoapOwner::OUTBOX, recs[0]->seq, body, len, count)
+         ? SendResult::PENDING : SendResult::RETRY;
+}
+
+bool startCoapExchange(CoapOwner owner, uint32_t key, const uint8_t* body, size_t len, size_t count) {
+  if (coapExchange.owner != CoapOwner::NONE) return false;
+  LOG_I(COAP, "📦 CoAP POST (%u record, %u byte)", (unsigned)count, (unsigned)len);
+  unsigned long now = millis();
+  if (!coapUploader.start(body, len, now)) return false;
+  coapExchange = { owner, key, count, now, false, SendResult::PENDING };
+  return true;
+}
+
+// Satu poll per loop (retransmisi dan blok berikutnya); hasil akhir disimpan
+// sampai pemiliknya mengambil lewat takeCoapResult()
+void serviceCoapExchange(unsigned long now) {
+  if (coapExchange.owner == CoapOwner::NONE || coapExchange.done) return;
+  if (!radioQuiet.mayTransmit(now)) return;   // jangan TX saat berat sedang dikunci
+  CoapResult state = coapUploader.poll(now);
+  if (state == CoapResult::BUSY) return;
+
+  uint8_t code = coapUploader.responseCode();
+  uploadScheduler.observeResult(state == CoapResult::DONE || state == CoapResult::REJECTED);
+  LOG_I(COAP, "CoAP Code: %u.%02u", CoapCode::cls(code), code & 0x1F);
+  switch (state) {
+    case CoapResult::DONE:
+      coapRtt.sample(now - coapExchange.sentAt);
+      LOG_I(COAP, "✅ Database OK");
+      coapExchange.result = SendResult::ACKED;
+      break;
+    case CoapResult::REJECTED:
+      LOG_W(COAP, "⛔ Ditolak server, tidak dikirim ulang");
+      coapExchange.result = SendResult::REJECTED;
+      break;
+    default:
+      if (code == 0) coapRtt.onTimeout();
+      LOG_W(COAP, "❌ CoAP gagal, akan dikirim ulang");
+      coapExchange.result = SendResult::RETRY;
+      break;
   }
+  coapExchange.done = true;
+}
+
+// PENDING selama transfer milik owner masih berjalan; hasil akhir sekali ambil
+SendResult takeCoapResult(CoapOwner owner) {
+  if (coapExchange.owner != owner || !coapExchange.done) return SendResult::PENDING;
+  coapExchange.owner = CoapOwner::NONE;
+  return coapExchange.result;
+}
+#endif
 
-  String mqttData = "{";
-  mqttData += "\"weight\":" + String(currentWeight, 2) + ",";
-  mqttData += "\"fakultas\":\"" + String(fakultas) + "\",";
-  mqttData += "\"jenis\":\"" + String(jenisLengkap) + "\"";
-  // Tidak kirim timestamp, subscriber MQTT bisa pakai waktu terima (receive time)
-  mqttData += "}";
+// Sesi upload Laravel (TLS keep-alive) dan CoAP; dipanggil begin() backend
+void initUploadPath() {
+#ifdef ECOSCALE_COAP
+  coapUploader.setServer(COAP_SERVER, COAP_DEFAULT_PORT);
+  coapUploader.setPath(coap_path);
+  coapUploader.setKey(deviceId, (const uint8_t*)COAP_PSK, strlen(COAP_PSK));
+  coapUploader.seed(esp_random());
+#endif
+#if ECOSCALE_HTTPS_UPLOAD
+  uploadMutex = xSemaphoreCreateMutex();
+  uploadClient.setInsecure(); // Wajib jika tidak pakai NTP/Cert validation
+  uploadClient.setHandshakeTimeout(10);
+  hedgeClient.setInsecure();
+  hedgeClient.setHandshakeTimeout(10);
+  if (!laravelEndpoint.parse(serverName) ||
+      !laravelRequest.begin("POST", laravelEndpoint, "application/x-www-form-urlencoded")) {
+    LOG_E(HTTP, "❌ URL server tidak valid!");
+  }
+#endif
+}
 
-  Serial.println("📡 MQTT Publish: " + mqttData);
+#if ECOSCALE_HTTPS_UPLOAD
+// Connect dengan timeout dari estimasi connect sebelumnya; server mati
+// tidak lagi memakan 15 detik penuh di setiap percobaan.
+bool connectUpload(WiFiClientSecure& client, uint32_t timeoutMs) {
+  client.setHandshakeTimeout((timeoutMs + 999) / 1000);
+  unsigned long start = millis();
+  if (!client.connect(laravelEndpoint.host, laravelEndpoint.port, timeoutMs)) {
+    connectRtt.onTimeout();
+    return false;
+  }
+  connectRtt.sample(millis() - start);
+  return true;
+}
+
+// Kirim request di koneksi keep-alive. Jika koneksi lama ternyata sudah
+// ditutup server, sambung ulang sekali; aman karena request idempoten.
+int postOverKeepAlive(const char* request, size_t len) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = uploadClient.connected();
+    if (!reused && !connectUpload(uploadClient, connectRtt.rto())) {
+      return HTTP_ERR_CONNECT;
+    }
+    if (uploadClient.write((const uint8_t*)request, len) != len) {
+      uploadClient.stop();
+      if (reused) continue;
+      return HTTP_ERR_SEND;
+    }
+    httpTxBytes += len;
+    int code = readHttpResponse(request, len);
+    if (code == HTTP_ERR_CLOSED && reused) continue;
+    return code;
+  }
+  return HTTP_ERR_CLOSED;
+}
+
+// Satu request yang menunggu response di satu koneksi
+struct ResponseLeg {
+  WiFiClientSecure* client;
+  HttpResponseParser* parser;
+  unsigned long sentAt;
+  size_t total;
+};
+
+// Baca data yang sudah ada tanpa menunggu. Return 0 selama response belum
+// cukup; selain itu kode HTTP atau HTTP_ERR_*. Sisa body dikuras (dibuang)
+// agar koneksi bisa dipakai lagi.
+int pollResponseLeg(ResponseLeg& leg) {
+  HttpResponseParser& parser = *leg.parser;
+  uint8_t buf[256];
+
+  while (!parser.done()) {
+    int avail = leg.client->available();
+    if (avail <= 0) break;
+    int n = leg.client->read(buf, avail < (int)sizeof(buf) ? avail : sizeof(buf));
+    if (n <= 0) break;
+    leg.total += n;
+    httpRxBytes += n;
+    if (parser.feed(buf, n) < 0) { leg.client->stop(); return HTTP_ERR_PARSE; }
+  }
+
+  if (!parser.done()) {
+    if (!leg.client->connected()) parser.connectionClosed();
+    else if (!parser.prefixReady() ||
+             (parser.keepAlive() && leg.total <= HTTP_MAX_RESPONSE_BYTES)) return 0;
+  }
+
+  if (!parser.headersDone()) { leg.client->stop(); return HTTP_ERR_CLOSED; }
+  if (!parser.done() || !parser.keepAlive()) leg.client->stop();
+  return parser.statusCode();
+}
+
+// Tunggu response sampai RTO. Jika lebih lambat dari p95, request yang sama
+// dikirim sekali lagi di koneksi baru; mana yang lebih dulu selesai dipakai.
+int readHttpResponse(const char* request, size_t len) {
+  laravelResponse.reset();
+  ResponseLeg primary = { &uploadClient, &laravelResponse, millis(), 0 };
+  ResponseLeg hedge = { &hedgeClient, &hedgeResponse, 0, 0 };
+  uint32_t timeout = uploadRtt.rto();
+  uint32_t hedgeAfter = uploadRtt.sampleCount() >= HEDGE_MIN_SAMPLES ? uploadRtt.percentile(95) : 0;
+  bool hedged = false;
+  int primaryCode = 0, hedgeCode = 0;
+
+  for (;;) {
+    if (primaryCode == 0) primaryCode = pollResponseLeg(primary);
+    if (hedged && hedgeCode == 0) hedgeCode = pollResponseLeg(hedge);
+    unsigned long now = millis();
+
+    if (primaryCode > 0) {
+      if (hedged) hedgeClient.stop();
+      uploadRtt.sample(now - primary.sentAt);
+      return primaryCode;
+    }
+    if (hedgeCode > 0) {
+      // Koneksi utama dalam keadaan tidak jelas: tutup, request berikutnya sambung baru
+      uploadClient.stop();
+      hedgeClient.stop();
+      laravelResponse = hedgeResponse;
+      hedgeWins++;
+      uploadRtt.sample(now - hedge.sentAt);
+      return hedgeCode;
+    }
+    // Tanpa hedge yang masih hidup, kegagalan koneksi utama langsung dilaporkan
+    if (primaryCode < 0 && (!hedged || hedgeCode < 0)) return primaryCode;
+
+    if (now - primary.sentAt > timeout) {
+      uploadClient.stop();
+      if (hedged) hedgeClient.stop();
+      uploadRtt.onTimeout();
+      return HTTP_ERR_TIMEOUT;
+    }
+
+    if (!hedged && hedgeAfter > 0 && hedgeAfter < timeout && now - primary.sentAt > hedgeAfter &&
+        heap_caps_get_free_size(MALLOC_CAP_8BIT) > HEDGE_MIN_FREE_HEAP) {
+      hedged = true;
+      hedgeCount++;
+      hedgeResponse.reset();
+      uint32_t budget = timeout - (now - primary.sentAt);
+      LOG_I(HTTP, "🔀 Hedge: respon > p95 (%lu ms), kirim ulang di koneksi baru", (unsigned long)hedgeAfter);
+      if (connectUpload(hedgeClient, budget) &&
+          hedgeClient.write((const uint8_t*)request, len) == len) {
+        hedge.sentAt = millis();
+        httpTxBytes += len;
+      } else {
+        hedgeClient.stop();
+        hedgeCode = HTTP_ERR_CONNECT;
+      }
+      continue;
+    }
+
+    delay(1);
+    esp_task_wdt_reset();
+  }
+}
+
+// --- PRE-WARMING KONEKSI ---
+
+// Beban baru stabil: operator kemungkinan besar akan menekan tombol kirim.
+// DNS + TCP + TLS dikerjakan di task core 0 supaya tampilan tidak tertahan.
+void prewarmUploadConnection() {
+  if (!Backend::PREWARM || !cfg.prewarmUpload || offlineMode || WiFi.status() != WL_CONNECTED) return;
+  lastUploadUse = millis();
+  if (prewarmRunning || connectionWarm) return;
+
+  prewarmRunning = true;
+  if (xTaskCreatePinnedToCore(prewarmTask, "prewarm", 10240, nullptr, 1, nullptr, 0) != pdPASS) {
+    prewarmRunning = false;
+  }
+}
+
+void prewarmTask(void* param) {
+  // Jangan mulai handshake saat berat sedang dikunci
+  while (!radioQuiet.mayTransmit(millis())) vTaskDelay(pdMS_TO_TICKS(10));
+  if (xSemaphoreTake(uploadMutex, 0) == pdTRUE) {
+    unsigned long start = millis();
+    if (!uploadClient.connected()) connectUpload(uploadClient, connectRtt.rto());
+    connectionWarm = uploadClient.connected();
+    lastUploadUse = millis();
+    xSemaphoreGive(uploadMutex);
+    LOG_I(HTTP, "🔥 Pre-warm %s (%lu ms)", connectionWarm ? "OK" : "gagal", millis() - start);
+  }
+  prewarmRunning = false;
+  vTaskDelete(NULL);
+}
+
+// Koneksi hangat yang tidak dipakai ditutup agar tidak memegang RAM TLS
+void expireWarmConnection() {
+  if (!Backend::PREWARM || !connectionWarm || prewarmRunning) return;
+  if (millis() - lastUploadUse < Config::WARM_IDLE_TIMEOUT) return;
+  if (xSemaphoreTake(uploadMutex, 0) != pdTRUE) return;
+  uploadClient.stop();
+  connectionWarm = false;
+  xSemaphoreGive(uploadMutex);
+  LOG_I(HTTP, "❄️ Koneksi hangat ditutup (idle)");
+}
+#endif
+
+void recordPressToAck(unsigned long latencyMs, bool warm) {
+  LatencyStats& stats = warm ? latencyWarm : latencyCold;
+  stats.count++;
+  stats.totalMs += latencyMs;
+  if (latencyMs > stats.maxMs) stats.maxMs = latencyMs;
+  LOG_I(SCALE, "⏱️ Press-to-ack %lu ms (%s) | warm avg %lu n=%lu | cold avg %lu n=%lu",
+        latencyMs, warm ? "warm" : "cold",
+        latencyWarm.count ? (unsigned long)(latencyWarm.totalMs / latencyWarm.count) : 0UL,
+        (unsigned long)latencyWarm.count,
+        latencyCold.count ? (unsigned long)(latencyCold.totalMs / latencyCold.count) : 0UL,
+        (unsigned long)latencyCold.count);
+}
+
+// Fragmentasi terlihat dari blok bebas terbesar yang terus turun walau
+// free heap total stabil. Titik terendah dicatat tiap HEAP_SAMPLE_INTERVAL,
+// log ringkas tiap HEAP_LOG_INTERVAL.
+void sampleHeap() {
+  size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  if (freeHeap < heapWatermark.minFree) heapWatermark.minFree = freeHeap;
+  if (largest < heapWatermark.minLargestBlock) heapWatermark.minLargestBlock = largest;
+}
+
+void logHeap() {
+  size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#if ECOSCALE_TLS_POOL
+  TlsPoolStats pool = tlsPoolStats();
+  LOG_I(METRICS, "🧠 Heap free %u (min %u) | blok terbesar %u (min %u) | TLS pool %u/%u peak %u, fallback %lu",
+        (unsigned)freeHeap, (unsigned)heapWatermark.minFree,
+        (unsigned)largest, (unsigned)heapWatermark.minLargestBlock,
+        (unsigned)pool.used, (unsigned)pool.capacity, (unsigned)pool.peak,
+        (unsigned long)pool.heapFallbacks);
+#else
+  LOG_I(METRICS, "🧠 Heap free %u (min %u) | blok terbesar %u (min %u)",
+        (unsigned)freeHeap, (unsigned)heapWatermark.minFree,
+        (unsigned)largest, (unsigned)heapWatermark.minLargestBlock);
+#endif
+}
+
+// snprintf berurutan ke buffer tetap. Sekali tidak muat, len = cap dan
+// append berikutnya diabaikan; pemanggil cukup cek len < cap di akhir.
+void appendf(char* buf, size_t cap, size_t& len, const char* fmt, ...) {
+  if (len >= cap) return;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + len, cap - len, fmt, args);
+  va_end(args);
+  len = (n < 0 || (size_t)n >= cap - len) ? cap : len + n;
+}
+
+// Estimasi RTT per backend + kualitas link (QoS 0, hilang satu tidak masalah) + log serial
+void publishMetrics() {
+  char payload[896];   // paket MQTT maks TX_BUFFER_SIZE (1024) termasuk topik
+  size_t n = 0;
+  appendf(payload, sizeof(payload), n, "{\"device_id\":\"%s\"", deviceId);
+#if ECOSCALE_HTTPS_UPLOAD
+  appendf(payload, sizeof(payload), n,
+          ",\"laravel\":{\"srtt_ms\":%lu,\"rttvar_ms\":%lu,\"rto_ms\":%lu,"
+          "\"p50_ms\":%lu,\"p95_ms\":%lu,\"p99_ms\":%lu,\"tx_bytes\":%lu,\"rx_bytes\":%lu,\"samples\":%lu,\"timeouts\":%lu,\"hedges\":%lu,\"hedge_wins\":%lu,"
+          "\"connect_srtt_ms\":%lu,\"connect_rto_ms\":%lu,\"prewarm\":%s}",
+          (unsigned long)uploadRtt.srtt(), (unsigned long)uploadRtt.rttvar(), (unsigned long)uploadRtt.rto(),
+          (unsigned long)uploadRtt.percentile(50), (unsigned long)uploadRtt.percentile(95),
+          (unsigned long)uploadRtt.percentile(99), (unsigned long)httpTxBytes, (unsigned long)httpRxBytes,
+          (unsigned long)uploadRtt.sampleCount(),
+          (unsigned long)uploadRtt.timeoutCount(), (unsigned long)hedgeCount, (unsigned long)hedgeWins,
+          (unsigned long)connectRtt.srtt(), (unsigned long)connectRtt.rto(),
+          cfg.prewarmUpload ? "true" : "false");
+#endif
+  appendf(payload, sizeof(payload), n,
+          ",\"link\":{\"rssi\":%d,\"fail_rate\":%.2f,"
+          "\"quality\":%u,\"queued\":%u},\"heap_min\":%u,\"largest_block_min\":%u,"
+          "\"ws\":{\"clients\":%d,\"sent\":%lu,\"dropped\":%lu,\"stalled\":%lu}",
+          (int)uploadScheduler.smoothedRssi(), uploadScheduler.failureRate(),
+          (unsigned)uploadScheduler.quality(), (unsigned)outbox.size(),
+          (unsigned)heapWatermark.minFree, (unsigned)heapWatermark.minLargestBlock,
+          liveView.clientCount(), (unsigned long)liveView.stats().framesSent,
+          (unsigned long)liveView.stats().framesDropped, (unsigned long)liveView.stats().stalledClosed);
+  {
+    const ButtonStats& btn = buttons.stats();
+    appendf(payload, sizeof(payload), n,
+            ",\"buttons\":{\"events\":%lu,\"lat_avg_us\":%lu,\"lat_max_us\":%lu,\"dropped\":%lu,\"stale\":%lu}",
+            (unsigned long)btn.events,
+            (unsigned long)(btn.handled ? btn.latencyTotalUs / btn.handled : 0),
+            (unsigned long)btn.latencyMaxUs, (unsigned long)(btn.edgesDropped + btn.eventsDropped),
+            (unsigned long)btn.stale);
+  }
+  {
+    const LoopStats& lp = flows.loopStats();
+    appendf(payload, sizeof(payload), n, ",\"loop\":{\"max_us\":%lu,\"flow_max_us\":%lu}",
+            (unsigned long)lp.maxPeriodUs, (unsigned long)lp.maxPeriodFlowUs);
+  }
+  {
+    LogStats lg = logger.stats();
+    appendf(payload, sizeof(payload), n, ",\"log\":{\"lines\":%lu,\"dropped\":%lu,\"hw\":%lu}",
+            (unsigned long)lg.lines, (unsigned long)lg.dropped, (unsigned long)lg.highWater);
+  }
+#ifdef ECOSCALE_ESPNOW
+  {
+    const EspNowStats& relay = espNowGateway.stats();
+    appendf(payload, sizeof(payload), n,
+            ",\"relay\":{\"nodes\":%d,\"pending\":%d,\"rx\":%lu,\"dup\":%lu,\"dropped\":%lu,\"bad\":%lu}",
+            espNowGateway.nodeCount(), espNowGateway.pendingCount(), (unsigned long)relay.framesReceived,
+            (unsigned long)relay.duplicates, (unsigned long)relay.dropped, (unsigned long)relay.badFrames);
+  }
+#endif
+#ifdef ECOSCALE_COAP
+  appendf(payload, sizeof(payload), n,
+            ",\"coap\":{\"srtt_ms\":%lu,\"p50_ms\":%lu,\"p99_ms\":%lu,\"samples\":%lu,"
+            "\"tx_bytes\":%lu,\"rx_bytes\":%lu,\"retransmits\":%lu}",
+            (unsigned long)coapRtt.srtt(), (unsigned long)coapRtt.percentile(50),
+            (unsigned long)coapRtt.percentile(99), (unsigned long)coapRtt.sampleCount(),
+            (unsigned long)coapUploader.bytesSent(), (unsigned long)coapUploader.bytesReceived(),
+            (unsigned long)coapUploader.retransmitCount());
+#endif
+#ifdef ECOSCALE_BACKEND_FIREBASE
+  {
+    const FirebaseAuthStats& fb = FirebaseBackend::authStats();
+    appendf(payload, sizeof(payload), n,
+            ",\"firebase\":{\"boots\":%lu,\"signups\":%lu,\"refreshes\":%lu,\"ready_ms\":%lu,\"cached\":%s}",
+            (unsigned long)fb.boots, (unsigned long)fb.signUps, (unsigned long)fb.refreshes,
+            (unsigned long)fb.readyMs, fb.fromCache ? "true" : "false");
+  }
+#endif
+  // Job yang melewati budget sejak laporan terakhir: log + ringkasan di metrics
+  appendf(payload, sizeof(payload), n, ",\"jobs\":{");
+  bool firstJob = true;
+  for (int8_t id = 0; id < scheduler.jobCount(); id++) {
+    const JobStats& st = scheduler.stats(id);
+    if (scheduler.takeOverrunFlag(id)) {
+      LOG_W(METRICS, "⏱️ Job %s melewati budget: %lu us (budget %lu, overrun %lu)", scheduler.name(id),
+            (unsigned long)st.durationMaxUs, (unsigned long)scheduler.budget(id), (unsigned long)st.overruns);
+    }
+    if (st.overruns == 0 && st.skipped == 0) continue;
+    appendf(payload, sizeof(payload), n, "%s\"%s\":[%lu,%lu,%lu,%lu]", firstJob ? "" : ",",
+            scheduler.name(id), (unsigned long)st.overruns, (unsigned long)st.skipped,
+            (unsigned long)st.jitterMaxUs, (unsigned long)st.durationMaxUs);
+    firstJob = false;
+  }
+  appendf(payload, sizeof(payload), n, "},\"metrics_dropped\":%lu}", (unsigned long)metricsDropped);
+  // Terpotong = JSON rusak: tidak dikirim, hanya dihitung
+  if (n >= sizeof(payload)) {
+    metricsDropped++;
+    LOG_W(METRICS, "⚠️ Payload metrics > %u byte, tidak dikirim", (unsigned)sizeof(payload));
+    return;
+  }
+  LOG_D(METRICS, "📊 %s", payload);  // lengkapnya di topik metrics
+  if (!offlineMode && mqttClient.connected()) mqttClient.publish(mqtt_metrics_topic, (const uint8_t*)payload, n, 0, false);
+}
+
+#if ECOSCALE_HTTPS_UPLOAD
+const char* httpErrorText(int code) {
+  switch (code) {
+    case HTTP_ERR_CONNECT: return "connection refused";
+    case HTTP_ERR_SEND:    return "send failed";
+    case HTTP_ERR_CLOSED:  return "connection lost";
+    case HTTP_ERR_TIMEOUT: return "read timeout";
+    case HTTP_ERR_PARSE:   return "bad response";
+    default:               return "unknown";
+  }
+}
+#endif
+
+// --- PENGIRIMAN KE MQTT ---
+bool sendToMQTT(const WeighingRecord& rec) {
+  // QoS 1: pesan masuk in-flight window dan dikirim ulang sampai PUBACK,
+  // jadi tidak perlu menunggu koneksi di sini
+  char idemKey[40];
+  formatIdempotencyKey(idemKey, sizeof(idemKey), rec.seq);
+
+  // Nama field waktu sama dengan form HTTP/CoAP (formatTimeFields)
+  char ts[80] = "";
+  if (timeService.synced()) {
+    char iso[32];
+    formatIso8601(iso, sizeof(iso), timeService.toEpochMs(rec.monoMs));
+    snprintf(ts, sizeof(ts), ",\"created_at\":\"%s\",\"ts_uncertainty_ms\":%lu",
+             iso, (unsigned long)timeService.uncertaintyAt(rec.monoMs));
+  }
+  // Buffer tetap seperti publishDeviceState: tidak ada String/heap di jalur kirim.
+  // QoS 1 bisa menghasilkan duplikat; subscriber dedup via idempotency_key
+  char payload[256];
+  int n = snprintf(payload, sizeof(payload),
+                   "{\"weight\":%.2f,\"fakultas\":\"%s\",\"jenis\":\"%s\",\"seq\":%lu,"
+                   "\"idempotency_key\":\"%s\",\"age_ms\":%lu%s}",
+                   rec.weight, fakultas, WasteCategories::name(rec.category), (unsigned long)rec.seq,
+                   idemKey, (unsigned long)(monoMillis() - rec.monoMs), ts);
+  if (n <= 0 || (size_t)n >= sizeof(payload)) {
+    LOG_E(MQTT, "❌ Payload MQTT terlalu besar!");
+    return false;
+  }
+
+  LOG_D(MQTT, "📡 MQTT Publish: %s", payload);
   
-  if (mqttClient.publish(mqtt_topic, mqttData.c_str())) {
-    Serial.println("✅ MQTT Sent");
+  uint16_t packetId = mqttClient.publish(cfg.mqttTopic, (const uint8_t*)payload, n, 1, false);
+  if (packetId) {
+    LOG_I(MQTT, "✅ MQTT Queued, id=%u", (unsigned)packetId);
     return true;
   } else {
-    Serial.println("❌ MQTT Failed");
+    LOG_W(MQTT, "❌ MQTT Failed (in-flight window penuh)");
     return false;
   }
 }
 
 // ==================== LOGIC UTAMA ====================
 
-void handleKirimData() {
+// Event diproses berurutan selama state masih menerima input; sisanya
+// (mis. tekanan saat status tampil) menunggu sampai kembali ke IDLE.
+void handleButtonEvents() {
+  ButtonEvent ev;
+  while ((currentState == AppState::IDLE || currentState == AppState::SELECTING_SUBTYPE) &&
+         buttons.next(ev, micros())) {
+    if (ev.button == TOMBOL_KIRIM) handleKirimData(ev);
+    else prosesTombol(ev);
+  }
+}
+
+void handleKirimData(const ButtonEvent& ev) {
   if (currentState != AppState::IDLE) return;
 
-  if (tombol[3].isPressed()) {
+  // DOUBLE = tekanan kedua yang terlalu cepat, jangan kirim dua kali
+  if (ev.type == ButtonEventType::PRESS) {
+    unsigned long pressedAt = millis() - (micros() - ev.at) / 1000;  // waktu tekan fisik
+    bool warmAtPress = connectionWarm || prewarmRunning;
     tone(Config::PIN_BUZZER, 2000, 100);
 
     if (offlineMode) {
-      lcd.setCursor(0, 0); lcd.print("Gagal: Offline!   ");
-      statusMsgTimestamp = millis(); currentState = AppState::SHOWING_STATUS;
+      screen.print(0, 0, "Gagal: Offline!   ");
+      showStatusMessage();
       return;
     }
 
     currentState = AppState::SENDING_DATA; 
-    lcd.setCursor(0, 0);
     
-    if (strcmp(sampah.jenis, "--") == 0) {
-      lcd.print("Error: Pilih Jenis!   ");
+    if (selectedCategory == WasteCategory::NONE) {
+      screen.print(0, 0, "Error: Pilih Jenis!   ");
     } else {
-      lcd.print("Status: Mengirim... ");
-      
-      bool laravelSuccess = sendToLaravel();
-      sendToMQTT(); 
-      
-      lcd.setCursor(0, 0);
-      lcd.print(laravelSuccess ? "Status: Sukses!      " : "Status: Gagal!        ");
+      screen.print(0, 0, "Status: Mengirim... ");
+      screen.flush(lcd);  // terlihat sebelum kirim (blocking)
       
-      if (laravelSuccess) {
-        safeStringCopy(sampah.jenis, "--", sizeof(sampah.jenis));
-        safeStringCopy(sampah.subJenis, "--", sizeof(sampah.subJenis));
+      currentWeight = latchWeightQuiet();
+      WeighingRecord rec;
+      buildRecord(rec);
+      // Backend async: record lewat outbox, flow "kirim" menunggu hasilnya
+      // tanpa menahan loop (layar "Mengirim..." tetap, tombol lain diabaikan)
+      if (Backend::ASYNC && outbox.push(rec)) {
+        if (Backend::MQTT_RECORDS) sendToMQTT(rec);
+        pendingSend = { rec.seq, pressedAt };
+        if (flows.start("kirim", sendFlow, millis())) return;
+        showSendResult(SendResult::RETRY, true);
+        return;
       }
+      // Link sangat buruk: jangan tahan operator menunggu timeout, langsung antrikan
+      SendResult result = !Backend::ASYNC && uploadScheduler.interactiveAllowed()
+                          ? Uploader::sendOne(rec) : SendResult::RETRY;
+      if (result == SendResult::ACKED) recordPressToAck(millis() - pressedAt, warmAtPress);
+      if (Backend::MQTT_RECORDS) sendToMQTT(rec);
+      
+      // Record yang belum di-ACK masuk outbox; retry memakai seq yang sama
+      bool queued = result == SendResult::RETRY && outbox.push(rec);
+      if (queued) outbox.onFailure(millis());
+      showSendResult(result, queued);
+      return;
     }
-    statusMsgTimestamp = millis();
-    currentState = AppState::SHOWING_STATUS;
+    showStatusMessage();
+  }
+}
+
+void showSendResult(SendResult result, bool queued) {
+  if (result == SendResult::ACKED) screen.print(0, 0, "Status: Sukses!      ");
+  else if (queued)                 screen.print(0, 0, "Status: Antri...     ");
+  else                             screen.print(0, 0, "Status: Gagal!        ");
+  
+  if (result == SendResult::ACKED || queued) {
+    selectedCategory = WasteCategory::NONE;
+  }
+  showStatusMessage();
+}
+
+// Record tombol kirim sudah selesai (ACK/ditolak)? Menguras outbox dari depan;
+// batch yang lebih tua di depannya ikut terkirim lebih dulu
+bool pendingSendSettled(SendResult& result) {
+  if (!uploadScheduler.interactiveAllowed() && !Uploader::pending()) {
+    result = SendResult::RETRY;   // link sangat buruk: langsung antrikan
+    return true;
   }
+  DrainStep step = Uploader::drainStep(outbox, RecordOutbox::CAPACITY, millis());
+  if (step.count == 0 || step.result == SendResult::PENDING) return false;
+  if ((int32_t)(step.lastSeq - pendingSend.seq) < 0) return false;
+  result = step.result;
+  return true;
+}
+
+// Setelah INTERACTIVE_WAIT_MS record tetap di outbox dan transfer yang
+// sedang berjalan diselesaikan drainOutbox()
+PtState sendFlow(Pt& pt, uint32_t now) {
+  static SendResult result;
+  static bool settled;
+  PT_BEGIN(pt);
+  PT_TIMER_START(pt, now);
+  PT_WAIT_UNTIL(pt, (settled = pendingSendSettled(result)) || PT_ELAPSED(pt, now) >= Config::INTERACTIVE_WAIT_MS);
+  if (!settled) result = SendResult::RETRY;
+  if (result == SendResult::ACKED) recordPressToAck(millis() - pendingSend.pressedAt, false);
+  showSendResult(result, result == SendResult::RETRY);
+  PT_END(pt);
 }
 
 // --- FUNGSI UTILITAS ---
@@ -397,140 +1591,370 @@ bool checkNetworkHealth() {
 }
 
 void manageWifiConnection() {
-  if (millis() - lastWifiCheckTime >= Config::WIFI_CHECK_INTERVAL) {
-    if (WiFi.status() != WL_CONNECTED) {
-      WiFi.reconnect(); 
-      offlineMode = true; isOnline = false;
-    } else {
-      if (offlineMode == true) {
-        // Jika sebelumnya offline dan sekarang connect, cek ping
-        if(checkNetworkHealth()) {
-           offlineMode = false;
-           // syncTime(); <--- SUDAH DIHAPUS, TIDAK PERLU SYNC
-           Serial.println("Reconnected! Ready to send.");
-        }
+  if (currentState == AppState::BOOTING) return;  // bootFlow sedang connect
+  if (WiFi.status() != WL_CONNECTED) {
+#ifdef ECOSCALE_ESPNOW
+    // Scan reconnect memindah channel radio; selama ter-link ke gateway dijarangkan
+    static unsigned long lastRelayedRetry = 0;
+    if (!espNowNode.linked() || millis() - lastRelayedRetry >= Config::RELAY_WIFI_RETRY_INTERVAL) {
+      WiFi.reconnect();
+      lastRelayedRetry = millis();
+    }
+#else
+    WiFi.reconnect(); 
+#endif
+    offlineMode = true; isOnline = false;
+  } else {
+    if (offlineMode == true) {
+      // Jika sebelumnya offline dan sekarang connect, cek ping
+      if(checkNetworkHealth()) {
+         offlineMode = false;
+         installTxHook(radioQuiet);
+         if (!liveListener.listening()) startLiveView();
+         // syncTime(); <--- SUDAH DIHAPUS, TIDAK PERLU SYNC
+         connectMQTT();
+#ifdef ECOSCALE_COAP
+         coapUploader.reopen();   // alamat server & socket dibuka ulang di transfer berikutnya
+#endif
+         LOG_I(NET, "Reconnected! Ready to send.");
       }
     }
-    lastWifiCheckTime = millis();
   }
 }
 
+// Timbangan kosong dan tidak ada proses pilih/kirim. Dipakai untuk pekerjaan
+// jaringan yang boleh menahan loop sebentar (roaming, kirim ulang outbox).
+bool isScaleIdle() {
+  return currentState == AppState::IDLE && currentWeight == 0 && selectedCategory == WasteCategory::NONE;
+}
+
+void buildRecord(WeighingRecord& rec) {
+  rec.seq = seqCounter.next();
+  rec.monoMs = monoMillis();
+  rec.weight = currentWeight;
+  rec.attempts = 1;
+  rec.category = selectedCategory;
+  lastRecordSeq = rec.seq;
+  lastRecordWeight = rec.weight;
+}
+
+void formatIdempotencyKey(char* dest, size_t destSize, uint32_t seq) {
+  snprintf(dest, destSize, "%s-%lu", deviceId, (unsigned long)seq);
+}
+
+// --- WAKTU PERANGKAT ---
+
+uint64_t monoMillis() {
+  return (uint64_t)(esp_timer_get_time() / 1000);
+}
+
+void startTimeSync() {
+  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+}
+
+// Ambil hasil SNTP tanpa menunggu; status COMPLETED hanya dilaporkan sekali
+void serviceTimeSync() {
+  if (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) return;
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  int64_t epochMs = (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  if (timeService.offer(TimeSource::SNTP, epochMs, monoMillis(), 100)) {
+    LOG_I(TIME, "🕒 Waktu tersinkron (SNTP)");
+  }
+}
+
+// Header Date hanya presisi 1 detik; titik tengah request dipakai sebagai
+// waktu sampel dan setengah RTT ditambahkan ke ketidakpastian
+void learnTimeFromHttpDate(const char* dateHeader, uint64_t sentAt, uint64_t recvAt) {
+  int64_t epochSec;
+  if (!dateHeader || !parseHttpDate(dateHeader, epochSec)) return;
+  uint32_t halfRtt = (uint32_t)((recvAt - sentAt) / 2);
+  if (timeService.offer(TimeSource::HTTP_DATE, epochSec * 1000 + 500, sentAt + halfRtt, 500 + halfRtt)) {
+    LOG_I(TIME, "🕒 Waktu dari HTTP Date, +-%lu ms", (unsigned long)(500 + halfRtt));
+  }
+}
+
+// "&age_ms=..[&created_at=..&ts_uncertainty_ms=..]", return panjang yang ditulis.
+// Record MQTT (sendToMQTT) memakai nama field yang sama.
+size_t formatTimeFields(char* dest, size_t destSize, const WeighingRecord& rec) {
+  unsigned long ageMs = (unsigned long)(monoMillis() - rec.monoMs);
+  int n;
+  if (timeService.synced()) {
+    char iso[32];
+    formatIso8601(iso, sizeof(iso), timeService.toEpochMs(rec.monoMs));
+    n = snprintf(dest, destSize, "&age_ms=%lu&created_at=%s&ts_uncertainty_ms=%lu",
+                 ageMs, iso, (unsigned long)timeService.uncertaintyAt(rec.monoMs));
+  } else {
+    n = snprintf(dest, destSize, "&age_ms=%lu", ageMs);
+  }
+  return n > 0 && (size_t)n < destSize ? n : 0;
+}
+
+void onMqttMessage(const char* topic, const uint8_t* payload, size_t len) {
+  if (strcmp(topic, mqtt_time_topic) == 0 && len > 0 && len < 20) {
+    char text[20];
+    memcpy(text, payload, len); text[len] = '\0';
+    int64_t epochMs = strtoll(text, nullptr, 10);
+    // Latensi broker tidak diketahui, anggap +-1 detik
+    if (epochMs > 0) timeService.offer(TimeSource::MQTT, epochMs, monoMillis(), 1000);
+  } else if (strcmp(topic, mqtt_config_topic) == 0) {
+    // Diparse langsung dari buffer RX ke staging; mengaktifkan + menulis
+    // NVS di job config, bukan di tengah pembacaan paket MQTT
+    ConfigResult r = remoteConfig.offer((const char*)payload, len);
+    if (r.status == ConfigStatus::UNCHANGED) return;   // retained dikirim ulang tiap reconnect
+    configResult = r;
+    configResultPending = true;
+    scheduler.trigger(jobConfig);
+  }
+}
+
+// ==================== KONFIGURASI JARAK JAUH ====================
+
+RuntimeConfig defaultRuntimeConfig() {
+  RuntimeConfig c = {};
+  c.weightReadMs = Config::WEIGHT_READ_INTERVAL;
+  c.lcdUpdateMs = Config::LCD_UPDATE_INTERVAL;
+  c.statusRowMs = Config::STATUS_ROW_INTERVAL;
+  c.wifiCheckMs = Config::WIFI_CHECK_INTERVAL;
+  c.pingCheckMs = Config::PING_CHECK_INTERVAL;
+  c.metricsMs = Config::METRICS_INTERVAL;
+  c.weightPublishMs = Config::WEIGHT_PUBLISH_INTERVAL;
+  c.minWeightKg = Config::MIN_WEIGHT_THRESHOLD;
+  c.prewarmUpload = Config::PREWARM_UPLOAD;
+  safeStringCopy(c.mqttServer, mqtt_server, sizeof(c.mqttServer));
+  c.mqttPort = mqtt_port;
+  safeStringCopy(c.mqttTopic, mqtt_topic, sizeof(c.mqttTopic));
+  safeStringCopy(c.fakultas, PROFILE.fakultas, sizeof(c.fakultas));
+  for (LogLevel& l : c.logLevels) l = LogLevel::INFO;
+  return c;
+}
+
+// Sebelum initDeviceTopics(): fakultas dari config menentukan topik
+void loadRemoteConfig() {
+  // PSK yang sama dipasang di backend (tools/sign-config.py) untuk deviceId ini
+  remoteConfig.setKey(deviceId, (const uint8_t*)CONFIG_PSK, strlen(CONFIG_PSK));
+  if (remoteConfig.begin()) LOG_I(SYS, "⚙️ Config v%lu dari NVS", (unsigned long)cfg.version);
+  safeStringCopy(fakultas, cfg.fakultas, sizeof(fakultas));
+  for (uint8_t m = 0; m < (uint8_t)LogModule::COUNT; m++) logger.setLevel((LogModule)m, cfg.logLevels[m]);
+}
+
+void applyRuntimeConfig(uint8_t effects) {
+  scheduler.setPeriod(jobWeight, cfg.weightReadMs);
+  scheduler.setPeriod(jobLcd, cfg.lcdUpdateMs);
+  scheduler.setPeriod(jobStatusRow, cfg.statusRowMs);
+  scheduler.setPeriod(jobPing, cfg.pingCheckMs);
+  scheduler.setPeriod(jobWifi, cfg.wifiCheckMs);
+  scheduler.setPeriod(jobMetrics, cfg.metricsMs);
+  for (uint8_t m = 0; m < (uint8_t)LogModule::COUNT; m++) logger.setLevel((LogModule)m, cfg.logLevels[m]);
+
+  if (effects & CONFIG_RECONNECT) {
+    LOG_I(MQTT, "🔁 Pindah broker MQTT ke %s:%u", cfg.mqttServer, (unsigned)cfg.mqttPort);
+    mqttClient.disconnect();
+    if (!offlineMode) connectMQTT();
+  }
+  if (effects & CONFIG_REBOOT) LOG_I(SYS, "⚙️ Fakultas %s berlaku setelah restart", cfg.fakultas);
+}
+
+void applyConfigJob() {
+  if (configCommitPending) {
+    configCommitPending = false;
+    commitRemoteConfig();
+  }
+  // Penolakan dilaporkan dulu; dokumen valid yang sudah disiapkan tetap
+  // diaktifkan walau ada tawaran lain yang ditolak setelahnya
+  if (configResultPending) {
+    configResultPending = false;
+    const ConfigResult& offered = configResult;
+    if (offered.status == ConfigStatus::REJECTED) {
+      LOG_W(SYS, "⚠️ Config v%lu ditolak: %s", (unsigned long)offered.version, offered.error);
+      publishConfigAck(offered);
+    } else if (offered.status == ConfigStatus::STALE) {
+      LOG_W(SYS, "⚠️ Config v%lu lebih lama dari v%lu, diabaikan", (unsigned long)offered.version, (unsigned long)cfg.version);
+      publishConfigAck(offered);
+    }
+  }
+
+  ConfigResult r = remoteConfig.activate();
+  if (r.status != ConfigStatus::APPLIED) return;
+  LOG_I(SYS, "⚙️ Config v%lu diterapkan", (unsigned long)r.version);
+  applyRuntimeConfig(r.effects);
+  // Broker baru (atau masih dalam masa uji): simpan setelah tersambung
+  if (r.effects & CONFIG_RECONNECT) scheduler.arm(jobBrokerProbation, Config::BROKER_PROBATION_MS);
+  else if (!scheduler.armed(jobBrokerProbation)) commitRemoteConfig();
+  publishConfigAck(r);
+}
+
+// Broker dari config tidak tersambung dalam BROKER_PROBATION_MS: kembali
+// ke config tersimpan agar perangkat tetap bisa dijangkau backend
+void brokerProbationExpired() {
+  char failedServer[sizeof(cfg.mqttServer)];
+  safeStringCopy(failedServer, cfg.mqttServer, sizeof(failedServer));
+  ConfigResult r = remoteConfig.rollback();
+  if (r.status != ConfigStatus::ROLLED_BACK) return;
+  LOG_W(MQTT, "⚠️ Broker %s tidak tersambung, config kembali ke v%lu", failedServer, (unsigned long)cfg.version);
+  applyRuntimeConfig(r.effects);
+  publishConfigAck(r);   // QoS 1: terkirim setelah tersambung lagi ke broker lama
+}
+
+void commitRemoteConfig() {
+  if (!remoteConfig.uncommitted()) return;
+  if (remoteConfig.commit()) LOG_I(SYS, "💾 Config v%lu disimpan", (unsigned long)cfg.version);
+  else LOG_W(SYS, "⚠️ Config v%lu gagal disimpan ke NVS", (unsigned long)cfg.version);
+}
+
+void publishConfigAck(const ConfigResult& r) {
+  char payload[160];
+  size_t n = formatConfigAck(payload, sizeof(payload), r);
+  if (n > 0) mqttClient.publish(mqtt_config_ack_topic, (const uint8_t*)payload, n, 1, false);
+}
+
+// Kirim ulang record tertua di outbox saat timbangan tidak dipakai
+// Jumlah record per kuras ditentukan uploadScheduler (kualitas link + isi
+// antrian), dikirim per MAX_BATCH backend (CoAP: satu batch Block1); burst
+// dibatasi DRAIN_BURST_MS agar tombol tetap responsif.
+void drainOutbox() {
+  if (offlineMode || !isScaleIdle() || !outbox.due(millis()) || !radioQuiet.mayTransmit(millis())) return;
+  uint8_t budget = uploadScheduler.drainBudget(millis(), outbox.size(), RecordOutbox::CAPACITY);
+  unsigned long burstStart = millis();
+
+  while (budget > 0 && outbox.due(millis())) {
+    if (millis() - burstStart > Config::DRAIN_BURST_MS) break;
+    const WeighingRecord& first = outbox.front();
+    if (!Uploader::pending())
+      LOG_I(HTTP, "🔁 Retry %s seq=%lu (percobaan %u)", Backend::name(), (unsigned long)first.seq,
+            (unsigned)(first.attempts + 1));
+
+    // Backend async: PENDING = transfer jalan di background, cek lagi loop berikutnya
+    DrainStep step = Uploader::drainStep(outbox, budget, millis());
+    if (step.count == 0 || step.result == SendResult::RETRY || step.result == SendResult::PENDING) return;
+    if (step.result == SendResult::REJECTED) LOG_W(HTTP, "⛔ %u record dibuang dari outbox", (unsigned)step.count);
+    budget -= step.count < budget ? step.count : budget;
+    esp_task_wdt_reset();
+  }
+}
+
+// Waktu dinding record untuk backend yang menyimpan timestamp sendiri
+bool recordWallClock(uint64_t monoMs, char* iso, size_t cap) {
+  if (!timeService.synced()) return false;
+  formatIso8601(iso, cap, timeService.toEpochMs(monoMs));
+  return true;
+}
+
+// Sampel yang konversinya bertepatan dengan TX WiFi (atau scan roaming)
+// ditandai dan dilewati filter
 float readSmoothedWeight() {
   float rawWeight = LoadCell.getData();
   float weightInKg = rawWeight / 1000.0;
   if (weightInKg < 0.05) weightInKg = 0;
-  weightBuffer[bufferIndex] = weightInKg;
-  bufferIndex = (bufferIndex + 1) % 2;
-  return (weightBuffer[0] + weightBuffer[1]) / 2.0f;
-}
-
-void prosesTombol() {
-  if (tombol[0].isPressed()) {
-    if (currentState == AppState::IDLE) {
-      safeStringCopy(sampah.jenis, "Organik", sizeof(sampah.jenis));
-      safeStringCopy(sampah.subJenis, "--", sizeof(sampah.subJenis));
-      tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay();
-    } else if (currentState == AppState::SELECTING_SUBTYPE) {
-      safeStringCopy(sampah.jenis, "Anorganik", sizeof(sampah.jenis));
-      safeStringCopy(sampah.subJenis, "Umum", sizeof(sampah.subJenis));
-      tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay(); currentState = AppState::IDLE;
+  bool tagged = radioQuiet.txNear(lastConversionAt, Config::HX711_CONVERSION_MS) || wifiRoaming.isScanning();
+  return weightFilter.update(weightInKg, tagged);
+}
+
+// Kunci berat untuk pengiriman di jendela senyap: jaringan (loop, pre-warm,
+// outbox) ditunda, lalu dirata-rata LATCH_SAMPLES konversi baru yang bebas
+// TX. Jika waktu habis, pakai nilai terfilter yang sudah ada.
+float latchWeightQuiet() {
+  unsigned long start = millis();
+  radioQuiet.requestQuiet(start, Config::LATCH_QUIET_MS);
+  float sum = 0;
+  uint8_t clean = 0;
+
+  while (clean < Config::LATCH_SAMPLES && millis() - start < Config::LATCH_QUIET_MS) {
+    if (LoadCell.update()) {
+      unsigned long at = millis();
+      float weightInKg = LoadCell.getData() / 1000.0;
+      if (weightInKg < 0.05) weightInKg = 0;
+      if (!radioQuiet.txNear(at, Config::HX711_CONVERSION_MS)) { sum += weightInKg; clean++; }
     }
-  } else if (tombol[1].isPressed()) {
-    if (currentState == AppState::IDLE) {
+    delay(1);
+  }
+  radioQuiet.release();
+  return clean ? sum / clean : currentWeight;
+}
+
+// Tombol 1-3 memilih kategori lewat tabel WasteCategories (tampilan utama
+// atau menu sub-jenis); yang disimpan hanya kodenya
+void prosesTombol(const ButtonEvent& ev) {
+  if (ev.type == ButtonEventType::LONG || ev.button >= WasteCategories::KEY_COUNT) return;
+  if (currentState == AppState::IDLE) {
+    WasteCategory picked = WasteCategories::MAIN_KEYS[ev.button];
+    if (picked == WasteCategory::NONE) {
       currentState = AppState::SELECTING_SUBTYPE; tampilkanSubJenisAnorganik();
-    } else if (currentState == AppState::SELECTING_SUBTYPE) {
-      safeStringCopy(sampah.jenis, "Anorganik", sizeof(sampah.jenis));
-      safeStringCopy(sampah.subJenis, "Botol", sizeof(sampah.subJenis));
-      tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay(); currentState = AppState::IDLE;
-    }
-  } else if (tombol[2].isPressed()) {
-    if (currentState == AppState::IDLE) {
-      safeStringCopy(sampah.jenis, "Residu", sizeof(sampah.jenis));
-      safeStringCopy(sampah.subJenis, "--", sizeof(sampah.subJenis));
-      tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay();
-    } else if (currentState == AppState::SELECTING_SUBTYPE) {
-      safeStringCopy(sampah.jenis, "Anorganik", sizeof(sampah.jenis));
-      safeStringCopy(sampah.subJenis, "Kertas", sizeof(sampah.subJenis));
-      tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay(); currentState = AppState::IDLE;
+      return;
     }
+    selectedCategory = picked;
+    tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay();
+  } else if (currentState == AppState::SELECTING_SUBTYPE) {
+    selectedCategory = WasteCategories::SUBTYPE_KEYS[ev.button];
+    tone(Config::PIN_BUZZER, 2500, 100); restoreDefaultDisplay(); currentState = AppState::IDLE;
   }
 }
 
+// Dua pilihan per baris mulai baris 1, kolom 0 dan 11
 void tampilkanSubJenisAnorganik() {
-  lcd.clear(); lcd.setCursor(2, 0); lcd.print("Pilih Sub-jenis:");
-  lcd.setCursor(0, 1); lcd.print(" 1.Umum     2.Botol");
-  lcd.setCursor(0, 2); lcd.print(" 3.Kertas");
+  screen.clear(); screen.print(2, 0, "Pilih Sub-jenis:");
+  char item[12];
+  for (uint8_t i = 0; i < WasteCategories::KEY_COUNT; i++) {
+    snprintf(item, sizeof(item), " %u.%s", (unsigned)(i + 1),
+             WasteCategories::info(WasteCategories::SUBTYPE_KEYS[i]).menuLabel);
+    screen.print((i % 2) * 11, 1 + i / 2, item);
+  }
 }
 
+// Baris 3 kolom 0 dan 17-19 (indikator) dibiarkan; angka besar langsung
+// digambar ulang sehingga sel yang sama tidak dikirim ulang ke LCD.
 void restoreDefaultDisplay() {
-  lcd.clear(); lcd.setCursor(0, 0);
-  char displayText[21];
-  if (strcmp(sampah.jenis, "Anorganik") == 0 && strcmp(sampah.subJenis, "--") != 0) {
-    if (strcmp(sampah.subJenis, "Umum") == 0) snprintf(displayText, sizeof(displayText), "Jenis: Anorganik");
-    else snprintf(displayText, sizeof(displayText), "Jenis: %s", sampah.subJenis);
-  } else {
-    snprintf(displayText, sizeof(displayText), "Jenis: %s", sampah.jenis);
-  }
-  lcd.print(displayText); lcd.setCursor(17, 1); lcd.print("kg"); lastDisplayedWeight = -1.00;
+  for (uint8_t row = 0; row < 3; row++) screen.clearRow(row);
+  uint8_t col = screen.print(0, 0, "Jenis: ");
+  screen.print(col, 0, WasteCategories::name(selectedCategory)); screen.print(17, 1, "kg");
+  updateWeightDisplay(currentWeight); lastDisplayedWeight = currentWeight;
 }
 
 void updateWeightDisplay(float weight) {
   char weightString[10]; snprintf(weightString, sizeof(weightString), "%6.2f", weight);
-  bigNumbers.setBigNumberCursor(1, 1); bigNumbers.print(weightString);
+  screen.bigNumber(1, 1, weightString);
 }
 
 void updateStatusIndicators() {
-  const unsigned long DISPLAY_UPDATE_INTERVAL = 1000; 
-  static unsigned long lastDisplayUpdateTime = 0;
   static bool blinkerState = false;
+  if (currentState != AppState::IDLE) return;  // menu sub-jenis memakai seluruh layar
 
-  if (millis() - lastDisplayUpdateTime >= DISPLAY_UPDATE_INTERVAL) {
-    char signalText[5];
-    if (WiFi.status() == WL_CONNECTED && !offlineMode) {
-      long rssi = WiFi.RSSI(); snprintf(signalText, sizeof(signalText), "%3ld", rssi);
-    } else {
-      safeStringCopy(signalText, "OFF", sizeof(signalText));
-    }
-    lcd.setCursor(17, 3); lcd.print(signalText);
-
-    blinkerState = !blinkerState;
-    if (offlineMode) { 
-      lcd.setCursor(0, 3); lcd.write(ICON_IDX_NO_INTERNET); 
-    } else if (mqttClient.connected()) {
-      lcd.setCursor(0, 3); lcd.print(" "); 
-    } else {
-      lcd.setCursor(0, 3); lcd.print(blinkerState ? "-" : " "); 
-    }
-    lastDisplayUpdateTime = millis();
+  char signalText[5];
+  if (WiFi.status() == WL_CONNECTED && !offlineMode) {
+    long rssi = WiFi.RSSI(); snprintf(signalText, sizeof(signalText), "%3ld", rssi);
+    uploadScheduler.observeRssi(rssi);
+  } else {
+    safeStringCopy(signalText, "OFF", sizeof(signalText));
   }
+  screen.print(17, 3, signalText);
 
-  const unsigned long PING_CHECK_INTERVAL = 10000;
-  static unsigned long lastPingTime = 0;
-  if (!offlineMode && millis() - lastPingTime >= PING_CHECK_INTERVAL) {
-    if (WiFi.status() == WL_CONNECTED) isOnline = checkNetworkHealth();
-    else isOnline = false;
-    lastPingTime = millis();
+  blinkerState = !blinkerState;
+  if (offlineMode) { 
+    screen.put(0, 3, ICON_IDX_NO_INTERNET); 
+  } else if (mqttClient.connected()) {
+    screen.put(0, 3, ' '); 
+  } else {
+    screen.put(0, 3, blinkerState ? '-' : ' '); 
   }
 }
 
+void checkInternetJob() {
+  if (offlineMode || currentState != AppState::IDLE) return;
+  if (WiFi.status() == WL_CONNECTED) isOnline = checkNetworkHealth();
+  else isOnline = false;
+}
+
 void initializeSystem() {
-  safeStringCopy(sampah.jenis, "--", sizeof(sampah.jenis));
-  safeStringCopy(sampah.subJenis, "--", sizeof(sampah.subJenis));
   pinMode(Config::PIN_BUZZER, OUTPUT);
-  lcd.init(); lcd.backlight(); lcd.clear();
-  lcd.createChar(ICON_IDX_SIGNAL_1, wifiSignal_1);
-  lcd.createChar(ICON_IDX_SIGNAL_2, wifiSignal_2);
-  lcd.createChar(ICON_IDX_SIGNAL_3, wifiSignal_3);
-  lcd.createChar(ICON_IDX_SIGNAL_4, wifiSignal_4);
+  attachButtonInterrupts(buttons, PIN_TOMBOL, 4);
+  lcdBus.begin(Config::LCD_I2C_CLOCK);
+  if (!lcd.begin([](uint32_t us) { delayMicroseconds(us); })) LOG_W(SYS, "⚠️ LCD tidak merespon di I2C");
   lcd.createChar(ICON_IDX_NO_INTERNET, noInternetIcon);
-  bigNumbers.begin();
-  LoadCell.begin(); EEPROM.begin(512); LoadCell.start(2000, true);
-  if (LoadCell.getTareTimeoutFlag()) {
-    lcd.clear(); lcd.print("HX711 Error!"); while (1) { esp_task_wdt_reset(); delay(100); } 
-  } else {
-    LoadCell.setCalFactor(Config::CALIBRATION_VALUE);
-    LoadCell.setSamplesInUse(1);
-  }
+  lcdLoadBigDigits(lcd);
+  screen.markCleared();
+  if (Config::LCD_ASYNC && !lcd.startAsync()) LOG_W(SYS, "⚠️ Task LCD gagal, kirim sinkron");
+  // Stabilisasi + tare di bootFlow
+  LoadCell.begin(); EEPROM.begin(512);
 }
 
 void safeStringCopy(char* dest, const char* src, size_t destSize) {
@@ -0,0 +1,535 @@
+#include "mqtt-async.h"
+#include <string.h>
+
+namespace {
+  constexpr unsigned long CONNECT_TIMEOUT = 10000;
+  constexpr unsigned long ACK_TIMEOUT     = 15000; // PUBACK tidak datang -> reconnect + kirim ulang
+  constexpr unsigned long RETRY_MIN       = 1000;
+  constexpr unsigned long RETRY_MAX       = 30000;
+
+  constexpr uint8_t TYPE_CONNECT  = 0x10;
+  constexpr uint8_t TYPE_CONNACK  = 0x20;
+  constexpr uint8_t TYPE_PUBLISH  = 0x30;
+  constexpr uint8_t TYPE_PUBACK   = 0x40;
+  constexpr uint8_t TYPE_SUBSCRIBE = 0x82;
+  constexpr uint8_t TYPE_SUBACK   = 0x90;
+  constexpr uint8_t TYPE_PINGREQ  = 0xC0;
+  constexpr uint8_t TYPE_PINGRESP = 0xD0;
+
+  size_t encodeLength(uint8_t* out, size_t len) {
+    size_t n = 0;
+    do {
+      uint8_t b = len % 128; len /= 128;
+      if (len > 0) b |= 0x80;
+      out[n++] = b;
+    } while (len > 0 && n < 4);
+    return n;
+  }
+
+  size_t putString(uint8_t* out, const char* s, size_t len) {
+    out[0] = len >> 8; out[1] = len & 0xFF;
+    memcpy(out + 2, s, len);
+    return len + 2;
+  }
+}
+
+// ==================== KONFIGURASI ====================
+
+void MqttAsyncClient::setInflightWindow(uint8_t w) {
+  if (w < 1) w = 1;
+  if (w > MAX_INFLIGHT) w = MAX_INFLIGHT;
+  window = w;
+}
+
+void MqttAsyncClient::setWill(const char* topic, const char* payload, uint8_t qos, bool retain) {
+  willTopic = topic; willPayload = payload; willQos = qos > 1 ? 1 : qos; willRetain = retain;
+}
+
+uint8_t MqttAsyncClient::inflightCount() const {
+  uint8_t n = 0;
+  for (int i = 0; i < MAX_INFLIGHT; i++) if (inflight[i].used) n++;
+  return n;
+}
+
+uint16_t MqttAsyncClient::nextPacketId() {
+  if (++lastPacketId == 0) lastPacketId = 1;
+  return lastPacketId;
+}
+
+// ==================== API PUBLIK ====================
+
+uint16_t MqttAsyncClient::publish(const char* topic, const char* payload, uint8_t qos, bool retain) {
+  return publish(topic, (const uint8_t*)payload, strlen(payload), qos, retain);
+}
+
+uint16_t MqttAsyncClient::publish(const char* topic, const uint8_t* payload, size_t len, uint8_t qos, bool retain) {
+  if (qos == 0) {
+    if (state != MqttState::CONNECTED) return 0;
+    return queuePublish(topic, payload, len, 0, retain, false, 0) ? 1 : 0;
+  }
+
+  size_t topicLen = strlen(topic);
+  if (topicLen >= TOPIC_SIZE || len > PAYLOAD_SIZE) return 0;
+  if (windowFull()) return 0;
+
+  for (int i = 0; i < MAX_INFLIGHT; i++) {
+    Inflight& m = inflight[i];
+    if (m.used) continue;
+    m.used = true; m.needsSend = true; m.sentOnce = false; m.retain = retain;
+    m.packetId = nextPacketId();
+    memcpy(m.topic, topic, topicLen + 1);
+    memcpy(m.payload, payload, len);
+    m.payloadLen = len;
+    return m.packetId;
+  }
+  return 0;
+}
+
+bool MqttAsyncClient::subscribe(const char* topic, uint8_t qos) {
+  size_t topicLen = strlen(topic);
+  if (topicLen >= TOPIC_SIZE) return false;
+
+  Subscription* slot = nullptr;
+  for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+    if (subs[i].used && strcmp(subs[i].topic, topic) == 0) { slot = &subs[i]; break; }
+    if (!subs[i].used && !slot) slot = &subs[i];
+  }
+  if (!slot) return false;
+  slot->used = true; slot->qos = qos > 1 ? 1 : qos;
+  memcpy(slot->topic, topic, topicLen + 1);
+
+  if (state == MqttState::CONNECTED) sendSubscriptions();
+  return true;
+}
+
+void MqttAsyncClient::disconnect() {
+  if (state == MqttState::CONNECTED) {
+    const uint8_t pkt[] = { 0xE0, 0x00 };
+    transport.write(pkt, sizeof(pkt));
+  }
+  transport.close();
+  state = MqttState::DISCONNECTED;
+  host = nullptr; // berhenti reconnect sampai setServer() lagi
+}
+
+// ==================== STATE MACHINE ====================
+
+void MqttAsyncClient::loop(unsigned long now) {
+  if (!host) return;
+
+  switch (state) {
+    case MqttState::DISCONNECTED:
+      if (!everAttempted || now - stateSince >= retryDelay) startConnect(now);
+      return;
+
+    case MqttState::CONNECTING: {
+      int r = transport.poll();
+      if (r > 0) {
+        if (sendConnect()) { state = MqttState::WAIT_CONNACK; stateSince = now; }
+        else dropConnection(now, "CONNECT");
+      } else if (r < 0 || now - stateSince > CONNECT_TIMEOUT) {
+        dropConnection(now, "TCP");
+      }
+      break;
+    }
+
+    case MqttState::WAIT_CONNACK:
+      if (now - stateSince > CONNECT_TIMEOUT) { dropConnection(now, "CONNACK"); return; }
+      readIncoming(now);
+      break;
+
+    case MqttState::CONNECTED: {
+      readIncoming(now);
+      if (state != MqttState::CONNECTED) return;
+
+      const unsigned long keepAliveMs = (unsigned long)keepAliveSec * 1000UL;
+      if (pingOutstanding && now - lastRxTime > keepAliveMs) { dropConnection(now, "PINGRESP"); return; }
+      if (!pingOutstanding && now - lastTxTime >= keepAliveMs * 3 / 4) {
+        const uint8_t ping[] = { TYPE_PINGREQ, 0x00 };
+        if (queueTx(ping, sizeof(ping))) pingOutstanding = true;
+      }
+      pumpInflight(now);
+      break;
+    }
+  }
+
+  if (state == MqttState::WAIT_CONNACK || state == MqttState::CONNECTED) flushTx(now);
+}
+
+void MqttAsyncClient::startConnect(unsigned long now) {
+  everAttempted = true;
+  stateSince = now;
+  txLen = 0; rxLen = 0; rxSkip = 0;
+  if (transport.open(host, port)) state = MqttState::CONNECTING;
+  else dropConnection(now, "open");
+}
+
+void MqttAsyncClient::dropConnection(unsigned long now, const char* reason) {
+  (void)reason;
+  transport.close();
+  state = MqttState::DISCONNECTED;
+  stateSince = now;
+  txLen = 0; rxLen = 0; rxSkip = 0;
+  pingOutstanding = false;
+  retryDelay = retryDelay * 2 > RETRY_MAX ? RETRY_MAX : retryDelay * 2;
+  // Semua QoS 1 yang belum di-ACK dikirim ulang (DUP) setelah CONNACK berikutnya
+  for (int i = 0; i < MAX_INFLIGHT; i++) if (inflight[i].used) inflight[i].needsSend = true;
+}
+
+bool MqttAsyncClient::sendConnect() {
+  size_t idLen = strlen(clientId);
+  size_t remaining = 10 + 2 + idLen;
+  uint8_t flags = cleanSession ? 0x02 : 0x00;
+  size_t wtLen = 0, wpLen = 0;
+  if (willTopic && willPayload) {
+    wtLen = strlen(willTopic); wpLen = strlen(willPayload);
+    remaining += 2 + wtLen + 2 + wpLen;
+    flags |= 0x04 | (willQos << 3) | (willRetain ? 0x20 : 0x00);
+  }
+
+  uint8_t pkt[5 + 10 + 2 + 64 + 2 + TOPIC_SIZE + 2 + 64];
+  if (idLen > 64 || wtLen >= TOPIC_SIZE || wpLen > 64) return false;
+
+  size_t n = 0;
+  pkt[n++] = TYPE_CONNECT;
+  n += encodeLength(pkt + n, remaining);
+  n += putString(pkt + n, "MQTT", 4);
+  pkt[n++] = 4; // MQTT 3.1.1
+  pkt[n++] = flags;
+  pkt[n++] = keepAliveSec >> 8; pkt[n++] = keepAliveSec & 0xFF;
+  n += putString(pkt + n, clientId, idLen);
+  if (flags & 0x04) {
+    n += putString(pkt + n, willTopic, wtLen);
+    n += putString(pkt + n, willPayload, wpLen);
+  }
+  return queueTx(pkt, n);
+}
+
+void MqttAsyncClient::sendSubscriptions() {
+  for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+    if (!subs[i].used) continue;
+    size_t topicLen = strlen(subs[i].topic);
+    uint8_t pkt[5 + 2 + 2 + TOPIC_SIZE + 1];
+    size_t n = 0;
+    uint16_t id = nextPacketId();
+    pkt[n++] = TYPE_SUBSCRIBE;
+    n += encodeLength(pkt + n, 2 + 2 + topicLen + 1);
+    pkt[n++] = id >> 8; pkt[n++] = id & 0xFF;
+    n += putString(pkt + n, subs[i].topic, topicLen);
+    pkt[n++] = subs[i].qos;
+    queueTx(pkt, n);
+  }
+}
+
+void MqttAsyncClient::pumpInflight(unsigned long now) {
+  // Kirim sesuai urutan packetId (MQTT mewajibkan urutan asli saat kirim ulang)
+  while (true) {
+    Inflight* next = nullptr;
+    for (int i = 0; i < MAX_INFLIGHT; i++) {
+      Inflight& m = inflight[i];
+      if (!m.used) continue;
+      if (!m.needsSend) {
+        if (now - m.sentAt > ACK_TIMEOUT) { dropConnection(now, "PUBACK"); return; }
+        continue;
+      }
+      if (!next || (uint16_t)(m.packetId - next->packetId) > 0x8000) next = &m;
+    }
+    if (!next) return;
+    if (!queuePublish(next->topic, next->payload, next->payloadLen, 1, next->retain,
+                      next->sentOnce, next->packetId)) return; // TX penuh, lanjut di loop berikutnya
+    if (next->sentOnce) retransmits++;
+    next->sentOnce = true; next->needsSend = false; next->sentAt = now;
+  }
+}
+
+// ==================== TX / RX ====================
+
+bool MqttAsyncClient::queueTx(const uint8_t* data, size_t len) {
+  if (len > TX_BUFFER_SIZE - txLen) return false;
+  memcpy(txBuf + txLen, data, len);
+  txLen += len;
+  return true;
+}
+
+bool MqttAsyncClient::queuePublish(const char* topic, const uint8_t* payload, size_t len,
+                                   uint8_t qos, bool retain, bool dup, uint16_t packetId) {
+  size_t topicLen = strlen(topic);
+  size_t remaining = 2 + topicLen + (qos ? 2 : 0) + len;
+  uint8_t hdr[5];
+  size_t hdrLen = 1 + encodeLength(hdr + 1, remaining);
+  hdr[0] = TYPE_PUBLISH | (dup ? 0x08 : 0x00) | (qos << 1) | (retain ? 0x01 : 0x00);
+  if (hdrLen + remaining > TX_BUFFER_SIZE - txLen) return false;
+
+  uint8_t* p = txBuf + txLen;
+  memcpy(p, hdr, hdrLen); p += hdrLen;
+  p += putString(p, topic, topicLen);
+  if (qos) { *p++ = packetId >> 8; *p++ = packetId & 0xFF; }
+  memcpy(p, payload, len);
+  txLen += hdrLen + remaining;
+  return true;
+}
+
+bool MqttAsyncClient::queueAck(uint8_t type, uint16_t packetId) {
+  const uint8_t pkt[] = { type, 0x02, (uint8_t)(packetId >> 8), (uint8_t)(packetId & 0xFF) };
+  return queueTx(pkt, sizeof(pkt));
+}
+
+void MqttAsyncClient::flushTx(unsigned long now) {
+  if (txLen == 0) return;
+  int n = transport.write(txBuf, txLen);
+  if (n < 0) { dropConnection(now, "write"); return; }
+  if (n == 0) return;
+  memmove(txBuf, txBuf + n, txLen - n);
+  txLen -= n;
+  lastTxTime = now;
+}
+
+void MqttAsyncClient::readIncoming(unsigned long now) {
+  while (true) {
+    int n = transport.read(rxBuf + rxLen, RX_BUFFER_SIZE - rxLen);
+    if (n < 0) { dropConnection(now, "closed"); return; }
+    if (n == 0) break;
+    rxLen += n;
+    lastRxTime = now;
+
+    if (rxSkip > 0) {
+      discardOversized();
+      if (rxSkip > 0) continue;
+    }
+
+    while (rxLen >= 2) {
+      size_t remaining = 0, mul = 1, i = 1;
+      bool complete = false;
+      for (; i < rxLen && i <= 4; i++) {
+        remaining += (rxBuf[i] & 0x7F) * mul;
+        mul *= 128;
+        if (!(rxBuf[i] & 0x80)) { complete = true; i++; break; }
+      }
+      if (!complete) break;
+      size_t total = i + remaining;
+
+      if (total > RX_BUFFER_SIZE) {
+        // Paket terlalu besar: isinya dibuang sambil dibaca. PUBLISH QoS 1
+        // tetap di-ACK setelah packet id terbaca (bisa beberapa read() lagi),
+        // kalau tidak broker mengirim ulang paket yang sama tiap reconnect.
+        uint8_t header = rxBuf[0];
+        bool qos1 = (header & 0xF0) == TYPE_PUBLISH && ((header >> 1) & 0x03) == 1;
+        rxDiscard = qos1 ? RxDiscard::TOPIC_LEN : RxDiscard::BODY;
+        rxSkip = remaining;
+        memmove(rxBuf, rxBuf + i, rxLen - i);
+        rxLen -= i;
+        discardOversized();
+        if (rxSkip > 0) break;
+        continue;
+      }
+      if (rxLen < total) break;
+
+      handlePacket(rxBuf[0], rxBuf + i, remaining, now);
+      if (state == MqttState::DISCONNECTED) return;
+      memmove(rxBuf, rxBuf + total, rxLen - total);
+      rxLen -= total;
+    }
+  }
+}
+
+// Buang byte paket terlalu besar dari awal rxBuf. Untuk PUBLISH QoS 1,
+// panjang topik dan packet id dibaca dulu (bisa terpotong antar read())
+void MqttAsyncClient::discardOversized() {
+  while (rxSkip > 0 && rxLen > 0) {
+    size_t k;
+    switch (rxDiscard) {
+      case RxDiscard::TOPIC_LEN:
+        if (rxLen < 2) return;
+        rxTopicLeft = (rxBuf[0] << 8) | rxBuf[1];
+        rxDiscard = rxTopicLeft ? RxDiscard::TOPIC : RxDiscard::PACKET_ID;
+        k = 2;
+        break;
+      case RxDiscard::TOPIC:
+        k = rxTopicLeft < rxLen ? rxTopicLeft : rxLen;
+        rxTopicLeft -= k;
+        if (rxTopicLeft == 0) rxDiscard = RxDiscard::PACKET_ID;
+        break;
+      case RxDiscard::PACKET_ID:
+        if (rxLen < 2) return;
+        if (rxSkip >= 2) queueAck(TYPE_PUBACK, (rxBuf[0] << 8) | rxBuf[1]);
+        rxDiscard = RxDiscard::BODY;
+        k = 2;
+        break;
+      case RxDiscard::BODY:
+      default:
+        k = rxLen;
+        break;
+    }
+    // Topik lebih panjang dari paketnya: paket rusak, cukup dibuang
+    if (k > rxSkip) k = rxSkip;
+    memmove(rxBuf, rxBuf + k, rxLen - k);
+    rxLen -= k;
+    rxSkip -= k;
+  }
+}
+
+void MqttAsyncClient::handlePacket(uint8_t header, const uint8_t* body, size_t len, unsigned long now) {
+  switch (header & 0xF0) {
+    case TYPE_CONNACK:
+      if (len < 2 || body[1] != 0) { dropConnection(now, "refused"); return; }
+      state = MqttState::CONNECTED;
+      stateSince = now; lastTxTime = now; lastRxTime = now;
+      retryDelay = RETRY_MIN;
+      reconnects++;
+      sendSubscriptions();
+      if (onConnect) onConnect();
+      break;
+
+    case TYPE_PUBLISH: {
+      uint8_t qos = (header >> 1) & 0x03;
+      if (len < 2) return;
+      size_t topicLen = (body[0] << 8) | body[1];
+      size_t offset = 2 + topicLen + (qos ? 2 : 0);
+      if (offset > len) return;
+      if (qos == 1) queueAck(TYPE_PUBACK, (body[2 + topicLen] << 8) | body[3 + topicLen]);
+      if (!onMessage || topicLen >= TOPIC_SIZE) return;
+      char topic[TOPIC_SIZE];
+      memcpy(topic, body + 2, topicLen);
+      topic[topicLen] = '\0';
+      onMessage(topic, body + offset, len - offset);
+      break;
+    }
+
+    case TYPE_PUBACK: {
+      if (len < 2) return;
+      uint16_t id = (body[0] << 8) | body[1];
+      for (int i = 0; i < MAX_INFLIGHT; i++) {
+        if (inflight[i].used && inflight[i].packetId == id) {
+          inflight[i].used = false;
+          if (onAck) onAck(id);
+          break;
+        }
+      }
+      break;
+    }
+
+    case TYPE_PINGRESP:
+      pingOutstanding = false;
+      break;
+
+    case TYPE_SUBACK:
+    default:
+      break;
+  }
+}
+
+// ==================== TRANSPORT lwIP ====================
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#include <errno.h>
+
+namespace {
+  volatile int dnsStatus = 0;   // 0 = menunggu, 1 = OK, -1 = gagal
+  volatile uint32_t dnsAddress = 0;
+
+  void onDnsFound(const char* name, const ip_addr_t* ipaddr, void* arg) {
+    (void)name; (void)arg;
+    if (ipaddr) { dnsAddress = ip_2_ip4(ipaddr)->addr; dnsStatus = 1; }
+    else dnsStatus = -1;
+  }
+
+  // API raw lwIP (dns_*) tidak thread-safe: harus jalan di task tcpip, bukan
+  // di task Arduino (sama seperti WiFi.hostByName)
+  struct DnsCall {
+    struct tcpip_api_call_data call;   // harus anggota pertama
+    const char* host;
+    ip_addr_t addr;
+    err_t err;
+  };
+
+  err_t dnsLookupInTcpip(struct tcpip_api_call_data* data) {
+    DnsCall* c = reinterpret_cast<DnsCall*>(data);
+    c->err = dns_gethostbyname(c->host, &c->addr, onDnsFound, nullptr);
+    return ERR_OK;
+  }
+}
+
+bool LwipTcpTransport::open(const char* host, uint16_t port) {
+  close();
+  this->host = host; this->port = port;
+
+  DnsCall lookup = {};
+  lookup.host = host;
+  dnsStatus = 0;
+  tcpip_api_call(dnsLookupInTcpip, &lookup.call);
+  if (lookup.err == ERR_OK) {
+    dnsAddress = ip_2_ip4(&lookup.addr)->addr;
+    return startSocket();
+  }
+  if (lookup.err != ERR_INPROGRESS) return false;
+  resolving = true;
+  return true;
+}
+
+bool LwipTcpTransport::startSocket() {
+  resolving = false;
+  fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return false;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = dnsAddress;
+  if (connect(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0 && errno != EINPROGRESS) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+int LwipTcpTransport::poll() {
+  if (resolving) {
+    if (dnsStatus == 0) return 0;
+    if (dnsStatus < 0 || !startSocket()) return -1;
+  }
+  if (fd < 0) return -1;
+  if (socketConnected) return 1;
+
+  fd_set wfds;
+  FD_ZERO(&wfds); FD_SET(fd, &wfds);
+  struct timeval tv = { 0, 0 };
+  if (select(fd + 1, nullptr, &wfds, nullptr, &tv) <= 0) return 0;
+
+  int soError = 0;
+  socklen_t optLen = sizeof(soError);
+  getsockopt(fd, SOL_SOCKET, SO_ERROR, &soError, &optLen);
+  if (soError != 0) return -1;
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  socketConnected = true;
+  return 1;
+}
+
+int LwipTcpTransport::write(const uint8_t* data, size_t len) {
+  if (fd < 0) return -1;
+  int n = send(fd, data, len, MSG_DONTWAIT);
+  if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  return n;
+}
+
+int LwipTcpTransport::read(uint8_t* buf, size_t len) {
+  if (fd < 0) return -1;
+  if (len == 0) return 0;
+  int n = recv(fd, buf, len, MSG_DONTWAIT);
+  if (n == 0) return -1;
+  if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  return n;
+}
+
+void LwipTcpTransport::close() {
+  if (fd >= 0) ::close(fd);
+  fd = -1;
+  resolving = false;
+  socketConnected = false;
+}
+#endif
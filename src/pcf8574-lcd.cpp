@@ -0,0 +1,166 @@
+#include "pcf8574-lcd.h"
+
+#ifdef ARDUINO
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace {
+constexpr uint8_t PIN_RS = 0x01;
+constexpr uint8_t PIN_EN = 0x04;
+constexpr uint8_t ROW_OFFSETS[4] = { 0x00, 0x40, 0x14, 0x54 };
+constexpr uint32_t RING_MASK = Pcf8574Lcd::RING_SIZE - 1;
+static_assert((Pcf8574Lcd::RING_SIZE & RING_MASK) == 0, "RING_SIZE harus pangkat 2");
+}
+
+// ==================== ENCODER ====================
+
+// Tunggu sampai ring muat expanderBytes. Mode sinkron mengirim sendiri;
+// mode async membangunkan task pengirim lalu memberi CPU (pump() selalu
+// memajukan tail, bus error pun tidak membuat ini macet).
+void Pcf8574Lcd::waitRoom(size_t expanderBytes) {
+  while (RING_SIZE - (head - tail) < expanderBytes) {
+    if (task == nullptr) { pump(); continue; }
+#ifdef ARDUINO
+    xTaskNotifyGive((TaskHandle_t)task);
+    vTaskDelay(1);
+#endif
+  }
+}
+
+void Pcf8574Lcd::push(uint8_t expanderByte) {
+  // Pemanggil yang menghormati room() tidak pernah menunggu di sini
+  waitRoom(1);
+  ring[head & RING_MASK] = expanderByte;
+  head = head + 1;
+}
+
+void Pcf8574Lcd::sendByte(uint8_t value, uint8_t mode) {
+  uint8_t base = mode | backlight;
+  uint8_t hi = value & 0xF0;
+  uint8_t lo = (uint8_t)(value << 4);
+  // RS harus stabil sebelum EN naik; hanya perlu byte tambahan saat RS berganti
+  if (mode != lastMode) { push(hi | base); lastMode = mode; }
+  // Data dibaca HD44780 di tepi turun EN
+  push(hi | base | PIN_EN); push(hi | base);
+  push(lo | base | PIN_EN); push(lo | base);
+}
+
+void Pcf8574Lcd::command(uint8_t value) {
+  sendByte(value, 0);
+}
+
+void Pcf8574Lcd::setCursor(uint8_t col, uint8_t row) {
+  command(0x80 | (ROW_OFFSETS[row & 3] + col));
+}
+
+void Pcf8574Lcd::write(const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) sendByte(data[i], PIN_RS);
+}
+
+void Pcf8574Lcd::createChar(uint8_t slot, const uint8_t rows[8]) {
+  waitRoom(9 * (BYTES_PER_LCD_BYTE + 1));   // perintah CGRAM + 8 baris
+  command(0x40 | ((slot & 7) << 3));
+  write(rows, 8);
+}
+
+void Pcf8574Lcd::setBacklight(bool on) {
+  backlight = on ? 0x08 : 0x00;
+  push(backlight);
+  lastMode = 0;
+  commit();
+}
+
+size_t Pcf8574Lcd::room() const {
+  // Kasus terburuk 5 byte expander per byte LCD (termasuk byte setup RS)
+  return (RING_SIZE - (head - tail)) / (BYTES_PER_LCD_BYTE + 1);
+}
+
+// ==================== PENGIRIMAN ====================
+
+size_t Pcf8574Lcd::pump() {
+  uint32_t h = head, t = tail;
+  if (h == t) return 0;
+  size_t len = h - t;
+  size_t contiguous = RING_SIZE - (t & RING_MASK);
+  if (len > contiguous) len = contiguous;
+  if (len > MAX_TRANSFER) len = MAX_TRANSFER;
+
+  if (!bus.write(address, &ring[t & RING_MASK], len)) counters.errors++;
+  counters.transfers++;
+  counters.bytes += len;
+  tail = t + len;
+  return len;
+}
+
+void Pcf8574Lcd::pumpAll() {
+  while (pump() > 0) {}
+}
+
+void Pcf8574Lcd::commit() {
+#ifdef ARDUINO
+  if (task != nullptr) { xTaskNotifyGive((TaskHandle_t)task); return; }
+#endif
+  pumpAll();
+}
+
+bool Pcf8574Lcd::begin(DelayUsFn delayUs) {
+  uint32_t errorsBefore = counters.errors;
+  backlight = 0x08;
+
+  // Power-on: HD44780 butuh >40 ms setelah Vcc naik
+  push(backlight); pumpAll();
+  delayUs(50000);
+
+  // Reset ke mode 8-bit tiga kali (datasheet fig. 24), lalu pindah ke 4-bit
+  const uint8_t resetNibbles[4] = { 0x30, 0x30, 0x30, 0x20 };
+  const uint32_t waits[4] = { 4500, 150, 150, 150 };
+  for (int i = 0; i < 4; i++) {
+    push(resetNibbles[i] | backlight | PIN_EN); push(resetNibbles[i] | backlight);
+    pumpAll();
+    delayUs(waits[i]);
+  }
+  lastMode = 0;
+
+  command(0x28);   // 4-bit, 2 baris, font 5x8
+  command(0x0C);   // display on, kursor off
+  command(0x01);   // clear
+  pumpAll();
+  delayUs(2000);
+  command(0x06);   // entry mode: kursor maju, tanpa geser
+  pumpAll();
+  return counters.errors == errorsBefore;
+}
+
+// ==================== ADAPTER ESP32 ====================
+#ifdef ARDUINO
+
+static void lcdTask(void* param) {
+  Pcf8574Lcd* lcd = static_cast<Pcf8574Lcd*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (lcd->pump() > 0) {}
+  }
+}
+
+bool Pcf8574Lcd::startAsync() {
+  if (task != nullptr) return true;
+  TaskHandle_t handle = nullptr;
+  if (xTaskCreatePinnedToCore(lcdTask, "lcd", 2048, this, 1, &handle, 0) != pdPASS) return false;
+  task = handle;
+  return true;
+}
+
+bool WireI2cBus::begin(uint32_t clockHz) {
+  if (!wire.begin()) return false;
+  return wire.setClock(clockHz);
+}
+
+bool WireI2cBus::write(uint8_t address, const uint8_t* data, size_t len) {
+  wire.beginTransmission(address);
+  wire.write(data, len);
+  return wire.endTransmission() == 0;
+}
+
+#endif
@@ -0,0 +1,44 @@
+#include "protothread.h"
+
+bool PtRunner::start(const char* name, PtFn fn, uint32_t nowMs) {
+  if (fn == nullptr || running(fn)) return false;
+  for (Flow& f : flows) {
+    if (f.fn != nullptr) continue;
+    f = Flow{ name, fn, {}, nowMs, 0 };
+    active++;
+    return true;
+  }
+  return false;
+}
+
+bool PtRunner::running(PtFn fn) const {
+  for (const Flow& f : flows) {
+    if (f.fn == fn) return true;
+  }
+  return false;
+}
+
+void PtRunner::run(uint32_t nowMs) {
+  for (Flow& f : flows) {
+    if (f.fn == nullptr) continue;
+    if (f.fn(f.pt, nowMs) == PtState::WAITING) continue;
+    Flow ended = f;
+    f.fn = nullptr;
+    active--;
+    // Slot sudah kosong: callback boleh langsung memulai flow lanjutan
+    if (done) done(ended.name, nowMs - ended.startedAt, ended.maxLoopUs);
+  }
+}
+
+void PtRunner::markLoop(uint32_t nowUs) {
+  if (stats.loops++ == 0) { lastLoopUs = nowUs; return; }
+  uint32_t period = nowUs - lastLoopUs;
+  lastLoopUs = nowUs;
+  stats.lastPeriodUs = period;
+  if (period > stats.maxPeriodUs) stats.maxPeriodUs = period;
+  if (active == 0) return;
+  if (period > stats.maxPeriodFlowUs) stats.maxPeriodFlowUs = period;
+  for (Flow& f : flows) {
+    if (f.fn != nullptr && period > f.maxLoopUs) f.maxLoopUs = period;
+  }
+}
@@ -0,0 +1,78 @@
+#include "radio-quiet.h"
+
+void RadioQuiet::requestQuiet(uint32_t now, uint32_t durationMs) {
+  quietActive = true;
+  quietUntil = now + durationMs;
+}
+
+bool RadioQuiet::txNear(uint32_t sampleAt, uint32_t conversionMs) const {
+  uint32_t windowStart = sampleAt - conversionMs - TX_GUARD_MS;
+  uint32_t count = txEvents;
+  uint32_t available = count < TX_HISTORY ? count : TX_HISTORY;
+
+  // Dari TX terbaru ke terlama; timestamp tidak pernah mundur
+  uint32_t examined = 0;
+  bool reachedOlder = false;
+  for (; examined < available; examined++) {
+    uint32_t tx = txRing[(count - 1 - examined) % TX_HISTORY];
+    if ((int32_t)(tx - sampleAt) > 0) continue;        // setelah konversi selesai
+    if ((int32_t)(tx - windowStart) >= 0) return true;  // bersinggungan dengan konversi
+    reachedOlder = true;                               // sebelum jendela: sisanya lebih tua lagi
+    examined++;
+    break;
+  }
+  // Slot yang dibaca bisa tertimpa TX baru selama pemindaian
+  if (txEvents - count + examined > TX_HISTORY) return true;
+  // Semua histori lebih baru dari sampel: TX di jendela mungkin sudah hilang
+  return !reachedOlder && count > TX_HISTORY;
+}
+
+float CleanWeightFilter::update(float value, bool tagged) {
+  if (tagged && filled > 0 && skipRun < MAX_CONSECUTIVE_SKIP) {
+    skipRun++;
+    skipped++;
+    return output;
+  }
+  skipRun = 0;
+
+  window[index] = value;
+  index = (index + 1) % WINDOW;
+  if (filled < WINDOW) filled++;
+
+  float sum = 0;
+  for (uint8_t i = 0; i < filled; i++) sum += window[i];
+  output = sum / filled;
+  return output;
+}
+
+// ==================== HOOK TX (ESP32) ====================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/netif.h>
+
+namespace {
+  RadioQuiet* hookTarget = nullptr;
+  netif_linkoutput_fn originalLinkOutput = nullptr;
+
+  // Jalan di task tcpip untuk setiap frame yang dikirim ke driver WiFi
+  err_t linkOutputHook(struct netif* nif, struct pbuf* p) {
+    hookTarget->noteTx(millis());
+    return originalLinkOutput(nif, p);
+  }
+}
+
+bool installTxHook(RadioQuiet& radioQuiet) {
+  esp_netif_t* handle = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+  if (!handle) return false;
+  struct netif* nif = (struct netif*)esp_netif_get_netif_impl(handle);
+  if (!nif || !nif->linkoutput) return false;
+  if (nif->linkoutput == linkOutputHook) return true;
+
+  hookTarget = &radioQuiet;
+  originalLinkOutput = nif->linkoutput;
+  nif->linkoutput = linkOutputHook;
+  return true;
+}
+#endif
@@ -0,0 +1,75 @@
+#include "record-outbox.h"
+
+// ==================== SEQUENCE COUNTER ====================
+
+void SequenceCounter::begin() {
+  // Nilai tersimpan = batas atas blok terakhir yang dicadangkan
+  nextSeq = storage.load() + 1;
+  reservedUpTo = nextSeq - 1;
+}
+
+uint32_t SequenceCounter::next() {
+  if (nextSeq > reservedUpTo) {
+    reservedUpTo = nextSeq + SEQ_BLOCK - 1;
+    storage.save(reservedUpTo);
+  }
+  return nextSeq++;
+}
+
+// ==================== OUTBOX ====================
+
+bool RecordOutbox::push(const WeighingRecord& rec) {
+  if (count >= CAPACITY) return false;
+  items[(head + count) % CAPACITY] = rec;
+  count++;
+  return true;
+}
+
+void RecordOutbox::pop() {
+  if (count == 0) return;
+  head = (head + 1) % CAPACITY;
+  count--;
+}
+
+bool RecordOutbox::remove(uint32_t seq) {
+  for (size_t i = 0; i < count; i++) {
+    if (items[(head + i) % CAPACITY].seq != seq) continue;
+    // Geser record sesudahnya satu langkah ke depan (urutan tetap)
+    for (size_t j = i; j + 1 < count; j++) {
+      items[(head + j) % CAPACITY] = items[(head + j + 1) % CAPACITY];
+    }
+    count--;
+    return true;
+  }
+  return false;
+}
+
+void RecordOutbox::onSuccess(unsigned long now) {
+  retryDelay = RETRY_MIN;
+  nextAttemptAt = now; // record berikutnya langsung boleh dikirim
+}
+
+void RecordOutbox::onFailure(unsigned long now) {
+  nextAttemptAt = now + retryDelay;
+  retryDelay = retryDelay * 2 > RETRY_MAX ? RETRY_MAX : retryDelay * 2;
+}
+
+// ==================== NVS ====================
+#ifdef ARDUINO
+#include <Preferences.h>
+
+uint32_t NvsCounterStorage::load() {
+  Preferences prefs;
+  prefs.begin("ecoscale", true);
+  uint32_t value = prefs.getUInt(key, 0);
+  prefs.end();
+  return value;
+}
+
+void NvsCounterStorage::save(uint32_t value) {
+  Preferences prefs;
+  prefs.begin("ecoscale", false);
+  prefs.putUInt(key, value);
+  prefs.end();
+}
+#endif
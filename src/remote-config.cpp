@@ -0,0 +1,363 @@
+#include "remote-config.h"
+#include "hmac-sha256.h"
+#include "json-lite.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+// String dibedakan menurut pemakaiannya: NAME masuk topik MQTT dan form
+// upload (alfanumerik saja), HOST nama/alamat broker, TOPIC topik publish.
+// Semuanya juga masuk payload JSON/form, jadi '"', '\\', '&', '=' dan
+// karakter kontrol tidak pernah diterima.
+enum class FieldType : uint8_t { U32, U16, F32, BOOL, NAME, HOST, TOPIC };
+
+// Batas string = panjang (tanpa '\0'). Periode maks 30 menit (JobScheduler).
+struct ConfigField {
+  const char* key;
+  FieldType type;
+  size_t offset;
+  size_t size;
+  double min;
+  double max;
+  uint8_t effect;
+};
+
+#define FIELD(key, type, member, min, max, effect) \
+  { key, FieldType::type, offsetof(RuntimeConfig, member), sizeof(RuntimeConfig::member), min, max, effect }
+
+const ConfigField FIELDS[] = {
+  FIELD("weight_read_ms",    U32, weightReadMs,    20,    5000,    CONFIG_LIVE),
+  FIELD("lcd_update_ms",     U32, lcdUpdateMs,     50,    5000,    CONFIG_LIVE),
+  FIELD("status_row_ms",     U32, statusRowMs,     250,   60000,   CONFIG_LIVE),
+  FIELD("wifi_check_ms",     U32, wifiCheckMs,     5000,  600000,  CONFIG_LIVE),
+  FIELD("ping_check_ms",     U32, pingCheckMs,     2000,  600000,  CONFIG_LIVE),
+  FIELD("metrics_ms",        U32, metricsMs,       5000,  1800000, CONFIG_LIVE),
+  FIELD("weight_publish_ms", U32, weightPublishMs, 200,   60000,   CONFIG_LIVE),
+  FIELD("min_weight_kg",     F32, minWeightKg,     0.001, 1.0,     CONFIG_LIVE),
+  FIELD("prewarm_upload",    BOOL, prewarmUpload,  0,     1,       CONFIG_LIVE),
+  FIELD("mqtt_server",       HOST,  mqttServer,    1,     63,      CONFIG_RECONNECT),
+  FIELD("mqtt_port",         U16,   mqttPort,      1,     65535,   CONFIG_RECONNECT),
+  FIELD("mqtt_topic",        TOPIC, mqttTopic,     1,     63,      CONFIG_LIVE),
+  FIELD("fakultas",          NAME,  fakultas,      1,     7,       CONFIG_REBOOT),
+};
+#undef FIELD
+
+const char* const LEVEL_NAMES[] = { "none", "error", "warn", "info", "debug" };
+
+bool isString(FieldType type) {
+  return type == FieldType::NAME || type == FieldType::HOST || type == FieldType::TOPIC;
+}
+
+bool isAlnum(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+bool validChar(FieldType type, char c) {
+  switch (type) {
+    case FieldType::NAME: return isAlnum(c);
+    case FieldType::HOST: return isAlnum(c) || c == '.' || c == '-';
+    // ASCII cetak tanpa spasi, wildcard MQTT, dan karakter yang perlu di-escape
+    case FieldType::TOPIC: return c > ' ' && c < 0x7F && !strchr("+#\"\\&=", c);
+    default: return false;
+  }
+}
+
+const ConfigField* findField(const JsonSlice& key) {
+  for (const ConfigField& f : FIELDS) {
+    if (key.equals(f.key)) return &f;
+  }
+  return nullptr;
+}
+
+bool fail(char* error, size_t cap, const JsonSlice& key, const char* reason) {
+  snprintf(error, cap, "%.*s: %s", (int)(key.len < 24 ? key.len : 24), key.ptr, reason);
+  return false;
+}
+
+// Nilai satu field dari token terakhir reader ke out (sudah divalidasi)
+bool readField(JsonReader& json, JsonToken t, const ConfigField& f, RuntimeConfig& out,
+               char* error, size_t cap, const JsonSlice& key) {
+  uint8_t* dst = reinterpret_cast<uint8_t*>(&out) + f.offset;
+
+  if (isString(f.type)) {
+    char text[64];
+    if (t != JsonToken::STRING || !json.copyString(text, sizeof(text))) return fail(error, cap, key, "harus string");
+    size_t n = strlen(text);
+    if (n < f.min || n > f.max || n >= f.size) return fail(error, cap, key, "panjang di luar batas");
+    for (size_t i = 0; i < n; i++) {
+      if (!validChar(f.type, text[i])) return fail(error, cap, key, "karakter tidak valid");
+    }
+    memcpy(dst, text, n + 1);
+    return true;
+  }
+
+  if (f.type == FieldType::BOOL) {
+    if (t != JsonToken::TRUE && t != JsonToken::FALSE) return fail(error, cap, key, "harus true/false");
+    *dst = t == JsonToken::TRUE;
+    return true;
+  }
+
+  double v;
+  if (t != JsonToken::NUMBER || !json.number(v)) return fail(error, cap, key, "harus angka");
+  if (!(v >= f.min && v <= f.max)) return fail(error, cap, key, "di luar batas");
+  if (f.type != FieldType::F32 && v != floor(v)) return fail(error, cap, key, "harus bilangan bulat");
+
+  switch (f.type) {
+    case FieldType::U32: { uint32_t x = (uint32_t)v; memcpy(dst, &x, sizeof(x)); break; }
+    case FieldType::U16: { uint16_t x = (uint16_t)v; memcpy(dst, &x, sizeof(x)); break; }
+    case FieldType::F32: { float x = (float)v;       memcpy(dst, &x, sizeof(x)); break; }
+    default: break;
+  }
+  return true;
+}
+
+// "log": {"mqtt": "debug", ...}; nama modul seperti di baris log
+bool readLogLevels(JsonReader& json, RuntimeConfig& out, char* error, size_t cap) {
+  static const JsonSlice LOG_KEY = { "log", 3 };
+  if (json.next() != JsonToken::OBJECT_BEGIN) return fail(error, cap, LOG_KEY, "harus objek");
+  for (;;) {
+    JsonToken t = json.next();
+    if (t == JsonToken::OBJECT_END) return true;
+    if (t != JsonToken::KEY) return fail(error, cap, LOG_KEY, "JSON rusak");
+    JsonSlice key = json.text();
+
+    uint8_t module = 0;
+    while (module < (uint8_t)LogModule::COUNT && !key.equals(AsyncLog::moduleName((LogModule)module))) module++;
+    if (module == (uint8_t)LogModule::COUNT) return fail(error, cap, key, "modul tidak dikenal");
+
+    if (json.next() != JsonToken::STRING) return fail(error, cap, key, "harus string");
+    JsonSlice value = json.text();
+    uint8_t level = 0;
+    while (level < sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]) && !value.equals(LEVEL_NAMES[level])) level++;
+    if (level == sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0])) return fail(error, cap, key, "level tidak dikenal");
+    out.logLevels[module] = (LogLevel)level;
+  }
+}
+}
+
+// ==================== PARSE ====================
+
+bool RemoteConfig::parse(const char* doc, size_t len, const RuntimeConfig& defaults,
+                         RuntimeConfig& out, char* error, size_t errorCap) {
+  static const JsonSlice DOC = { "dokumen", 7 };
+  out = defaults;
+  out.version = 0;
+  JsonReader json(doc, len);
+  if (json.next() != JsonToken::OBJECT_BEGIN) return fail(error, errorCap, DOC, "harus objek JSON");
+
+  for (;;) {
+    JsonToken t = json.next();
+    if (t == JsonToken::OBJECT_END) break;
+    if (t != JsonToken::KEY) return fail(error, errorCap, DOC, "JSON rusak");
+    JsonSlice key = json.text();
+
+    if (key.equals("version")) {
+      double v;
+      if (json.next() != JsonToken::NUMBER || !json.number(v) || v < 1 || v > 4294967295.0 || v != floor(v)) {
+        return fail(error, errorCap, key, "harus bilangan bulat >= 1");
+      }
+      out.version = (uint32_t)v;
+    } else if (key.equals("log")) {
+      if (!readLogLevels(json, out, error, errorCap)) return false;
+    } else {
+      const ConfigField* f = findField(key);
+      if (!f) return fail(error, errorCap, key, "field tidak dikenal");
+      if (!readField(json, json.next(), *f, out, error, errorCap, key)) return false;
+    }
+  }
+  if (json.next() != JsonToken::END) return fail(error, errorCap, DOC, "JSON rusak");
+  if (out.version == 0) return fail(error, errorCap, DOC, "version wajib");
+  return true;
+}
+
+uint8_t RemoteConfig::diff(const RuntimeConfig& a, const RuntimeConfig& b) {
+  uint8_t effects = 0;
+  for (const ConfigField& f : FIELDS) {
+    const uint8_t* pa = reinterpret_cast<const uint8_t*>(&a) + f.offset;
+    const uint8_t* pb = reinterpret_cast<const uint8_t*>(&b) + f.offset;
+    bool changed = isString(f.type) ? strcmp((const char*)pa, (const char*)pb) != 0
+                                            : memcmp(pa, pb, f.size) != 0;
+    if (changed) effects |= f.effect;
+  }
+  if (memcmp(a.logLevels, b.logLevels, sizeof(a.logLevels)) != 0) effects |= CONFIG_LIVE;
+  return effects;
+}
+
+// ==================== AUTENTIKASI ====================
+
+void RemoteConfig::sign(const char* keyId, const uint8_t* psk, size_t pskLen,
+                        const char* doc, size_t len, char out[TAG_HEX]) {
+  static const char DIGITS[] = "0123456789abcdef";
+  uint8_t tag[Sha256::DIGEST_SIZE];
+  HmacSha256 mac(psk, pskLen);
+  mac.update((const uint8_t*)keyId, strlen(keyId));
+  mac.update((const uint8_t*)"\n", 1);
+  mac.update((const uint8_t*)doc, len);
+  mac.finish(tag);
+  for (size_t i = 0; i < sizeof(tag); i++) {
+    out[2 * i] = DIGITS[tag[i] >> 4];
+    out[2 * i + 1] = DIGITS[tag[i] & 0x0F];
+  }
+}
+
+void RemoteConfig::setKey(const char* keyId, const uint8_t* psk, size_t pskLen) {
+  this->keyId = keyId;
+  this->psk = psk;
+  this->pskLen = pskLen;
+}
+
+// docLen = panjang dokumen tanpa "\n<tag>"
+bool RemoteConfig::authenticate(const char* payload, size_t len, size_t& docLen) const {
+  if (psk == nullptr || len < TAG_HEX + 2 || payload[len - TAG_HEX - 1] != '\n') return false;
+  docLen = len - TAG_HEX - 1;
+  char expected[TAG_HEX];
+  char received[TAG_HEX];
+  sign(keyId, psk, pskLen, payload, docLen, expected);
+  for (size_t i = 0; i < TAG_HEX; i++) {
+    char c = payload[docLen + 1 + i];
+    received[i] = c >= 'A' && c <= 'F' ? c - 'A' + 'a' : c;
+  }
+  return constantTimeEqual((const uint8_t*)expected, (const uint8_t*)received, TAG_HEX);
+}
+
+// ==================== SIKLUS HIDUP ====================
+
+bool RemoteConfig::begin() {
+  char doc[DOC_MAX];
+  char error[48];
+  size_t len = store.load(doc, sizeof(doc));
+  RuntimeConfig loaded;
+  if (len == 0 || !parse(doc, len, defaults, loaded, error, sizeof(error))) return false;
+  activeCfg = committedCfg = loaded;
+  return true;
+}
+
+ConfigResult RemoteConfig::offer(const char* payload, size_t payloadLen) {
+  ConfigResult r = {};
+  RuntimeConfig next;
+  const char* doc = payload;
+  size_t len;
+  if (!authenticate(payload, payloadLen, len)) {
+    r.status = ConfigStatus::REJECTED;
+    snprintf(r.error, sizeof(r.error), "tag HMAC tidak valid");
+    return r;
+  }
+  if (len > DOC_MAX) {
+    r.status = ConfigStatus::REJECTED;
+    snprintf(r.error, sizeof(r.error), "dokumen > %u byte", (unsigned)DOC_MAX);
+    return r;
+  }
+  bool ok = parse(doc, len, defaults, next, r.error, sizeof(r.error));
+  r.version = next.version;
+  if (!ok) { r.status = ConfigStatus::REJECTED; return r; }
+
+  // Dokumen retained dikirim ulang broker tiap reconnect
+  uint32_t newest = stagedLen ? stagedCfg.version : activeCfg.version;
+  if (next.version == newest) { r.status = ConfigStatus::UNCHANGED; return r; }
+  if (next.version < newest) { r.status = ConfigStatus::STALE; return r; }
+  // Versi yang sudah di-rollback (retained, dikirim ulang saat reconnect ke
+  // broker lama) tidak dicoba lagi sampai backend menerbitkan versi baru
+  if (next.version <= failedVersion) {
+    r.status = ConfigStatus::REJECTED;
+    snprintf(r.error, sizeof(r.error), "v%lu sudah di-rollback", (unsigned long)failedVersion);
+    return r;
+  }
+
+  r.status = ConfigStatus::APPLIED;
+  r.effects = diff(activeCfg, next);
+  stagedCfg = next;
+  memcpy(stagedDoc, doc, len);
+  stagedLen = len;
+  return r;
+}
+
+ConfigResult RemoteConfig::activate() {
+  ConfigResult r = {};
+  r.version = activeCfg.version;
+  if (stagedLen == 0) { r.status = ConfigStatus::UNCHANGED; return r; }
+  r.status = ConfigStatus::APPLIED;
+  r.version = stagedCfg.version;
+  r.effects = diff(activeCfg, stagedCfg);
+  activeCfg = stagedCfg;
+  memcpy(pendingDoc, stagedDoc, stagedLen);
+  pendingLen = stagedLen;
+  stagedLen = 0;
+  return r;
+}
+
+bool RemoteConfig::commit() {
+  if (pendingLen == 0) return true;
+  if (!store.save(pendingDoc, pendingLen)) return false;
+  committedCfg = activeCfg;
+  pendingLen = 0;
+  return true;
+}
+
+ConfigResult RemoteConfig::rollback() {
+  ConfigResult r = {};
+  r.version = activeCfg.version;
+  if (pendingLen == 0) { r.status = ConfigStatus::UNCHANGED; return r; }
+  r.status = ConfigStatus::ROLLED_BACK;
+  r.effects = diff(activeCfg, committedCfg);
+  failedVersion = activeCfg.version;
+  activeCfg = committedCfg;
+  pendingLen = 0;
+  return r;
+}
+
+// ==================== ACK ====================
+
+const char* configStatusName(ConfigStatus s) {
+  switch (s) {
+    case ConfigStatus::APPLIED:     return "applied";
+    case ConfigStatus::UNCHANGED:   return "unchanged";
+    case ConfigStatus::STALE:       return "stale";
+    case ConfigStatus::REJECTED:    return "rejected";
+    case ConfigStatus::ROLLED_BACK: return "rolled_back";
+    default:                        return "unknown";
+  }
+}
+
+size_t formatConfigAck(char* out, size_t cap, const ConfigResult& r) {
+  // error bisa berisi potongan key mentah dari dokumen: kutip/backslash dibuang
+  char error[sizeof(r.error)];
+  size_t e = 0;
+  for (size_t i = 0; i < sizeof(r.error) - 1 && r.error[i]; i++) {
+    if (r.error[i] != '"' && r.error[i] != '\\' && (uint8_t)r.error[i] >= 0x20) error[e++] = r.error[i];
+  }
+  error[e] = '\0';
+
+  int n = snprintf(out, cap, "{\"version\":%lu,\"status\":\"%s\",\"effects\":[%s%s%s%s%s],\"error\":\"%s\"}",
+                   (unsigned long)r.version, configStatusName(r.status),
+                   (r.effects & CONFIG_LIVE) ? "\"live\"" : "",
+                   (r.effects & CONFIG_LIVE) && (r.effects & (CONFIG_RECONNECT | CONFIG_REBOOT)) ? "," : "",
+                   (r.effects & CONFIG_RECONNECT) ? "\"reconnect\"" : "",
+                   (r.effects & CONFIG_RECONNECT) && (r.effects & CONFIG_REBOOT) ? "," : "",
+                   (r.effects & CONFIG_REBOOT) ? "\"reboot\"" : "",
+                   error);
+  return (n > 0 && (size_t)n < cap) ? n : 0;
+}
+
+// ==================== NVS ====================
+#ifdef ARDUINO
+#include <Preferences.h>
+
+size_t NvsConfigStore::load(char* buf, size_t cap) {
+  Preferences prefs;
+  prefs.begin("ecoscale", true);
+  size_t len = prefs.getBytesLength(key);
+  if (len > cap) len = 0;
+  if (len > 0) len = prefs.getBytes(key, buf, len);
+  prefs.end();
+  return len;
+}
+
+bool NvsConfigStore::save(const char* doc, size_t len) {
+  Preferences prefs;
+  prefs.begin("ecoscale", false);
+  size_t written = prefs.putBytes(key, doc, len);
+  prefs.end();
+  return written == len;
+}
+#endif
@@ -0,0 +1,63 @@
+#include "rtt-estimator.h"
+
+RttEstimator::RttEstimator(const RttPolicy& policy) : policy(policy) {}
+
+// Bin ke-i menampung RTT sampai 16 * 1.41^i ms (16 ms .. ~45 s)
+uint32_t RttEstimator::bucketUpper(uint8_t i) {
+  uint32_t base = 16u << (i / 2);
+  return (i & 1) ? base + (base * 53) / 128 : base;
+}
+
+uint8_t RttEstimator::bucketFor(uint32_t ms) {
+  for (uint8_t i = 0; i < BUCKETS - 1; i++) {
+    if (ms <= bucketUpper(i)) return i;
+  }
+  return BUCKETS - 1;
+}
+
+void RttEstimator::sample(uint32_t rttMs) {
+  if (samples == 0) {
+    srtt8 = rttMs << 3;
+    rttvar4 = (rttMs / 2) << 2;
+  } else {
+    int32_t err = (int32_t)rttMs - (int32_t)(srtt8 >> 3);
+    uint32_t absErr = err < 0 ? -err : err;
+    rttvar4 = rttvar4 - (rttvar4 >> 2) + absErr;   // 3/4 var + 1/4 |err| (skala 4)
+    srtt8 = srtt8 - (srtt8 >> 3) + rttMs;           // 7/8 srtt + 1/8 R (skala 8)
+  }
+  samples++;
+  backoffShift = 0;
+
+  hist[bucketFor(rttMs)]++;
+  if (++sinceDecay >= policy.decayAfter) {
+    for (uint8_t i = 0; i < BUCKETS; i++) hist[i] >>= 1;
+    sinceDecay = 0;
+  }
+}
+
+void RttEstimator::onTimeout() {
+  timeouts++;
+  if (backoffShift < 4) backoffShift++;
+}
+
+uint32_t RttEstimator::rto() const {
+  uint32_t base = samples ? (srtt8 >> 3) + rttvar4 : policy.initialRtoMs;
+  if (base < policy.minRtoMs) base = policy.minRtoMs;
+  uint32_t r = base << backoffShift;
+  if (r > policy.maxRtoMs || r < base) r = policy.maxRtoMs;
+  return r;
+}
+
+uint32_t RttEstimator::percentile(uint8_t pct) const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < BUCKETS; i++) total += hist[i];
+  if (total == 0) return 0;
+
+  uint32_t target = (total * pct + 99) / 100;
+  uint32_t acc = 0;
+  for (uint8_t i = 0; i < BUCKETS; i++) {
+    acc += hist[i];
+    if (acc >= target) return bucketUpper(i);
+  }
+  return bucketUpper(BUCKETS - 1);
+}
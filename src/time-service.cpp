@@ -0,0 +1,84 @@
+#include "time-service.h"
+#include <stdio.h>
+#include <string.h>
+
+// ==================== OFFSET & UNCERTAINTY ====================
+
+uint32_t TimeService::uncertaintyAt(uint64_t monoMs) const {
+  if (!synced()) return UINT32_MAX;
+  uint64_t elapsed = monoMs > syncMonoMs ? monoMs - syncMonoMs : syncMonoMs - monoMs;
+  // Dibulatkan ke atas: setiap ms yang berlalu menambah ketidakpastian
+  uint64_t drift = (elapsed * DRIFT_PPM + 999999ULL) / 1000000ULL;
+  uint64_t total = baseUncertaintyMs + drift;
+  return total > UINT32_MAX ? UINT32_MAX : (uint32_t)total;
+}
+
+bool TimeService::offer(TimeSource src, int64_t epochMs, uint64_t monoMs, uint32_t uncertaintyMs) {
+  if (src == TimeSource::NONE) return false;
+  // Bandingkan pada titik waktu sampel baru: estimasi lama sudah bertambah drift.
+  // Seri dimenangkan sampel baru, jadi sampel lama yang salah (mis. MQTT +-1 s)
+  // tergantikan oleh sampel berikutnya dengan presisi yang sama.
+  if (synced() && uncertaintyMs > uncertaintyAt(monoMs)) return false;
+
+  source = src;
+  offsetMs = epochMs - (int64_t)monoMs;
+  syncMonoMs = monoMs;
+  baseUncertaintyMs = uncertaintyMs;
+  return true;
+}
+
+// ==================== FORMAT TANGGAL ====================
+
+namespace {
+  // Hari sejak 1970-01-01 untuk tanggal Gregorian (algoritma days_from_civil)
+  int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+  }
+
+  void civilFromDays(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400 + (m <= 2));
+  }
+}
+
+bool parseHttpDate(const char* text, int64_t& epochSec) {
+  static const char* const MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  char mon[4] = {0};
+  int day, year, hh, mm, ss;
+  // IMF-fixdate, satu-satunya format yang wajib dikirim server HTTP/1.1
+  if (sscanf(text, "%*3s, %d %3s %d %d:%d:%d GMT", &day, mon, &year, &hh, &mm, &ss) != 6) return false;
+
+  const char* found = strstr(MONTHS, mon);
+  if (!found || strlen(mon) != 3 || (found - MONTHS) % 3 != 0) return false;
+  unsigned month = (found - MONTHS) / 3 + 1;
+  if (day < 1 || day > 31 || hh > 23 || mm > 59 || ss > 60) return false;
+
+  epochSec = daysFromCivil(year, month, day) * 86400 + hh * 3600 + mm * 60 + ss;
+  return true;
+}
+
+void formatIso8601(char* dest, size_t destSize, int64_t epochMs) {
+  int64_t secs = epochMs / 1000;
+  int ms = (int)(epochMs % 1000);
+  if (ms < 0) { ms += 1000; secs--; }
+  int64_t days = secs / 86400;
+  int rem = (int)(secs % 86400);
+  if (rem < 0) { rem += 86400; days--; }
+
+  int y; unsigned m, d;
+  civilFromDays(days, y, m, d);
+  snprintf(dest, destSize, "%04d-%02u-%02uT%02d:%02d:%02d.%03dZ",
+           y, m, d, rem / 3600, (rem / 60) % 60, rem % 60, ms);
+}
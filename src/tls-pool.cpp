@@ -0,0 +1,128 @@
+#include "tls-pool.h"
+#include <string.h>
+
+// ==================== FIRST-FIT POOL ====================
+// Free list terurut alamat, blok bebas yang bersebelahan digabung saat
+// release sehingga pool tidak ikut terfragmentasi oleh pola handshake.
+
+StaticPool::StaticPool(uint8_t* buffer, size_t size) {
+  uintptr_t start = ((uintptr_t)buffer + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1);
+  base = (uint8_t*)start;
+  capacity = (size - (start - (uintptr_t)buffer)) & ~(ALIGN - 1);
+  freeList = (Block*)base;
+  freeList->size = capacity;
+  freeList->next = nullptr;
+}
+
+void* StaticPool::allocate(size_t size) {
+  if (size == 0) size = 1;
+  size_t need = ((size + ALIGN - 1) & ~(ALIGN - 1)) + HEADER;
+
+  Block* prev = nullptr;
+  for (Block* b = freeList; b; prev = b, b = b->next) {
+    if (b->size < need) continue;
+
+    if (b->size - need >= MIN_SPLIT) {
+      Block* rest = (Block*)((uint8_t*)b + need);
+      rest->size = b->size - need;
+      rest->next = b->next;
+      b->size = need;
+      if (prev) prev->next = rest; else freeList = rest;
+    } else {
+      if (prev) prev->next = b->next; else freeList = b->next;
+    }
+
+    used += b->size;
+    if (used > peak) peak = used;
+    return (uint8_t*)b + HEADER;
+  }
+  failures++;
+  return nullptr;
+}
+
+bool StaticPool::release(void* ptr) {
+  if (!ptr || !owns(ptr)) return false;
+  Block* blk = (Block*)((uint8_t*)ptr - HEADER);
+  used -= blk->size;
+
+  Block* prev = nullptr;
+  Block* next = freeList;
+  while (next && next < blk) { prev = next; next = next->next; }
+
+  blk->next = next;
+  if (next && (uint8_t*)blk + blk->size == (uint8_t*)next) {
+    blk->size += next->size;
+    blk->next = next->next;
+  }
+  if (prev && (uint8_t*)prev + prev->size == (uint8_t*)blk) {
+    prev->size += blk->size;
+    prev->next = blk->next;
+  } else if (prev) {
+    prev->next = blk;
+  } else {
+    freeList = blk;
+  }
+  return true;
+}
+
+size_t StaticPool::largestFreeBlock() const {
+  size_t largest = 0;
+  for (Block* b = freeList; b; b = b->next) {
+    if (b->size > largest) largest = b->size;
+  }
+  return largest > HEADER ? largest - HEADER : 0;
+}
+
+// ==================== ALLOCATOR mbedTLS ====================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <mbedtls/platform.h>
+
+namespace {
+  // 48 KB cukup untuk satu sesi TLS (buffer IN 16 KB + OUT 4 KB + handshake).
+  // Sesi kedua (mis. hedged request) akan memakai fallback heap.
+  constexpr size_t TLS_POOL_SIZE = 48 * 1024;
+  uint8_t tlsPoolBuffer[TLS_POOL_SIZE];
+  StaticPool tlsPool(tlsPoolBuffer, sizeof(tlsPoolBuffer));
+  portMUX_TYPE tlsPoolMux = portMUX_INITIALIZER_UNLOCKED;
+  volatile uint32_t heapFallbacks = 0;
+
+  void* tlsCalloc(size_t n, size_t size) {
+    if (size && n > SIZE_MAX / size) return nullptr;
+    size_t total = n * size;
+    portENTER_CRITICAL(&tlsPoolMux);
+    void* p = tlsPool.allocate(total);
+    portEXIT_CRITICAL(&tlsPoolMux);
+    if (!p) {
+      heapFallbacks++;
+      return calloc(n, size);
+    }
+    memset(p, 0, total);
+    return p;
+  }
+
+  void tlsFree(void* p) {
+    if (!p) return;
+    portENTER_CRITICAL(&tlsPoolMux);
+    bool released = tlsPool.release(p);
+    portEXIT_CRITICAL(&tlsPoolMux);
+    if (!released) free(p);
+  }
+}
+
+bool installTlsMemoryPool() {
+  return mbedtls_platform_set_calloc_free(tlsCalloc, tlsFree) == 0;
+}
+
+TlsPoolStats tlsPoolStats() {
+  TlsPoolStats s;
+  portENTER_CRITICAL(&tlsPoolMux);
+  s.capacity = tlsPool.capacityBytes();
+  s.used = tlsPool.usedBytes();
+  s.peak = tlsPool.peakBytes();
+  s.largestFree = tlsPool.largestFreeBlock();
+  portEXIT_CRITICAL(&tlsPoolMux);
+  s.heapFallbacks = heapFallbacks;
+  return s;
+}
+#endif
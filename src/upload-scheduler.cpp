@@ -0,0 +1,50 @@
+#include "upload-scheduler.h"
+
+void UploadScheduler::observeRssi(int dbm) {
+  if (!haveRssi) { rssi = dbm; haveRssi = true; return; }
+  rssi += (dbm - rssi) * 0.25f;
+}
+
+void UploadScheduler::observeResult(bool ok) {
+  failRate += ((ok ? 0.0f : 1.0f) - failRate) * 0.125f;
+}
+
+LinkQuality UploadScheduler::quality() const {
+  // Tanpa sampel RSSI hanya tingkat gagal yang dipakai
+  bool rssiGood = !haveRssi || rssi >= policy.goodRssi;
+  bool rssiFair = !haveRssi || rssi >= policy.fairRssi;
+  if (rssiGood && failRate < policy.goodFailRate) return LinkQuality::GOOD;
+  if (rssiFair && failRate < policy.fairFailRate) return LinkQuality::FAIR;
+  return LinkQuality::POOR;
+}
+
+uint8_t UploadScheduler::drainBudget(unsigned long now, size_t queueDepth, size_t capacity) {
+  if (queueDepth == 0) return 0;
+
+  size_t budget;
+  switch (quality()) {
+    case LinkQuality::GOOD:
+      budget = policy.burstBatch;
+      break;
+    case LinkQuality::FAIR:
+      // Antrian menumpuk: batch digandakan supaya outbox tidak penuh
+      budget = queueDepth * 2 >= capacity ? policy.fairBatch * 2 : policy.fairBatch;
+      break;
+    case LinkQuality::POOR:
+    default: {
+      // Outbox >= 3/4 penuh: berhenti menunda. Timeout lebih murah daripada
+      // record yang dibuang karena outbox penuh, jadi kirim tiap kesempatan.
+      bool nearlyFull = queueDepth * 4 >= capacity * 3;
+      if (!nearlyFull && probed && now - lastProbe < policy.poorProbeInterval) return 0;
+      lastProbe = now;
+      probed = true;
+      budget = 1;
+      break;
+    }
+  }
+  return budget < queueDepth ? budget : queueDepth;
+}
+
+bool UploadScheduler::interactiveAllowed() const {
+  return quality() != LinkQuality::POOR || failRate < policy.interactiveMaxFailRate;
+}
@@ -0,0 +1,133 @@
+#include "wifi-roaming.h"
+#include <string.h>
+
+// ==================== LOGIKA ROAMING ====================
+
+void WifiRoaming::tick(unsigned long now, bool idle) {
+  if (!radio.isConnected()) {
+    // Saat reconnect biasa tidak perlu roaming, reset histori sampel
+    weak = false; weakSamples = 0; scanning = false;
+    return;
+  }
+
+  if (scanning) {
+    finishScan(now, idle);
+    return;
+  }
+
+  sampleRssi(now);
+
+  if (!weak || !idle) return;
+  if (hasScanned && now - lastScanTime < policy.scanInterval) return;
+  if (hasRoamed && now - lastRoamTime < policy.roamCooldown) return;
+
+  if (radio.startScan()) {
+    scanning = true; hasScanned = true;
+    lastScanTime = now; scans++;
+  }
+}
+
+void WifiRoaming::sampleRssi(unsigned long now) {
+  if (now - lastSampleTime < policy.sampleInterval) return;
+  lastSampleTime = now;
+  rssiSample = radio.rssi();
+
+  if (rssiSample < policy.weakRssi) {
+    if (weakSamples < policy.weakSamplesRequired) weakSamples++;
+    if (weakSamples >= policy.weakSamplesRequired) weak = true;
+  } else {
+    weakSamples = 0;
+    // Hysteresis: status lemah baru dilepas setelah naik jauh di atas ambang
+    if (rssiSample >= policy.weakRssi + policy.hysteresisDb) weak = false;
+  }
+}
+
+void WifiRoaming::finishScan(unsigned long now, bool idle) {
+  int count = radio.scanResult(candidates, MAX_CANDIDATES);
+  if (count < 0) return; // masih scan
+  scanning = false;
+
+  // Hasil scan dibuang jika penimbangan sedang berjalan; scan berikutnya
+  // menunggu scanInterval lagi sehingga tidak mengganggu operator.
+  if (!idle || count == 0) return;
+
+  const uint8_t* current = radio.bssid();
+  int32_t currentRssi = radio.rssi();
+  int best = -1;
+  for (int i = 0; i < count; i++) {
+    if (current && memcmp(candidates[i].bssid, current, 6) == 0) continue;
+    if (best < 0 || candidates[i].rssi > candidates[best].rssi) best = i;
+  }
+  if (best < 0) return;
+  if (candidates[best].rssi < currentRssi + policy.hysteresisDb) return;
+
+  radio.roamTo(candidates[best]);
+  hasRoamed = true; lastRoamTime = now; roams++;
+  weak = false; weakSamples = 0;
+}
+
+// ==================== RADIO ESP32 ====================
+#ifdef ARDUINO
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include "credentials.h"
+#include "async-log.h"
+
+// roamTo() mengunci BSSID di config STA. Setelah tersambung (atau AP tujuan
+// tidak menjawab) kunci dilepas, jika tidak WiFi.reconnect()/auto-reconnect
+// terus mencari AP itu walau sudah hilang.
+bool WifiStaRadio::isConnected() {
+  bool connected = WiFi.status() == WL_CONNECTED;
+  if (pinned && (connected || millis() - pinnedAt > PIN_TIMEOUT_MS) && unpinBssid() && !connected) {
+    LOG_W(NET, "⚠️ AP tujuan roaming tidak tersambung, BSSID dilepas");
+  }
+  return connected;
+}
+
+// Gagal (ESP_ERR_WIFI_STATE) selama driver masih connecting: dicoba lagi tick berikutnya
+bool WifiStaRadio::unpinBssid() {
+  wifi_config_t conf;
+  if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK) return false;
+  if (conf.sta.bssid_set) {
+    conf.sta.bssid_set = 0;
+    if (esp_wifi_set_config(WIFI_IF_STA, &conf) != ESP_OK) return false;
+  }
+  pinned = false;
+  return true;
+}
+
+int32_t WifiStaRadio::rssi() { return WiFi.RSSI(); }
+
+const uint8_t* WifiStaRadio::bssid() { return WiFi.BSSID(); }
+
+bool WifiStaRadio::startScan() {
+  // Async, aktif, 120 ms per kanal, hanya SSID kita
+  return WiFi.scanNetworks(true, false, false, 120, 0, WIFI_SSID) == WIFI_SCAN_RUNNING;
+}
+
+int WifiStaRadio::scanResult(ApInfo* out, int maxCount) {
+  int16_t n = WiFi.scanComplete();
+  if (n == WIFI_SCAN_RUNNING) return -1;
+  if (n < 0) return 0; // WIFI_SCAN_FAILED
+
+  int count = 0;
+  for (int i = 0; i < n && count < maxCount; i++) {
+    if (WiFi.SSID(i) != WIFI_SSID) continue;
+    memcpy(out[count].bssid, WiFi.BSSID(i), 6);
+    out[count].channel = WiFi.channel(i);
+    out[count].rssi = WiFi.RSSI(i);
+    count++;
+  }
+  WiFi.scanDelete();
+  return count;
+}
+
+void WifiStaRadio::roamTo(const ApInfo& ap) {
+  LOG_I(NET, "📶 Roaming ke %02X:%02X:%02X:%02X:%02X:%02X ch%d (%d dBm, sebelumnya %ld dBm)",
+        ap.bssid[0], ap.bssid[1], ap.bssid[2], ap.bssid[3], ap.bssid[4], ap.bssid[5],
+        (int)ap.channel, (int)ap.rssi, WiFi.RSSI());
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD, ap.channel, ap.bssid);
+  pinned = true;
+  pinnedAt = millis();
+}
+#endif
@@ -0,0 +1,409 @@
+#include "ws-server.h"
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+namespace {
+  const char* WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+  constexpr uint8_t OP_TEXT   = 0x1;
+  constexpr uint8_t OP_BINARY = 0x2;
+  constexpr uint8_t OP_CLOSE  = 0x8;
+  constexpr uint8_t OP_PING   = 0x9;
+  constexpr uint8_t OP_PONG   = 0xA;
+
+  // --- SHA-1 (hanya untuk handshake, bukan keamanan) ---
+  class Sha1 {
+  public:
+    void update(const uint8_t* data, size_t len) {
+      while (len--) {
+        block[blockLen++] = *data++;
+        total++;
+        if (blockLen == 64) { compress(); blockLen = 0; }
+      }
+    }
+    void finish(uint8_t out[20]) {
+      uint64_t bits = total * 8;
+      uint8_t pad = 0x80;
+      update(&pad, 1);
+      pad = 0;
+      while (blockLen != 56) update(&pad, 1);
+      for (int i = 7; i >= 0; i--) { uint8_t b = bits >> (i * 8); update(&b, 1); }
+      for (int i = 0; i < 5; i++) {
+        out[i * 4] = h[i] >> 24; out[i * 4 + 1] = h[i] >> 16;
+        out[i * 4 + 2] = h[i] >> 8; out[i * 4 + 3] = h[i];
+      }
+    }
+
+  private:
+    static uint32_t rol(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+    void compress() {
+      uint32_t w[80];
+      for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+      }
+      for (int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+      uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+      for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        uint32_t t = rol(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = rol(b, 30); b = a; a = t;
+      }
+      h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    uint8_t block[64];
+    size_t blockLen = 0;
+    uint64_t total = 0;
+  };
+
+  size_t base64Encode(const uint8_t* in, size_t len, char* out) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    for (size_t i = 0; i < len; i += 3) {
+      uint32_t v = (uint32_t)in[i] << 16;
+      if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+      if (i + 2 < len) v |= in[i + 2];
+      out[n++] = table[(v >> 18) & 0x3F];
+      out[n++] = table[(v >> 12) & 0x3F];
+      out[n++] = i + 1 < len ? table[(v >> 6) & 0x3F] : '=';
+      out[n++] = i + 2 < len ? table[v & 0x3F] : '=';
+    }
+    out[n] = '\0';
+    return n;
+  }
+
+  // Nilai header (case-insensitive), tanpa spasi di awal/akhir
+  bool findHeader(const char* req, const char* name, char* out, size_t outSize) {
+    size_t nameLen = strlen(name);
+    for (const char* line = strstr(req, "\r\n"); line && line[2]; line = strstr(line + 2, "\r\n")) {
+      const char* p = line + 2;
+      if (strncasecmp(p, name, nameLen) != 0 || p[nameLen] != ':') continue;
+      p += nameLen + 1;
+      while (*p == ' ' || *p == '\t') p++;
+      const char* end = strstr(p, "\r\n");
+      while (end > p && (end[-1] == ' ' || end[-1] == '\t')) end--;
+      size_t len = end - p;
+      if (len >= outSize) return false;
+      memcpy(out, p, len);
+      out[len] = '\0';
+      return true;
+    }
+    return false;
+  }
+
+  bool containsToken(const char* value, const char* token) {
+    size_t len = strlen(token);
+    for (const char* p = value; *p; p++) {
+      if (strncasecmp(p, token, len) == 0) return true;
+    }
+    return false;
+  }
+}
+
+bool wsAcceptKey(const char* clientKey, char* out, size_t outSize) {
+  if (outSize < 29) return false;
+  Sha1 sha;
+  sha.update((const uint8_t*)clientKey, strlen(clientKey));
+  sha.update((const uint8_t*)WS_GUID, strlen(WS_GUID));
+  uint8_t digest[20];
+  sha.finish(digest);
+  base64Encode(digest, sizeof(digest), out);
+  return true;
+}
+
+// ==================== LOOP ====================
+
+void WsServer::loop(unsigned long now) {
+  acceptClients(now);
+  for (int i = 0; i < MAX_CLIENTS; i++) {
+    Client& c = clients[i];
+    if (c.phase == Phase::FREE) continue;
+    if (c.phase == Phase::REQUEST || c.phase == Phase::WEBSOCKET) readClient(c, now);
+    if (c.phase != Phase::FREE) flushClient(c, now);
+  }
+}
+
+void WsServer::acceptClients(unsigned long now) {
+  for (;;) {
+    int handle = listener.accept();
+    if (handle < 0) return;
+    Client* slot = nullptr;
+    for (int i = 0; i < MAX_CLIENTS && !slot; i++) {
+      if (clients[i].phase == Phase::FREE) slot = &clients[i];
+    }
+    if (!slot) {
+      static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+      listener.write(handle, (const uint8_t*)busy, sizeof(busy) - 1);
+      listener.close(handle);
+      continue;
+    }
+    slot->phase = Phase::REQUEST;
+    slot->handle = handle;
+    slot->since = now;
+    slot->pageSent = 0;
+    slot->rxLen = 0;
+    slot->txLen = 0;
+  }
+}
+
+void WsServer::readClient(Client& c, unsigned long now) {
+  if (c.phase == Phase::REQUEST && now - c.since > REQUEST_TIMEOUT) { drop(c); return; }
+
+  int n = listener.read(c.handle, c.rx + c.rxLen, RX_BUFFER_SIZE - 1 - c.rxLen);
+  if (n < 0) { drop(c); return; }
+  if (n == 0) return;
+  c.rxLen += n;
+
+  if (c.phase == Phase::REQUEST) handleRequest(c, now);
+  else handleFrames(c);
+}
+
+void WsServer::handleRequest(Client& c, unsigned long now) {
+  c.rx[c.rxLen] = '\0';
+  char* req = (char*)c.rx;
+  char* headerEnd = strstr(req, "\r\n\r\n");
+  if (!headerEnd) {
+    if (c.rxLen >= RX_BUFFER_SIZE - 1) drop(c);  // request terlalu besar
+    return;
+  }
+  headerEnd[2] = '\0';  // potong setelah CRLF baris terakhir
+
+  char path[32] = "";
+  bool isGet = strncmp(req, "GET ", 4) == 0;
+  if (isGet) {
+    const char* p = req + 4;
+    size_t len = strcspn(p, " ?\r\n");
+    if (len < sizeof(path)) { memcpy(path, p, len); path[len] = '\0'; }
+  }
+
+  char key[32], upgrade[32], version[8];
+  if (isGet && strcmp(path, "/ws") == 0 &&
+      findHeader(req, "Upgrade", upgrade, sizeof(upgrade)) && containsToken(upgrade, "websocket") &&
+      findHeader(req, "Sec-WebSocket-Key", key, sizeof(key)) &&
+      findHeader(req, "Sec-WebSocket-Version", version, sizeof(version)) && strcmp(version, "13") == 0) {
+    char accept[32];
+    wsAcceptKey(key, accept, sizeof(accept));
+    char resp[160];
+    int len = snprintf(resp, sizeof(resp),
+                       "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+    queue(c, (const uint8_t*)resp, len);
+    c.phase = Phase::WEBSOCKET;
+    c.since = now;
+    counters.handshakes++;
+    // Frame yang ikut terbaca bersama request diproses sebagai frame
+    size_t consumed = (uint8_t*)headerEnd + 4 - c.rx;
+    memmove(c.rx, c.rx + consumed, c.rxLen - consumed);
+    c.rxLen -= consumed;
+    if (c.rxLen) handleFrames(c);
+    return;
+  }
+
+  char resp[160];
+  int len;
+  if (isGet && strcmp(path, "/") == 0 && page) {
+    len = snprintf(resp, sizeof(resp),
+                   "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\n"
+                   "Content-Length: %u\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n",
+                   (unsigned)pageLen);
+    c.phase = Phase::PAGE;
+  } else {
+    len = snprintf(resp, sizeof(resp), "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                   isGet ? "404 Not Found" : "405 Method Not Allowed");
+    c.phase = Phase::CLOSING;
+  }
+  queue(c, (const uint8_t*)resp, len);
+  c.since = now;
+  c.rxLen = 0;
+}
+
+// Frame dari browser selalu di-mask. Hanya close dan ping yang ditanggapi;
+// data dari klien diabaikan (live view satu arah).
+void WsServer::handleFrames(Client& c) {
+  while (c.phase == Phase::WEBSOCKET && c.rxLen >= 2) {
+    uint8_t opcode = c.rx[0] & 0x0F;
+    bool masked = c.rx[1] & 0x80;
+    size_t len = c.rx[1] & 0x7F;
+    size_t header = 2;
+    if (len == 126) {
+      if (c.rxLen < 4) return;
+      len = (size_t)c.rx[2] << 8 | c.rx[3];
+      header = 4;
+    } else if (len == 127 || !masked) {
+      drop(c);
+      return;
+    }
+    if (header + 4 + len > RX_BUFFER_SIZE - 1) { drop(c); return; }
+    if (c.rxLen < header + 4 + len) return;
+
+    uint8_t* mask = c.rx + header;
+    uint8_t* payload = mask + 4;
+    for (size_t i = 0; i < len; i++) payload[i] ^= mask[i & 3];
+
+    if (opcode == OP_CLOSE) {
+      queueFrame(c, OP_CLOSE, payload, len >= 2 ? 2 : 0);
+      c.phase = Phase::CLOSING;
+    } else if (opcode == OP_PING) {
+      queueFrame(c, OP_PONG, payload, len);
+    }
+
+    size_t consumed = header + 4 + len;
+    memmove(c.rx, c.rx + consumed, c.rxLen - consumed);
+    c.rxLen -= consumed;
+  }
+}
+
+void WsServer::flushClient(Client& c, unsigned long now) {
+  if (c.txLen > 0) {
+    int n = listener.write(c.handle, c.tx, c.txLen);
+    if (n < 0) { drop(c); return; }
+    if (n > 0) {
+      memmove(c.tx, c.tx + n, c.txLen - n);
+      c.txLen -= n;
+      c.since = now;
+    }
+  }
+
+  if (c.phase == Phase::PAGE && c.txLen == 0) {
+    if (c.pageSent < pageLen) {
+      int n = listener.write(c.handle, (const uint8_t*)page + c.pageSent, pageLen - c.pageSent);
+      if (n < 0) { drop(c); return; }
+      if (n > 0) { c.pageSent += n; c.since = now; }
+    }
+    if (c.pageSent >= pageLen) c.phase = Phase::CLOSING;
+  }
+
+  if (c.txLen == 0) {
+    if (c.phase == Phase::CLOSING) { drop(c); return; }
+    if (c.phase == Phase::WEBSOCKET) c.since = now;
+  }
+  if ((c.phase == Phase::WEBSOCKET || c.phase == Phase::PAGE || c.phase == Phase::CLOSING) &&
+      now - c.since > STALL_TIMEOUT) {
+    counters.stalledClosed++;
+    drop(c);
+  }
+}
+
+// ==================== TX ====================
+
+bool WsServer::queue(Client& c, const uint8_t* data, size_t len) {
+  if (c.txLen + len > TX_BUFFER_SIZE) return false;
+  memcpy(c.tx + c.txLen, data, len);
+  c.txLen += len;
+  return true;
+}
+
+// Frame server tidak di-mask. Ditulis utuh atau tidak sama sekali.
+bool WsServer::queueFrame(Client& c, uint8_t opcode, const uint8_t* payload, size_t len) {
+  if (len > 0xFFFF) return false;
+  uint8_t header[4];
+  size_t headerLen = 2;
+  header[0] = 0x80 | opcode;
+  if (len < 126) {
+    header[1] = len;
+  } else {
+    header[1] = 126; header[2] = len >> 8; header[3] = len & 0xFF;
+    headerLen = 4;
+  }
+  if (c.txLen + headerLen + len > TX_BUFFER_SIZE) return false;
+  queue(c, header, headerLen);
+  queue(c, payload, len);
+  return true;
+}
+
+int WsServer::broadcastBinary(const uint8_t* data, size_t len) {
+  int delivered = 0;
+  for (int i = 0; i < MAX_CLIENTS; i++) {
+    Client& c = clients[i];
+    if (c.phase != Phase::WEBSOCKET) continue;
+    if (queueFrame(c, OP_BINARY, data, len)) { delivered++; counters.framesSent++; }
+    else counters.framesDropped++;
+  }
+  return delivered;
+}
+
+void WsServer::drop(Client& c) {
+  listener.close(c.handle);
+  c.phase = Phase::FREE;
+  c.handle = -1;
+  c.txLen = 0;
+  c.rxLen = 0;
+}
+
+void WsServer::closeAll() {
+  for (int i = 0; i < MAX_CLIENTS; i++) {
+    if (clients[i].phase != Phase::FREE) drop(clients[i]);
+  }
+}
+
+int WsServer::clientCount() const {
+  int n = 0;
+  for (int i = 0; i < MAX_CLIENTS; i++) if (clients[i].phase == Phase::WEBSOCKET) n++;
+  return n;
+}
+
+// ==================== LISTENER lwIP ====================
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <errno.h>
+
+bool LwipWsListener::begin(uint16_t port) {
+  end();
+  fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return false;
+  int yes = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0 || listen(fd, 2) < 0) {
+    end();
+    return false;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  return true;
+}
+
+void LwipWsListener::end() {
+  if (fd >= 0) ::close(fd);
+  fd = -1;
+}
+
+int LwipWsListener::accept() {
+  if (fd < 0) return -1;
+  int client = ::accept(fd, nullptr, nullptr);
+  if (client < 0) return -1;
+  fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+  int yes = 1;
+  setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+  return client;
+}
+
+int LwipWsListener::write(int handle, const uint8_t* data, size_t len) {
+  int n = send(handle, data, len, 0);
+  if (n >= 0) return n;
+  return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+int LwipWsListener::read(int handle, uint8_t* buf, size_t len) {
+  if (len == 0) return 0;
+  int n = recv(handle, buf, len, 0);
+  if (n > 0) return n;
+  if (n == 0) return -1;
+  return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+void LwipWsListener::close(int handle) {
+  ::close(handle);
+}
+#endif
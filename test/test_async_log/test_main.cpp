@@ -0,0 +1,259 @@
+// AsyncLog di host: format baris, level per modul, ring penuh (dibuang +
+// dihitung, pemanggil tidak menunggu), wrap ring, dan stress 3 produsen
+// (thread) + 1 konsumen. UART 115200 baud dimodelkan sebagai sink dengan
+// budget byte per tick pada jam virtual.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "async-log.h"
+
+namespace {
+uint32_t nowMs = 12345;
+uint32_t virtualClock() { return nowMs; }
+
+struct StringSink : LogSink {
+  std::string out;
+  size_t write(const uint8_t* data, size_t len) override {
+    out.append((const char*)data, len);
+    return len;
+  }
+};
+
+// UART: 10 bit per byte, byte yang sudah ditulis menghabiskan budget
+struct UartSink : LogSink {
+  int32_t budget = 0;
+  uint32_t bytes = 0;
+  size_t write(const uint8_t* data, size_t len) override {
+    budget -= (int32_t)len;
+    bytes += len;
+    return len;
+  }
+};
+
+std::vector<std::string> splitLines(const std::string& s) {
+  std::vector<std::string> lines;
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t end = s.find('\n', pos);
+    if (end == std::string::npos) end = s.size();
+    lines.push_back(s.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  return lines;
+}
+
+const char* PAD = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx";
+}
+
+AsyncLog logger(virtualClock);
+
+void setUp() {
+  StringSink discard;
+  logger.drain(discard);
+  logger.setLevelAll(LogLevel::INFO);
+  nowMs = 12345;
+}
+void tearDown() {}
+
+void test_line_format_and_module_levels() {
+  StringSink sink;
+  LOG_I(NET, "halo %d", 1);
+  LOG_D(NET, "tidak tampil %d", 2);   // di atas LOG_MAX_LEVEL: tidak dikompilasi
+  logger.setLevel(LogModule::MQTT, LogLevel::WARN);
+  LOG_I(MQTT, "payload %s", "{}");
+  LOG_W(MQTT, "putus rc=%d", -2);
+  nowMs = 7;
+  LOG_E(SCALE, "HX711 %s", "timeout");
+  logger.drain(sink);
+  TEST_ASSERT_EQUAL_STRING(
+      "[12.345] I net: halo 1\n"
+      "[12.345] W mqtt: putus rc=-2\n"
+      "[0.007] E scale: HX711 timeout\n",
+      sink.out.c_str());
+  TEST_ASSERT_FALSE(logger.enabled(LogModule::MQTT, LogLevel::INFO));
+  TEST_ASSERT_TRUE(logger.enabled(LogModule::NET, LogLevel::INFO));
+  TEST_ASSERT_FALSE(logger.drainOne(sink));
+}
+
+void test_full_ring_drops_and_reports() {
+  LogStats before = logger.stats();
+  StringSink sink;
+  uint32_t attempts = 0;
+  // Tanpa konsumen: ring penuh, sisanya dibuang tanpa menunggu
+  for (int i = 0; i < 200; i++, attempts++) LOG_I(HTTP, "body %03d %s%s", i, PAD, PAD);
+  LogStats full = logger.stats();
+  uint32_t kept = full.lines - before.lines;
+  uint32_t dropped = full.dropped - before.dropped;
+  TEST_ASSERT_EQUAL_UINT32(attempts, kept + dropped);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, dropped);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(AsyncLog::RING_SIZE, full.highWater);
+  TEST_ASSERT_GREATER_THAN_UINT32(AsyncLog::RING_SIZE - 128, full.highWater);
+
+  logger.drain(sink);
+  std::vector<std::string> lines = splitLines(sink.out);
+  TEST_ASSERT_EQUAL_UINT32(kept + 1, lines.size());
+  // Yang tersimpan adalah yang paling awal, urut
+  TEST_ASSERT_EQUAL_STRING_LEN("[12.345] I http: body 000 ", lines[0].c_str(), 26);
+  char notice[64];
+  snprintf(notice, sizeof(notice), "[12.345] W log: %u baris dibuang (ring penuh)", (unsigned)dropped);
+  TEST_ASSERT_EQUAL_STRING(notice, lines.back().c_str());
+
+  // Pemberitahuan hanya sekali
+  sink.out.clear();
+  logger.drain(sink);
+  TEST_ASSERT_EQUAL_UINT32(0, sink.out.size());
+}
+
+void test_long_line_truncated() {
+  StringSink sink;
+  uint32_t before = logger.stats().truncated;
+  std::string big(400, 'y');
+  LOG_E(SYS, "%s", big.c_str());
+  logger.drain(sink);
+  TEST_ASSERT_EQUAL_UINT32(AsyncLog::LINE_MAX - 1, sink.out.size());
+  TEST_ASSERT_EQUAL_UINT8('\n', (uint8_t)sink.out.back());
+  TEST_ASSERT_EQUAL_UINT32(before + 1, logger.stats().truncated);
+}
+
+void test_lines_intact_across_ring_wrap() {
+  StringSink sink;
+  // Panjang bervariasi supaya batas ring jatuh di header maupun isi baris
+  for (int i = 0; i < 2000; i++) {
+    LOG_I(SCALE, "sampel %d %.*s", i, i % 37, PAD);
+    if (i % 5 == 4) logger.drain(sink);
+  }
+  logger.drain(sink);
+  std::vector<std::string> lines = splitLines(sink.out);
+  TEST_ASSERT_EQUAL_UINT32(2000, lines.size());
+  for (int i = 0; i < 2000; i++) {
+    char expect[96];
+    snprintf(expect, sizeof(expect), "[12.345] I scale: sampel %d %.*s", i, i % 37, PAD);
+    TEST_ASSERT_EQUAL_STRING(expect, lines[i].c_str());
+  }
+}
+
+void test_three_producers_one_consumer() {
+  constexpr int PRODUCERS = 3;
+  constexpr int PER_PRODUCER = 20000;
+  StringSink sink;
+  LogStats before = logger.stats();
+  std::atomic<bool> stop{false};
+
+  std::thread consumer([&] {
+    while (!stop.load()) {
+      if (!logger.drainOne(sink)) std::this_thread::yield();
+    }
+  });
+  std::vector<std::thread> producers;
+  for (int t = 0; t < PRODUCERS; t++) {
+    producers.emplace_back([t] {
+      for (int i = 0; i < PER_PRODUCER; i++) {
+        LOG_W(MQTT, "t%d i%d %s", t, i, PAD);
+        if (i % 32 == 31) std::this_thread::yield();   // burst > laju konsumen: sebagian dibuang
+      }
+    });
+  }
+  for (std::thread& p : producers) p.join();
+  stop.store(true);
+  consumer.join();
+  logger.drain(sink);
+
+  LogStats after = logger.stats();
+  uint32_t kept = after.lines - before.lines;
+  uint32_t dropped = after.dropped - before.dropped;
+  TEST_ASSERT_EQUAL_UINT32(PRODUCERS * PER_PRODUCER, kept + dropped);
+
+  // Setiap baris utuh, tidak tercampur; urutan per produsen terjaga
+  int last[PRODUCERS] = { -1, -1, -1 };
+  uint32_t received = 0, notices = 0, reportedDrops = 0;
+  for (const std::string& line : splitLines(sink.out)) {
+    unsigned n = 0;
+    if (sscanf(line.c_str(), "[12.345] W log: %u baris dibuang", &n) == 1) {
+      notices++;
+      reportedDrops += n;
+      continue;
+    }
+    int t = -1, i = -1;
+    char pad[64] = {};
+    int fields = sscanf(line.c_str(), "[12.345] W mqtt: t%d i%d %63s", &t, &i, pad);
+    if (fields != 3 || t < 0 || t >= PRODUCERS || strcmp(pad, PAD) != 0) {
+      TEST_FAIL_MESSAGE(line.c_str());
+      return;
+    }
+    TEST_ASSERT_GREATER_THAN_INT32(last[t], i);
+    last[t] = i;
+    received++;
+  }
+  printf("  3 produsen x %d baris: %u diterima, %u dibuang (%u pemberitahuan), high water %u B\n",
+         PER_PRODUCER, (unsigned)received, (unsigned)dropped, (unsigned)notices,
+         (unsigned)after.highWater);
+  TEST_ASSERT_EQUAL_UINT32(kept, received);
+  TEST_ASSERT_EQUAL_UINT32(dropped, reportedDrops);
+}
+
+void test_uart_burst_never_stalls_acquisition() {
+  // 80 SPS dengan satu baris per sampel (statistik.cpp lama) dan tiap 5 s
+  // satu body POST ~330 byte. UART 115200 baud = 11.52 byte/ms.
+  const double BYTES_PER_MS = 11.52;
+  UartSink uart;
+  LogStats before = logger.stats();
+  uint32_t samples = 0;
+  for (nowMs = 0; nowMs < 60000; nowMs++) {
+    if (nowMs % 12 == 0) {
+      LOG_I(SCALE, "sampel %u raw=%ld berat=%.3f", (unsigned)samples, 8388000L + (long)(samples % 97), 1.25);
+      samples++;
+    }
+    if (nowMs % 5000 == 0) {
+      LOG_I(HTTP, "POST berat=%.2f&fakultas=%s&jenis=%s %s%s%s%s%s%s%s", 1.23, "ft", "Organik",
+            PAD, PAD, PAD, PAD, PAD, PAD, PAD);
+    }
+    // Konsumen: kirim selama budget UART tick ini masih ada
+    uart.budget += (nowMs % 2 == 0) ? 12 : 11;
+    while (uart.budget > 0 && logger.drainOne(uart)) {}
+    if (uart.budget > 0) uart.budget = 0;   // UART idle tidak menabung
+  }
+  logger.drain(uart);
+  LogStats after = logger.stats();
+
+  // Serial.println sinkron dengan trafik yang sama: pemanggil menunggu
+  // sampai sisa baris muat di FIFO 128 byte
+  double uartFreeAt = 0, blockedMs = 0, worstStallMs = 0;
+  const size_t SAMPLE_LINE = 53, POST_LINE = 332;   // panjang baris di atas
+  for (uint32_t t = 0; t < 60000; t++) {
+    size_t len = 0;
+    if (t % 12 == 0) len += SAMPLE_LINE;
+    if (t % 5000 == 0) len += POST_LINE;
+    if (len == 0) continue;
+    double start = uartFreeAt > t ? uartFreeAt : t;
+    uartFreeAt = start + len / BYTES_PER_MS;
+    double stall = uartFreeAt - 128 / BYTES_PER_MS - t;
+    if (stall > 0) {
+      blockedMs += stall;
+      if (stall > worstStallMs) worstStallMs = stall;
+    }
+  }
+
+  printf("  async         : %u baris, %u dibuang, %u byte UART, loop tidak pernah menunggu\n",
+         (unsigned)(after.lines - before.lines), (unsigned)(after.dropped - before.dropped),
+         (unsigned)uart.bytes);
+  printf("  Serial.println: loop tertahan total %.0f ms, terlama %.1f ms (periode sampel 12 ms)\n",
+         blockedMs, worstStallMs);
+  TEST_ASSERT_EQUAL_UINT32(samples + 12, after.lines - before.lines);
+  TEST_ASSERT_EQUAL_UINT32(0, after.dropped - before.dropped);
+  TEST_ASSERT_GREATER_THAN_FLOAT(12.0, worstStallMs);   // satu sampel HX711 terlewat
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_line_format_and_module_levels);
+  RUN_TEST(test_full_ring_drops_and_reports);
+  RUN_TEST(test_long_line_truncated);
+  RUN_TEST(test_lines_intact_across_ring_wrap);
+  RUN_TEST(test_three_producers_one_consumer);
+  RUN_TEST(test_uart_burst_never_stalls_acquisition);
+  return UNITY_END();
+}
@@ -0,0 +1,199 @@
+// ButtonEvents di host: tepi dengan timestamp disuntik lewat onEdge() seperti
+// ISR, update()/next() dipanggil dengan jam virtual (us). Level pin untuk
+// sinkron ulang setelah antrian tepi penuh dibaca dari array.
+#include <unity.h>
+#include <stdio.h>
+#include <vector>
+#include "button-events.h"
+
+namespace {
+const uint32_t MS = 1000;
+
+bool levels[ButtonEvents::MAX_BUTTONS];
+bool readLevel(uint8_t button) { return levels[button]; }
+
+// Tepi tekan/lepas dengan bouncing: level berganti `bounces` kali tiap
+// 300 us sebelum menetap
+void bouncyEdge(ButtonEvents& b, uint8_t button, bool pressed, uint32_t at, int bounces) {
+  for (int i = 0; i < bounces; i++) b.onEdge(button, i % 2 == 0 ? pressed : !pressed, at + i * 300);
+  b.onEdge(button, pressed, at + bounces * 300);
+  levels[button] = pressed;
+}
+
+void click(ButtonEvents& b, uint8_t button, uint32_t at, uint32_t holdUs = 80 * MS) {
+  bouncyEdge(b, button, true, at, 4);
+  bouncyEdge(b, button, false, at + holdUs, 4);
+}
+
+// Jalankan update() tiap 1 ms pada [from, to)
+void run(ButtonEvents& b, uint32_t from, uint32_t to) {
+  for (uint32_t t = from; t < to; t += MS) b.update(t);
+}
+
+std::vector<ButtonEvent> drain(ButtonEvents& b, uint32_t nowUs) {
+  std::vector<ButtonEvent> out;
+  ButtonEvent ev;
+  while (b.next(ev, nowUs)) out.push_back(ev);
+  return out;
+}
+}
+
+void setUp() {
+  for (bool& l : levels) l = false;
+}
+void tearDown() {}
+
+void test_bounce_collapses_to_one_press() {
+  ButtonEvents b;
+  b.begin(2, readLevel, 0);
+  click(b, 0, 100 * MS);
+  run(b, 100 * MS, 300 * MS);
+  std::vector<ButtonEvent> ev = drain(b, 300 * MS);
+  TEST_ASSERT_EQUAL_UINT32(1, ev.size());
+  TEST_ASSERT_EQUAL_UINT8(0, ev[0].button);
+  TEST_ASSERT_TRUE(ev[0].type == ButtonEventType::PRESS);
+  // Waktu = tepi pertama, sebelum bouncing
+  TEST_ASSERT_EQUAL_UINT32(100 * MS, ev[0].at);
+  TEST_ASSERT_EQUAL_UINT32(10, b.stats().edges);
+  TEST_ASSERT_EQUAL_UINT32(1, b.stats().events);
+
+  // Gangguan lebih pendek dari debounce yang kembali ke level semula: tidak ada event
+  b.onEdge(1, true, 400 * MS);
+  b.onEdge(1, false, 400 * MS + 5 * MS);
+  run(b, 400 * MS, 500 * MS);
+  TEST_ASSERT_FALSE(b.pending());
+  TEST_ASSERT_EQUAL_UINT32(1, b.stats().events);
+}
+
+void test_double_and_long_press() {
+  ButtonEvents b;
+  b.begin(1, readLevel, 0);
+  // Dua klik 200 ms terpisah = PRESS + DOUBLE; klik ketiga memulai pasangan baru
+  // (klik ke-4 700 ms kemudian: di luar jendela double)
+  const uint32_t clicks[] = { 100, 300, 500, 1200, 2000 };
+  for (int i = 0; i < 4; i++) {
+    click(b, 0, clicks[i] * MS);
+    run(b, clicks[i] * MS, clicks[i + 1] * MS);
+  }
+  std::vector<ButtonEvent> ev = drain(b, 2000 * MS);
+  TEST_ASSERT_EQUAL_UINT32(4, ev.size());
+  TEST_ASSERT_TRUE(ev[0].type == ButtonEventType::PRESS);
+  TEST_ASSERT_TRUE(ev[1].type == ButtonEventType::DOUBLE);
+  TEST_ASSERT_EQUAL_UINT32(300 * MS, ev[1].at);
+  TEST_ASSERT_TRUE(ev[2].type == ButtonEventType::PRESS);
+  TEST_ASSERT_TRUE(ev[3].type == ButtonEventType::PRESS);
+
+  // Ditahan 1.5 s: PRESS lalu LONG tepat longPressUs setelah tepi pertama, sekali
+  bouncyEdge(b, 0, true, 3000 * MS, 6);
+  run(b, 3000 * MS, 4500 * MS);
+  bouncyEdge(b, 0, false, 4500 * MS, 6);
+  run(b, 4500 * MS, 5000 * MS);
+  ev = drain(b, 5000 * MS);
+  TEST_ASSERT_EQUAL_UINT32(2, ev.size());
+  TEST_ASSERT_TRUE(ev[0].type == ButtonEventType::PRESS);
+  TEST_ASSERT_TRUE(ev[1].type == ButtonEventType::LONG);
+  TEST_ASSERT_EQUAL_UINT32(4000 * MS, ev[1].at);
+
+  // Sudah ditahan saat boot: bukan long-press
+  levels[0] = true;
+  ButtonEvents boot;
+  boot.begin(1, readLevel, 0);
+  run(boot, 0, 2000 * MS);
+  TEST_ASSERT_FALSE(boot.pending());
+}
+
+void test_press_during_stalled_loop_keeps_physical_time() {
+  ButtonEvents b;
+  b.begin(1, readLevel, 0);
+  // loop() tertahan 800 ms (HTTP POST); ISR tetap mencatat
+  click(b, 0, 150 * MS);
+  run(b, 900 * MS, 920 * MS);
+  ButtonEvent ev;
+  TEST_ASSERT_TRUE(b.next(ev, 920 * MS));
+  TEST_ASSERT_EQUAL_UINT32(150 * MS, ev.at);
+  TEST_ASSERT_EQUAL_UINT32(1, b.stats().handled);
+  TEST_ASSERT_EQUAL_UINT32(770 * MS, b.stats().latencyMaxUs);
+  TEST_ASSERT_EQUAL_UINT32(770 * MS, (uint32_t)b.stats().latencyTotalUs);
+}
+
+void test_edge_queue_overflow_resyncs_from_pin() {
+  ButtonEvents b;
+  b.begin(1, readLevel, 0);
+  // 40 tepi tanpa update(): 32 masuk antrian, 8 dibuang
+  for (int i = 0; i < 40; i++) b.onEdge(0, i % 2 == 0, 100 * MS + i * 200);
+  TEST_ASSERT_EQUAL_UINT32(40 - ButtonEvents::EDGE_QUEUE, b.stats().edgesDropped);
+  // Tepi terakhir yang masuk antrian = lepas, tapi tombol sebenarnya ditekan
+  levels[0] = true;
+  run(b, 110 * MS, 200 * MS);
+  TEST_ASSERT_EQUAL_UINT32(ButtonEvents::EDGE_QUEUE, b.stats().edges);
+  std::vector<ButtonEvent> ev = drain(b, 200 * MS);
+  TEST_ASSERT_EQUAL_UINT32(1, ev.size());
+  TEST_ASSERT_TRUE(ev[0].type == ButtonEventType::PRESS);
+  TEST_ASSERT_EQUAL_UINT32(100 * MS, ev[0].at);
+
+  // Setelah sinkron ulang, tepi lepas berikutnya diproses normal
+  bouncyEdge(b, 0, false, 300 * MS, 2);
+  click(b, 0, 900 * MS);
+  run(b, 300 * MS, 1100 * MS);
+  ev = drain(b, 1100 * MS);
+  TEST_ASSERT_EQUAL_UINT32(1, ev.size());
+  TEST_ASSERT_EQUAL_UINT32(900 * MS, ev[0].at);
+}
+
+void test_event_queue_overflow_and_stale_drop() {
+  ButtonEvents b;
+  b.begin(1, readLevel, 0);
+  // 20 klik (500 ms terpisah, tidak ada double) tanpa next(): antrian event 16
+  for (int i = 0; i < 20; i++) {
+    click(b, 0, (100 + i * 500) * MS);
+    run(b, (100 + i * 500) * MS, (600 + i * 500) * MS);
+  }
+  const ButtonStats& s = b.stats();
+  TEST_ASSERT_EQUAL_UINT32(ButtonEvents::EVENT_QUEUE, s.events);
+  TEST_ASSERT_EQUAL_UINT32(20 - ButtonEvents::EVENT_QUEUE, s.eventsDropped);
+
+  // Diambil pada 9 s: klik lebih tua dari 3 s dibuang sebagai stale
+  uint32_t now = 9000 * MS;
+  std::vector<ButtonEvent> ev = drain(b, now);
+  uint32_t expectFresh = 0;
+  for (int i = 0; i < ButtonEvents::EVENT_QUEUE; i++) {
+    if (now - (100 + i * 500) * MS <= 3000 * MS) expectFresh++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(expectFresh, ev.size());
+  TEST_ASSERT_EQUAL_UINT32(ButtonEvents::EVENT_QUEUE - expectFresh, s.stale);
+  TEST_ASSERT_EQUAL_UINT32(expectFresh, s.handled);
+  for (const ButtonEvent& e : ev) TEST_ASSERT_LESS_OR_EQUAL_UINT32(3000 * MS, now - e.at);
+  TEST_ASSERT_EQUAL_UINT32(now - ev.front().at, s.latencyMaxUs);
+
+  printf("  20 klik tanpa next(): %u event, %u dibuang (antrian penuh), %u stale, "
+         "%u diambil, latensi maks %u ms, rata-rata %u ms\n",
+         (unsigned)s.events, (unsigned)s.eventsDropped, (unsigned)s.stale, (unsigned)s.handled,
+         (unsigned)(s.latencyMaxUs / MS), (unsigned)(s.latencyTotalUs / s.handled / MS));
+}
+
+void test_buttons_independent_and_out_of_range_ignored() {
+  ButtonEvents b;
+  b.begin(2, readLevel, 0);
+  // Tombol 0 dan 1 ditekan bergantian dalam jendela double: bukan DOUBLE
+  click(b, 0, 100 * MS);
+  click(b, 1, 200 * MS);
+  b.onEdge(3, true, 250 * MS);   // di luar count: diabaikan
+  run(b, 100 * MS, 500 * MS);
+  std::vector<ButtonEvent> ev = drain(b, 500 * MS);
+  TEST_ASSERT_EQUAL_UINT32(2, ev.size());
+  TEST_ASSERT_EQUAL_UINT8(0, ev[0].button);
+  TEST_ASSERT_EQUAL_UINT8(1, ev[1].button);
+  TEST_ASSERT_TRUE(ev[1].type == ButtonEventType::PRESS);
+  TEST_ASSERT_EQUAL_UINT32(20, b.stats().edges);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bounce_collapses_to_one_press);
+  RUN_TEST(test_double_and_long_press);
+  RUN_TEST(test_press_during_stalled_loop_keeps_physical_time);
+  RUN_TEST(test_edge_queue_overflow_resyncs_from_pin);
+  RUN_TEST(test_event_queue_overflow_and_stale_drop);
+  RUN_TEST(test_buttons_independent_and_out_of_range_ignored);
+  return UNITY_END();
+}
@@ -0,0 +1,554 @@
+// CoapUploader di host lewat link UDP palsu pada jam virtual. Sisi server
+// meniru tools/coap-receiver.cpp: cek tag HMAC, rakit Block1, jawab ulang
+// retransmisi dari cache. Link bisa membuang datagram tertentu atau acak,
+// menunda per arah, dan membalas dengan separate response.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include "coap-lite.h"
+#include "hmac-sha256.h"
+#include "http-lite.h"
+
+namespace {
+const char* DEVICE = "ecoscale-a1b2c3";
+const char* PSK = "psk-situs-tembalang";
+const char* RECORD =
+    "berat=1.25&fakultas=FT&jenis=Organik&device_id=ecoscale-a1b2c3&seq=42"
+    "&idempotency_key=ecoscale-a1b2c3-42&waktu=2026-10-18T09:15:02%2B07:00";
+
+uint32_t nowMs = 0;
+
+uint32_t xorshift(uint32_t& s) {
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+struct Datagram {
+  uint32_t at;
+  std::vector<uint8_t> data;
+};
+
+class FakeLink : public CoapTransport {
+public:
+  std::string serverPsk = PSK;
+  uint32_t minDelayMs = 40;        // satu arah
+  uint32_t jitterMs = 0;
+  uint32_t lossPermille = 0;       // acak per datagram, dua arah
+  uint32_t rng = 0x1234567;
+  std::vector<size_t> dropRequests; // indeks datagram dari client yang hilang
+  bool separate = false;           // empty ACK dulu, response CON menyusul
+
+  uint32_t opens = 0;
+  std::vector<uint32_t> sendTimes;
+  std::vector<std::vector<uint8_t>> sent;
+  std::vector<std::string> ingested;
+  std::vector<uint8_t> codes;      // kode response yang dikirim server
+  uint32_t clientAcks = 0;
+
+  bool open(const char*, uint16_t) override { opens++; return true; }
+  bool send(const uint8_t* data, size_t len) override {
+    size_t index = sent.size();
+    sent.push_back(std::vector<uint8_t>(data, data + len));
+    sendTimes.push_back(nowMs);
+    if (std::find(dropRequests.begin(), dropRequests.end(), index) != dropRequests.end()) return true;
+    if (lost()) return true;
+
+    CoapMessage msg;
+    if (!msg.parse(data, len)) return true;
+    if (msg.type == CoapType::ACK) { clientAcks++; return true; }
+    uint32_t arrive = nowMs + delay();
+
+    std::vector<uint8_t> response;
+    if (msg.messageId == lastMessageId && !lastResponse.empty()) {
+      response = lastResponse;   // retransmisi: ACK kita hilang
+    } else {
+      response = handle(msg);
+      lastMessageId = msg.messageId;
+      lastResponse = response;
+    }
+    if (separate) {
+      std::vector<uint8_t> empty(4);
+      CoapWriter w(empty.data(), empty.size());
+      w.header(CoapType::ACK, CoapCode::EMPTY, msg.messageId, nullptr, 0);
+      deliver(arrive, empty);
+      response[0] = (uint8_t)((response[0] & 0xCF) | ((uint8_t)CoapType::CON << 4));
+      response[2] = 0x7E;   // message id milik server
+      deliver(arrive + 300, response);
+    } else {
+      deliver(arrive, response);
+    }
+    return true;
+  }
+  int receive(uint8_t* buf, size_t cap) override {
+    if (toClient.empty() || (int32_t)(nowMs - toClient.front().at) < 0) return 0;
+    Datagram d = toClient.front();
+    toClient.pop_front();
+    size_t n = d.data.size() < cap ? d.data.size() : cap;
+    memcpy(buf, d.data.data(), n);
+    return (int)n;
+  }
+
+  // Ukuran Block1 dari datagram client ke-i
+  uint32_t block1Of(size_t i) const {
+    CoapMessage msg;
+    msg.parse(sent[i].data(), sent[i].size());
+    return msg.optionUint(CoapOption::BLOCK1, 0xFFFFFFFF);
+  }
+
+private:
+  std::deque<Datagram> toClient;
+  std::string assembling;
+  uint32_t nextBlock = 0;
+  uint16_t lastMessageId = 0;
+  std::vector<uint8_t> lastResponse;
+
+  bool lost() { return lossPermille && xorshift(rng) % 1000 < lossPermille; }
+  uint32_t delay() { return minDelayMs + (jitterMs ? xorshift(rng) % (jitterMs + 1) : 0); }
+
+  void deliver(uint32_t arrive, const std::vector<uint8_t>& d) {
+    if (lost()) return;
+    uint32_t at = arrive + delay();
+    // Urutan dijaga supaya receive() cukup melihat antrian depan
+    auto it = toClient.end();
+    while (it != toClient.begin() && (int32_t)((it - 1)->at - at) > 0) --it;
+    toClient.insert(it, Datagram{ at, d });
+  }
+
+  std::vector<uint8_t> reply(const CoapMessage& req, uint8_t code, bool echo, uint32_t block1) {
+    codes.push_back(code);
+    std::vector<uint8_t> out(64);
+    CoapWriter w(out.data(), out.size());
+    w.header(CoapType::ACK, code, req.messageId, req.token, req.tokenLen);
+    if (echo) w.optionUint(CoapOption::BLOCK1, block1);
+    out.resize(w.length());
+    return out;
+  }
+
+  std::vector<uint8_t> handle(const CoapMessage& msg) {
+    const CoapOptionView* tag = msg.find(CoapOption::AUTH_TAG);
+    const CoapOptionView* key = msg.find(CoapOption::KEY_ID);
+    if (!tag || !key || tag->length != COAP_AUTH_TAG_SIZE) return reply(msg, CoapCode::UNAUTHORIZED, false, 0);
+    std::string keyId((const char*)key->value, key->length);
+    bool hasBlock = msg.find(CoapOption::BLOCK1) != nullptr;
+    uint32_t block1 = msg.optionUint(CoapOption::BLOCK1, 0);
+    uint8_t expected[COAP_AUTH_TAG_SIZE];
+    coapAuthTag((const uint8_t*)serverPsk.data(), serverPsk.size(), msg.code, msg.messageId,
+                msg.token, msg.tokenLen, keyId.c_str(), hasBlock ? block1 : 0,
+                msg.payload, msg.payloadLen, expected);
+    if (!constantTimeEqual(expected, tag->value, COAP_AUTH_TAG_SIZE)) return reply(msg, CoapCode::UNAUTHORIZED, false, 0);
+
+    std::string payload((const char*)msg.payload, msg.payloadLen);
+    if (!hasBlock) {
+      ingested.push_back(payload);
+      return reply(msg, CoapCode::CHANGED, false, 0);
+    }
+    if (coapBlockNum(block1) == 0) { assembling.clear(); nextBlock = 0; }
+    if (coapBlockNum(block1) != nextBlock) return reply(msg, CoapCode::INCOMPLETE, false, 0);
+    assembling += payload;
+    nextBlock++;
+    if (coapBlockMore(block1)) return reply(msg, CoapCode::CONTINUE, true, block1);
+    ingested.push_back(assembling);
+    return reply(msg, CoapCode::CHANGED, true, block1 & ~0x08u);
+  }
+};
+
+void setupUploader(CoapUploader& up) {
+  up.setServer("ingest.local", COAP_DEFAULT_PORT);
+  up.setKey(DEVICE, (const uint8_t*)PSK, strlen(PSK));
+  up.seed(0xC0FFEE);
+}
+
+// Poll tiap 1 ms sampai selesai; return hasil, nowMs = saat selesai
+CoapResult runUntilDone(CoapUploader& up, uint32_t limitMs = 60000) {
+  uint32_t end = nowMs + limitMs;
+  CoapResult r = up.poll(nowMs);
+  while (r == CoapResult::BUSY && nowMs < end) {
+    nowMs++;
+    r = up.poll(nowMs);
+  }
+  return r;
+}
+
+std::string batchBody(size_t records) {
+  std::string body;
+  for (size_t i = 0; i < records; i++) {
+    body += RECORD;
+    body += '\n';
+  }
+  return body;
+}
+
+uint32_t percentile(std::vector<uint32_t> v, uint32_t p) {
+  std::sort(v.begin(), v.end());
+  return v[(v.size() - 1) * p / 100];
+}
+}
+
+void setUp() { nowMs = 1000; }
+void tearDown() {}
+
+void test_option_codec_round_trip() {
+  uint8_t buf[1024];
+  uint8_t token[3] = { 0xA1, 0xB2, 0xC3 };
+  std::string mid(20, 'm'), big(300, 'b');
+  CoapWriter w(buf, sizeof(buf));
+  TEST_ASSERT_TRUE(w.header(CoapType::CON, CoapCode::POST, 0xBEEF, token, sizeof(token)));
+  TEST_ASSERT_TRUE(w.optionString(CoapOption::URI_PATH, "ingest"));           // delta 11
+  TEST_ASSERT_TRUE(w.optionString(CoapOption::URI_PATH, ""));                 // delta 0, panjang 0
+  TEST_ASSERT_TRUE(w.optionUint(CoapOption::CONTENT_FORMAT, 0));              // nilai 0 = 0 byte
+  TEST_ASSERT_TRUE(w.optionString(25, mid.c_str()));                          // delta 13, panjang 1 byte ext
+  TEST_ASSERT_TRUE(w.optionUint(CoapOption::BLOCK1, 0x12345));
+  TEST_ASSERT_TRUE(w.option(300, (const uint8_t*)big.data(), big.size()));    // delta 273, panjang 2 byte ext
+  TEST_ASSERT_TRUE(w.optionUint(CoapOption::AUTH_TAG, 0xFFFFFFFF));           // delta 64701
+  TEST_ASSERT_TRUE(w.payload((const uint8_t*)"x=1", 3));
+  size_t len = w.length();
+  TEST_ASSERT_GREATER_THAN_UINT32(0, len);
+  // Nomor opsi turun: ditolak, writer tetap gagal sesudahnya
+  CoapWriter bad(buf + 512, 64);
+  bad.optionUint(CoapOption::BLOCK1, 1);
+  TEST_ASSERT_FALSE(bad.optionUint(CoapOption::URI_PATH, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, bad.length());
+
+  CoapMessage msg;
+  TEST_ASSERT_TRUE(msg.parse(buf, len));
+  TEST_ASSERT_TRUE(msg.type == CoapType::CON);
+  TEST_ASSERT_EQUAL_UINT8(CoapCode::POST, msg.code);
+  TEST_ASSERT_EQUAL_UINT16(0xBEEF, msg.messageId);
+  TEST_ASSERT_EQUAL_UINT8(3, msg.tokenLen);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(token, msg.token, 3);
+  TEST_ASSERT_EQUAL_UINT8(7, msg.optionCount);
+  TEST_ASSERT_EQUAL_UINT16(CoapOption::URI_PATH, msg.options[1].number);
+  TEST_ASSERT_EQUAL_UINT16(0, msg.options[1].length);
+  TEST_ASSERT_EQUAL_UINT16(0, msg.find(CoapOption::CONTENT_FORMAT)->length);
+  TEST_ASSERT_EQUAL_UINT16(20, msg.find(25)->length);
+  TEST_ASSERT_EQUAL_UINT32(0x12345, msg.optionUint(CoapOption::BLOCK1, 0));
+  TEST_ASSERT_EQUAL_UINT16(3, msg.find(CoapOption::BLOCK1)->length);       // panjang minimal
+  TEST_ASSERT_EQUAL_UINT16(300, msg.find(300)->length);
+  TEST_ASSERT_EQUAL_MEMORY(big.data(), msg.find(300)->value, 300);
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, msg.optionUint(CoapOption::AUTH_TAG, 0));
+  TEST_ASSERT_EQUAL_UINT32(77, msg.optionUint(CoapOption::KEY_ID, 77));    // tidak ada: fallback
+  TEST_ASSERT_EQUAL_UINT32(3, msg.payloadLen);
+  TEST_ASSERT_EQUAL_MEMORY("x=1", msg.payload, 3);
+
+  // Block1 NUM | M | SZX
+  uint32_t b = coapBlockValue(5, true, 5);
+  TEST_ASSERT_EQUAL_UINT32(5, coapBlockNum(b));
+  TEST_ASSERT_TRUE(coapBlockMore(b));
+  TEST_ASSERT_EQUAL_UINT32(512, coapBlockSize(b));
+  TEST_ASSERT_FALSE(coapBlockMore(coapBlockValue(5, false, 2)));
+  TEST_ASSERT_EQUAL_UINT32(64, coapBlockSize(coapBlockValue(0, false, 2)));
+}
+
+void test_parser_rejects_malformed() {
+  CoapMessage msg;
+  const uint8_t version2[] = { 0x80, 0x02, 0x00, 0x01 };
+  const uint8_t shortHeader[] = { 0x40, 0x02, 0x00 };
+  const uint8_t tokenTooLong[] = { 0x49, 0x02, 0x00, 0x01, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  const uint8_t tokenTruncated[] = { 0x44, 0x02, 0x00, 0x01, 1, 2 };
+  const uint8_t markerOnly[] = { 0x40, 0x02, 0x00, 0x01, 0xFF };
+  const uint8_t reservedNibble[] = { 0x40, 0x02, 0x00, 0x01, 0xF1, 0x00 };
+  const uint8_t extTruncated[] = { 0x40, 0x02, 0x00, 0x01, 0xD1 };
+  const uint8_t valueTruncated[] = { 0x40, 0x02, 0x00, 0x01, 0xB4, 'i', 'n' };
+  TEST_ASSERT_FALSE(msg.parse(version2, sizeof(version2)));
+  TEST_ASSERT_FALSE(msg.parse(shortHeader, sizeof(shortHeader)));
+  TEST_ASSERT_FALSE(msg.parse(tokenTooLong, sizeof(tokenTooLong)));
+  TEST_ASSERT_FALSE(msg.parse(tokenTruncated, sizeof(tokenTruncated)));
+  TEST_ASSERT_FALSE(msg.parse(markerOnly, sizeof(markerOnly)));
+  TEST_ASSERT_FALSE(msg.parse(reservedNibble, sizeof(reservedNibble)));
+  TEST_ASSERT_FALSE(msg.parse(extTruncated, sizeof(extTruncated)));
+  TEST_ASSERT_FALSE(msg.parse(valueTruncated, sizeof(valueTruncated)));
+  // Empty ACK: header saja
+  const uint8_t emptyAck[] = { 0x60, 0x00, 0x12, 0x34 };
+  TEST_ASSERT_TRUE(msg.parse(emptyAck, sizeof(emptyAck)));
+  TEST_ASSERT_TRUE(msg.type == CoapType::ACK);
+  TEST_ASSERT_EQUAL_UINT8(0, msg.optionCount);
+  TEST_ASSERT_NULL(msg.payload);
+}
+
+void test_single_record_piggybacked() {
+  FakeLink link;
+  CoapUploader up(link);
+  setupUploader(up);
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs));
+  TEST_ASSERT_FALSE(up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs));   // masih sibuk
+  uint32_t started = nowMs;
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::DONE);
+  TEST_ASSERT_EQUAL_UINT32(80, nowMs - started);   // satu RTT
+  TEST_ASSERT_EQUAL_UINT8(CoapCode::CHANGED, up.responseCode());
+  TEST_ASSERT_EQUAL_UINT32(1, link.ingested.size());
+  TEST_ASSERT_EQUAL_STRING(RECORD, link.ingested[0].c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, link.sent.size());
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, link.block1Of(0));   // satu blok: tanpa Block1
+
+  CoapMessage msg;
+  TEST_ASSERT_TRUE(msg.parse(link.sent[0].data(), link.sent[0].size()));
+  TEST_ASSERT_EQUAL_UINT16(6, msg.find(CoapOption::URI_PATH)->length);
+  TEST_ASSERT_EQUAL_MEMORY("ingest", msg.find(CoapOption::URI_PATH)->value, 6);
+  TEST_ASSERT_EQUAL_UINT16(strlen(DEVICE), msg.find(CoapOption::KEY_ID)->length);
+  // api_key tidak pernah dikirim
+  std::string wire(link.sent[0].begin(), link.sent[0].end());
+  TEST_ASSERT_TRUE(wire.find("api_key") == std::string::npos);
+}
+
+void test_block1_sequence_reassembled() {
+  FakeLink link;
+  CoapUploader up(link);
+  setupUploader(up);
+  std::string body = batchBody(8);   // > 2 blok 512 byte
+  size_t blocks = (body.size() + 511) / 512;
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)body.data(), body.size(), nowMs));
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::DONE);
+
+  TEST_ASSERT_EQUAL_UINT32(blocks, link.sent.size());
+  CoapMessage first;
+  first.parse(link.sent[0].data(), link.sent[0].size());
+  size_t total = 0;
+  for (size_t i = 0; i < blocks; i++) {
+    CoapMessage msg;
+    TEST_ASSERT_TRUE(msg.parse(link.sent[i].data(), link.sent[i].size()));
+    uint32_t b = link.block1Of(i);
+    TEST_ASSERT_EQUAL_UINT32(i, coapBlockNum(b));
+    TEST_ASSERT_EQUAL_UINT32(i + 1 < blocks, coapBlockMore(b));
+    TEST_ASSERT_EQUAL_UINT32(512, coapBlockSize(b));
+    TEST_ASSERT_EQUAL_UINT32(i + 1 < blocks ? 512 : body.size() - 512 * (blocks - 1), msg.payloadLen);
+    // Message id baru per blok, token sama untuk seluruh transfer
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(first.messageId + i), msg.messageId);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first.token, msg.token, first.tokenLen);
+    total += msg.payloadLen;
+  }
+  TEST_ASSERT_EQUAL_UINT32(body.size(), total);
+  TEST_ASSERT_EQUAL_UINT32(1, link.ingested.size());
+  TEST_ASSERT_TRUE(link.ingested[0] == body);
+  TEST_ASSERT_EQUAL_UINT8(CoapCode::CONTINUE, link.codes[0]);
+  TEST_ASSERT_EQUAL_UINT8(CoapCode::CHANGED, link.codes.back());
+
+  // Body melebihi BODY_MAX ditolak sebelum mengirim apa pun
+  std::string huge(CoapUploader::BODY_MAX + 1, 'x');
+  TEST_ASSERT_FALSE(up.start((const uint8_t*)huge.data(), huge.size(), nowMs));
+}
+
+void test_retransmit_backoff_schedule() {
+  FakeLink link;
+  link.dropRequests = { 0, 1, 2, 3 };   // server tidak pernah menerima
+  CoapUploader up(link);
+  setupUploader(up);
+  uint32_t started = nowMs;
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs));
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::FAILED);
+
+  // Timeout awal acak di [ACK_TIMEOUT, 1.5 * ACK_TIMEOUT], lalu dua kali lipat
+  TEST_ASSERT_EQUAL_UINT32(4, link.sent.size());
+  uint32_t t0 = link.sendTimes[1] - link.sendTimes[0];
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1000, t0);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(1500, t0);
+  TEST_ASSERT_EQUAL_UINT32(3 * t0, link.sendTimes[2] - link.sendTimes[0]);
+  TEST_ASSERT_EQUAL_UINT32(7 * t0, link.sendTimes[3] - link.sendTimes[0]);
+  TEST_ASSERT_EQUAL_UINT32(15 * t0, nowMs - started);
+  TEST_ASSERT_EQUAL_UINT32(3, up.retransmitCount());
+  // Retransmisi = datagram yang sama persis
+  for (size_t i = 1; i < link.sent.size(); i++) TEST_ASSERT_TRUE(link.sent[i] == link.sent[0]);
+  printf("  backoff: timeout awal %u ms, kirim di +0/+%u/+%u/+%u ms, gagal di +%u ms\n",
+         (unsigned)t0, (unsigned)t0, (unsigned)(3 * t0), (unsigned)(7 * t0), (unsigned)(nowMs - started));
+
+  // Gagal: socket dibuka ulang (DNS baru) di start() berikutnya
+  link.dropRequests.clear();
+  TEST_ASSERT_EQUAL_UINT32(1, link.opens);
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs));
+  TEST_ASSERT_EQUAL_UINT32(2, link.opens);
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::DONE);
+}
+
+void test_lost_ack_answered_from_cache() {
+  FakeLink link;
+  CoapUploader up(link);
+  setupUploader(up);
+  // Blok 1 dari 3: request pertama hilang, retransmisi sampai
+  link.dropRequests = { 1 };
+  std::string body = batchBody(8);
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)body.data(), body.size(), nowMs));
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::DONE);
+  TEST_ASSERT_EQUAL_UINT32(1, up.retransmitCount());
+  TEST_ASSERT_TRUE(link.ingested[0] == body);
+
+  // Response hilang (arah server -> client): server menjawab retransmisi
+  // dari cache, record tidak di-ingest dua kali
+  FakeLink lossy;
+  lossy.lossPermille = 300;
+  lossy.rng = 0xBADC0DE;
+  CoapUploader up2(lossy);
+  setupUploader(up2);
+  uint32_t starts = 0, done = 0;
+  for (int i = 0; i < 40; i++) {
+    if (!up2.start((const uint8_t*)RECORD, strlen(RECORD), nowMs)) continue;
+    starts++;
+    if (runUntilDone(up2) == CoapResult::DONE) done++;
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(0, up2.retransmitCount());
+  // Tiap transfer yang selesai di-ingest tepat sekali; yang gagal paling
+  // banyak sekali (request sampai, semua response hilang)
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(done, lossy.ingested.size());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(starts, lossy.ingested.size());
+}
+
+void test_separate_response_acked() {
+  FakeLink link;
+  link.separate = true;
+  CoapUploader up(link);
+  setupUploader(up);
+  uint32_t started = nowMs;
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs));
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::DONE);
+  TEST_ASSERT_EQUAL_UINT32(380, nowMs - started);   // empty ACK lalu response 300 ms kemudian
+  TEST_ASSERT_EQUAL_UINT32(1, link.clientAcks);     // response CON di-ACK client
+  TEST_ASSERT_EQUAL_UINT32(0, up.retransmitCount());
+}
+
+void test_auth_tag_covers_every_field() {
+  const uint8_t psk[] = "rahasia";
+  const uint8_t token[4] = { 1, 2, 3, 4 };
+  const uint8_t payload[] = "berat=1.25";
+  uint8_t base[COAP_AUTH_TAG_SIZE], other[COAP_AUTH_TAG_SIZE];
+  coapAuthTag(psk, 7, CoapCode::POST, 100, token, 4, DEVICE, 0x25, payload, 10, base);
+  coapAuthTag(psk, 7, CoapCode::POST, 100, token, 4, DEVICE, 0x25, payload, 10, other);
+  TEST_ASSERT_EQUAL_MEMORY(base, other, COAP_AUTH_TAG_SIZE);
+
+  const uint8_t otherPsk[] = "rahasiA";
+  const uint8_t otherToken[4] = { 1, 2, 3, 5 };
+  const uint8_t otherPayload[] = "berat=9.25";
+  coapAuthTag(otherPsk, 7, CoapCode::POST, 100, token, 4, DEVICE, 0x25, payload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+  coapAuthTag(psk, 7, CoapCode::make(0, 3), 100, token, 4, DEVICE, 0x25, payload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+  coapAuthTag(psk, 7, CoapCode::POST, 101, token, 4, DEVICE, 0x25, payload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+  coapAuthTag(psk, 7, CoapCode::POST, 100, otherToken, 4, DEVICE, 0x25, payload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+  coapAuthTag(psk, 7, CoapCode::POST, 100, token, 4, "ecoscale-ffffff", 0x25, payload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+  coapAuthTag(psk, 7, CoapCode::POST, 100, token, 4, DEVICE, 0x2D, payload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+  coapAuthTag(psk, 7, CoapCode::POST, 100, token, 4, DEVICE, 0x25, otherPayload, 10, other);
+  TEST_ASSERT_TRUE(memcmp(base, other, COAP_AUTH_TAG_SIZE) != 0);
+}
+
+void test_wrong_psk_is_unauthorized_not_rejected() {
+  FakeLink link;
+  link.serverPsk = "psk-situs-lain";
+  CoapUploader up(link);
+  setupUploader(up);
+  TEST_ASSERT_TRUE(up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs));
+  // 4.01 bisa pulih (kunci belum terdaftar): record tetap di outbox
+  TEST_ASSERT_TRUE(runUntilDone(up) == CoapResult::FAILED);
+  TEST_ASSERT_EQUAL_UINT8(CoapCode::UNAUTHORIZED, up.responseCode());
+  TEST_ASSERT_EQUAL_UINT32(0, link.ingested.size());
+
+  // Payload diubah di jalan: tag tidak cocok lagi
+  FakeLink tampered;
+  CoapUploader up2(tampered);
+  setupUploader(up2);
+  up2.start((const uint8_t*)RECORD, strlen(RECORD), nowMs);
+  std::vector<uint8_t> d = tampered.sent[0];
+  d[d.size() - 1] ^= 0x01;
+  CoapMessage msg;
+  TEST_ASSERT_TRUE(msg.parse(d.data(), d.size()));
+  uint8_t expected[COAP_AUTH_TAG_SIZE];
+  coapAuthTag((const uint8_t*)PSK, strlen(PSK), msg.code, msg.messageId, msg.token, msg.tokenLen,
+              DEVICE, 0, msg.payload, msg.payloadLen, expected);
+  TEST_ASSERT_FALSE(constantTimeEqual(expected, msg.find(CoapOption::AUTH_TAG)->value, COAP_AUTH_TAG_SIZE));
+  TEST_ASSERT_TRUE(runUntilDone(up2) == CoapResult::DONE);   // salinan asli tetap sah
+}
+
+void test_bytes_and_latency_vs_https() {
+  // Link kampus lambat: 30-150 ms satu arah, 5% datagram/segmen hilang
+  const int RECORDS = 400;
+  FakeLink link;
+  link.minDelayMs = 30;
+  link.jitterMs = 120;
+  link.lossPermille = 50;
+  CoapUploader up(link);
+  setupUploader(up);
+  std::vector<uint32_t> coapMs;
+  uint32_t failed = 0;
+  for (int i = 0; i < RECORDS; i++) {
+    uint32_t started = nowMs;
+    up.start((const uint8_t*)RECORD, strlen(RECORD), nowMs);
+    if (runUntilDone(up) == CoapResult::DONE) coapMs.push_back(nowMs - started);
+    else failed++;
+    nowMs += 1000;
+  }
+
+  // HTTPS dingin di link yang sama: TCP (1 RTT) + TLS 1.2 (2 RTT) +
+  // request/response (1 RTT); segmen hilang diulang setelah RTO TCP 1 s
+  uint32_t rng = 0xFEED;
+  std::vector<uint32_t> httpsMs;
+  for (int i = 0; i < RECORDS; i++) {
+    uint32_t total = 0;
+    for (int exchange = 0; exchange < 4; exchange++) {
+      uint32_t rto = 1000;
+      for (;;) {
+        uint32_t rtt = 60 + xorshift(rng) % 121 + xorshift(rng) % 121;
+        bool lost = xorshift(rng) % 1000 < 50 || xorshift(rng) % 1000 < 50;
+        if (!lost) { total += rtt; break; }
+        total += rto;
+        rto *= 2;
+      }
+    }
+    httpsMs.push_back(total);
+  }
+
+  // Byte lapisan aplikasi: datagram CoAP vs request HTTP saja (tanpa TLS)
+  FakeLink clean, cleanBatch;
+  CoapUploader one(clean), batch(cleanBatch);
+  setupUploader(one);
+  setupUploader(batch);
+  one.start((const uint8_t*)RECORD, strlen(RECORD), nowMs);
+  runUntilDone(one);
+  std::string body8 = batchBody(8);
+  batch.start((const uint8_t*)body8.data(), body8.size(), nowMs);
+  runUntilDone(batch);
+
+  HttpEndpoint endpoint;
+  HttpRequestWriter writer;
+  TEST_ASSERT_TRUE(endpoint.parse("https://ecoscale.undip.us/api/receive-sampah"));
+  TEST_ASSERT_TRUE(writer.begin("POST", endpoint, "application/x-www-form-urlencoded"));
+  std::string form = std::string("api_key=0123456789abcdef0123456789abcdef&") + RECORD;
+  char request[1024];
+  size_t httpBytes = writer.build(request, sizeof(request), "Idempotency-Key: ecoscale-a1b2c3-42\r\n",
+                                  form.data(), form.size());
+
+  printf("  1 record : CoAP %u B tx / %u B rx | request HTTP saja %u B (+ response, TLS)\n",
+         (unsigned)one.bytesSent(), (unsigned)one.bytesReceived(), (unsigned)httpBytes);
+  printf("  8 record : CoAP Block1 %u B tx / %u B rx\n",
+         (unsigned)batch.bytesSent(), (unsigned)batch.bytesReceived());
+  printf("  latensi  : CoAP p50 %u / p99 %u ms (%u gagal) | HTTPS dingin p50 %u / p99 %u ms\n",
+         (unsigned)percentile(coapMs, 50), (unsigned)percentile(coapMs, 99), (unsigned)failed,
+         (unsigned)percentile(httpsMs, 50), (unsigned)percentile(httpsMs, 99));
+
+  TEST_ASSERT_GREATER_THAN_UINT32(0, httpBytes);
+  TEST_ASSERT_LESS_THAN_UINT32(httpBytes, one.bytesSent());
+  TEST_ASSERT_LESS_THAN_UINT32(8 * one.bytesSent(), batch.bytesSent());
+  TEST_ASSERT_LESS_THAN_UINT32(percentile(httpsMs, 50), percentile(coapMs, 50));
+  TEST_ASSERT_LESS_THAN_UINT32(percentile(httpsMs, 99), percentile(coapMs, 99));
+  TEST_ASSERT_LESS_THAN_UINT32(RECORDS / 100, failed);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_option_codec_round_trip);
+  RUN_TEST(test_parser_rejects_malformed);
+  RUN_TEST(test_single_record_piggybacked);
+  RUN_TEST(test_block1_sequence_reassembled);
+  RUN_TEST(test_retransmit_backoff_schedule);
+  RUN_TEST(test_lost_ack_answered_from_cache);
+  RUN_TEST(test_separate_response_acked);
+  RUN_TEST(test_auth_tag_covers_every_field);
+  RUN_TEST(test_wrong_psk_is_unauthorized_not_rejected);
+  RUN_TEST(test_bytes_and_latency_vs_https);
+  return UNITY_END();
+}
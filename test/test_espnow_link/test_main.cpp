@@ -0,0 +1,352 @@
+// Radio ESP-NOW simulasi: medium bersama 1 Mbps (frame diserialisasi dengan
+// airtime), channel per radio, dan kehilangan frame acak. Node dan gateway
+// sungguhan berjalan di atasnya; upload gateway dimodelkan dengan latensi
+// tetap per batch dan dicatat per (mac, seq) untuk mendeteksi upload ganda.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "espnow-link.h"
+
+namespace {
+const uint8_t PSK[] = "kampus-undip-relay";
+const uint8_t GATEWAY_MAC[6] = { 0x24, 0, 0, 0, 0, 0xAA };
+
+struct AirFrame {
+  uint8_t src[6];
+  uint8_t dst[6];
+  uint8_t channel;
+  uint32_t at;
+  std::vector<uint8_t> data;
+};
+
+class SimAir;
+
+class SimRadio : public EspNowRadio {
+public:
+  SimAir* air = nullptr;
+  uint8_t mac[6] = {};
+  uint8_t channel = 1;
+  bool send(const uint8_t dst[6], const uint8_t* data, size_t len) override;
+  bool setChannel(uint8_t ch) override { channel = ch; return true; }
+};
+
+class SimAir {
+public:
+  std::mt19937 rng{42};
+  double loss = 0;
+  uint32_t now = 0;
+  uint32_t mediumFreeAt = 0;
+  double airtimeCarry = 0;
+  std::deque<AirFrame> frames;
+  // Filter opsional: return true untuk membuang frame tertentu
+  bool (*drop)(const AirFrame& f) = nullptr;
+
+  void transmit(const SimRadio& from, const uint8_t dst[6], const uint8_t* data, size_t len) {
+    // ~50 byte overhead MAC/PHY per frame di 1 Mbps + ACK/IFS ~0.3 ms
+    airtimeCarry += (len + 50) * 8 / 1000.0 + 0.3;
+    uint32_t start = mediumFreeAt > now ? mediumFreeAt : now;
+    uint32_t dur = (uint32_t)airtimeCarry;
+    airtimeCarry -= dur;
+    mediumFreeAt = start + dur;
+    AirFrame f;
+    memcpy(f.src, from.mac, 6);
+    memcpy(f.dst, dst, 6);
+    f.channel = from.channel;
+    f.at = mediumFreeAt;
+    f.data.assign(data, data + len);
+    frames.push_back(f);
+  }
+
+  bool lost(const AirFrame& f) {
+    if (drop && drop(f)) return true;
+    return std::uniform_real_distribution<double>(0, 1)(rng) < loss;
+  }
+};
+
+bool SimRadio::send(const uint8_t dst[6], const uint8_t* data, size_t len) {
+  air->transmit(*this, dst, data, len);
+  return true;
+}
+
+bool addressedTo(const AirFrame& f, const SimRadio& r) {
+  bool broadcast = memcmp(f.dst, ESPNOW_BROADCAST, 6) == 0;
+  return (broadcast || memcmp(f.dst, r.mac, 6) == 0) && f.channel == r.channel && memcmp(f.src, r.mac, 6) != 0;
+}
+
+// Hasil per node diterima lewat callback tanpa konteks: node yang sedang
+// diproses dicatat di `current`
+int current = -1;
+std::map<std::pair<int, uint32_t>, int> results;   // (node, seq) -> jumlah callback
+std::vector<uint32_t> latencies;
+std::map<std::pair<int, uint32_t>, uint32_t> createdAt;
+uint32_t simNow = 0;
+
+void onResult(uint32_t seq, SendResult result) {
+  results[std::make_pair(current, seq)]++;
+  latencies.push_back(simNow - createdAt[std::make_pair(current, seq)]);
+}
+
+struct Network {
+  SimAir air;
+  SimRadio gatewayRadio;
+  EspNowGateway gateway{gatewayRadio};
+  std::vector<SimRadio> nodeRadios;
+  std::vector<EspNowNode*> nodes;
+  std::map<std::pair<std::string, uint32_t>, int> uploads;   // upload per (mac, seq)
+  uint32_t uploadMs = 400;
+  SendResult uploadResult = SendResult::ACKED;
+  bool uploading = false;
+  uint32_t uploadDone = 0;
+  RelayedRecord batch[EspNowGateway::MAX_PENDING];
+  size_t batchLen = 0;
+
+  explicit Network(int count, uint8_t gatewayChannel = 6) : nodeRadios(count) {
+    gatewayRadio.air = &air;
+    memcpy(gatewayRadio.mac, GATEWAY_MAC, 6);
+    gatewayRadio.channel = gatewayChannel;
+    gateway.setIdentity(GATEWAY_MAC);
+    gateway.setKey(PSK, sizeof(PSK) - 1);
+    for (int i = 0; i < count; i++) {
+      SimRadio& r = nodeRadios[i];
+      r.air = &air;
+      const uint8_t mac[6] = { 0x24, 1, 2, 3, 0, (uint8_t)i };
+      memcpy(r.mac, mac, 6);
+      EspNowNode* n = new EspNowNode(r);
+      n->setIdentity(mac);
+      n->setKey(PSK, sizeof(PSK) - 1);
+      n->setResultCallback(onResult);
+      nodes.push_back(n);
+    }
+  }
+  ~Network() { for (EspNowNode* n : nodes) delete n; }
+
+  // Satu milidetik simulasi
+  void tick() {
+    air.now = simNow;
+    for (size_t i = 0; i < nodes.size(); i++) { current = (int)i; nodes[i]->loop(simNow); }
+    while (!air.frames.empty() && air.frames.front().at <= simNow) {
+      AirFrame f = air.frames.front();
+      air.frames.pop_front();
+      if (air.lost(f)) continue;
+      if (addressedTo(f, gatewayRadio)) gateway.onFrame(f.src, f.data.data(), f.data.size(), simNow);
+      for (size_t i = 0; i < nodes.size(); i++) {
+        if (!addressedTo(f, nodeRadios[i])) continue;
+        current = (int)i;
+        nodes[i]->onFrame(f.src, f.data.data(), f.data.size(), simNow);
+      }
+    }
+    if (!uploading) {
+      batchLen = gateway.takeBatch(batch, 16, simNow);
+      if (batchLen) { uploading = true; uploadDone = simNow + uploadMs; }
+    } else if (simNow >= uploadDone) {
+      SendResult res[EspNowGateway::MAX_PENDING];
+      for (size_t k = 0; k < batchLen; k++) {
+        res[k] = uploadResult;
+        if (uploadResult != SendResult::RETRY) uploads[std::make_pair(std::string((const char*)batch[k].mac, 6), batch[k].rec.seq)]++;
+      }
+      gateway.complete(batch, res, batchLen, simNow);
+      uploading = false;
+    }
+    simNow++;
+  }
+  void run(uint32_t ms) { for (uint32_t end = simNow + ms; simNow < end;) tick(); }
+
+  bool submit(int node, uint32_t seq) {
+    EspNowRecord r = {};
+    r.seq = seq;
+    r.weight = 1.5f;
+    strcpy(r.fakultas, "FT");
+    r.category = WasteCategory::ORGANIK;
+    createdAt[std::make_pair(node, seq)] = simNow;
+    current = node;
+    return nodes[node]->submit(r, simNow, simNow);
+  }
+
+  int duplicateUploads() const {
+    int d = 0;
+    for (auto& u : uploads) d += u.second - 1;
+    return d;
+  }
+};
+
+EspNowRecord sampleRecord() {
+  EspNowRecord r = {};
+  r.seq = 7;
+  r.weight = 2.25f;
+  r.ageMs = 1234;
+  strcpy(r.fakultas, "FEB");
+  r.category = WasteCategory::RESIDU;
+  return r;
+}
+
+int ackDropsLeft = 0;
+bool dropAcks(const AirFrame& f) {
+  if (ackDropsLeft <= 0 || memcmp(f.src, GATEWAY_MAC, 6) != 0 || f.data[1] != EspNowFrame::ACK) return false;
+  ackDropsLeft--;
+  return true;
+}
+}
+
+void setUp() {
+  current = -1;
+  results.clear();
+  latencies.clear();
+  createdAt.clear();
+  simNow = 0;
+  ackDropsLeft = 0;
+}
+void tearDown() {}
+
+void test_codec_roundtrip_and_tamper() {
+  const uint8_t mac[6] = { 1, 2, 3, 4, 5, 6 };
+  uint8_t payload[64];
+  size_t plen = espNowPackRecord(payload, sizeof(payload), sampleRecord());
+  uint8_t frame[EspNowFrame::MAX_SIZE];
+  size_t len = espNowEncode(frame, EspNowFrame::RECORD, 7, payload, plen, mac, PSK, sizeof(PSK) - 1);
+  TEST_ASSERT_EQUAL_UINT32(EspNowFrame::HEADER_SIZE + plen + EspNowFrame::TAG_SIZE, len);
+
+  uint8_t type;
+  uint32_t id;
+  const uint8_t* p;
+  size_t n;
+  TEST_ASSERT_TRUE(espNowDecode(frame, len, mac, PSK, sizeof(PSK) - 1, type, id, p, n));
+  TEST_ASSERT_EQUAL_UINT8(EspNowFrame::RECORD, type);
+  TEST_ASSERT_EQUAL_UINT32(7, id);
+  EspNowRecord rec;
+  TEST_ASSERT_TRUE(espNowUnpackRecord(p, n, rec));
+  TEST_ASSERT_EQUAL_FLOAT(2.25f, rec.weight);
+  TEST_ASSERT_EQUAL_UINT32(1234, rec.ageMs);
+  TEST_ASSERT_EQUAL_STRING("FEB", rec.fakultas);
+  TEST_ASSERT_EQUAL_UINT8((uint8_t)WasteCategory::RESIDU, (uint8_t)rec.category);
+
+  const uint8_t other[6] = { 1, 2, 3, 4, 5, 7 };
+  TEST_ASSERT_FALSE(espNowDecode(frame, len, other, PSK, sizeof(PSK) - 1, type, id, p, n));   // MAC palsu
+  TEST_ASSERT_FALSE(espNowDecode(frame, len, mac, (const uint8_t*)"x", 1, type, id, p, n));
+  frame[EspNowFrame::HEADER_SIZE] ^= 1;
+  TEST_ASSERT_FALSE(espNowDecode(frame, len, mac, PSK, sizeof(PSK) - 1, type, id, p, n));
+}
+
+void test_unknown_category_is_rejected() {
+  uint8_t payload[64];
+  size_t plen = espNowPackRecord(payload, sizeof(payload), sampleRecord());
+  EspNowRecord rec;
+  payload[plen - 1] = (uint8_t)WasteCategory::COUNT;
+  TEST_ASSERT_FALSE(espNowUnpackRecord(payload, plen, rec));
+  payload[plen - 1] = (uint8_t)WasteCategory::NONE;
+  TEST_ASSERT_FALSE(espNowUnpackRecord(payload, plen, rec));
+}
+
+void test_node_hunts_gateway_channel() {
+  Network net(1, 6);
+  TEST_ASSERT_TRUE(net.submit(0, 1));
+  net.run(2000);
+  TEST_ASSERT_TRUE(net.nodes[0]->linked());
+  TEST_ASSERT_EQUAL_UINT8(6, net.nodes[0]->channel());
+  TEST_ASSERT_EQUAL_MEMORY(GATEWAY_MAC, net.nodes[0]->gateway(), 6);
+  TEST_ASSERT_EQUAL_UINT32(1, net.nodes[0]->stats().hunts);
+  TEST_ASSERT_EQUAL_INT(1, net.gateway.nodeCount());
+}
+
+void test_record_acked_after_upload() {
+  Network net(1);
+  net.submit(0, 1);
+  net.run(5000);
+  TEST_ASSERT_EQUAL_INT(1, (results[std::make_pair(0, 1u)]));
+  TEST_ASSERT_EQUAL_INT(0, net.nodes[0]->pendingCount());
+  TEST_ASSERT_EQUAL_UINT32(1, net.uploads.size());
+  // ACK baru dikirim setelah upload: latensi >= maxWait + upload
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(EspNowGatewayPolicy().maxWaitMs + net.uploadMs, latencies[0]);
+}
+
+void test_lost_ack_is_answered_without_second_upload() {
+  Network net(1);
+  net.air.drop = dropAcks;
+  ackDropsLeft = 1;
+  net.submit(0, 1);
+  net.run(20000);
+  TEST_ASSERT_EQUAL_INT(1, (results[std::make_pair(0, 1u)]));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, net.nodes[0]->stats().retransmits);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, net.gateway.stats().duplicates);
+  TEST_ASSERT_EQUAL_INT(0, net.duplicateUploads());
+}
+
+void test_upload_failure_is_retried_by_gateway() {
+  Network net(1);
+  net.uploadResult = SendResult::RETRY;
+  net.submit(0, 1);
+  net.run(4000);
+  TEST_ASSERT_EQUAL_INT(0, (results[std::make_pair(0, 1u)]));
+  TEST_ASSERT_EQUAL_INT(1, net.gateway.pendingCount());
+  net.uploadResult = SendResult::ACKED;
+  net.run(20000);
+  TEST_ASSERT_EQUAL_INT(1, (results[std::make_pair(0, 1u)]));
+  TEST_ASSERT_EQUAL_INT(0, net.gateway.pendingCount());
+  TEST_ASSERT_EQUAL_UINT32(0, net.nodes[0]->stats().hunts - 1);   // gateway tetap menjawab, tidak berburu ulang
+}
+
+void test_twenty_scales_throughput_with_loss() {
+  const int N = 20;
+  const double PER_NODE_RATE = 0.2;   // record/s per timbangan (jauh di atas pemakaian nyata)
+  const uint32_t DURATION = 300000;
+  Network net(N);
+  net.air.loss = 0.05;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> u(0, 1);
+  std::vector<std::deque<uint32_t>> backlog(N);
+  std::vector<uint32_t> nextSeq(N, 1);
+  int produced = 0;
+
+  while (simNow < DURATION) {
+    if (simNow < DURATION - 60000) {
+      for (int i = 0; i < N; i++) {
+        if (u(rng) < PER_NODE_RATE / 1000.0) { backlog[i].push_back(nextSeq[i]++); produced++; }
+      }
+    }
+    for (int i = 0; i < N; i++) {
+      while (!backlog[i].empty() && net.nodes[i]->hasRoom()) {
+        net.submit(i, backlog[i].front());
+        backlog[i].pop_front();
+      }
+    }
+    net.tick();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  uint32_t retransmits = 0;
+  for (EspNowNode* n : net.nodes) retransmits += n->stats().retransmits;
+  printf("  %d timbangan, %d record, %u di-ACK, latensi p50 %u ms p99 %u ms, retransmisi %u, dup gw %u\n",
+         N, produced, (unsigned)results.size(), (unsigned)latencies[latencies.size() / 2],
+         (unsigned)latencies[latencies.size() * 99 / 100], (unsigned)retransmits,
+         (unsigned)net.gateway.stats().duplicates);
+
+  TEST_ASSERT_EQUAL_UINT32(produced, results.size());
+  for (auto& r : results) TEST_ASSERT_EQUAL_INT(1, r.second);
+  TEST_ASSERT_EQUAL_UINT32(produced, net.uploads.size());
+  TEST_ASSERT_EQUAL_INT(0, net.duplicateUploads());
+  TEST_ASSERT_EQUAL_UINT32(0, net.gateway.stats().badFrames);
+  TEST_ASSERT_EQUAL_UINT32(0, net.gateway.stats().dropped);
+  TEST_ASSERT_EQUAL_INT(N, net.gateway.nodeCount());
+  // Frame hilang dibayar satu ackTimeout; p99 paling buruk dua kali hilang
+  EspNowNodePolicy node;
+  EspNowGatewayPolicy gw;
+  TEST_ASSERT_LESS_THAN_UINT32(2 * node.ackTimeoutMs + gw.maxWaitMs + net.uploadMs,
+                               latencies[latencies.size() * 99 / 100]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_codec_roundtrip_and_tamper);
+  RUN_TEST(test_unknown_category_is_rejected);
+  RUN_TEST(test_node_hunts_gateway_channel);
+  RUN_TEST(test_record_acked_after_upload);
+  RUN_TEST(test_lost_ack_is_answered_without_second_upload);
+  RUN_TEST(test_upload_failure_is_retried_by_gateway);
+  RUN_TEST(test_twenty_scales_throughput_with_loss);
+  return UNITY_END();
+}
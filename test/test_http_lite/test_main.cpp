@@ -0,0 +1,260 @@
+// Codec HTTP lite: request/response sungguhan dipotong di sembarang byte, plus
+// benchmark alokasi heap dan waktu CPU per request dibanding alur gaya
+// HTTPClient (header String disambung, getString() lalu indexOf()).
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include "http-lite.h"
+
+// Hitung alokasi heap lewat operator new global (hanya selama `counting`)
+namespace {
+bool counting = false;
+size_t allocCount = 0;
+size_t allocBytes = 0;
+}
+
+void* operator new(size_t size) {
+  if (counting) { allocCount++; allocBytes += size; }
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+const char* URL = "https://ecoscale.undip.us/api/receive-sampah";
+const char* BODY = "api_key=XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX&berat=1.25&fakultas=FEB&jenis=Organik"
+                   "&device_id=ESP32Scale-AABBCC&seq=1&idempotency_key=ESP32Scale-AABBCC-1&age_ms=1200";
+const char* IDEM = "Idempotency-Key: ESP32Scale-AABBCC-1\r\n";
+const char* RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+    "Server: nginx\r\n"
+    "Content-Type: application/json\r\n"
+    "Cache-Control: no-cache, private\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "2b\r\n{\"status\":\"berhasil\",\"message\":\"Data tersim\r\n"
+    "d\r\npan\",\"id\":42}\r\n"
+    "0\r\n\r\n";
+
+struct Bench {
+  size_t allocs;
+  size_t bytes;
+  double usPerRequest;
+};
+
+// Alur lama: mirip HTTPClient::sendHeader()/handleHeaderResponse()/getString()
+bool httpClientStyle(const HttpEndpoint& e, std::string& wire) {
+  std::string header = std::string("POST") + " " + e.path + " HTTP/1.1";
+  header += std::string("\r\nHost: ") + e.host;
+  header += std::string("\r\nUser-Agent: ") + "ESP32HTTPClient" + "\r\nConnection: keep-alive\r\n";
+  header += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+  std::string headers;
+  headers += std::string("Content-Type") + ": " + "application/x-www-form-urlencoded" + "\r\n";
+  headers += std::string("Idempotency-Key") + ": " + "ESP32Scale-AABBCC-1" + "\r\n";
+  headers += std::string("Content-Length") + ": " + std::to_string(strlen(BODY)) + "\r\n";
+  header += headers + "\r\n";
+  wire = header + BODY;
+
+  // Respon: readStringUntil('\n') per baris header, lalu getString() seluruh body
+  std::string in(RESPONSE);
+  size_t pos = 0;
+  int code = 0;
+  bool chunked = false;
+  while (true) {
+    size_t nl = in.find('\n', pos);
+    std::string line = in.substr(pos, nl - pos);
+    pos = nl + 1;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) break;
+    if (line.compare(0, 5, "HTTP/") == 0) { code = atoi(line.substr(9, 3).c_str()); continue; }
+    size_t colon = line.find(':');
+    std::string name = line.substr(0, colon);
+    std::string value = line.substr(colon + 2);
+    if (name == "Transfer-Encoding" && value == "chunked") chunked = true;
+  }
+  std::string payload;
+  while (chunked) {
+    size_t nl = in.find("\r\n", pos);
+    size_t n = strtoul(in.substr(pos, nl - pos).c_str(), nullptr, 16);
+    pos = nl + 2;
+    if (n == 0) break;
+    payload += in.substr(pos, n);
+    pos += n + 2;
+  }
+  return code == 200 && payload.find("berhasil") != std::string::npos;
+}
+
+// Alur baru: blok header statis dari boot, buffer tetap, parser inkremental
+bool httpLite(const HttpRequestWriter& w, char* out, size_t cap, size_t& wireLen) {
+  wireLen = w.build(out, cap, IDEM, BODY, strlen(BODY));
+  HttpResponseParser p;
+  p.reset();
+  const uint8_t* data = (const uint8_t*)RESPONSE;
+  size_t len = strlen(RESPONSE);
+  for (size_t off = 0; off < len && !p.prefixReady(); off += 64) {
+    size_t n = len - off < 64 ? len - off : 64;   // seukuran segmen read() kecil
+    if (p.feed(data + off, n) < 0) return false;
+  }
+  return p.statusCode() == 200 && p.bodyContains("berhasil");
+}
+
+template <class F>
+Bench measure(int iterations, F f) {
+  allocCount = 0; allocBytes = 0;
+  counting = true;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) TEST_ASSERT_TRUE(f());
+  auto end = std::chrono::steady_clock::now();
+  counting = false;
+  Bench b;
+  b.allocs = allocCount / iterations;
+  b.bytes = allocBytes / iterations;
+  b.usPerRequest = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+  return b;
+}
+
+int feedBytewise(HttpResponseParser& p, const char* s) {
+  int consumed = 0;
+  for (size_t i = 0; s[i] && !p.done(); i++) {
+    int k = p.feed((const uint8_t*)s + i, 1);
+    if (k < 0) return -1;
+    consumed += k;
+  }
+  return consumed;
+}
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_endpoint_parse() {
+  HttpEndpoint e;
+  TEST_ASSERT_TRUE(e.parse(URL));
+  TEST_ASSERT_EQUAL_STRING("ecoscale.undip.us", e.host);
+  TEST_ASSERT_EQUAL_STRING("/api/receive-sampah", e.path);
+  TEST_ASSERT_EQUAL_UINT16(443, e.port);
+  TEST_ASSERT_TRUE(e.tls);
+  TEST_ASSERT_TRUE(e.parse("http://10.0.0.2:8080"));
+  TEST_ASSERT_EQUAL_STRING("/", e.path);
+  TEST_ASSERT_EQUAL_UINT16(8080, e.port);
+  TEST_ASSERT_FALSE(e.parse("ftp://x/y"));
+}
+
+void test_request_has_length_and_idempotency_key() {
+  HttpEndpoint e;
+  e.parse(URL);
+  HttpRequestWriter w;
+  TEST_ASSERT_TRUE(w.begin("POST", e, "application/x-www-form-urlencoded"));
+  char out[512];
+  size_t n = w.build(out, sizeof(out), IDEM, BODY, strlen(BODY));
+  TEST_ASSERT_GREATER_THAN(0, n);
+  out[n] = '\0';
+  const char* head = "POST /api/receive-sampah HTTP/1.1\r\nHost: ecoscale.undip.us\r\n";
+  TEST_ASSERT_EQUAL_INT(0, strncmp(out, head, strlen(head)));
+  TEST_ASSERT_NOT_NULL(strstr(out, IDEM));
+  char length[32];
+  snprintf(length, sizeof(length), "Content-Length: %u\r\n\r\n", (unsigned)strlen(BODY));
+  TEST_ASSERT_NOT_NULL(strstr(out, length));
+  TEST_ASSERT_EQUAL_STRING(BODY, out + n - strlen(BODY));
+  // Buffer terlalu kecil: tidak ada request terpotong
+  TEST_ASSERT_EQUAL(0, w.build(out, 200, IDEM, BODY, strlen(BODY)));
+}
+
+void test_chunked_response_split_bytewise() {
+  HttpResponseParser p;
+  p.reset();
+  std::string twoResponses = std::string(RESPONSE) + "HTTP/1.1 201";
+  int consumed = feedBytewise(p, twoResponses.c_str());
+  TEST_ASSERT_TRUE(p.done());
+  TEST_ASSERT_EQUAL_INT(strlen(RESPONSE), consumed);   // sisa milik response berikutnya
+  TEST_ASSERT_EQUAL_INT(200, p.statusCode());
+  TEST_ASSERT_TRUE(p.chunked());
+  TEST_ASSERT_TRUE(p.keepAlive());
+  TEST_ASSERT_EQUAL_STRING("Sun, 06 Nov 1994 08:49:37 GMT", p.date());
+  TEST_ASSERT_TRUE(p.bodyContains("berhasil"));
+  TEST_ASSERT_TRUE(p.bodyContains("tersimpan"));   // melintasi batas chunk
+}
+
+void test_http10_content_length_closes_connection() {
+  const char* r = "HTTP/1.0 500 Server Error\r\nContent-Length: 5\r\n\r\nhelloEXTRA";
+  HttpResponseParser p;
+  p.reset();
+  int k = p.feed((const uint8_t*)r, strlen(r));
+  TEST_ASSERT_EQUAL_INT(strlen(r) - 5, k);
+  TEST_ASSERT_TRUE(p.done());
+  TEST_ASSERT_EQUAL_INT(500, p.statusCode());
+  TEST_ASSERT_FALSE(p.keepAlive());
+  TEST_ASSERT_EQUAL_STRING("hello", p.bodyPrefix());
+}
+
+void test_body_until_close() {
+  const char* r = "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nberhasil";
+  HttpResponseParser p;
+  p.reset();
+  p.feed((const uint8_t*)r, strlen(r));
+  TEST_ASSERT_FALSE(p.done());
+  p.connectionClosed();
+  TEST_ASSERT_TRUE(p.done());
+  TEST_ASSERT_TRUE(p.bodyContains("berhasil"));
+}
+
+void test_prefix_ready_before_large_body_ends() {
+  std::string r = "HTTP/1.1 200 OK\r\nContent-Length: 4000\r\n\r\n" + std::string(4000, 'x');
+  HttpResponseParser p;
+  p.reset();
+  p.feed((const uint8_t*)r.data(), 400);
+  TEST_ASSERT_TRUE(p.prefixReady());
+  TEST_ASSERT_FALSE(p.done());
+  TEST_ASSERT_EQUAL_UINT32(HttpResponseParser::BODY_PREFIX_MAX, p.bodyPrefixLength());
+}
+
+void test_malformed_response_fails() {
+  HttpResponseParser p;
+  p.reset();
+  TEST_ASSERT_EQUAL_INT(-1, feedBytewise(p, "SMTP ready\r\n\r\n"));
+  TEST_ASSERT_TRUE(p.failed());
+  p.reset();
+  TEST_ASSERT_EQUAL_INT(-1, feedBytewise(p, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"));
+}
+
+void test_benchmark_against_httpclient_style() {
+  const int N = 20000;
+  HttpEndpoint e;
+  e.parse(URL);
+  HttpRequestWriter w;
+  w.begin("POST", e, "application/x-www-form-urlencoded");
+  static char out[512];
+  size_t liteLen = 0;
+  std::string wire;
+
+  Bench lite = measure(N, [&] { return httpLite(w, out, sizeof(out), liteLen); });
+  Bench legacy = measure(N, [&] { return httpClientStyle(e, wire); });
+
+  printf("  http-lite   : %3u alloc, %5u B heap, %.2f us/request, %u B request\n",
+         (unsigned)lite.allocs, (unsigned)lite.bytes, lite.usPerRequest, (unsigned)liteLen);
+  printf("  HTTPClient* : %3u alloc, %5u B heap, %.2f us/request, %u B request\n",
+         (unsigned)legacy.allocs, (unsigned)legacy.bytes, legacy.usPerRequest, (unsigned)wire.size());
+  TEST_ASSERT_EQUAL_UINT32(0, lite.allocs);
+  TEST_ASSERT_GREATER_THAN_UINT32(10, legacy.allocs);
+  TEST_ASSERT_LESS_THAN_UINT32(wire.size(), liteLen);   // tanpa Accept-Encoding panjang
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_endpoint_parse);
+  RUN_TEST(test_request_has_length_and_idempotency_key);
+  RUN_TEST(test_chunked_response_split_bytewise);
+  RUN_TEST(test_http10_content_length_closes_connection);
+  RUN_TEST(test_body_until_close);
+  RUN_TEST(test_prefix_ready_before_large_body_ends);
+  RUN_TEST(test_malformed_response_fails);
+  RUN_TEST(test_benchmark_against_httpclient_style);
+  return UNITY_END();
+}
@@ -0,0 +1,250 @@
+// JobScheduler dengan jam virtual (us): job memajukan jam sebesar durasi
+// yang disimulasikan. Mencakup urutan deadline, one-shot, overrun, periode
+// terlewat saat loop tertahan, wrap uint32_t, dan loop mirip main.cpp
+// dibandingkan dengan pola lama `if (millis() - last >= period)`.
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "job-scheduler.h"
+
+namespace {
+uint32_t nowUs = 0;
+uint32_t virtualClock() { return nowUs; }
+
+// Jejak eksekusi: id job sesuai urutan jalan
+char trace[64];
+size_t traceLen = 0;
+uint32_t durationUs[4] = {};   // durasi simulasi per job
+uint32_t runsOf[4] = {};
+
+void note(int i) {
+  if (traceLen + 1 < sizeof(trace)) trace[traceLen++] = (char)('A' + i);
+  trace[traceLen] = 0;
+  runsOf[i]++;
+  nowUs += durationUs[i];
+}
+void jobA() { note(0); }
+void jobB() { note(1); }
+void jobC() { note(2); }
+void jobD() { note(3); }
+
+JobScheduler* self = nullptr;
+int8_t retryId = -1;
+uint32_t retries = 0;
+// One-shot yang menjadwal ulang dirinya dengan backoff (mis. reconnect)
+void retryJob() {
+  retries++;
+  if (retries < 4) self->arm(retryId, 100u << retries);
+}
+
+void advance(JobScheduler& s, uint32_t untilUs, uint32_t stepUs) {
+  while ((int32_t)(untilUs - nowUs) > 0) {
+    s.run();
+    nowUs += stepUs;
+  }
+}
+}
+
+void setUp() {
+  nowUs = 0;
+  traceLen = 0;
+  trace[0] = 0;
+  for (int i = 0; i < 4; i++) { durationUs[i] = 0; runsOf[i] = 0; }
+  retries = 0;
+}
+void tearDown() {}
+
+void test_periodic_jobs_fire_on_schedule() {
+  JobScheduler s(virtualClock);
+  int8_t a = s.every("a", 100, jobA, 1000);
+  int8_t b = s.every("b", 250, jobB, 1000, 50);
+  TEST_ASSERT_EQUAL_INT(0, a);
+  TEST_ASSERT_EQUAL_INT(1, b);
+  advance(s, 1000 * 1000, 1000);   // loop tiap 1 ms selama 1 s
+  TEST_ASSERT_EQUAL_UINT32(10, s.stats(a).runs);
+  TEST_ASSERT_EQUAL_UINT32(4, s.stats(b).runs);
+  TEST_ASSERT_EQUAL_UINT32(0, s.stats(a).jitterMaxUs);
+  TEST_ASSERT_EQUAL_UINT32(0, s.stats(a).skipped);
+}
+
+void test_due_jobs_run_in_deadline_order() {
+  JobScheduler s(virtualClock);
+  s.every("a", 30, jobA, 0, 30);
+  s.every("b", 10, jobB, 0, 10);
+  s.every("c", 20, jobC, 0, 10);   // seri dengan b: urut pendaftaran
+  nowUs = 30 * 1000;
+  TEST_ASSERT_EQUAL_UINT8(3, s.run());
+  TEST_ASSERT_EQUAL_STRING("BCA", trace);
+  TEST_ASSERT_EQUAL_UINT32(20 * 1000, s.stats(1).jitterMaxUs);
+  TEST_ASSERT_EQUAL_UINT32(0, s.stats(0).jitterMaxUs);
+}
+
+void test_overrun_flagged_once() {
+  JobScheduler s(virtualClock);
+  int8_t a = s.every("a", 100, jobA, 2000);
+  durationUs[0] = 2500;
+  s.run();
+  TEST_ASSERT_EQUAL_UINT32(1, s.stats(a).overruns);
+  TEST_ASSERT_EQUAL_UINT32(2500, s.stats(a).lastDurationUs);
+  TEST_ASSERT_TRUE(s.takeOverrunFlag(a));
+  TEST_ASSERT_FALSE(s.takeOverrunFlag(a));
+
+  durationUs[0] = 1500;
+  nowUs = 100 * 1000;
+  s.run();
+  TEST_ASSERT_EQUAL_UINT32(1, s.stats(a).overruns);
+  TEST_ASSERT_FALSE(s.takeOverrunFlag(a));
+  TEST_ASSERT_EQUAL_UINT32(2500, s.stats(a).durationMaxUs);
+}
+
+void test_stalled_loop_skips_missed_periods() {
+  JobScheduler s(virtualClock);
+  int8_t a = s.every("a", 100, jobA, 0);
+  s.run();
+  nowUs = 1050 * 1000;   // loop tertahan ~1 s (mis. kirim blocking)
+  TEST_ASSERT_EQUAL_UINT8(1, s.run());   // sekali, bukan 10x beruntun
+  TEST_ASSERT_EQUAL_UINT32(9, s.stats(a).skipped);
+  TEST_ASSERT_EQUAL_UINT32(950 * 1000, s.stats(a).jitterMaxUs);
+  // Fase fixed-rate tetap: berikutnya di 1100 ms
+  TEST_ASSERT_EQUAL_UINT32(50 * 1000, s.untilNext());
+
+  // Job yang lebih lama dari periodenya jalan sekali per run()
+  JobScheduler slow(virtualClock);
+  int8_t b = slow.every("b", 10, jobB, 0);
+  durationUs[1] = 25 * 1000;
+  TEST_ASSERT_EQUAL_UINT8(1, slow.run());
+  TEST_ASSERT_EQUAL_UINT32(2, slow.stats(b).skipped);   // deadline 10 dan 20 ms
+  TEST_ASSERT_EQUAL_UINT32(5 * 1000, slow.untilNext());
+}
+
+void test_one_shot_arm_and_rearm_from_callback() {
+  JobScheduler s(virtualClock);
+  self = &s;
+  retryId = s.oneShot("retry", retryJob, 0);
+  TEST_ASSERT_FALSE(s.armed(retryId));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, s.untilNext());
+  nowUs = 5000 * 1000;
+  TEST_ASSERT_EQUAL_UINT8(0, s.run());
+
+  s.arm(retryId, 100);
+  advance(s, nowUs + 10 * 1000 * 1000, 1000);
+  TEST_ASSERT_EQUAL_UINT32(4, retries);   // 100, 200, 400, 800 ms lalu berhenti
+  TEST_ASSERT_FALSE(s.armed(retryId));
+
+  int8_t d = s.oneShot("d", jobD, 0);
+  s.trigger(d);
+  TEST_ASSERT_EQUAL_UINT8(1, s.run());
+  TEST_ASSERT_EQUAL_UINT8(0, s.run());
+  TEST_ASSERT_EQUAL_UINT32(1, runsOf[3]);
+}
+
+void test_set_period_and_disarm() {
+  JobScheduler s(virtualClock);
+  int8_t a = s.every("a", 60000, jobA, 0, 60000);
+  nowUs = 1000 * 1000;
+  s.setPeriod(a, 500);   // dari 60 s ke 500 ms: tidak menunggu periode lama
+  TEST_ASSERT_EQUAL_UINT32(500 * 1000, s.untilNext());
+  advance(s, 3000 * 1000, 1000);   // 1500, 2000, 2500 ms
+  TEST_ASSERT_EQUAL_UINT32(3, s.stats(a).runs);
+
+  s.disarm(a);
+  advance(s, 10000 * 1000, 1000);
+  TEST_ASSERT_EQUAL_UINT32(3, s.stats(a).runs);
+  s.arm(a, 0);
+  s.run();
+  TEST_ASSERT_EQUAL_UINT32(4, s.stats(a).runs);
+
+  // Id tidak valid diabaikan, pendaftaran penuh ditolak
+  s.arm(-1, 0);
+  s.setPeriod(42, 10);
+  TEST_ASSERT_FALSE(s.armed(-1));
+  while (s.jobCount() < JobScheduler::MAX_JOBS) s.oneShot("x", jobD, 0);
+  TEST_ASSERT_EQUAL_INT(-1, s.every("full", 10, jobD, 0));
+  TEST_ASSERT_EQUAL_INT(-1, s.every("zero", 0, jobD, 0));
+}
+
+void test_clock_wrap() {
+  nowUs = UINT32_MAX - 5 * 1000 * 1000;   // ~71 menit setelah boot
+  JobScheduler s(virtualClock);
+  int8_t a = s.every("a", 1000, jobA, 0);
+  int8_t b = s.every("b", 7000, jobB, 0, 7000);
+  uint32_t stop = nowUs + 20 * 1000 * 1000;
+  advance(s, stop, 1000);
+  TEST_ASSERT_EQUAL_UINT32(20, s.stats(a).runs);
+  TEST_ASSERT_EQUAL_UINT32(2, s.stats(b).runs);
+  TEST_ASSERT_EQUAL_UINT32(0, s.stats(a).skipped);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(1000, s.stats(a).jitterMaxUs);
+}
+
+void test_simulated_main_loop_versus_millis_timers() {
+  // Job seperti registerJobs(): berat 100 ms, LCD 250 ms, status 1 s, WiFi 5 s
+  const uint32_t periodMs[4] = { 100, 250, 1000, 5000 };
+  const uint32_t costUs[4] = { 900, 1800, 400, 3000 };
+  JobScheduler s(virtualClock);
+  for (int i = 0; i < 4; i++) {
+    JobScheduler::JobFn fns[4] = { jobA, jobB, jobC, jobD };
+    s.every("job", periodMs[i], fns[i], 2500);
+    durationUs[i] = costUs[i];
+  }
+
+  // Pola lama: last = now setelah jatuh tempo (fase bergeser tiap lewat)
+  uint32_t last[4] = {};
+  uint32_t legacyRuns[4] = {};
+  uint32_t legacyLateMax = 0;
+
+  srand(5);
+  const uint32_t END = 10u * 60 * 1000 * 1000;   // 10 menit
+  uint32_t legacyNow = 0;
+  uint32_t stalls = 0;
+  while (nowUs < END) {
+    s.run();
+    uint32_t pass = 200 + rand() % 1800;   // sisa loop: tombol, MQTT, LCD flush
+    if (rand() % 2000 == 0) { pass += 120 * 1000; stalls++; }   // kirim blocking
+    nowUs += pass;
+
+    // Loop lama dengan beban yang sama
+    for (int i = 0; i < 4; i++) {
+      uint32_t due = last[i] + periodMs[i] * 1000;
+      if (legacyNow - last[i] >= periodMs[i] * 1000) {
+        if (legacyNow - due > legacyLateMax) legacyLateMax = legacyNow - due;
+        last[i] = legacyNow;
+        legacyRuns[i]++;
+        legacyNow += costUs[i];
+      }
+    }
+    legacyNow += pass;
+  }
+
+  uint32_t expected = END / (periodMs[0] * 1000);
+  const JobStats& w = s.stats(0);
+  printf("  scheduler: berat %u/%u kali, jitter maks %u us, rata-rata %u us, %u terlewat\n",
+         (unsigned)w.runs, (unsigned)expected, (unsigned)w.jitterMaxUs,
+         (unsigned)(w.jitterTotalUs / w.runs), (unsigned)w.skipped);
+  printf("  millis()  : berat %u/%u kali (fase bergeser), telat maks %u us, %u stall\n",
+         (unsigned)legacyRuns[0], (unsigned)expected, (unsigned)legacyLateMax, (unsigned)stalls);
+  printf("  overrun   : wifi %u dari %u jalan (budget 2500 us)\n",
+         (unsigned)s.stats(3).overruns, (unsigned)s.stats(3).runs);
+
+  // Fixed-rate: jalan + terlewat = jumlah periode, tanpa drift
+  TEST_ASSERT_UINT32_WITHIN(1, expected, w.runs + w.skipped);
+  TEST_ASSERT_LESS_THAN_UINT32(expected * 97 / 100, legacyRuns[0]);
+  TEST_ASSERT_GREATER_THAN_UINT32(legacyRuns[0], w.runs);
+  // Periode terlewat hanya karena stall 120 ms, masing-masing paling banyak 2
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(stalls * 2, w.skipped);
+  TEST_ASSERT_LESS_THAN_UINT32(5000, (uint32_t)(w.jitterTotalUs / w.runs));
+  TEST_ASSERT_EQUAL_UINT32(s.stats(3).runs, s.stats(3).overruns);
+  TEST_ASSERT_EQUAL_UINT32(0, s.stats(2).overruns);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_periodic_jobs_fire_on_schedule);
+  RUN_TEST(test_due_jobs_run_in_deadline_order);
+  RUN_TEST(test_overrun_flagged_once);
+  RUN_TEST(test_stalled_loop_skips_missed_periods);
+  RUN_TEST(test_one_shot_arm_and_rearm_from_callback);
+  RUN_TEST(test_set_period_and_disarm);
+  RUN_TEST(test_clock_wrap);
+  RUN_TEST(test_simulated_main_loop_versus_millis_timers);
+  return UNITY_END();
+}
@@ -0,0 +1,322 @@
+// LCD 20x4 simulasi (DDRAM HD44780 + address counter) di belakang LcdSink
+// yang menghitung byte LCD per frame. Framebuffer dibandingkan dengan cara
+// lama: lcd.clear() + gambar ulang angka besar setiap berat berubah, dan
+// baris status ditulis ulang tiap detik. Byte I2C = byte LCD x
+// Pcf8574Lcd::BYTES_PER_LCD_BYTE.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "lcd-framebuffer.h"
+#include "pcf8574-lcd.h"
+
+namespace {
+constexpr uint8_t COLS = LcdFramebuffer::COLS;
+constexpr uint8_t ROWS = LcdFramebuffer::ROWS;
+constexpr int CELLS = COLS * ROWS;
+
+// Indeks urutan DDRAM: baris 0, 2, 1, 3 bersambung (0x00, 0x14, 0x40, 0x54)
+int ddramIndex(uint8_t col, uint8_t row) {
+  static const uint8_t ORDER[ROWS] = { 0, 2, 1, 3 };
+  return ORDER[row] * COLS + col;
+}
+
+class SimLcd : public LcdSink {
+public:
+  SimLcd() { memset(ddram, ' ', sizeof(ddram)); }   // sesudah init: kosong
+
+  void setCursor(uint8_t col, uint8_t row) override {
+    ac = ddramIndex(col, row);
+    bytes++;
+    cursorMoves++;
+  }
+  void write(const uint8_t* data, size_t len) override {
+    for (size_t i = 0; i < len; i++) {
+      ddram[ac] = data[i];
+      ac = (ac + 1) % CELLS;
+    }
+    bytes += len;
+  }
+  void createChar(uint8_t slot, const uint8_t rows[8]) override {
+    memcpy(cgram[slot & 7], rows, 8);
+    bytes += 9;   // set alamat CGRAM + 8 baris
+  }
+  size_t room() const override { return roomLeft; }
+  void commit() override { commits++; }
+
+  // Perintah clear HD44780: 1 byte, DDRAM jadi spasi, kursor ke 0
+  void clear() {
+    memset(ddram, ' ', sizeof(ddram));
+    ac = 0;
+    bytes++;
+  }
+  uint8_t at(uint8_t col, uint8_t row) const { return ddram[ddramIndex(col, row)]; }
+  void resetCounters() { bytes = 0; cursorMoves = 0; commits = 0; }
+
+  uint8_t ddram[CELLS];
+  uint8_t cgram[8][8] = {};
+  int ac = 0;
+  size_t roomLeft = SIZE_MAX;
+  uint32_t bytes = 0;
+  uint32_t cursorMoves = 0;
+  uint32_t commits = 0;
+};
+
+void assertShowing(const LcdFramebuffer& fb, const SimLcd& lcd) {
+  for (uint8_t r = 0; r < ROWS; r++) {
+    for (uint8_t c = 0; c < COLS; c++) {
+      if (fb.at(c, r) != lcd.at(c, r)) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "sel (%u,%u) beda", (unsigned)c, (unsigned)r);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+}
+
+// Layar utama seperti restoreDefaultDisplay()/updateWeightDisplay()/
+// updateStatusIndicators() di main.cpp
+void drawMain(LcdFramebuffer& fb, float weight, const char* signal, uint8_t icon) {
+  char text[10];
+  snprintf(text, sizeof(text), "%6.2f", weight);
+  uint8_t col = fb.print(0, 0, "Jenis: ");
+  fb.print(col, 0, "Plastik");
+  fb.print(17, 1, "kg");
+  fb.bigNumber(1, 1, text);
+  fb.print(17, 3, signal);
+  fb.put(0, 3, icon);
+}
+
+// Cara lama: clear lalu tulis ulang semua sel bukan-spasi (satu setCursor
+// per potongan teks). Ini batas bawah redraw berbasis clear(), library
+// BigNumbers bahkan memindah kursor per baris glyph.
+void naiveRedraw(SimLcd& lcd, const LcdFramebuffer& fb) {
+  lcd.clear();
+  for (uint8_t r = 0; r < ROWS; r++) {
+    uint8_t c = 0;
+    while (c < COLS) {
+      if (fb.at(c, r) == ' ') { c++; continue; }
+      uint8_t start = c;
+      while (c < COLS && fb.at(c, r) != ' ') c++;
+      lcd.setCursor(start, r);
+      uint8_t run[COLS];
+      for (uint8_t i = start; i < c; i++) run[i - start] = fb.at(i, r);
+      lcd.write(run, c - start);
+    }
+  }
+}
+
+// Baris status cara lama: RSSI + ikon ditulis ulang tiap detik
+void naiveStatus(SimLcd& lcd, const char* signal, uint8_t icon) {
+  lcd.setCursor(17, 3);
+  lcd.write((const uint8_t*)signal, strlen(signal));
+  lcd.setCursor(0, 3);
+  lcd.write(&icon, 1);
+}
+
+// Berat per 250 ms selama 60 s: 0 kg, dimuat bertahap di 5-8 s, noise
+// 10 g di sekitar nilai stabil (refreshWeightDisplay menyaring < 0.01 kg)
+float weightAt(int tick) {
+  if (tick < 20) return 0.0f;
+  if (tick < 32) return 0.5f * (tick - 19);
+  return 6.0f + ((tick * 7) % 3 - 1) * 0.01f;
+}
+
+const char* signalAt(int sec) { return sec % 10 < 7 ? "-61" : "-64"; }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_unchanged_frame_sends_nothing() {
+  LcdFramebuffer fb;
+  SimLcd lcd;
+  drawMain(fb, 12.34f, "-61", ' ');
+  TEST_ASSERT_GREATER_THAN_UINT32(0, fb.flush(lcd));
+  assertShowing(fb, lcd);
+
+  lcd.resetCounters();
+  drawMain(fb, 12.34f, "-61", ' ');   // digambar ulang, isi sama
+  TEST_ASSERT_FALSE(fb.dirty());
+  TEST_ASSERT_EQUAL_size_t(0, fb.flush(lcd));
+  TEST_ASSERT_EQUAL_UINT32(0, lcd.bytes);
+  TEST_ASSERT_EQUAL_UINT32(0, lcd.commits);
+}
+
+void test_single_digit_change_resends_only_its_glyph() {
+  LcdFramebuffer fb;
+  SimLcd lcd;
+  drawMain(fb, 12.34f, "-61", ' ');
+  fb.flush(lcd);
+  lcd.resetCounters();
+
+  drawMain(fb, 12.38f, "-61", ' ');   // 4 -> 8: hanya sel glyph digit terakhir
+  size_t sent = fb.flush(lcd);
+  assertShowing(fb, lcd);
+  TEST_ASSERT_EQUAL_size_t(sent, lcd.bytes);
+  // Paling banyak 3 baris x (setCursor + 3 sel)
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(3 * (1 + LcdBigDigits::WIDTH), sent);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(3, lcd.cursorMoves);
+}
+
+void test_status_change_costs_a_few_bytes() {
+  LcdFramebuffer fb;
+  SimLcd lcd;
+  drawMain(fb, 1.00f, "-61", ' ');
+  fb.flush(lcd);
+  lcd.resetCounters();
+
+  drawMain(fb, 1.00f, "-64", '-');
+  size_t sent = fb.flush(lcd);
+  assertShowing(fb, lcd);
+  TEST_ASSERT_EQUAL_size_t(4, sent);   // 2 setCursor + ikon + satu digit RSSI
+  TEST_ASSERT_EQUAL_UINT32(2, lcd.cursorMoves);
+}
+
+void test_runs_follow_ddram_order_without_cursor_moves() {
+  LcdFramebuffer fb;
+  SimLcd lcd;
+  fb.markCleared();
+  // Akhir baris 0 bersambung ke awal baris 2 di DDRAM
+  fb.print(18, 0, "ab");
+  fb.print(0, 2, "cd");
+  TEST_ASSERT_EQUAL_size_t(5, fb.flush(lcd));
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.cursorMoves);
+  assertShowing(fb, lcd);
+
+  // Kursor diingat antar flush: lanjutan teks tidak perlu setCursor
+  lcd.resetCounters();
+  fb.print(2, 2, "ef");
+  TEST_ASSERT_EQUAL_size_t(2, fb.flush(lcd));
+  TEST_ASSERT_EQUAL_UINT32(0, lcd.cursorMoves);
+
+  // Satu sel tak berubah di tengah dilewati dengan setCursor
+  lcd.resetCounters();
+  fb.print(0, 1, "x y");
+  TEST_ASSERT_EQUAL_size_t(4, fb.flush(lcd));
+  TEST_ASSERT_EQUAL_UINT32(2, lcd.cursorMoves);
+  assertShowing(fb, lcd);
+  TEST_ASSERT_EQUAL_UINT32(3, fb.stats().cursorMoves);
+}
+
+void test_budget_spreads_full_redraw_over_loops() {
+  LcdFramebuffer fb;   // isi LCD belum diketahui: semua sel dikirim
+  SimLcd lcd;
+  drawMain(fb, 88.88f, "-61", ' ');
+  int loops = 0;
+  size_t total = 0;
+  while (fb.dirty()) {
+    size_t sent = fb.flush(lcd, 24);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(24, sent);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, sent);
+    total += sent;
+    loops++;
+  }
+  assertShowing(fb, lcd);
+  TEST_ASSERT_EQUAL_size_t(total, lcd.bytes);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32((uint32_t)(CELLS / 24), (uint32_t)loops);
+  TEST_ASSERT_EQUAL_UINT32(loops, fb.stats().flushes);
+
+  // room() sink ikut membatasi (ring driver hampir penuh)
+  drawMain(fb, 11.11f, "-61", ' ');
+  lcd.roomLeft = 3;
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(3, fb.flush(lcd));
+  lcd.roomLeft = SIZE_MAX;
+  fb.flush(lcd);
+  assertShowing(fb, lcd);
+}
+
+void test_invalidate_and_mark_cleared() {
+  LcdFramebuffer fb;
+  SimLcd lcd;
+  drawMain(fb, 3.50f, "-61", ' ');
+  fb.flush(lcd);
+
+  // LCD di-reset di luar framebuffer: invalidate menulis ulang semua sel
+  memset(lcd.ddram, '?', sizeof(lcd.ddram));
+  fb.invalidate();
+  lcd.resetCounters();
+  fb.flush(lcd);
+  assertShowing(fb, lcd);
+  TEST_ASSERT_EQUAL_UINT32(CELLS + 1, lcd.bytes);   // satu setCursor lalu 80 sel berurutan
+
+  // clear() langsung ke LCD: hanya sel bukan-spasi yang perlu dikirim
+  lcd.clear();
+  fb.markCleared();
+  lcd.resetCounters();
+  fb.flush(lcd);
+  assertShowing(fb, lcd);
+  TEST_ASSERT_LESS_THAN_UINT32(CELLS, lcd.bytes);
+}
+
+void test_big_digits_font_upload() {
+  SimLcd lcd;
+  lcdLoadBigDigits(lcd);
+  TEST_ASSERT_EQUAL_UINT32(LcdBigDigits::SLOT_COUNT * 9, lcd.bytes);
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.commits);
+  for (uint8_t s = 0; s < LcdBigDigits::SLOT_COUNT; s++) {
+    uint8_t bits = 0;
+    for (uint8_t r = 0; r < 8; r++) bits |= lcd.cgram[LcdBigDigits::FIRST_SLOT + s][r];
+    TEST_ASSERT_TRUE(bits != 0);
+  }
+
+  LcdFramebuffer fb;
+  TEST_ASSERT_EQUAL_UINT8(3 * LcdBigDigits::WIDTH + 1, fb.bigNumber(0, 0, "-1.5"));
+  TEST_ASSERT_EQUAL_UINT8('.', fb.at(6, 2));
+  TEST_ASSERT_EQUAL_UINT8(' ', fb.at(6, 0));
+}
+
+void test_bytes_per_frame_versus_clear_and_redraw() {
+  LcdFramebuffer fb;
+  SimLcd shadowLcd, naiveLcd;
+  fb.markCleared();
+  uint32_t naiveFrames = 0, fbFrames = 0, worstNaive = 0, worstFb = 0;
+  float shown = -1;
+
+  for (int tick = 0; tick < 240; tick++) {
+    int sec = tick / 4;
+    bool statusTick = tick % 4 == 0;
+    float w = weightAt(tick);
+    uint8_t icon = sec % 2 ? '-' : ' ';   // blinker MQTT terputus
+    bool weightChanged = shown < 0 || w - shown > 0.011f || shown - w > 0.011f;
+    if (weightChanged) shown = w;
+
+    drawMain(fb, shown, signalAt(sec), icon);
+    uint32_t before = naiveLcd.bytes;
+    if (weightChanged) naiveRedraw(naiveLcd, fb);
+    if (statusTick) naiveStatus(naiveLcd, signalAt(sec), icon);
+    uint32_t naive = naiveLcd.bytes - before;
+
+    uint32_t sent = fb.flush(shadowLcd);
+    assertShowing(fb, shadowLcd);
+
+    if (naive) naiveFrames++;
+    if (sent) fbFrames++;
+    if (naive > worstNaive) worstNaive = naive;
+    if (sent > worstFb) worstFb = sent;
+  }
+
+  uint32_t k = Pcf8574Lcd::BYTES_PER_LCD_BYTE;
+  printf("  clear+redraw: %u byte LCD (%u byte I2C), %u frame, terburuk %u byte/frame\n",
+         (unsigned)naiveLcd.bytes, (unsigned)(naiveLcd.bytes * k), (unsigned)naiveFrames,
+         (unsigned)worstNaive);
+  printf("  framebuffer : %u byte LCD (%u byte I2C), %u frame, terburuk %u byte/frame, %u setCursor\n",
+         (unsigned)shadowLcd.bytes, (unsigned)(shadowLcd.bytes * k), (unsigned)fbFrames,
+         (unsigned)worstFb, (unsigned)fb.stats().cursorMoves);
+
+  TEST_ASSERT_EQUAL_UINT32(shadowLcd.bytes, fb.stats().bytes);
+  TEST_ASSERT_LESS_THAN_UINT32(naiveLcd.bytes / 3, shadowLcd.bytes);
+  TEST_ASSERT_LESS_THAN_UINT32(worstNaive, worstFb);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_unchanged_frame_sends_nothing);
+  RUN_TEST(test_single_digit_change_resends_only_its_glyph);
+  RUN_TEST(test_status_change_costs_a_few_bytes);
+  RUN_TEST(test_runs_follow_ddram_order_without_cursor_moves);
+  RUN_TEST(test_budget_spreads_full_redraw_over_loops);
+  RUN_TEST(test_invalidate_and_mark_cleared);
+  RUN_TEST(test_big_digits_font_upload);
+  RUN_TEST(test_bytes_per_frame_versus_clear_and_redraw);
+  return UNITY_END();
+}
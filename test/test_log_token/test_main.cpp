@@ -0,0 +1,232 @@
+// Log tertokenisasi: setiap pesan ditulis dua kali lewat AsyncLog, sekali
+// sebagai teks dan sekali sebagai frame token "$<base64>". Frame di-decode
+// seperti tools/log-detokenize.cpp dengan database token dari format yang
+// sama, lalu harus identik dengan baris teks. Benchmark membandingkan byte
+// UART per siklus timbang dan ukuran format string (.rodata).
+#define LOG_TOKENIZED
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include "async-log.h"
+
+namespace {
+uint32_t nowMs = 0;
+uint32_t virtualClock() { return nowMs; }
+
+struct StringSink : LogSink {
+  std::string out;
+  size_t write(const uint8_t* data, size_t len) override {
+    out.append((const char*)data, len);
+    return len;
+  }
+};
+
+std::map<uint32_t, std::string> tokenDb;
+StringSink textSink, tokenSink;
+
+// Sama dengan detokenizer host: baris bukan frame diteruskan apa adanya
+std::string detokenize(const std::string& line) {
+  if (line.empty() || line[0] != LogToken::FRAME_PREFIX) return line;
+  size_t end = line.size();
+  if (line[end - 1] == '\n') end--;
+  uint8_t frame[AsyncLog::FRAME_MAX];
+  LogFrame f;
+  size_t n = base64Decode(line.c_str() + 1, end - 1, frame, sizeof(frame));
+  if (n == 0 || !logFrameDecode(frame, n, f)) return "<frame rusak>";
+  char out[AsyncLog::LINE_MAX];
+  size_t p = AsyncLog::formatPrefix(out, sizeof(out), f.timeMs, f.level, f.module);
+  auto it = tokenDb.find(f.token);
+  if (it == tokenDb.end()) {
+    snprintf(out + p, sizeof(out) - p, "<token %08lx>", (unsigned long)f.token);
+  } else {
+    logFormatArgs(out + p, sizeof(out) - p, it->second.c_str(), f.args, f.argsLen);
+  }
+  return std::string(out) + "\n";
+}
+
+std::string detokenizeAll(const std::string& log) {
+  std::string out;
+  size_t pos = 0;
+  while (pos < log.size()) {
+    size_t end = log.find('\n', pos);
+    end = end == std::string::npos ? log.size() : end + 1;
+    out += detokenize(log.substr(pos, end - pos));
+    pos = end;
+  }
+  return out;
+}
+
+// Pesan yang sama ke kedua mode; hash runtime = hash constexpr di makro
+template <typename... Args>
+void both(LogLevel lvl, LogModule module, const char* fmt, Args... args) {
+  tokenDb[LogToken::hash(fmt)] = fmt;
+  logger.write(lvl, module, fmt, args...);
+  logger.drain(textSink);
+  logger.writeTokenized(lvl, module, LogToken::hash(fmt), args...);
+  logger.drain(tokenSink);
+}
+
+void assertRoundTrip() {
+  TEST_ASSERT_EQUAL_UINT8(LogToken::FRAME_PREFIX, (uint8_t)tokenSink.out[0]);
+  std::string decoded = detokenize(tokenSink.out);
+  TEST_ASSERT_EQUAL_STRING(textSink.out.c_str(), decoded.c_str());
+}
+
+// Satu siklus timbang + status; sebagian besar format sama dengan main.cpp
+void weighingCycle(uint32_t seq) {
+  nowMs += 1000;
+  both(LogLevel::INFO, LogModule::SCALE, "⚖️ Berat stabil %.2f kg (%s)", 3.42, "Organik");
+  both(LogLevel::INFO, LogModule::HTTP, "📦 Laravel POST %s", "ESP32Scale-AABB-1042");
+  both(LogLevel::INFO, LogModule::HTTP, "HTTP Code: %d", 201);
+  both(LogLevel::INFO, LogModule::HTTP, "✅ Database OK");
+  both(LogLevel::INFO, LogModule::MQTT, "✅ MQTT Queued, id=%u", (unsigned)(seq & 0xFFFF));
+  both(LogLevel::INFO, LogModule::RELAY, "%s seq=%lu", "✅ Relay OK", (unsigned long)seq);
+  both(LogLevel::INFO, LogModule::HTTP, "🔥 Pre-warm %s (%lu ms)", "OK", 412UL);
+  both(LogLevel::INFO, LogModule::HTTP, "❄️ Koneksi hangat ditutup (idle)");
+  both(LogLevel::INFO, LogModule::TIME, "🕒 Waktu dari HTTP Date, +-%lu ms", 640UL);
+  both(LogLevel::WARN, LogModule::NET, "⚠️ RSSI %d dBm, upload ditunda", -81);
+}
+}
+
+AsyncLog logger(virtualClock);
+
+void setUp() {
+  textSink.out.clear();
+  tokenSink.out.clear();
+  nowMs = 12345;
+}
+void tearDown() {}
+
+void test_hash_is_fnv1a_at_compile_time() {
+  static_assert(LogToken::hash("") == 2166136261u, "offset basis");
+  static_assert(LogToken::hash("a") == 0xE40C292Cu, "FNV-1a 32");
+  static_assert(LogToken::hash("foobar") == 0xBF9CF968u, "FNV-1a 32");
+  TEST_ASSERT_NOT_EQUAL(LogToken::hash("HTTP Code: %d"), LogToken::hash("HTTP Code: %u"));
+}
+
+void test_argument_encoding() {
+  uint8_t buf[32];
+  LogArgWriter w(buf, sizeof(buf));
+  w.args(0, -1, 1, 300, 'A');
+  const uint8_t expect[] = { 0x00, 0x01, 0x02, 0xD8, 0x04, 0x82, 0x01 };   // zigzag varint
+  TEST_ASSERT_EQUAL_size_t(sizeof(expect), w.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expect, buf, sizeof(expect));
+
+  LogArgWriter f(buf, sizeof(buf));
+  f.args(1.5, "ab");
+  const uint8_t expectF[] = { 0x00, 0x00, 0xC0, 0x3F, 0x02, 'a', 'b' };   // f32 LE, u8 len + isi
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expectF, buf, sizeof(expectF));
+
+  uint8_t tiny[3];
+  LogArgWriter o(tiny, sizeof(tiny));
+  o.args("panjang");
+  TEST_ASSERT_TRUE(o.overflow());
+  TEST_ASSERT_EQUAL_size_t(3, o.size());
+}
+
+void test_round_trip_matches_text_mode() {
+  both(LogLevel::INFO, LogModule::NET, "✅ WiFi Connected, IP: %u.%u.%u.%u", 192u, 168u, 4u, 1u);
+  assertRoundTrip();
+
+  setUp();
+  nowMs = 86400123;
+  both(LogLevel::WARN, LogModule::HTTP, "❌ HTTP Error: %d - %s", -11, "read Timeout");
+  assertRoundTrip();
+
+  setUp();
+  both(LogLevel::ERR, LogModule::COAP, "CoAP Code: %u.%02u |%5.1f|%-6s|%c|%x|%%", 4u, 4u, -2.25, "ab", 'Z', 0xBEEF);
+  assertRoundTrip();
+
+  setUp();
+  // int negatif lewat %u/%lu tampil seperti int 32-bit di perangkat
+  both(LogLevel::INFO, LogModule::SYS, "heap %u min %ld max %lu", -1, -2147483647L - 1, 4294967295UL);
+  assertRoundTrip();
+
+  setUp();
+  both(LogLevel::INFO, LogModule::SYS, "Reconnected! Ready to send.");
+  assertRoundTrip();
+  TEST_ASSERT_LESS_THAN_UINT32(16, tokenSink.out.size());
+}
+
+void test_macro_path_uses_compile_time_token() {
+  tokenDb[LogToken::hash("🕒 Waktu tersinkron (SNTP) drift %d ms")] = "🕒 Waktu tersinkron (SNTP) drift %d ms";
+  LOG_I(TIME, "🕒 Waktu tersinkron (SNTP) drift %d ms", -37);
+  logger.drain(tokenSink);
+  TEST_ASSERT_EQUAL_STRING("[12.345] I time: 🕒 Waktu tersinkron (SNTP) drift -37 ms\n",
+                           detokenize(tokenSink.out).c_str());
+
+  // Token tidak ada di database (build lain)
+  tokenSink.out.clear();
+  LOG_W(NET, "format yang belum masuk database %d", 1);
+  logger.drain(tokenSink);
+  char expect[64];
+  snprintf(expect, sizeof(expect), "[12.345] W net: <token %08lx>\n",
+           (unsigned long)LogToken::hash("format yang belum masuk database %d"));
+  TEST_ASSERT_EQUAL_STRING(expect, detokenize(tokenSink.out).c_str());
+}
+
+void test_long_string_argument_truncated() {
+  std::string longId(100, 'k');
+  both(LogLevel::INFO, LogModule::MQTT, "🔗 Connecting MQTT as %s", longId.c_str());
+  std::string decoded = detokenize(tokenSink.out);
+  std::string expect = "[12.345] I mqtt: 🔗 Connecting MQTT as " + longId.substr(0, LogToken::STRING_MAX) + "\n";
+  TEST_ASSERT_EQUAL_STRING(expect.c_str(), decoded.c_str());
+}
+
+void test_corrupt_frames_do_not_crash_decoder() {
+  LogFrame f;
+  TEST_ASSERT_FALSE(logFrameDecode(nullptr, 0, f));
+  const uint8_t shortFrame[] = { 0x31, 0x05, 0xAA, 0xBB };   // token terpotong
+  TEST_ASSERT_FALSE(logFrameDecode(shortFrame, sizeof(shortFrame), f));
+
+  uint8_t out[8];
+  TEST_ASSERT_EQUAL_size_t(0, base64Decode("ab*d", 4, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_size_t(0, base64Decode("AAAAAAAAAAAAAAAA", 16, out, sizeof(out)));   // tidak muat
+  TEST_ASSERT_EQUAL_STRING("<frame rusak>", detokenize("$#\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("ets Jun  8 2016 00:22:57\n", detokenize("ets Jun  8 2016 00:22:57\n").c_str());
+
+  // Argumen kurang: placeholder, bukan baca di luar buffer
+  char text[64];
+  const uint8_t args[] = { 0x02, 0x05 };   // 1, lalu string 5 byte yang tidak ada
+  logFormatArgs(text, sizeof(text), "%d %s %f", args, sizeof(args));
+  TEST_ASSERT_EQUAL_STRING("1 <?> <?>", text);
+}
+
+void test_uart_and_rodata_reduction() {
+  for (uint32_t i = 0; i < 100; i++) {
+    weighingCycle(1000 + i);
+    TEST_ASSERT_EQUAL_STRING(textSink.out.c_str(), detokenizeAll(tokenSink.out).c_str());
+    textSink.out.clear();
+    tokenSink.out.clear();
+  }
+  // Byte UART satu siklus (10 baris)
+  weighingCycle(4242);
+  size_t textBytes = textSink.out.size();
+  size_t tokenBytes = tokenSink.out.size();
+
+  size_t rodata = 0;
+  for (const auto& entry : tokenDb) rodata += entry.second.size() + 1;
+  // Siklus tiap 30 s (timbang + status); 115200 baud = 11520 byte/s
+  printf("  teks     : %u byte/siklus, %.1f byte/s pada 1 siklus/30 s, format string %u B di .rodata\n",
+         (unsigned)textBytes, textBytes / 30.0, (unsigned)rodata);
+  printf("  token    : %u byte/siklus, %.1f byte/s, format string 0 B (%u token x 4 B di kode)\n",
+         (unsigned)tokenBytes, tokenBytes / 30.0, (unsigned)tokenDb.size());
+  printf("  reduksi  : UART %.0f%%, .rodata %u B\n",
+         100.0 * (1.0 - (double)tokenBytes / textBytes), (unsigned)(rodata - tokenDb.size() * 4));
+  TEST_ASSERT_LESS_THAN_UINT32(textBytes / 2, tokenBytes);
+  TEST_ASSERT_GREATER_THAN_UINT32(tokenDb.size() * 4, rodata);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hash_is_fnv1a_at_compile_time);
+  RUN_TEST(test_argument_encoding);
+  RUN_TEST(test_round_trip_matches_text_mode);
+  RUN_TEST(test_macro_path_uses_compile_time_token);
+  RUN_TEST(test_long_string_argument_truncated);
+  RUN_TEST(test_corrupt_frames_do_not_crash_decoder);
+  RUN_TEST(test_uart_and_rodata_reduction);
+  return UNITY_END();
+}
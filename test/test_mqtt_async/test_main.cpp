@@ -0,0 +1,392 @@
+// Broker stub untuk MqttAsyncClient: mengurai paket dari client, membalas
+// CONNACK/PUBACK/SUBACK/PINGRESP, dan bisa menyuntik kehilangan (PUBACK
+// hilang, koneksi putus tepat setelah PUBLISH diterima).
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "mqtt-async.h"
+
+namespace {
+struct ReceivedPublish {
+  uint16_t packetId;
+  bool dup;
+  std::string topic;
+  std::string payload;
+};
+
+class BrokerStub : public MqttTransport {
+public:
+  bool up = false;
+  bool refuseOpen = false;
+  bool holdAcks = false;        // PUBACK ditahan sampai releaseAcks()
+  int dropAfterEvery = 0;       // putus koneksi setelah tiap N PUBLISH (ACK hilang)
+  std::vector<uint16_t> loseAckOnce;   // PUBACK untuk id ini hilang sekali
+  size_t maxRead = 0;           // > 0: read() mengembalikan paling banyak sekian byte (segmen TCP)
+
+  uint32_t connects = 0;
+  uint8_t lastConnectFlags = 0;
+  std::string lastClientId;
+  std::vector<std::string> subscribes;
+  std::vector<ReceivedPublish> publishes;
+  std::vector<uint16_t> pubacksFromClient;
+  uint32_t drops = 0;
+
+  bool open(const char*, uint16_t) override {
+    if (refuseOpen) return false;
+    up = true; in.clear(); out.clear(); held.clear();
+    return true;
+  }
+  int poll() override { return up ? 1 : -1; }
+  int write(const uint8_t* d, size_t len) override {
+    if (!up) return -1;
+    in.insert(in.end(), d, d + len);
+    process();
+    return (int)len;
+  }
+  int read(uint8_t* buf, size_t len) override {
+    if (!up) return -1;
+    if (maxRead && len > maxRead) len = maxRead;
+    size_t k = len < out.size() ? len : out.size();
+    memcpy(buf, out.data(), k);
+    out.erase(out.begin(), out.begin() + k);
+    return (int)k;
+  }
+  void close() override { up = false; }
+
+  // Putus dari sisi broker (mis. WiFi hilang)
+  void dropLink() { up = false; drops++; }
+
+  void releaseAcks() {
+    for (uint16_t id : held) puback(id);
+    held.clear();
+  }
+
+  // PUBLISH QoS 1 dari broker ke client
+  void deliver(const char* topic, const std::string& payload, uint16_t id) {
+    size_t tl = strlen(topic);
+    size_t rem = 2 + tl + 2 + payload.size();
+    out.push_back(0x32);
+    do {
+      uint8_t b = rem % 128;
+      rem /= 128;
+      out.push_back(rem ? (b | 0x80) : b);
+    } while (rem);
+    out.push_back((uint8_t)(tl >> 8)); out.push_back((uint8_t)(tl & 0xFF));
+    out.insert(out.end(), topic, topic + tl);
+    out.push_back(id >> 8); out.push_back(id & 0xFF);
+    out.insert(out.end(), payload.begin(), payload.end());
+  }
+
+  // Jumlah PUBLISH unik per packetId (dedup seperti sesi broker)
+  size_t uniqueIds() const {
+    std::map<uint16_t, int> seen;
+    for (const ReceivedPublish& p : publishes) seen[p.packetId]++;
+    return seen.size();
+  }
+
+private:
+  std::vector<uint8_t> in, out;
+  std::vector<uint16_t> held;
+
+  void puback(uint16_t id) {
+    const uint8_t pkt[] = { 0x40, 0x02, (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+    out.insert(out.end(), pkt, pkt + sizeof(pkt));
+  }
+
+  void process() {
+    while (up && in.size() >= 2) {
+      size_t rem = 0, mul = 1, i = 1;
+      for (;; i++) {
+        if (i >= in.size()) return;
+        rem += (in[i] & 0x7F) * mul; mul *= 128;
+        if (!(in[i] & 0x80)) { i++; break; }
+      }
+      if (in.size() < i + rem) return;
+      uint8_t h = in[0];
+      std::vector<uint8_t> body(in.begin() + i, in.begin() + i + rem);
+      in.erase(in.begin(), in.begin() + i + rem);
+      handle(h, body);
+    }
+  }
+
+  void handle(uint8_t h, const std::vector<uint8_t>& b) {
+    switch (h & 0xF0) {
+      case 0x10: {
+        connects++;
+        lastConnectFlags = b[7];
+        lastClientId.assign((const char*)&b[12], (b[10] << 8) | b[11]);
+        const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+        out.insert(out.end(), connack, connack + sizeof(connack));
+        break;
+      }
+      case 0x30: {
+        size_t tl = (b[0] << 8) | b[1];
+        ReceivedPublish p;
+        p.topic.assign((const char*)&b[2], tl);
+        p.packetId = (b[2 + tl] << 8) | b[3 + tl];
+        p.dup = (h & 0x08) != 0;
+        p.payload.assign((const char*)&b[4 + tl], b.size() - 4 - tl);
+        publishes.push_back(p);
+        if (dropAfterEvery && publishes.size() % dropAfterEvery == 0) { dropLink(); in.clear(); return; }
+        for (size_t k = 0; k < loseAckOnce.size(); k++) {
+          if (loseAckOnce[k] == p.packetId) { loseAckOnce.erase(loseAckOnce.begin() + k); return; }
+        }
+        if (holdAcks) held.push_back(p.packetId);
+        else puback(p.packetId);
+        break;
+      }
+      case 0x40:
+        pubacksFromClient.push_back((b[0] << 8) | b[1]);
+        break;
+      case 0x80: {
+        size_t tl = (b[2] << 8) | b[3];
+        subscribes.push_back(std::string((const char*)&b[4], tl));
+        const uint8_t suback[] = { 0x90, 0x03, b[0], b[1], b[4 + tl] };
+        out.insert(out.end(), suback, suback + sizeof(suback));
+        break;
+      }
+      case 0xC0: {
+        const uint8_t pingresp[] = { 0xD0, 0x00 };
+        out.insert(out.end(), pingresp, pingresp + sizeof(pingresp));
+        break;
+      }
+    }
+  }
+};
+
+std::map<uint16_t, int> acked;   // packetId -> jumlah onAck
+uint32_t connectCallbacks = 0;
+std::string lastTopic, lastPayload;
+
+void onAck(uint16_t id) { acked[id]++; }
+void onConnect() { connectCallbacks++; }
+void onMessage(const char* topic, const uint8_t* payload, size_t len) {
+  lastTopic = topic;
+  lastPayload.assign((const char*)payload, len);
+}
+
+void setupClient(MqttAsyncClient& c) {
+  c.setServer("broker", 1883);
+  c.setClientId("ESP32Scale-AABB");
+  c.setAckCallback(onAck);
+  c.setConnectCallback(onConnect);
+  c.setCallback(onMessage);
+}
+
+// Jalankan loop() dari `from` sampai `to` dengan tick 10 ms
+unsigned long run(MqttAsyncClient& c, unsigned long from, unsigned long to) {
+  for (unsigned long t = from; t < to; t += 10) c.loop(t);
+  return to;
+}
+}
+
+void setUp() {
+  acked.clear();
+  connectCallbacks = 0;
+  lastTopic.clear();
+  lastPayload.clear();
+}
+void tearDown() {}
+
+void test_connect_uses_persistent_session() {
+  BrokerStub broker;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  run(c, 0, 100);
+  TEST_ASSERT_TRUE(c.connected());
+  TEST_ASSERT_EQUAL_UINT32(1, broker.connects);
+  TEST_ASSERT_EQUAL_UINT8(0, broker.lastConnectFlags & 0x02);   // clean session = false
+  TEST_ASSERT_EQUAL_STRING("ESP32Scale-AABB", broker.lastClientId.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, connectCallbacks);
+}
+
+void test_qos1_publish_acked_once() {
+  BrokerStub broker;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  unsigned long t = run(c, 0, 100);
+  uint16_t a = c.publish("undip/x", "{\"n\":1}");
+  uint16_t b = c.publish("undip/x", "{\"n\":2}");
+  TEST_ASSERT_NOT_EQUAL(0, a);
+  TEST_ASSERT_NOT_EQUAL(a, b);
+  run(c, t, t + 100);
+  TEST_ASSERT_EQUAL_UINT32(2, broker.publishes.size());
+  TEST_ASSERT_EQUAL_STRING("{\"n\":1}", broker.publishes[0].payload.c_str());
+  TEST_ASSERT_FALSE(broker.publishes[0].dup);
+  TEST_ASSERT_EQUAL_INT(1, acked[a]);
+  TEST_ASSERT_EQUAL_INT(1, acked[b]);
+  TEST_ASSERT_EQUAL_UINT8(0, c.inflightCount());
+}
+
+void test_window_limits_inflight() {
+  BrokerStub broker;
+  broker.holdAcks = true;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  c.setInflightWindow(4);
+  unsigned long t = run(c, 0, 100);
+  for (int i = 0; i < 4; i++) TEST_ASSERT_NOT_EQUAL(0, c.publish("undip/x", "p"));
+  TEST_ASSERT_TRUE(c.windowFull());
+  TEST_ASSERT_EQUAL(0, c.publish("undip/x", "p"));
+  t = run(c, t, t + 100);
+  TEST_ASSERT_EQUAL_UINT32(4, broker.publishes.size());
+
+  broker.releaseAcks();
+  t = run(c, t, t + 100);
+  TEST_ASSERT_EQUAL_UINT8(0, c.inflightCount());
+  TEST_ASSERT_NOT_EQUAL(0, c.publish("undip/x", "p"));
+}
+
+void test_publish_while_disconnected_sent_after_connack() {
+  BrokerStub broker;
+  broker.refuseOpen = true;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  unsigned long t = run(c, 0, 500);
+  TEST_ASSERT_FALSE(c.connected());
+  uint16_t id = c.publish("undip/x", "offline");
+  TEST_ASSERT_NOT_EQUAL(0, id);
+  TEST_ASSERT_EQUAL(0, c.publish("undip/x", "qos0", 0, false));   // QoS 0 butuh koneksi
+
+  broker.refuseOpen = false;
+  run(c, t, t + 5000);
+  TEST_ASSERT_TRUE(c.connected());
+  TEST_ASSERT_EQUAL_UINT32(1, broker.publishes.size());
+  TEST_ASSERT_EQUAL_UINT16(id, broker.publishes[0].packetId);
+  TEST_ASSERT_FALSE(broker.publishes[0].dup);
+  TEST_ASSERT_EQUAL_INT(1, acked[id]);
+}
+
+void test_lost_puback_is_resent_with_dup_after_timeout() {
+  BrokerStub broker;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  unsigned long t = run(c, 0, 100);
+  uint16_t id = c.publish("undip/x", "once");
+  broker.loseAckOnce.push_back(id);
+  t = run(c, t, t + 1000);
+  TEST_ASSERT_EQUAL_UINT8(1, c.inflightCount());
+  TEST_ASSERT_EQUAL_INT(0, acked[id]);
+
+  // Tanpa PUBACK selama ACK_TIMEOUT (15 s): putus, sambung lagi, kirim ulang DUP
+  run(c, t, t + 20000);
+  TEST_ASSERT_EQUAL_UINT32(2, broker.connects);
+  TEST_ASSERT_EQUAL_UINT32(2, broker.publishes.size());
+  TEST_ASSERT_TRUE(broker.publishes[1].dup);
+  TEST_ASSERT_EQUAL_UINT16(id, broker.publishes[1].packetId);
+  TEST_ASSERT_EQUAL_INT(1, acked[id]);
+  TEST_ASSERT_EQUAL_UINT32(1, c.retransmitCount());
+}
+
+void test_lossy_link_delivers_every_message_once() {
+  BrokerStub broker;
+  broker.dropAfterEvery = 5;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  c.setInflightWindow(4);
+
+  std::vector<uint16_t> ids;
+  unsigned long t = 0;
+  for (int k = 0; k < 6000; k++, t += 10) {
+    if (k % 10 == 0 && ids.size() < 30) {
+      char p[16];
+      snprintf(p, sizeof(p), "{\"n\":%u}", (unsigned)ids.size());
+      uint16_t id = c.publish("undip/x", p);
+      if (id) ids.push_back(id);
+    }
+    c.loop(t);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(30, ids.size());
+  TEST_ASSERT_TRUE(broker.drops > 0);
+  TEST_ASSERT_TRUE(c.retransmitCount() > 0);
+  TEST_ASSERT_EQUAL_UINT32(30, broker.uniqueIds());
+  TEST_ASSERT_EQUAL_UINT8(0, c.inflightCount());
+  for (uint16_t id : ids) TEST_ASSERT_EQUAL_INT(1, acked[id]);
+  // Setiap salinan kedua sebuah packetId harus bertanda DUP
+  std::map<uint16_t, int> seen;
+  for (const ReceivedPublish& p : broker.publishes) {
+    if (seen[p.packetId]++ > 0) TEST_ASSERT_TRUE(p.dup);
+  }
+}
+
+void test_subscriptions_resent_after_reconnect() {
+  BrokerStub broker;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  TEST_ASSERT_TRUE(c.subscribe("undip/x/config"));
+  unsigned long t = run(c, 0, 100);
+  TEST_ASSERT_EQUAL_UINT32(1, broker.subscribes.size());
+
+  broker.dropLink();
+  run(c, t, t + 5000);
+  TEST_ASSERT_TRUE(c.connected());
+  TEST_ASSERT_EQUAL_UINT32(2, broker.subscribes.size());
+  TEST_ASSERT_EQUAL_STRING("undip/x/config", broker.subscribes[1].c_str());
+  TEST_ASSERT_EQUAL_UINT32(2, connectCallbacks);
+}
+
+void test_inbound_qos1_is_acked_and_delivered() {
+  BrokerStub broker;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  unsigned long t = run(c, 0, 100);
+  broker.deliver("undip/x/tare", "1", 77);
+  run(c, t, t + 100);
+  TEST_ASSERT_EQUAL_STRING("undip/x/tare", lastTopic.c_str());
+  TEST_ASSERT_EQUAL_STRING("1", lastPayload.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, broker.pubacksFromClient.size());
+  TEST_ASSERT_EQUAL_UINT16(77, broker.pubacksFromClient[0]);
+}
+
+void test_oversized_inbound_qos1_acked_across_reads() {
+  BrokerStub broker;
+  MqttAsyncClient c(broker);
+  setupClient(c);
+  unsigned long t = run(c, 0, 100);
+  // Dokumen config retained yang lebih besar dari RX_BUFFER_SIZE, tiba dalam
+  // potongan 3 byte: header variabel terpotong di tengah panjang topik,
+  // topik, dan packet id
+  std::string big(MqttAsyncClient::RX_BUFFER_SIZE + 300, 'x');
+  std::string longTopic = "undip/" + std::string(120, 't') + "/config";
+  broker.maxRead = 3;
+  broker.deliver("undip/x/config", big, 301);
+  broker.deliver(longTopic.c_str(), big, 302);
+  broker.deliver("undip/x/tare", "1", 303);
+  run(c, t, t + 5000);
+  TEST_ASSERT_EQUAL_UINT32(3, broker.pubacksFromClient.size());
+  TEST_ASSERT_EQUAL_UINT16(301, broker.pubacksFromClient[0]);
+  TEST_ASSERT_EQUAL_UINT16(302, broker.pubacksFromClient[1]);
+  TEST_ASSERT_EQUAL_UINT16(303, broker.pubacksFromClient[2]);
+  // Yang terlalu besar tidak diteruskan, paket berikutnya utuh
+  TEST_ASSERT_EQUAL_STRING("undip/x/tare", lastTopic.c_str());
+  TEST_ASSERT_EQUAL_STRING("1", lastPayload.c_str());
+  TEST_ASSERT_TRUE(c.connected());
+
+  // Topik sendiri melebihi buffer RX: tetap di-ACK, sekali
+  broker.maxRead = 0;
+  std::string hugeTopic(MqttAsyncClient::RX_BUFFER_SIZE + 10, 'T');
+  broker.deliver(hugeTopic.c_str(), "2", 304);
+  broker.deliver("undip/x/tare", "3", 305);
+  run(c, t + 5000, t + 5100);
+  TEST_ASSERT_EQUAL_UINT32(5, broker.pubacksFromClient.size());
+  TEST_ASSERT_EQUAL_UINT16(304, broker.pubacksFromClient[3]);
+  TEST_ASSERT_EQUAL_STRING("3", lastPayload.c_str());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_connect_uses_persistent_session);
+  RUN_TEST(test_qos1_publish_acked_once);
+  RUN_TEST(test_window_limits_inflight);
+  RUN_TEST(test_publish_while_disconnected_sent_after_connack);
+  RUN_TEST(test_lost_puback_is_resent_with_dup_after_timeout);
+  RUN_TEST(test_lossy_link_delivers_every_message_once);
+  RUN_TEST(test_subscriptions_resent_after_reconnect);
+  RUN_TEST(test_inbound_qos1_is_acked_and_delivered);
+  RUN_TEST(test_oversized_inbound_qos1_acked_across_reads);
+  return UNITY_END();
+}
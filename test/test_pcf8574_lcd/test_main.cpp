@@ -0,0 +1,303 @@
+// HD44780 simulasi di belakang PCF8574: nibble dikunci di tepi turun EN,
+// DDRAM/CGRAM dan address counter dimodelkan, waktu bus dihitung per
+// transaksi (start + alamat + 9 bit per byte + stop). Pcf8574Lcd
+// dibandingkan dengan encoder gaya LiquidCrystal_I2C (3 transaksi per
+// nibble + delay 1 us dan 50 us) untuk satu redraw layar penuh.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "pcf8574-lcd.h"
+
+namespace {
+constexpr uint8_t PIN_RS = 0x01;
+constexpr uint8_t PIN_EN = 0x04;
+constexpr uint8_t BACKLIGHT = 0x08;
+
+class SimBus : public I2cBus {
+public:
+  SimBus() { memset(ddram, ' ', sizeof(ddram)); }
+
+  bool write(uint8_t addr, const uint8_t* data, size_t len) override {
+    transfers++;
+    busUs += (1 + 9 + 9.0 * len + 1) * 1e6 / hz;
+    if (len > maxTransfer) maxTransfer = len;
+    if (failNext) { failNext = false; return false; }
+    if (addr != 0x27) return false;
+    for (size_t i = 0; i < len; i++) clock(data[i]);
+    return true;
+  }
+
+  uint8_t at(uint8_t col, uint8_t row) const {
+    static const uint8_t OFFSETS[4] = { 0x00, 0x40, 0x14, 0x54 };
+    return ddram[OFFSETS[row] + col];
+  }
+  void resetTiming() { busUs = 0; transfers = 0; maxTransfer = 0; }
+
+  uint32_t hz = 400000;
+  double busUs = 0;
+  uint32_t transfers = 0;
+  size_t maxTransfer = 0;
+  bool failNext = false;
+  bool fourBit = false;
+  bool displayOn = false;
+  uint8_t entryMode = 0;
+  uint32_t rsGlitches = 0;    // RS berubah bersamaan dengan EN naik
+  uint32_t backlightOff = 0;  // byte tanpa bit backlight
+  uint8_t ddram[128];
+  uint8_t cgram[64] = {};
+
+private:
+  void clock(uint8_t b) {
+    if (!(b & BACKLIGHT)) backlightOff++;
+    bool rise = !(last & PIN_EN) && (b & PIN_EN);
+    if (rise && (last & PIN_RS) != (b & PIN_RS)) rsGlitches++;
+    bool fall = (last & PIN_EN) && !(b & PIN_EN);
+    if (fall) latch(last & 0xF0, last & PIN_RS);
+    last = b;
+  }
+
+  void latch(uint8_t nibble, bool rs) {
+    if (!fourBit) {            // masih mode 8-bit: satu nibble = satu perintah
+      if (nibble == 0x20) fourBit = true;
+      return;
+    }
+    if (!haveHigh) { high = nibble; haveHigh = true; return; }
+    haveHigh = false;
+    execute(high | (nibble >> 4), rs);
+  }
+
+  void execute(uint8_t v, bool rs) {
+    if (!rs) {
+      if (v & 0x80) { ac = v & 0x7F; cg = false; }
+      else if (v & 0x40) { ac = v & 0x3F; cg = true; }
+      else if (v & 0x08) displayOn = v & 0x04;
+      else if (v & 0x04) entryMode = v;
+      else if (v == 0x01) { memset(ddram, ' ', sizeof(ddram)); ac = 0; cg = false; }
+      return;
+    }
+    if (cg) { cgram[ac] = v; ac = (ac + 1) & 0x3F; return; }
+    ddram[ac] = v;
+    ac++;
+    if (ac == 0x28) ac = 0x40;
+    else if (ac == 0x68) ac = 0x00;
+  }
+
+  uint8_t last = 0;
+  bool haveHigh = false;
+  uint8_t high = 0;
+  uint8_t ac = 0;
+  bool cg = false;
+};
+
+// Encoder gaya LiquidCrystal_I2C: expanderWrite + pulseEnable per nibble,
+// masing-masing transaksi 1 byte, delay dihitung sebagai waktu blocking
+class LegacyLcd {
+public:
+  explicit LegacyLcd(SimBus& bus) : bus(bus) {}
+  void clear() { send(0x01, 0); bus.busUs += 2000; }
+  void setCursor(uint8_t col, uint8_t row) {
+    static const uint8_t OFFSETS[4] = { 0x00, 0x40, 0x14, 0x54 };
+    send(0x80 | (OFFSETS[row] + col), 0);
+  }
+  void print(const char* text) { while (*text) send((uint8_t)*text++, PIN_RS); }
+
+private:
+  void nibble(uint8_t v) {
+    expander(v);
+    expander(v | PIN_EN); bus.busUs += 1;
+    expander(v);          bus.busUs += 50;
+  }
+  void send(uint8_t v, uint8_t mode) {
+    nibble((v & 0xF0) | mode | BACKLIGHT);
+    nibble((uint8_t)(v << 4) | mode | BACKLIGHT);
+  }
+  void expander(uint8_t b) { bus.write(0x27, &b, 1); }
+  SimBus& bus;
+};
+
+void noDelay(uint32_t) {}
+
+uint32_t delayTotal = 0;
+void countDelay(uint32_t us) { delayTotal += us; }
+
+void assertShowing(const LcdFramebuffer& fb, const SimBus& bus) {
+  for (uint8_t r = 0; r < LcdFramebuffer::ROWS; r++) {
+    for (uint8_t c = 0; c < LcdFramebuffer::COLS; c++) {
+      if (fb.at(c, r) != bus.at(c, r)) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "sel (%u,%u) beda", (unsigned)c, (unsigned)r);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+}
+
+void drawFullScreen(LcdFramebuffer& fb) {
+  for (uint8_t r = 0; r < LcdFramebuffer::ROWS; r++) fb.print(0, r, "ABCDEFGHIJKLMNOPQRST");
+}
+}
+
+void setUp() { delayTotal = 0; }
+void tearDown() {}
+
+void test_begin_enters_four_bit_mode() {
+  SimBus bus;
+  memset(bus.ddram, '?', sizeof(bus.ddram));
+  Pcf8574Lcd lcd(bus);
+  TEST_ASSERT_TRUE(lcd.begin(countDelay));
+  TEST_ASSERT_TRUE(bus.fourBit);
+  TEST_ASSERT_TRUE(bus.displayOn);
+  TEST_ASSERT_EQUAL_UINT8(0x06, bus.entryMode);
+  TEST_ASSERT_EQUAL_UINT8(' ', bus.at(0, 0));   // clear dieksekusi
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(50000 + 4500 + 2000, delayTotal);
+  TEST_ASSERT_TRUE(lcd.idle());
+  TEST_ASSERT_EQUAL_UINT32(0, bus.rsGlitches);
+  TEST_ASSERT_EQUAL_UINT32(0, bus.backlightOff);
+}
+
+void test_begin_reports_missing_expander() {
+  SimBus bus;
+  Pcf8574Lcd lcd(bus, 0x3F);   // tidak ada perangkat di alamat ini
+  TEST_ASSERT_FALSE(lcd.begin(noDelay));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, lcd.stats().errors);
+}
+
+void test_big_digits_reach_cgram() {
+  SimBus bus;
+  Pcf8574Lcd lcd(bus);
+  lcd.begin(noDelay);
+  lcdLoadBigDigits(lcd);
+  const uint8_t top[8] = { 0x1F, 0x1F, 0, 0, 0, 0, 0, 0 };
+  const uint8_t right[8] = { 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 };
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(top, &bus.cgram[LcdBigDigits::FIRST_SLOT * 8], 8);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(right, &bus.cgram[(LcdBigDigits::FIRST_SLOT + 4) * 8], 8);
+  TEST_ASSERT_TRUE(lcd.idle());
+}
+
+void test_run_packed_into_few_transfers() {
+  SimBus bus;
+  Pcf8574Lcd lcd(bus);
+  lcd.begin(noDelay);
+  uint32_t before = lcd.stats().bytes;
+  bus.resetTiming();
+
+  // setCursor (RS 0) + 20 karakter (RS 1): hanya satu byte setup RS
+  lcd.setCursor(0, 2);
+  lcd.write((const uint8_t*)"ABCDEFGHIJKLMNOPQRST", 20);
+  lcd.commit();
+  TEST_ASSERT_EQUAL_UINT32(21 * Pcf8574Lcd::BYTES_PER_LCD_BYTE + 1, lcd.stats().bytes - before);
+  TEST_ASSERT_EQUAL_UINT32(1, bus.transfers);   // 85 byte expander < MAX_TRANSFER
+  TEST_ASSERT_EQUAL_UINT8('A', bus.at(0, 2));
+  TEST_ASSERT_EQUAL_UINT8('T', bus.at(19, 2));
+  TEST_ASSERT_EQUAL_UINT32(0, bus.rsGlitches);
+}
+
+void test_full_redraw_through_driver() {
+  SimBus bus;
+  Pcf8574Lcd lcd(bus);
+  lcd.begin(noDelay);
+  lcdLoadBigDigits(lcd);
+  LcdFramebuffer fb;
+  fb.print(0, 0, "Jenis: Anorganik");
+  fb.print(17, 1, "kg");
+  fb.bigNumber(1, 1, " 88.88");
+  fb.print(17, 3, "-67");
+  bus.resetTiming();
+
+  size_t lcdBytes = fb.flush(lcd);
+  assertShowing(fb, bus);
+  TEST_ASSERT_EQUAL_size_t(LcdFramebuffer::COLS * LcdFramebuffer::ROWS + 1, lcdBytes);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(Pcf8574Lcd::MAX_TRANSFER, bus.maxTransfer);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(4, bus.transfers);
+  TEST_ASSERT_EQUAL_UINT32(0, bus.rsGlitches);
+
+  // Satu digit berubah: hanya sel glyph itu
+  bus.resetTiming();
+  fb.bigNumber(1, 1, " 88.89");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(3 * (1 + LcdBigDigits::WIDTH), fb.flush(lcd));
+  assertShowing(fb, bus);
+  TEST_ASSERT_EQUAL_UINT32(1, bus.transfers);
+}
+
+void test_bus_error_never_stalls_ring() {
+  SimBus bus;
+  Pcf8574Lcd lcd(bus);
+  lcd.begin(noDelay);
+  size_t room = lcd.room();
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(LcdFramebuffer::COLS * LcdFramebuffer::ROWS + 1, room);
+
+  bus.failNext = true;
+  LcdFramebuffer fb;
+  drawFullScreen(fb);
+  fb.flush(lcd);
+  TEST_ASSERT_TRUE(lcd.idle());
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.stats().errors);
+  TEST_ASSERT_EQUAL_size_t(room, lcd.room());
+
+  // Isi LCD tidak pasti setelah error: invalidate lalu kirim ulang
+  fb.invalidate();
+  fb.flush(lcd);
+  assertShowing(fb, bus);
+}
+
+void test_writes_beyond_ring_drain_in_sync_mode() {
+  SimBus bus;
+  Pcf8574Lcd lcd(bus);
+  lcd.begin(noDelay);
+  // 3 x 80 byte LCD tanpa commit: > RING_SIZE byte expander
+  for (int pass = 0; pass < 3; pass++) {
+    lcd.setCursor(0, 0);
+    for (uint8_t r = 0; r < 4; r++) lcd.write((const uint8_t*)"01234567890123456789", 20);
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(0, bus.transfers);
+  lcd.commit();
+  TEST_ASSERT_TRUE(lcd.idle());
+  TEST_ASSERT_EQUAL_UINT8('9', bus.at(19, 3));
+  TEST_ASSERT_EQUAL_UINT32(0, lcd.stats().errors);
+}
+
+void test_full_redraw_benchmark_versus_legacy() {
+  LcdFramebuffer fb;
+  drawFullScreen(fb);
+
+  SimBus legacyBus;
+  legacyBus.hz = 100000;   // bawaan Wire
+  Pcf8574Lcd init(legacyBus);
+  init.begin(noDelay);
+  legacyBus.resetTiming();
+  LegacyLcd legacy(legacyBus);
+  legacy.clear();
+  for (uint8_t r = 0; r < LcdFramebuffer::ROWS; r++) {
+    legacy.setCursor(0, r);
+    legacy.print("ABCDEFGHIJKLMNOPQRST");
+  }
+  assertShowing(fb, legacyBus);
+
+  SimBus bus;
+  Pcf8574Lcd lcd(bus);
+  lcd.begin(noDelay);
+  bus.resetTiming();
+  fb.invalidate();
+  fb.flush(lcd);
+  assertShowing(fb, bus);
+
+  printf("  LiquidCrystal_I2C 100 kHz: %7.0f us per redraw penuh, %u transaksi\n",
+         legacyBus.busUs, (unsigned)legacyBus.transfers);
+  printf("  Pcf8574Lcd 400 kHz       : %7.0f us per redraw penuh, %u transaksi\n",
+         bus.busUs, (unsigned)bus.transfers);
+  TEST_ASSERT_LESS_THAN_FLOAT(legacyBus.busUs / 10, bus.busUs);
+  TEST_ASSERT_LESS_THAN_UINT32(legacyBus.transfers / 100, bus.transfers);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_enters_four_bit_mode);
+  RUN_TEST(test_begin_reports_missing_expander);
+  RUN_TEST(test_big_digits_reach_cgram);
+  RUN_TEST(test_run_packed_into_few_transfers);
+  RUN_TEST(test_full_redraw_through_driver);
+  RUN_TEST(test_bus_error_never_stalls_ring);
+  RUN_TEST(test_writes_beyond_ring_drain_in_sync_mode);
+  RUN_TEST(test_full_redraw_benchmark_versus_legacy);
+  return UNITY_END();
+}
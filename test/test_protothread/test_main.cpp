@@ -0,0 +1,252 @@
+// Protothread + PtRunner di host: flow dijalankan dari loop() virtual
+// (jam ms/us dimajukan manual). Urutan boot disimulasikan seperti bootFlow
+// (stabilisasi, tare, WiFi, layar status) untuk membandingkan periode loop
+// dari LoopStats dengan versi delay() yang lama.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "protothread.h"
+
+namespace {
+std::vector<std::string> trace;
+bool ready = false;
+
+struct Done {
+  std::string name;
+  uint32_t elapsedMs;
+  uint32_t maxLoopUs;
+};
+std::vector<Done> finished;
+void onDone(const char* name, uint32_t elapsedMs, uint32_t maxLoopUs) {
+  finished.push_back(Done{ name, elapsedMs, maxLoopUs });
+}
+
+void mark(const char* step, uint32_t now) {
+  trace.push_back(std::string(step) + "@" + std::to_string(now));
+}
+
+PtState sleepWaitFlow(Pt& pt, uint32_t now) {
+  PT_BEGIN(pt);
+  mark("mulai", now);
+  PT_SLEEP(pt, now, 500);
+  mark("bangun", now);
+  PT_WAIT_UNTIL(pt, ready);
+  mark("siap", now);
+  PT_END(pt);
+}
+
+uint32_t yieldSteps = 0;
+PtState yieldFlow(Pt& pt, uint32_t now) {
+  static uint8_t i;
+  PT_BEGIN(pt);
+  for (i = 0; i < 3; i++) {
+    yieldSteps++;
+    PT_YIELD(pt);
+  }
+  PT_END(pt);
+}
+
+bool exitEarly = false;
+PtState exitFlow(Pt& pt, uint32_t now) {
+  PT_BEGIN(pt);
+  mark("a", now);
+  PT_YIELD(pt);
+  if (exitEarly) PT_EXIT(pt);
+  mark("b", now);
+  PT_END(pt);
+}
+
+// Variabel lokal diinisialisasi ulang setiap kali flow dilanjutkan
+int localAfterYield = -1, staticAfterYield = -1;
+PtState localsFlow(Pt& pt, uint32_t now) {
+  int local = 0;
+  static int kept;
+  PT_BEGIN(pt);
+  local = 42;
+  kept = 42;
+  PT_YIELD(pt);
+  localAfterYield = local;
+  staticAfterYield = kept;
+  PT_END(pt);
+}
+
+// ---- Simulasi bootFlow ----
+// Waktu (ms sejak boot) yang dipakai simulasi perangkat keras
+const uint32_t STABILIZING_MS = 2000;
+const uint32_t TARE_DONE_AT = 2350;      // HX711 selesai tare
+const uint32_t WIFI_CONNECTED_AT = 4100;
+const uint32_t SPLASH_MS = 1000;
+
+uint32_t bootStartMs = 0;
+bool tareDone(uint32_t now) { return now - bootStartMs >= TARE_DONE_AT; }
+bool wifiUp(uint32_t now) { return now - bootStartMs >= WIFI_CONNECTED_AT; }
+
+PtState simBootFlow(Pt& pt, uint32_t now) {
+  static uint8_t dots;
+  PT_BEGIN(pt);
+  PT_SLEEP(pt, now, STABILIZING_MS);
+  PT_WAIT_UNTIL(pt, tareDone(now));
+  for (dots = 0; dots < 20 && !wifiUp(now); dots++) {
+    PT_SLEEP(pt, now, 500);
+  }
+  PT_SLEEP(pt, now, SPLASH_MS);
+  PT_END(pt);
+}
+}
+
+void setUp() {
+  trace.clear();
+  finished.clear();
+  ready = false;
+  yieldSteps = 0;
+  exitEarly = false;
+}
+void tearDown() {}
+
+void test_sleep_and_wait_until() {
+  PtRunner runner;
+  runner.onDone(onDone);
+  TEST_ASSERT_TRUE(runner.start("tunggu", sleepWaitFlow, 1000));
+  for (uint32_t t = 1000; t <= 1800; t += 10) {
+    if (t == 1700) ready = true;
+    runner.run(t);
+  }
+  TEST_ASSERT_EQUAL_UINT32(3, trace.size());
+  TEST_ASSERT_EQUAL_STRING("mulai@1000", trace[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("bangun@1500", trace[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("siap@1700", trace[2].c_str());
+  TEST_ASSERT_FALSE(runner.busy());
+  TEST_ASSERT_EQUAL_UINT32(1, finished.size());
+  TEST_ASSERT_EQUAL_STRING("tunggu", finished[0].name.c_str());
+  TEST_ASSERT_EQUAL_UINT32(700, finished[0].elapsedMs);
+}
+
+void test_sleep_across_millis_wrap() {
+  Pt pt = {};
+  uint32_t start = 0xFFFFFF00u;   // millis() wrap setelah ~49.7 hari
+  TEST_ASSERT_TRUE(sleepWaitFlow(pt, start) == PtState::WAITING);
+  TEST_ASSERT_TRUE(sleepWaitFlow(pt, start + 499) == PtState::WAITING);
+  TEST_ASSERT_EQUAL_UINT32(1, trace.size());
+  sleepWaitFlow(pt, start + 500);
+  TEST_ASSERT_EQUAL_UINT32(2, trace.size());
+  TEST_ASSERT_EQUAL_STRING("bangun@244", trace[1].c_str());
+}
+
+void test_yield_runs_one_step_per_loop() {
+  PtRunner runner;
+  runner.start("yield", yieldFlow, 0);
+  for (uint32_t loop = 1; loop <= 3; loop++) {
+    runner.run(loop);
+    TEST_ASSERT_EQUAL_UINT32(loop, yieldSteps);
+    TEST_ASSERT_TRUE(runner.busy());
+  }
+  runner.run(4);   // lanjut setelah yield ketiga: selesai
+  TEST_ASSERT_EQUAL_UINT32(3, yieldSteps);
+  TEST_ASSERT_FALSE(runner.busy());
+}
+
+void test_restart_and_exit() {
+  PtRunner runner;
+  runner.onDone(onDone);
+  TEST_ASSERT_TRUE(runner.start("exit", exitFlow, 0));
+  // Flow yang sama tidak bisa dimulai dua kali
+  TEST_ASSERT_FALSE(runner.start("exit", exitFlow, 0));
+  TEST_ASSERT_TRUE(runner.running(exitFlow));
+  runner.run(10);
+  runner.run(20);
+  TEST_ASSERT_EQUAL_UINT32(2, trace.size());
+  TEST_ASSERT_FALSE(runner.running(exitFlow));
+
+  // Dimulai ulang dari awal (pt.line = 0), PT_EXIT mengakhiri di tengah
+  exitEarly = true;
+  TEST_ASSERT_TRUE(runner.start("exit", exitFlow, 30));
+  runner.run(30);
+  runner.run(40);
+  TEST_ASSERT_EQUAL_UINT32(3, trace.size());
+  TEST_ASSERT_EQUAL_STRING("a@30", trace[2].c_str());
+  TEST_ASSERT_FALSE(runner.busy());
+  TEST_ASSERT_EQUAL_UINT32(2, finished.size());
+  TEST_ASSERT_EQUAL_UINT32(10, finished[1].elapsedMs);
+
+  // Pt yang dipakai langsung juga kembali ke awal setelah PT_END
+  Pt pt = {};
+  exitEarly = false;
+  trace.clear();
+  exitFlow(pt, 0);
+  TEST_ASSERT_TRUE(exitFlow(pt, 1) == PtState::ENDED);
+  TEST_ASSERT_EQUAL_UINT16(0, pt.line);
+  exitFlow(pt, 2);
+  TEST_ASSERT_EQUAL_STRING("a@2", trace[2].c_str());
+
+  // Slot penuh
+  PtRunner full;
+  TEST_ASSERT_TRUE(full.start("1", sleepWaitFlow, 0));
+  TEST_ASSERT_TRUE(full.start("2", yieldFlow, 0));
+  TEST_ASSERT_TRUE(full.start("3", exitFlow, 0));
+  TEST_ASSERT_TRUE(full.start("4", localsFlow, 0));
+  TEST_ASSERT_FALSE(full.start("5", simBootFlow, 0));
+  TEST_ASSERT_FALSE(full.start("null", nullptr, 0));
+}
+
+void test_locals_do_not_survive_yield() {
+  Pt pt = {};
+  localsFlow(pt, 0);
+  localsFlow(pt, 1);
+  TEST_ASSERT_EQUAL_INT(0, localAfterYield);    // diinisialisasi ulang, bukan 42
+  TEST_ASSERT_EQUAL_INT(42, staticAfterYield);
+}
+
+void test_boot_flow_keeps_loop_period_short() {
+  // loop() virtual: pekerjaan lain 1-3 ms per iterasi, flush LCD 12 ms
+  // tiap 200 ms. bootFlow jalan di dalamnya.
+  PtRunner runner;
+  runner.onDone(onDone);
+  uint32_t nowUs = 5000 * 1000;
+  bootStartMs = nowUs / 1000;
+  runner.start("boot", simBootFlow, bootStartMs);
+  uint32_t loops = 0;
+  uint32_t expectedMaxUs = 0, lastUs = nowUs;
+  while (runner.busy() || loops < 10) {
+    runner.markLoop(nowUs);
+    if (loops > 0 && nowUs - lastUs > expectedMaxUs && runner.busy()) expectedMaxUs = nowUs - lastUs;
+    lastUs = nowUs;
+    runner.run(nowUs / 1000);
+    uint32_t work = 1000 + (loops % 3) * 1000;
+    if (loops % 100 == 99) work += 12000;
+    nowUs += work;
+    loops++;
+  }
+  const LoopStats& stats = runner.loopStats();
+  TEST_ASSERT_EQUAL_UINT32(1, finished.size());
+  uint32_t bootMs = finished[0].elapsedMs;
+
+  // setup() lama: delay() selama seluruh urutan, loop() belum berjalan
+  uint32_t blockingMs = TARE_DONE_AT + (WIFI_CONNECTED_AT - TARE_DONE_AT + 499) / 500 * 500 + SPLASH_MS;
+
+  printf("  boot %u ms dalam %u loop: periode loop maks %u us (selama flow %u us, flow boot %u us)\n",
+         (unsigned)bootMs, (unsigned)stats.loops, (unsigned)stats.maxPeriodUs,
+         (unsigned)stats.maxPeriodFlowUs, (unsigned)finished[0].maxLoopUs);
+  printf("  versi delay(): loop() pertama setelah %u ms\n", (unsigned)blockingMs);
+
+  TEST_ASSERT_EQUAL_UINT32(expectedMaxUs, stats.maxPeriodFlowUs);
+  TEST_ASSERT_EQUAL_UINT32(stats.maxPeriodFlowUs, finished[0].maxLoopUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(15000, stats.maxPeriodUs);
+  // Tiap tahap (stabilisasi, tare, WiFi, splash) selesai paling lambat satu
+  // periode loop setelah waktunya
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(blockingMs, bootMs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(blockingMs + 4 * stats.maxPeriodFlowUs / 1000, bootMs);
+  TEST_ASSERT_LESS_THAN_UINT32(blockingMs * 1000 / 100, stats.maxPeriodUs);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sleep_and_wait_until);
+  RUN_TEST(test_sleep_across_millis_wrap);
+  RUN_TEST(test_yield_runs_one_step_per_loop);
+  RUN_TEST(test_restart_and_exit);
+  RUN_TEST(test_locals_do_not_survive_yield);
+  RUN_TEST(test_boot_flow_keeps_loop_period_short);
+  return UNITY_END();
+}
@@ -0,0 +1,153 @@
+// Jejak HX711 simulasi (10 SPS) dengan anotasi TX WiFi: setiap burst TX
+// menambah spike ripple pada sampel yang konversinya bersinggungan. Noise
+// (stddev dalam gram) dibandingkan tanpa penandaan, dengan penandaan TX,
+// dan dengan jendela senyap saat berat dikunci.
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <random>
+#include "radio-quiet.h"
+
+namespace {
+constexpr uint32_t SAMPLE_MS = 100;   // HX711 10 SPS
+constexpr float TRUE_WEIGHT = 1.0f;   // kg
+
+struct TraceStats {
+  double stddevGrams;
+  double meanKg;
+  uint32_t skipped;
+};
+
+// Replay 10 menit: TX rata-rata tiap 400 ms (eksponensial), spike 6-16 g
+TraceStats replay(bool tagging, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0, 0.0008f);   // 0.8 g noise dasar
+  std::uniform_real_distribution<float> u(0, 1);
+  RadioQuiet rq;
+  CleanWeightFilter filter;
+  double sum = 0, sq = 0;
+  int n = 0;
+  uint32_t nextTx = 50;
+  for (uint32_t t = 0; t < 600000; t += SAMPLE_MS) {
+    float spike = 0;
+    while (nextTx < t) {
+      rq.noteTx(nextTx);
+      if (nextTx + SAMPLE_MS > t) spike += 0.006f + 0.010f * u(rng);
+      nextTx += (uint32_t)(-400 * logf(1 - u(rng))) + 1;
+    }
+    float out = filter.update(TRUE_WEIGHT + noise(rng) + spike, tagging && rq.txNear(t, SAMPLE_MS));
+    if (t > 1000) { sum += out; sq += out * out; n++; }
+  }
+  double mean = sum / n;
+  TraceStats s = { sqrt(sq / n - mean * mean) * 1000, mean, filter.skippedCount() };
+  return s;
+}
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_tx_inside_conversion_is_tagged() {
+  RadioQuiet r;
+  TEST_ASSERT_FALSE(r.txNear(1000, 100));
+  r.noteTx(950);
+  r.noteTx(1200);   // TX sesudahnya tidak boleh menyembunyikan TX di jendela
+  TEST_ASSERT_TRUE(r.txNear(1000, 100));
+
+  RadioQuiet guard;
+  guard.noteTx(1000 - 100 - RadioQuiet::TX_GUARD_MS);   // ripple masih terasa
+  TEST_ASSERT_TRUE(guard.txNear(1000, 100));
+
+  RadioQuiet clean;
+  clean.noteTx(800);
+  clean.noteTx(1100);
+  TEST_ASSERT_FALSE(clean.txNear(1000, 100));
+}
+
+void test_overwritten_history_counts_as_tagged() {
+  RadioQuiet lost;
+  lost.noteTx(950);
+  for (uint32_t i = 0; i < RadioQuiet::TX_HISTORY; i++) lost.noteTx(1100 + i);
+  TEST_ASSERT_TRUE(lost.txNear(1000, 100));
+
+  RadioQuiet visible;
+  visible.noteTx(700);
+  for (uint32_t i = 0; i + 1 < RadioQuiet::TX_HISTORY; i++) visible.noteTx(1100 + i);
+  TEST_ASSERT_FALSE(visible.txNear(1000, 100));
+
+  RadioQuiet old;
+  for (int i = 0; i < 40; i++) old.noteTx(500 + i);
+  TEST_ASSERT_FALSE(old.txNear(1000, 100));
+}
+
+void test_quiet_window_defers_transmit() {
+  RadioQuiet r;
+  TEST_ASSERT_TRUE(r.mayTransmit(0));
+  r.requestQuiet(1000, 500);
+  TEST_ASSERT_FALSE(r.mayTransmit(1000));
+  TEST_ASSERT_FALSE(r.mayTransmit(1499));
+  TEST_ASSERT_TRUE(r.mayTransmit(1500));
+  r.requestQuiet(2000, 500);
+  r.release();
+  TEST_ASSERT_TRUE(r.mayTransmit(2001));
+}
+
+void test_filter_skips_tagged_but_never_freezes() {
+  CleanWeightFilter f;
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, f.update(1.0f, true));   // sampel pertama selalu dipakai
+  f.update(1.0f, false);
+  for (int i = 0; i < CleanWeightFilter::MAX_CONSECUTIVE_SKIP; i++) {
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, f.update(5.0f, true));
+  }
+  TEST_ASSERT_EQUAL_UINT32(CleanWeightFilter::MAX_CONSECUTIVE_SKIP, f.skippedCount());
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, f.update(5.0f, true));   // radio sibuk terus: tetap dipakai
+}
+
+void test_replayed_trace_noise_reduction() {
+  TraceStats raw = replay(false, 11);
+  TraceStats tagged = replay(true, 11);
+  printf("  tanpa penandaan: stddev %.2f g, rata-rata %.4f kg\n", raw.stddevGrams, raw.meanKg);
+  printf("  dengan penandaan: stddev %.2f g, rata-rata %.4f kg, %u sampel dibuang\n",
+         tagged.stddevGrams, tagged.meanKg, (unsigned)tagged.skipped);
+  TEST_ASSERT_LESS_THAN_FLOAT(raw.stddevGrams / 2, tagged.stddevGrams);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, TRUE_WEIGHT, (float)tagged.meanKg);
+  TEST_ASSERT_GREATER_THAN_FLOAT(0.002f, raw.meanKg - TRUE_WEIGHT);   // spike menggeser rata-rata
+}
+
+void test_latched_weight_clean_inside_quiet_window() {
+  std::mt19937 rng(3);
+  std::normal_distribution<float> noise(0, 0.0008f);
+  RadioQuiet rq;
+  CleanWeightFilter filter;
+  // Kode jaringan ingin TX tiap 50 ms; berat dikunci di 2000-3000 ms
+  rq.requestQuiet(2000, 1000);
+  uint32_t txDuringQuiet = 0;
+  double worst = 0;
+  for (uint32_t t = 0; t < 4000; t += 10) {
+    if (t % 50 == 0 && rq.mayTransmit(t)) {
+      rq.noteTx(t);
+      if (t >= 2000 && t < 3000) txDuringQuiet++;
+    }
+    if (t % SAMPLE_MS != 0) continue;
+    bool hit = rq.txNear(t, SAMPLE_MS);
+    float out = filter.update(TRUE_WEIGHT + noise(rng) + (hit ? 0.01f : 0.0f), hit);
+    if (t >= 2000 + SAMPLE_MS + RadioQuiet::TX_GUARD_MS && t < 3000) {
+      TEST_ASSERT_FALSE(hit);
+      double err = fabs(out - TRUE_WEIGHT) * 1000;
+      if (err > worst) worst = err;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, txDuringQuiet);
+  TEST_ASSERT_LESS_THAN_FLOAT(4.0f, worst);   // gram; noise dasar saja
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_tx_inside_conversion_is_tagged);
+  RUN_TEST(test_overwritten_history_counts_as_tagged);
+  RUN_TEST(test_quiet_window_defers_transmit);
+  RUN_TEST(test_filter_skips_tagged_but_never_freezes);
+  RUN_TEST(test_replayed_trace_noise_reduction);
+  RUN_TEST(test_latched_weight_clean_inside_quiet_window);
+  return UNITY_END();
+}
@@ -0,0 +1,249 @@
+// Server stub yang men-dedup berdasarkan kunci "<deviceId>-<seq>" seperti
+// backend sungguhan, dipasang sebagai policy RecordUploader. Retry karena
+// respon hilang, 5xx, atau transfer async tidak boleh membuat baris ganda.
+#include <unity.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "upload-backend.h"
+
+namespace {
+class MemoryCounterStorage : public CounterStorage {
+public:
+  uint32_t value = 0;
+  uint32_t saves = 0;
+  uint32_t load() override { return value; }
+  void save(uint32_t v) override { value = v; saves++; }
+};
+
+// Tabel server: kunci idempotensi -> jumlah POST yang diterima
+struct ServerStub {
+  std::map<std::string, int> rows;
+  std::map<std::string, int> posts;
+  int failBeforeStore = 0;   // N request berikutnya 5xx sebelum disimpan
+  int loseResponse = 0;      // N request berikutnya disimpan, respon hilang
+  bool reject = false;       // 4xx
+  int pendingPolls = 0;      // send() async mengembalikan PENDING sekian kali
+
+  void reset() { *this = ServerStub(); }
+};
+
+ServerStub server;
+
+std::string key(uint32_t seq) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "ESP32Scale-AABB-%u", (unsigned)seq);
+  return buf;
+}
+
+template <uint8_t BATCH, bool IS_ASYNC>
+struct SimBackend {
+  static const char* name() { return "sim"; }
+  static constexpr uint8_t MAX_BATCH = BATCH;
+  static constexpr bool MQTT_RECORDS = false;
+  static constexpr bool PREWARM = false;
+  static constexpr bool ASYNC = IS_ASYNC;
+  static int polls;
+
+  static SendResult send(WeighingRecord* const* recs, size_t count) {
+    if (ASYNC && polls < server.pendingPolls) { polls++; return SendResult::PENDING; }
+    polls = 0;
+    if (server.failBeforeStore > 0) { server.failBeforeStore--; return SendResult::RETRY; }
+    if (server.reject) return SendResult::REJECTED;
+    for (size_t i = 0; i < count; i++) {
+      std::string k = key(recs[i]->seq);
+      server.posts[k]++;
+      server.rows[k] = 1;   // upsert: duplikat hanya menimpa baris yang sama
+    }
+    if (server.loseResponse > 0) { server.loseResponse--; return SendResult::RETRY; }
+    return SendResult::ACKED;
+  }
+};
+template <uint8_t BATCH, bool IS_ASYNC>
+int SimBackend<BATCH, IS_ASYNC>::polls = 0;
+
+typedef RecordUploader<SimBackend<1, false> > SingleUploader;
+typedef RecordUploader<SimBackend<4, false> > BatchUploader;
+typedef RecordUploader<SimBackend<4, true> > AsyncUploader;
+
+WeighingRecord makeRecord(SequenceCounter& seq) {
+  WeighingRecord rec = {};
+  rec.seq = seq.next();
+  rec.weight = 1.5f;
+  rec.category = WasteCategory::ORGANIK;
+  return rec;
+}
+
+// Kuras outbox dengan waktu virtual sampai kosong atau batas langkah
+template <class Uploader>
+unsigned long drain(RecordOutbox& outbox, unsigned long now, int maxSteps) {
+  for (int i = 0; i < maxSteps && !outbox.empty(); i++) {
+    if (!outbox.due(now)) { now += 1000; continue; }
+    Uploader::drainStep(outbox, RecordOutbox::CAPACITY, now);
+  }
+  return now;
+}
+}
+
+void setUp() { server.reset(); }
+void tearDown() {}
+
+void test_sequence_never_repeats_across_reboots() {
+  MemoryCounterStorage storage;
+  std::vector<uint32_t> seen;
+  for (int boot = 0; boot < 5; boot++) {
+    SequenceCounter seq(storage);
+    seq.begin();
+    for (int i = 0; i < 10 + boot * 7; i++) seen.push_back(seq.next());
+  }
+  for (size_t i = 1; i < seen.size(); i++) TEST_ASSERT_GREATER_THAN_UINT32(seen[i - 1], seen[i]);
+  // Flash ditulis per blok, bukan per record
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(seen.size() / SequenceCounter::SEQ_BLOCK + 5, storage.saves);
+}
+
+void test_lost_response_retry_does_not_duplicate() {
+  MemoryCounterStorage storage;
+  SequenceCounter seq(storage);
+  seq.begin();
+  RecordOutbox outbox;
+  for (int i = 0; i < 5; i++) TEST_ASSERT_TRUE(outbox.push(makeRecord(seq)));
+
+  server.loseResponse = 3;
+  server.failBeforeStore = 2;
+  drain<SingleUploader>(outbox, 0, 200);
+
+  TEST_ASSERT_TRUE(outbox.empty());
+  TEST_ASSERT_EQUAL_UINT32(5, server.rows.size());
+  int totalPosts = 0;
+  for (auto& p : server.posts) totalPosts += p.second;
+  TEST_ASSERT_GREATER_THAN(5, totalPosts);   // memang ada POST ganda ...
+  for (auto& r : server.rows) TEST_ASSERT_EQUAL_INT(1, r.second);   // ... tapi satu baris per kunci
+}
+
+void test_batch_retry_keeps_order_and_dedups() {
+  MemoryCounterStorage storage;
+  SequenceCounter seq(storage);
+  seq.begin();
+  RecordOutbox outbox;
+  for (int i = 0; i < 10; i++) outbox.push(makeRecord(seq));
+
+  server.loseResponse = 2;
+  DrainStep step = BatchUploader::drainStep(outbox, RecordOutbox::CAPACITY, 0);
+  TEST_ASSERT_EQUAL(SendResult::RETRY, step.result);
+  TEST_ASSERT_EQUAL_UINT8(4, step.count);
+  TEST_ASSERT_EQUAL_UINT32(10, outbox.size());
+  TEST_ASSERT_EQUAL_UINT32(1, outbox.front().seq);
+
+  drain<BatchUploader>(outbox, 0, 200);
+  TEST_ASSERT_TRUE(outbox.empty());
+  TEST_ASSERT_EQUAL_UINT32(10, server.rows.size());
+  TEST_ASSERT_EQUAL_INT(3, server.posts[key(1)]);   // batch pertama terkirim 3x
+  TEST_ASSERT_EQUAL_INT(1, server.posts[key(10)]);
+}
+
+void test_retry_backoff_doubles_and_resets() {
+  RecordOutbox outbox;
+  WeighingRecord rec = {};
+  rec.seq = 1;
+  outbox.push(rec);
+
+  server.failBeforeStore = 3;
+  SingleUploader::drainStep(outbox, 1, 0);
+  TEST_ASSERT_FALSE(outbox.due(RecordOutbox::RETRY_MIN - 1));
+  TEST_ASSERT_TRUE(outbox.due(RecordOutbox::RETRY_MIN));
+  SingleUploader::drainStep(outbox, 1, RecordOutbox::RETRY_MIN);
+  TEST_ASSERT_FALSE(outbox.due(RecordOutbox::RETRY_MIN * 3 - 1));
+  TEST_ASSERT_TRUE(outbox.due(RecordOutbox::RETRY_MIN * 3));
+  TEST_ASSERT_EQUAL_UINT8(2, outbox.front().attempts);
+
+  outbox.push(rec);
+  SingleUploader::drainStep(outbox, 1, 100000);   // masih gagal (ke-3)
+  SingleUploader::drainStep(outbox, 1, 200000);   // sukses -> delay kembali ke minimum
+  TEST_ASSERT_TRUE(outbox.due(200000));
+  server.failBeforeStore = 1;
+  SingleUploader::drainStep(outbox, 1, 200000);
+  TEST_ASSERT_TRUE(outbox.due(200000 + RecordOutbox::RETRY_MIN));
+}
+
+void test_rejected_record_is_dropped() {
+  RecordOutbox outbox;
+  WeighingRecord rec = {};
+  rec.seq = 7;
+  outbox.push(rec);
+  server.reject = true;
+  DrainStep step = SingleUploader::drainStep(outbox, 1, 0);
+  TEST_ASSERT_EQUAL(SendResult::REJECTED, step.result);
+  TEST_ASSERT_TRUE(outbox.empty());
+  TEST_ASSERT_EQUAL_UINT32(0, server.rows.size());
+}
+
+void test_async_pending_batch_is_not_reattempted() {
+  MemoryCounterStorage storage;
+  SequenceCounter seq(storage);
+  seq.begin();
+  RecordOutbox outbox;
+  for (int i = 0; i < 6; i++) outbox.push(makeRecord(seq));
+
+  server.pendingPolls = 3;
+  DrainStep step = AsyncUploader::drainStep(outbox, 4, 0);
+  TEST_ASSERT_EQUAL(SendResult::PENDING, step.result);
+  TEST_ASSERT_EQUAL_UINT8(4, AsyncUploader::pending());
+  // Record baru masuk saat batch berjalan: batch tidak berubah
+  outbox.push(makeRecord(seq));
+  for (int i = 0; i < 2; i++) AsyncUploader::drainStep(outbox, 1, 0);
+  TEST_ASSERT_EQUAL_UINT8(1, outbox.front().attempts);   // attempts tidak naik tiap poll
+  step = AsyncUploader::drainStep(outbox, 1, 0);
+  TEST_ASSERT_EQUAL(SendResult::ACKED, step.result);
+  TEST_ASSERT_EQUAL_UINT8(4, step.count);
+  TEST_ASSERT_EQUAL_UINT32(4, step.lastSeq);
+  TEST_ASSERT_EQUAL_UINT8(0, AsyncUploader::pending());
+  TEST_ASSERT_EQUAL_UINT32(3, outbox.size());
+  TEST_ASSERT_EQUAL_UINT8(0, outbox.front().attempts);
+
+  server.pendingPolls = 0;
+  drain<AsyncUploader>(outbox, 0, 50);
+  TEST_ASSERT_TRUE(outbox.empty());
+  TEST_ASSERT_EQUAL_UINT32(7, server.rows.size());
+  for (auto& p : server.posts) TEST_ASSERT_EQUAL_INT(1, p.second);
+}
+
+void test_out_of_order_ack_removes_by_seq() {
+  RecordOutbox outbox;
+  for (uint32_t s = 1; s <= 4; s++) {
+    WeighingRecord rec = {};
+    rec.seq = s;
+    outbox.push(rec);
+  }
+  TEST_ASSERT_TRUE(outbox.remove(3));
+  TEST_ASSERT_FALSE(outbox.remove(3));   // ACK ganda dari relay diabaikan
+  TEST_ASSERT_EQUAL_UINT32(3, outbox.size());
+  TEST_ASSERT_EQUAL_UINT32(1, outbox.at(0).seq);
+  TEST_ASSERT_EQUAL_UINT32(2, outbox.at(1).seq);
+  TEST_ASSERT_EQUAL_UINT32(4, outbox.at(2).seq);
+}
+
+void test_full_outbox_refuses_push() {
+  RecordOutbox outbox;
+  WeighingRecord rec = {};
+  for (size_t i = 0; i < RecordOutbox::CAPACITY; i++) {
+    rec.seq = i + 1;
+    TEST_ASSERT_TRUE(outbox.push(rec));
+  }
+  rec.seq = 99;
+  TEST_ASSERT_FALSE(outbox.push(rec));
+  TEST_ASSERT_EQUAL_UINT32(RecordOutbox::CAPACITY, outbox.size());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sequence_never_repeats_across_reboots);
+  RUN_TEST(test_lost_response_retry_does_not_duplicate);
+  RUN_TEST(test_batch_retry_keeps_order_and_dedups);
+  RUN_TEST(test_retry_backoff_doubles_and_resets);
+  RUN_TEST(test_rejected_record_is_dropped);
+  RUN_TEST(test_async_pending_batch_is_not_reattempted);
+  RUN_TEST(test_out_of_order_ack_removes_by_seq);
+  RUN_TEST(test_full_outbox_refuses_push);
+  return UNITY_END();
+}
@@ -0,0 +1,346 @@
+// RemoteConfig di host: dokumen ditandatangani seperti tools/sign-config.py,
+// NVS dimodelkan sebagai buffer di RAM. Siklus broker baru yang gagal
+// (activate -> masa uji habis -> rollback) diulang dengan dokumen retained
+// yang dikirim ulang broker lama setiap reconnect.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "remote-config.h"
+
+namespace {
+const char* DEVICE = "ecoscale-a1b2c3";
+const uint8_t PSK[] = "kunci-rahasia-perangkat";
+
+struct MemoryStore : ConfigStore {
+  std::string doc;
+  uint32_t saves = 0;
+  bool failSave = false;
+  size_t load(char* buf, size_t cap) override {
+    if (doc.size() > cap) return 0;
+    memcpy(buf, doc.data(), doc.size());
+    return doc.size();
+  }
+  bool save(const char* d, size_t len) override {
+    if (failSave) return false;
+    doc.assign(d, len);
+    saves++;
+    return true;
+  }
+};
+
+RuntimeConfig defaults() {
+  RuntimeConfig c = {};
+  c.weightReadMs = 100;
+  c.lcdUpdateMs = 200;
+  c.statusRowMs = 1000;
+  c.wifiCheckMs = 30000;
+  c.pingCheckMs = 10000;
+  c.metricsMs = 60000;
+  c.weightPublishMs = 1000;
+  c.minWeightKg = 0.05f;
+  c.prewarmUpload = true;
+  strcpy(c.mqttServer, "broker.lama");
+  c.mqttPort = 1883;
+  strcpy(c.mqttTopic, "ecoscale/berat");
+  strcpy(c.fakultas, "FT");
+  for (LogLevel& l : c.logLevels) l = LogLevel::INFO;
+  return c;
+}
+
+std::string signedPayload(const std::string& doc, const char* keyId = DEVICE) {
+  char tag[RemoteConfig::TAG_HEX];
+  RemoteConfig::sign(keyId, PSK, sizeof(PSK) - 1, doc.data(), doc.size(), tag);
+  return doc + "\n" + std::string(tag, sizeof(tag));
+}
+
+MemoryStore store;
+RemoteConfig* config = nullptr;
+
+ConfigResult offer(const std::string& payload) {
+  return config->offer(payload.data(), payload.size());
+}
+
+ConfigResult offerDoc(const std::string& doc) {
+  return offer(signedPayload(doc));
+}
+
+// Dokumen dengan satu field tambahan; versi naik tiap panggilan supaya
+// dokumen yang diterima tidak terbaca UNCHANGED
+uint32_t nextVersion = 50;
+
+std::string docWith(const char* field) {
+  return "{\"version\":" + std::to_string(nextVersion++) + "," + field + "}";
+}
+
+void assertRejected(const char* field, const char* expectError) {
+  std::string doc = docWith(field);
+  ConfigResult r = offerDoc(doc);
+  if (r.status != ConfigStatus::REJECTED) TEST_FAIL_MESSAGE(doc.c_str());
+  TEST_ASSERT_EQUAL_STRING(expectError, r.error);
+}
+
+void assertAccepted(const char* field) {
+  std::string doc = docWith(field);
+  ConfigResult r = offerDoc(doc);
+  if (r.status != ConfigStatus::APPLIED) TEST_FAIL_MESSAGE(doc.c_str());
+}
+}
+
+void setUp() {
+  store = MemoryStore();
+  static RuntimeConfig base = defaults();
+  delete config;
+  config = new RemoteConfig(base, store);
+  config->setKey(DEVICE, PSK, sizeof(PSK) - 1);
+  config->begin();
+}
+void tearDown() {}
+
+void test_signed_document_staged_then_activated() {
+  ConfigResult r = offerDoc("{\"version\":3,\"weight_read_ms\":250,\"log\":{\"mqtt\":\"debug\"}}");
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::APPLIED);
+  TEST_ASSERT_EQUAL_UINT32(3, r.version);
+  TEST_ASSERT_EQUAL_UINT8(CONFIG_LIVE, r.effects);
+  // offer() hanya menyiapkan
+  TEST_ASSERT_TRUE(config->staged());
+  TEST_ASSERT_EQUAL_UINT32(100, config->active().weightReadMs);
+
+  r = config->activate();
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::APPLIED);
+  TEST_ASSERT_EQUAL_UINT32(250, config->active().weightReadMs);
+  TEST_ASSERT_TRUE(config->active().logLevels[(uint8_t)LogModule::MQTT] == LogLevel::DEBUG);
+  TEST_ASSERT_TRUE(config->active().logLevels[(uint8_t)LogModule::NET] == LogLevel::INFO);
+  // Field yang tidak ada = default
+  TEST_ASSERT_EQUAL_STRING("broker.lama", config->active().mqttServer);
+  TEST_ASSERT_FALSE(config->staged());
+  TEST_ASSERT_TRUE(config->activate().status == ConfigStatus::UNCHANGED);
+}
+
+void test_hmac_rejections() {
+  std::string doc = "{\"version\":4,\"lcd_update_ms\":300}";
+  std::string good = signedPayload(doc);
+
+  // Satu hex tag diubah
+  std::string wrongTag = good;
+  wrongTag[wrongTag.size() - 1] = wrongTag.back() == '0' ? '1' : '0';
+  ConfigResult r = offer(wrongTag);
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::REJECTED);
+  TEST_ASSERT_EQUAL_STRING("tag HMAC tidak valid", r.error);
+
+  // Ditandatangani untuk perangkat lain: tidak bisa diputar ulang ke sini
+  TEST_ASSERT_TRUE(offer(signedPayload(doc, "ecoscale-ffffff")).status == ConfigStatus::REJECTED);
+
+  // Dokumen diubah setelah ditandatangani
+  std::string tampered = good;
+  tampered.replace(tampered.find("300"), 3, "900");
+  TEST_ASSERT_TRUE(offer(tampered).status == ConfigStatus::REJECTED);
+
+  // Terpotong: tag kurang, tanpa '\n', atau tanpa tag sama sekali
+  TEST_ASSERT_TRUE(offer(good.substr(0, good.size() - 1)).status == ConfigStatus::REJECTED);
+  TEST_ASSERT_TRUE(offer(good.substr(0, doc.size() + 10)).status == ConfigStatus::REJECTED);
+  TEST_ASSERT_TRUE(offer(doc).status == ConfigStatus::REJECTED);
+  TEST_ASSERT_TRUE(offer("\n").status == ConfigStatus::REJECTED);
+  TEST_ASSERT_FALSE(config->staged());
+
+  // Tanpa kunci: semua ditolak
+  config->setKey(DEVICE, nullptr, 0);
+  TEST_ASSERT_TRUE(offer(good).status == ConfigStatus::REJECTED);
+  config->setKey(DEVICE, PSK, sizeof(PSK) - 1);
+
+  // Tag hex huruf besar diterima
+  std::string upper = good;
+  for (size_t i = doc.size() + 1; i < upper.size(); i++) {
+    if (upper[i] >= 'a' && upper[i] <= 'f') upper[i] = upper[i] - 'a' + 'A';
+  }
+  TEST_ASSERT_TRUE(offer(upper).status == ConfigStatus::APPLIED);
+}
+
+void test_numeric_bounds() {
+  assertAccepted("\"weight_read_ms\":20");
+  assertAccepted("\"weight_read_ms\":5000");
+  assertRejected("\"weight_read_ms\":19", "weight_read_ms: di luar batas");
+  assertRejected("\"weight_read_ms\":5001", "weight_read_ms: di luar batas");
+  assertRejected("\"weight_read_ms\":100.5", "weight_read_ms: harus bilangan bulat");
+  assertRejected("\"weight_read_ms\":\"100\"", "weight_read_ms: harus angka");
+  assertRejected("\"metrics_ms\":1800001", "metrics_ms: di luar batas");
+  assertRejected("\"mqtt_port\":0", "mqtt_port: di luar batas");
+  assertRejected("\"mqtt_port\":65536", "mqtt_port: di luar batas");
+  assertAccepted("\"min_weight_kg\":0.025");
+  assertRejected("\"min_weight_kg\":0.0005", "min_weight_kg: di luar batas");
+  assertRejected("\"min_weight_kg\":1.5", "min_weight_kg: di luar batas");
+
+  assertRejected("\"prewarm_upload\":1", "prewarm_upload: harus true/false");
+  assertRejected("\"prewarm_upload\":\"false\"", "prewarm_upload: harus true/false");
+
+  ConfigResult r = offerDoc("{\"version\":1000,\"mqtt_port\":8883,\"min_weight_kg\":0.2}");
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::APPLIED);
+  config->activate();
+  TEST_ASSERT_EQUAL_UINT16(8883, config->active().mqttPort);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.2f, config->active().minWeightKg);
+  TEST_ASSERT_TRUE(config->active().prewarmUpload);
+
+  // Pre-warm dimatikan tanpa build ulang: efek LIVE
+  r = offerDoc("{\"version\":1001,\"mqtt_port\":8883,\"min_weight_kg\":0.2,\"prewarm_upload\":false}");
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::APPLIED);
+  TEST_ASSERT_EQUAL_UINT8(CONFIG_LIVE, config->activate().effects);
+  TEST_ASSERT_FALSE(config->active().prewarmUpload);
+}
+
+void test_string_charset_and_length() {
+  assertAccepted("\"mqtt_server\":\"mqtt-2.kampus.ac.id\"");
+  assertAccepted("\"mqtt_server\":\"10.0.0.5\"");
+  assertRejected("\"mqtt_server\":\"\"", "mqtt_server: panjang di luar batas");
+  assertRejected("\"mqtt_server\":\"broker lama\"", "mqtt_server: karakter tidak valid");
+  assertRejected("\"mqtt_server\":\"broker_lama\"", "mqtt_server: karakter tidak valid");
+  std::string host64 = "\"mqtt_server\":\"" + std::string(64, 'a') + "\"";
+  assertRejected(host64.c_str(), "mqtt_server: harus string");   // tidak muat buffer 64
+
+  assertAccepted("\"mqtt_topic\":\"ecoscale/ft/berat\"");
+  assertRejected("\"mqtt_topic\":\"ecoscale/+/berat\"", "mqtt_topic: karakter tidak valid");
+  assertRejected("\"mqtt_topic\":\"ecoscale/#\"", "mqtt_topic: karakter tidak valid");
+  assertRejected("\"mqtt_topic\":\"a&b=c\"", "mqtt_topic: karakter tidak valid");
+  assertRejected("\"mqtt_topic\":\"a b\"", "mqtt_topic: karakter tidak valid");
+  assertRejected("\"mqtt_topic\":\"a\\\"b\"", "mqtt_topic: karakter tidak valid");
+
+  assertAccepted("\"fakultas\":\"FMIPA\"");
+  assertRejected("\"fakultas\":\"FMIPA-UI\"", "fakultas: panjang di luar batas");
+  assertRejected("\"fakultas\":\"F-T\"", "fakultas: karakter tidak valid");
+  assertRejected("\"fakultas\":7", "fakultas: harus string");
+
+  assertRejected("\"log\":{\"mqtt\":\"verbose\"}", "mqtt: level tidak dikenal");
+  assertRejected("\"log\":{\"wifi\":\"debug\"}", "wifi: modul tidak dikenal");
+  assertRejected("\"log\":\"debug\"", "log: harus objek");
+  assertRejected("\"warna\":1", "warna: field tidak dikenal");
+}
+
+void test_version_required_and_ordering() {
+  ConfigResult r = offerDoc("{\"weight_read_ms\":100}");
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::REJECTED);
+  TEST_ASSERT_EQUAL_STRING("dokumen: version wajib", r.error);
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":0}").status == ConfigStatus::REJECTED);
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":2.5}").status == ConfigStatus::REJECTED);
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":3").status == ConfigStatus::REJECTED);
+
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":5,\"lcd_update_ms\":400}").status == ConfigStatus::APPLIED);
+  // Dibandingkan dengan yang disiapkan, sebelum activate()
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":5,\"lcd_update_ms\":400}").status == ConfigStatus::UNCHANGED);
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":4}").status == ConfigStatus::STALE);
+  config->activate();
+  // Retained yang sama saat reconnect
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":5,\"lcd_update_ms\":400}").status == ConfigStatus::UNCHANGED);
+  r = offerDoc("{\"version\":2,\"lcd_update_ms\":900}");
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::STALE);
+  TEST_ASSERT_EQUAL_UINT32(2, r.version);
+  TEST_ASSERT_EQUAL_UINT32(400, config->active().lcdUpdateMs);
+
+  char ack[160];
+  TEST_ASSERT_GREATER_THAN_UINT32(0, formatConfigAck(ack, sizeof(ack), r));
+  TEST_ASSERT_EQUAL_STRING("{\"version\":2,\"status\":\"stale\",\"effects\":[],\"error\":\"\"}", ack);
+}
+
+void test_commit_persists_and_reloads() {
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":6,\"fakultas\":\"FK\",\"status_row_ms\":500}").status == ConfigStatus::APPLIED);
+  ConfigResult r = config->activate();
+  TEST_ASSERT_EQUAL_UINT8(CONFIG_LIVE | CONFIG_REBOOT, r.effects);
+  TEST_ASSERT_TRUE(config->uncommitted());
+  TEST_ASSERT_EQUAL_UINT32(0, store.saves);
+
+  // NVS gagal: tetap belum di-commit, dicoba lagi nanti
+  store.failSave = true;
+  TEST_ASSERT_FALSE(config->commit());
+  TEST_ASSERT_TRUE(config->uncommitted());
+  store.failSave = false;
+  TEST_ASSERT_TRUE(config->commit());
+  TEST_ASSERT_FALSE(config->uncommitted());
+  TEST_ASSERT_EQUAL_UINT32(1, store.saves);
+  // Disimpan tanpa tag
+  TEST_ASSERT_EQUAL_STRING("{\"version\":6,\"fakultas\":\"FK\",\"status_row_ms\":500}", store.doc.c_str());
+  // Sudah di-commit: rollback tidak punya apa-apa untuk dikembalikan
+  TEST_ASSERT_TRUE(config->rollback().status == ConfigStatus::UNCHANGED);
+
+  // Boot ulang dari NVS
+  RemoteConfig rebooted(defaults(), store);
+  TEST_ASSERT_TRUE(rebooted.begin());
+  TEST_ASSERT_EQUAL_UINT32(6, rebooted.active().version);
+  TEST_ASSERT_EQUAL_STRING("FK", rebooted.active().fakultas);
+  TEST_ASSERT_EQUAL_UINT32(500, rebooted.active().statusRowMs);
+
+  // NVS rusak: default firmware
+  MemoryStore broken;
+  broken.doc = "{\"version\":7,\"fakultas\":\"F K\"}";
+  RemoteConfig fallback(defaults(), broken);
+  TEST_ASSERT_FALSE(fallback.begin());
+  TEST_ASSERT_EQUAL_STRING("FT", fallback.active().fakultas);
+}
+
+void test_rollback_restores_committed() {
+  offerDoc("{\"version\":8,\"weight_read_ms\":300}");
+  config->activate();
+  config->commit();
+
+  offerDoc("{\"version\":9,\"weight_read_ms\":300,\"mqtt_server\":\"broker.baru\",\"lcd_update_ms\":500}");
+  ConfigResult r = config->activate();
+  TEST_ASSERT_EQUAL_UINT8(CONFIG_LIVE | CONFIG_RECONNECT, r.effects);
+  TEST_ASSERT_EQUAL_STRING("broker.baru", config->active().mqttServer);
+
+  r = config->rollback();
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::ROLLED_BACK);
+  TEST_ASSERT_EQUAL_UINT32(9, r.version);
+  TEST_ASSERT_EQUAL_UINT8(CONFIG_LIVE | CONFIG_RECONNECT, r.effects);
+  TEST_ASSERT_EQUAL_UINT32(8, config->active().version);
+  TEST_ASSERT_EQUAL_STRING("broker.lama", config->active().mqttServer);
+  TEST_ASSERT_EQUAL_UINT32(300, config->active().weightReadMs);
+  TEST_ASSERT_EQUAL_UINT32(200, config->active().lcdUpdateMs);
+  TEST_ASSERT_FALSE(config->uncommitted());
+  TEST_ASSERT_EQUAL_UINT32(1, store.saves);
+}
+
+void test_rolled_back_version_not_retried() {
+  // Backend menerbitkan v2 (retained) dengan broker yang tidak bisa dijangkau
+  std::string v2 = signedPayload("{\"version\":2,\"mqtt_server\":\"broker.mati\"}");
+  uint32_t activations = 0, rollbacks = 0;
+
+  // Setiap reconnect ke broker lama, broker mengirim ulang v2
+  for (int reconnect = 0; reconnect < 5; reconnect++) {
+    ConfigResult r = offer(v2);
+    if (r.status == ConfigStatus::APPLIED) {
+      config->activate();
+      activations++;
+      // Masa uji broker habis tanpa tersambung
+      if (config->rollback().status == ConfigStatus::ROLLED_BACK) rollbacks++;
+    } else {
+      TEST_ASSERT_TRUE(r.status == ConfigStatus::REJECTED);
+      TEST_ASSERT_EQUAL_UINT32(2, r.version);
+      TEST_ASSERT_EQUAL_STRING("v2 sudah di-rollback", r.error);
+    }
+    TEST_ASSERT_EQUAL_STRING("broker.lama", config->active().mqttServer);
+  }
+  printf("  5 reconnect dengan v2 retained: %u kali diaktifkan, %u rollback\n",
+         (unsigned)activations, (unsigned)rollbacks);
+  TEST_ASSERT_EQUAL_UINT32(1, activations);
+  TEST_ASSERT_EQUAL_UINT32(1, rollbacks);
+  // Versi lebih lama dari yang gagal juga ditolak
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":1,\"lcd_update_ms\":300}").status == ConfigStatus::REJECTED);
+
+  // Backend memperbaiki broker dan menaikkan versi
+  ConfigResult r = offerDoc("{\"version\":3,\"mqtt_server\":\"broker.baru\"}");
+  TEST_ASSERT_TRUE(r.status == ConfigStatus::APPLIED);
+  config->activate();
+  TEST_ASSERT_TRUE(config->commit());
+  TEST_ASSERT_EQUAL_STRING("broker.baru", config->active().mqttServer);
+  TEST_ASSERT_TRUE(offerDoc("{\"version\":3,\"mqtt_server\":\"broker.baru\"}").status == ConfigStatus::UNCHANGED);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_signed_document_staged_then_activated);
+  RUN_TEST(test_hmac_rejections);
+  RUN_TEST(test_numeric_bounds);
+  RUN_TEST(test_string_charset_and_length);
+  RUN_TEST(test_version_required_and_ordering);
+  RUN_TEST(test_commit_persists_and_reloads);
+  RUN_TEST(test_rollback_restores_committed);
+  RUN_TEST(test_rolled_back_version_not_retried);
+  return UNITY_END();
+}
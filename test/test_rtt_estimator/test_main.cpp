@@ -0,0 +1,163 @@
+// RttEstimator di host: SRTT/RTTVAR gaya Jacobson, batas RTO min/max,
+// backoff saat timeout, dan persentil dari histogram logaritmik dengan
+// distribusi sampel yang diketahui.
+#include <unity.h>
+#include <stdio.h>
+#include "rtt-estimator.h"
+
+namespace {
+// Histogram tanpa peluruhan, supaya persentil mencerminkan semua sampel
+RttPolicy noDecay() {
+  RttPolicy p;
+  p.decayAfter = 60000;
+  return p;
+}
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_sample_initialises() {
+  RttEstimator rtt;
+  TEST_ASSERT_EQUAL_UINT32(0, rtt.sampleCount());
+  TEST_ASSERT_EQUAL_UINT32(15000, rtt.rto());   // initialRtoMs
+  TEST_ASSERT_EQUAL_UINT32(0, rtt.percentile(95));
+
+  // SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 RTTVAR
+  rtt.sample(2000);
+  TEST_ASSERT_EQUAL_UINT32(1, rtt.sampleCount());
+  TEST_ASSERT_EQUAL_UINT32(2000, rtt.srtt());
+  TEST_ASSERT_EQUAL_UINT32(1000, rtt.rttvar());
+  TEST_ASSERT_EQUAL_UINT32(6000, rtt.rto());
+
+  // Sampel kedua memakai bobot 1/8 dan 1/4
+  rtt.sample(1200);
+  TEST_ASSERT_EQUAL_UINT32(1900, rtt.srtt());     // 7/8 * 2000 + 1/8 * 1200
+  TEST_ASSERT_EQUAL_UINT32(950, rtt.rttvar());    // 3/4 * 1000 + 1/4 * 800
+  TEST_ASSERT_EQUAL_UINT32(1900 + 4 * 950, rtt.rto());
+}
+
+void test_converges_after_step_change() {
+  RttEstimator rtt;
+  for (int i = 0; i < 50; i++) rtt.sample(1000);
+  TEST_ASSERT_UINT32_WITHIN(2, 1000, rtt.srtt());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(2, rtt.rttvar());
+
+  // Backend menjadi lebih cepat: SRTT turun monoton ke 300 ms
+  uint32_t prev = rtt.srtt();
+  int steps = 0;
+  while (rtt.srtt() > 310 && steps < 200) {
+    rtt.sample(300);
+    TEST_ASSERT_LESS_THAN_UINT32(prev, rtt.srtt());
+    prev = rtt.srtt();
+    steps++;
+  }
+  // (7/8)^n * 700 <= 10  ->  n ~ 32
+  TEST_ASSERT_UINT32_WITHIN(3, 32, steps);
+  for (int i = 0; i < 60; i++) rtt.sample(300);
+  TEST_ASSERT_UINT32_WITHIN(2, 300, rtt.srtt());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(2, rtt.rttvar());
+
+  // Jitter +-100 ms: RTTVAR mengikuti rata-rata |error|
+  for (int i = 0; i < 200; i++) rtt.sample(i % 2 ? 400 : 200);
+  TEST_ASSERT_UINT32_WITHIN(15, 300, rtt.srtt());
+  TEST_ASSERT_UINT32_WITHIN(15, 100, rtt.rttvar());
+}
+
+void test_rto_clamped_and_backoff() {
+  RttEstimator rtt;
+  // Backend cepat dan stabil: RTO tidak turun di bawah minRtoMs
+  for (int i = 0; i < 50; i++) rtt.sample(100);
+  TEST_ASSERT_EQUAL_UINT32(1500, rtt.rto());
+
+  // Backend sangat lambat: RTO tidak melewati maxRtoMs
+  RttEstimator slow;
+  slow.sample(20000);
+  TEST_ASSERT_EQUAL_UINT32(15000, slow.rto());
+
+  // Timeout menggandakan RTO (maks 2^4) sampai sampel valid berikutnya
+  RttEstimator r;
+  r.sample(1000);                                 // RTO 1000 + 4 * 500 = 3000
+  TEST_ASSERT_EQUAL_UINT32(3000, r.rto());
+  r.onTimeout();
+  TEST_ASSERT_EQUAL_UINT32(6000, r.rto());
+  r.onTimeout();
+  TEST_ASSERT_EQUAL_UINT32(12000, r.rto());
+  r.onTimeout();
+  TEST_ASSERT_EQUAL_UINT32(15000, r.rto());
+  for (int i = 0; i < 10; i++) r.onTimeout();
+  TEST_ASSERT_EQUAL_UINT32(15000, r.rto());
+  TEST_ASSERT_EQUAL_UINT32(13, r.timeoutCount());
+  r.sample(1000);
+  TEST_ASSERT_EQUAL_UINT32(1000 + 4 * 375, r.rto());
+
+  // Batas min berlaku juga sebelum backoff; timeout sebelum sampel pertama
+  RttPolicy p;
+  p.initialRtoMs = 4000;
+  p.maxRtoMs = 60000;
+  RttEstimator fresh(p);
+  fresh.onTimeout();
+  TEST_ASSERT_EQUAL_UINT32(8000, fresh.rto());
+  RttEstimator fast(p);
+  fast.sample(10);
+  fast.onTimeout();
+  TEST_ASSERT_EQUAL_UINT32(3000, fast.rto());     // max(10 + 20, 1500) * 2
+}
+
+void test_percentile_of_known_distribution() {
+  // Seragam 1..1000 ms: p50 = 500, p95 = 950 -> batas atas bin 512 dan 1024
+  RttEstimator uniform(noDecay());
+  for (uint32_t ms = 1; ms <= 1000; ms++) uniform.sample(ms);
+  TEST_ASSERT_EQUAL_UINT32(512, uniform.percentile(50));
+  TEST_ASSERT_EQUAL_UINT32(1024, uniform.percentile(95));
+  TEST_ASSERT_EQUAL_UINT32(724, uniform.percentile(70));   // 16 * 2^5 * 1.41
+
+  // 92% respon cepat (200 ms), 8% ekor lambat (3 s): p95 jatuh di ekor
+  RttEstimator tail(noDecay());
+  for (int i = 0; i < 1000; i++) tail.sample(i % 25 < 23 ? 200 : 3000);
+  TEST_ASSERT_EQUAL_UINT32(256, tail.percentile(90));
+  TEST_ASSERT_EQUAL_UINT32(4096, tail.percentile(95));
+
+  // 97% cepat: p95 tetap di bin 200 ms
+  RttEstimator mostlyFast(noDecay());
+  for (int i = 0; i < 1000; i++) mostlyFast.sample(i % 100 < 97 ? 200 : 3000);
+  TEST_ASSERT_EQUAL_UINT32(256, mostlyFast.percentile(95));
+  TEST_ASSERT_EQUAL_UINT32(4096, mostlyFast.percentile(99));
+
+  // Di luar rentang histogram: bin pertama dan terakhir
+  RttEstimator edges(noDecay());
+  edges.sample(0);
+  TEST_ASSERT_EQUAL_UINT32(16, edges.percentile(95));
+  edges.sample(120000);
+  TEST_ASSERT_EQUAL_UINT32(46336, edges.percentile(100));   // bin terakhir, ~45 s
+
+  printf("  92%% @200 ms + 8%% @3 s: SRTT %u ms, RTO %u ms, p90 %u ms, p95 %u ms\n",
+         (unsigned)tail.srtt(), (unsigned)tail.rto(),
+         (unsigned)tail.percentile(90), (unsigned)tail.percentile(95));
+}
+
+void test_histogram_decay_follows_network() {
+  // decayAfter 256: satu jendela ekor lambat lalu jendela-jendela cepat
+  RttEstimator rtt;
+  for (int i = 0; i < 256; i++) rtt.sample(3000);
+  TEST_ASSERT_EQUAL_UINT32(4096, rtt.percentile(95));
+  int windows = 0;
+  while (rtt.percentile(95) == 4096 && windows < 10) {
+    for (int i = 0; i < 256; i++) rtt.sample(200);
+    windows++;
+  }
+  // Ekor lambat 128 -> 64, 32, 16, 8 setelah tiap peluruhan; 8 dari 248 < 5%
+  TEST_ASSERT_EQUAL_INT(4, windows);
+  TEST_ASSERT_EQUAL_UINT32(256, rtt.percentile(95));
+  TEST_ASSERT_EQUAL_UINT32(4096, rtt.percentile(99));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_sample_initialises);
+  RUN_TEST(test_converges_after_step_change);
+  RUN_TEST(test_rto_clamped_and_backoff);
+  RUN_TEST(test_percentile_of_known_distribution);
+  RUN_TEST(test_histogram_decay_follows_network);
+  return UNITY_END();
+}
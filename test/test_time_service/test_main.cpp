@@ -0,0 +1,131 @@
+// TimeService di host: sampel SNTP/HTTP Date/MQTT ditawarkan dengan waktu
+// monoton virtual (ms). Menguji urutan penerimaan sampel, pertambahan
+// ketidakpastian karena drift, dan konversi/format tanggal.
+#include <unity.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "time-service.h"
+
+namespace {
+const int64_t EPOCH = 1714548612000LL;   // 2024-05-01T07:30:12.000Z
+const uint64_t SEC = 1000;
+const uint64_t HOUR = 3600 * SEC;
+
+// Waktu UTC sebenarnya pada waktu monoton tertentu (boot pada EPOCH)
+int64_t trueEpoch(uint64_t monoMs) { return EPOCH + (int64_t)monoMs; }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_unsynced_and_first_sample() {
+  TimeService ts;
+  TEST_ASSERT_FALSE(ts.synced());
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, ts.uncertaintyAt(0));
+  TEST_ASSERT_FALSE(ts.offer(TimeSource::NONE, trueEpoch(10 * SEC), 10 * SEC, 1));
+  TEST_ASSERT_FALSE(ts.synced());
+
+  // Sampel pertama selalu dipakai, sekasar apa pun
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::MQTT, trueEpoch(10 * SEC), 10 * SEC, 1000));
+  TEST_ASSERT_TRUE(ts.currentSource() == TimeSource::MQTT);
+  TEST_ASSERT_EQUAL_UINT32(1000, ts.uncertaintyAt(10 * SEC));
+  // Record yang dicap sebelum sync mendapat timestamp yang benar (back-correct)
+  TEST_ASSERT_TRUE(ts.toEpochMs(2 * SEC) == trueEpoch(2 * SEC));
+}
+
+void test_offer_ordering() {
+  TimeService ts;
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::SNTP, trueEpoch(10 * SEC), 10 * SEC, 100));
+  // Sampel kurang presisi tidak menggantikan SNTP yang masih segar
+  TEST_ASSERT_FALSE(ts.offer(TimeSource::HTTP_DATE, trueEpoch(11 * SEC) + 400, 11 * SEC, 500));
+  TEST_ASSERT_FALSE(ts.offer(TimeSource::MQTT, trueEpoch(12 * SEC) - 900, 12 * SEC, 1000));
+  TEST_ASSERT_TRUE(ts.currentSource() == TimeSource::SNTP);
+  TEST_ASSERT_TRUE(ts.toEpochMs(12 * SEC) == trueEpoch(12 * SEC));
+
+  // Sampel yang lebih presisi menang, sampel baru dengan presisi sama juga
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::HTTP_DATE, trueEpoch(13 * SEC) + 20, 13 * SEC, 50));
+  TEST_ASSERT_TRUE(ts.currentSource() == TimeSource::HTTP_DATE);
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::SNTP, trueEpoch(14 * SEC), 14 * SEC, 50));
+  TEST_ASSERT_TRUE(ts.currentSource() == TimeSource::SNTP);
+  TEST_ASSERT_TRUE(ts.toEpochMs(20 * SEC) == trueEpoch(20 * SEC));
+
+  // Sampel yang diproses terlambat (monoMs sebelum sampel tersimpan) dibandingkan
+  // dengan estimasi yang diekstrapolasi mundur
+  TEST_ASSERT_FALSE(ts.offer(TimeSource::MQTT, trueEpoch(5 * SEC), 5 * SEC, 1000));
+  TEST_ASSERT_EQUAL_UINT32(51, ts.uncertaintyAt(5 * SEC));
+}
+
+void test_wrong_coarse_sample_is_corrected_by_next_one() {
+  TimeService ts;
+  // Sampel MQTT pertama meleset 1 jam (pesan retained yang basi)
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::MQTT, trueEpoch(10 * SEC) - (int64_t)HOUR, 10 * SEC, 1000));
+  // Sampel MQTT berikutnya, presisi sama, memperbaiki offset
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::MQTT, trueEpoch(40 * SEC), 40 * SEC, 1000));
+  TEST_ASSERT_TRUE(ts.toEpochMs(40 * SEC) == trueEpoch(40 * SEC));
+  TEST_ASSERT_TRUE(ts.toEpochMs(15 * SEC) == trueEpoch(15 * SEC));
+  // Pada monoMs yang sama pun seri dimenangkan sampel baru
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::MQTT, trueEpoch(40 * SEC) + 300, 40 * SEC, 1000));
+  TEST_ASSERT_TRUE(ts.toEpochMs(40 * SEC) == trueEpoch(40 * SEC) + 300);
+}
+
+void test_uncertainty_grows_with_drift() {
+  TimeService ts;
+  ts.offer(TimeSource::SNTP, trueEpoch(0), 0, 100);
+  TEST_ASSERT_EQUAL_UINT32(100, ts.uncertaintyAt(0));
+  // 50 ppm, dibulatkan ke atas
+  TEST_ASSERT_EQUAL_UINT32(101, ts.uncertaintyAt(1));
+  TEST_ASSERT_EQUAL_UINT32(101, ts.uncertaintyAt(20 * SEC));
+  TEST_ASSERT_EQUAL_UINT32(102, ts.uncertaintyAt(20 * SEC + 1));
+  TEST_ASSERT_EQUAL_UINT32(280, ts.uncertaintyAt(HOUR));
+  TEST_ASSERT_EQUAL_UINT32(100 + 4320, ts.uncertaintyAt(24 * HOUR));
+
+  // HTTP Date +-600 ms kalah selama drift < 500 ms, menang setelah itu
+  const uint64_t crossover = 10000 * SEC;   // 500 ms / 50 ppm
+  TEST_ASSERT_EQUAL_UINT32(599, ts.uncertaintyAt(crossover - 20 * SEC));
+  TEST_ASSERT_FALSE(ts.offer(TimeSource::HTTP_DATE, trueEpoch(crossover - 20 * SEC), crossover - 20 * SEC, 600));
+  TEST_ASSERT_TRUE(ts.offer(TimeSource::HTTP_DATE, trueEpoch(crossover), crossover, 600));
+  TEST_ASSERT_TRUE(ts.currentSource() == TimeSource::HTTP_DATE);
+  // Estimasi baru ikut menua dari titik sampelnya
+  TEST_ASSERT_EQUAL_UINT32(600, ts.uncertaintyAt(crossover));
+  TEST_ASSERT_EQUAL_UINT32(780, ts.uncertaintyAt(crossover + HOUR));
+
+  // Ketidakpastian yang sangat besar dijenuhkan, bukan overflow
+  TimeService far;
+  far.offer(TimeSource::MQTT, 0, 0, UINT32_MAX - 10);
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, far.uncertaintyAt(1000 * HOUR));
+
+  printf("  SNTP +-100 ms: +-%u ms setelah 1 jam, +-%u ms setelah 24 jam; "
+         "HTTP Date +-600 ms menang setelah %u s\n",
+         (unsigned)(100 + HOUR * TimeService::DRIFT_PPM / 1000000),
+         (unsigned)(100 + 24 * HOUR * TimeService::DRIFT_PPM / 1000000),
+         (unsigned)(crossover / SEC));
+}
+
+void test_http_date_and_iso8601() {
+  int64_t sec = 0;
+  TEST_ASSERT_TRUE(parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", sec));
+  TEST_ASSERT_TRUE(sec == 784111777);
+  TEST_ASSERT_TRUE(parseHttpDate("Wed, 01 May 2024 07:30:12 GMT", sec));
+  TEST_ASSERT_TRUE(sec * 1000 == EPOCH);
+  TEST_ASSERT_FALSE(parseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT", sec));
+  TEST_ASSERT_FALSE(parseHttpDate("Sun, 06 Nov 1994 24:49:37 GMT", sec));
+  TEST_ASSERT_FALSE(parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", sec));
+
+  char buf[32];
+  formatIso8601(buf, sizeof(buf), EPOCH + 345);
+  TEST_ASSERT_EQUAL_STRING("2024-05-01T07:30:12.345Z", buf);
+  formatIso8601(buf, sizeof(buf), 951782400000LL);   // tahun kabisat abad
+  TEST_ASSERT_EQUAL_STRING("2000-02-29T00:00:00.000Z", buf);
+  formatIso8601(buf, sizeof(buf), -1);
+  TEST_ASSERT_EQUAL_STRING("1969-12-31T23:59:59.999Z", buf);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_unsynced_and_first_sample);
+  RUN_TEST(test_offer_ordering);
+  RUN_TEST(test_wrong_coarse_sample_is_corrected_by_next_one);
+  RUN_TEST(test_uncertainty_grows_with_drift);
+  RUN_TEST(test_http_date_and_iso8601);
+  return UNITY_END();
+}
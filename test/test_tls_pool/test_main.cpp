@@ -0,0 +1,190 @@
+// Soak StaticPool: ribuan handshake TLS simulasi (buffer IN/OUT + objek kecil
+// handshake) diselingi alokasi aplikasi berumur panjang. Heap utama juga
+// dimodelkan sebagai StaticPool supaya blok bebas terbesar bisa dipantau.
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "tls-pool.h"
+
+namespace {
+constexpr size_t TLS_POOL_SIZE = 48 * 1024;   // sama dengan src/tls-pool.cpp
+constexpr size_t HEAP_SIZE = 96 * 1024;
+constexpr size_t IN_BUF = 16384 + 325;
+constexpr size_t OUT_BUF = 4096 + 325;
+
+// Mirip tlsCalloc/tlsFree di ESP32: pool dulu, heap jika penuh
+struct TlsAllocator {
+  StaticPool* pool;
+  StaticPool* heap;
+  uint32_t fallbacks = 0;
+  uint32_t failures = 0;
+
+  void* alloc(size_t size) {
+    void* p = pool ? pool->allocate(size) : nullptr;
+    if (!p) {
+      if (pool) fallbacks++;
+      p = heap->allocate(size);
+      if (!p) failures++;
+    }
+    if (p) memset(p, 0xA5, size);
+    return p;
+  }
+  void release(void* p) {
+    if (!p) return;
+    if (!pool || !pool->release(p)) heap->release(p);
+  }
+};
+
+struct SoakResult {
+  size_t minLargestFree;   // blok bebas terbesar heap utama (terburuk)
+  size_t minFree;          // heap bebas terkecil
+  uint32_t tlsFailures;
+  uint32_t fallbacks;
+};
+
+// Satu handshake: buffer record + puluhan objek kecil dengan umur acak.
+// Di antara handshake aplikasi menyimpan objek kecil (antrian, string JSON)
+// yang baru dibebaskan beberapa handshake kemudian.
+SoakResult soak(StaticPool& heap, StaticPool* tlsPool, int handshakes, unsigned seed) {
+  srand(seed);
+  TlsAllocator tls = { tlsPool, &heap };
+  std::vector<void*> app;
+  SoakResult r = { (size_t)-1, (size_t)-1, 0, 0 };
+
+  for (int h = 0; h < handshakes; h++) {
+    void* in = tls.alloc(IN_BUF);
+    void* out = tls.alloc(OUT_BUF);
+    std::vector<void*> tmp;
+    for (int i = 0; i < 40; i++) {
+      tmp.push_back(tls.alloc(16 + rand() % 600));
+      if (rand() % 3 == 0) {
+        size_t k = rand() % tmp.size();
+        tls.release(tmp[k]);
+        tmp.erase(tmp.begin() + k);
+      }
+      if (i % 10 == 0) app.push_back(heap.allocate(32 + rand() % 200));
+    }
+    for (void* p : tmp) tls.release(p);
+
+    size_t largest = heap.largestFreeBlock();
+    size_t free = heap.capacityBytes() - heap.usedBytes();
+    if (largest < r.minLargestFree) r.minLargestFree = largest;
+    if (free < r.minFree) r.minFree = free;
+
+    tls.release(in);
+    tls.release(out);
+    while (app.size() > 24) {   // objek aplikasi hidup ~6 handshake
+      size_t k = rand() % 8;
+      heap.release(app[k]);
+      app.erase(app.begin() + k);
+    }
+  }
+  for (void* p : app) heap.release(p);
+  r.tlsFailures = tls.failures;
+  r.fallbacks = tls.fallbacks;
+  return r;
+}
+
+uint8_t heapBuffer[HEAP_SIZE];
+uint8_t poolBuffer[TLS_POOL_SIZE];
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_allocate_release_coalesces() {
+  StaticPool pool(poolBuffer, sizeof(poolBuffer));
+  size_t initial = pool.largestFreeBlock();
+  void* a = pool.allocate(1000);
+  void* b = pool.allocate(2000);
+  void* c = pool.allocate(3000);
+  TEST_ASSERT_NOT_NULL(a);
+  TEST_ASSERT_NOT_NULL(c);
+  TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)b % 8);
+  TEST_ASSERT_TRUE(pool.release(b));
+  TEST_ASSERT_TRUE(pool.release(a));
+  TEST_ASSERT_TRUE(pool.release(c));
+  TEST_ASSERT_EQUAL_UINT32(0, pool.usedBytes());
+  TEST_ASSERT_EQUAL_UINT32(initial, pool.largestFreeBlock());
+}
+
+void test_foreign_pointer_is_not_released() {
+  StaticPool pool(poolBuffer, sizeof(poolBuffer));
+  int onStack = 0;
+  TEST_ASSERT_FALSE(pool.release(&onStack));
+  TEST_ASSERT_FALSE(pool.release(nullptr));
+}
+
+void test_exhausted_pool_counts_failure() {
+  StaticPool pool(poolBuffer, sizeof(poolBuffer));
+  void* big = pool.allocate(TLS_POOL_SIZE - 1024);
+  TEST_ASSERT_NOT_NULL(big);
+  TEST_ASSERT_NULL(pool.allocate(IN_BUF));
+  TEST_ASSERT_EQUAL_UINT32(1, pool.failedAllocations());
+  pool.release(big);
+  TEST_ASSERT_NOT_NULL(pool.allocate(IN_BUF));
+}
+
+void test_soak_pool_never_fragments() {
+  StaticPool heap(heapBuffer, sizeof(heapBuffer));
+  StaticPool pool(poolBuffer, sizeof(poolBuffer));
+  SoakResult r = soak(heap, &pool, 20000, 1);
+
+  TEST_ASSERT_EQUAL_UINT32(0, pool.usedBytes());
+  TEST_ASSERT_EQUAL_UINT32(0, heap.usedBytes());
+  TEST_ASSERT_EQUAL_UINT32(0, r.fallbacks);
+  TEST_ASSERT_EQUAL_UINT32(0, r.tlsFailures);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TLS_POOL_SIZE, pool.peakBytes());
+  // Pool kembali utuh: handshake berikutnya selalu muat
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(IN_BUF + OUT_BUF, pool.largestFreeBlock());
+  // Heap utama hanya dipakai aplikasi, jadi tetap hampir utuh
+  TEST_ASSERT_GREATER_THAN_UINT32(HEAP_SIZE - 8 * 1024, r.minLargestFree);
+}
+
+void test_soak_without_pool_fragments_main_heap() {
+  StaticPool heap(heapBuffer, sizeof(heapBuffer));
+  SoakResult direct = soak(heap, nullptr, 20000, 1);
+  StaticPool heap2(heapBuffer, sizeof(heapBuffer));
+  StaticPool pool(poolBuffer, sizeof(poolBuffer));
+  SoakResult pooled = soak(heap2, &pool, 20000, 1);
+
+  printf("  tanpa pool: min heap bebas %u B, blok terbesar min %u B, gagal %u\n",
+         (unsigned)direct.minFree, (unsigned)direct.minLargestFree, (unsigned)direct.tlsFailures);
+  printf("  dengan pool: min heap bebas %u B, blok terbesar min %u B, gagal %u\n",
+         (unsigned)pooled.minFree, (unsigned)pooled.minLargestFree, (unsigned)pooled.tlsFailures);
+  TEST_ASSERT_LESS_THAN_UINT32(pooled.minLargestFree, direct.minLargestFree);
+  TEST_ASSERT_LESS_THAN_UINT32(pooled.minFree, direct.minFree);
+}
+
+void test_second_session_falls_back_to_heap() {
+  StaticPool heap(heapBuffer, sizeof(heapBuffer));
+  StaticPool pool(poolBuffer, sizeof(poolBuffer));
+  TlsAllocator tls = { &pool, &heap };
+  // Dua sesi bersamaan (hedged request): sesi kedua tidak muat di pool
+  void* in1 = tls.alloc(IN_BUF);
+  void* out1 = tls.alloc(OUT_BUF);
+  void* state1 = tls.alloc(20 * 1024);
+  void* in2 = tls.alloc(IN_BUF);
+  TEST_ASSERT_NOT_NULL(in2);
+  TEST_ASSERT_FALSE(pool.owns(in2));
+  TEST_ASSERT_EQUAL_UINT32(1, tls.fallbacks);
+  tls.release(in2);
+  tls.release(state1);
+  tls.release(out1);
+  tls.release(in1);
+  TEST_ASSERT_EQUAL_UINT32(0, heap.usedBytes());
+  TEST_ASSERT_EQUAL_UINT32(0, pool.usedBytes());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_allocate_release_coalesces);
+  RUN_TEST(test_foreign_pointer_is_not_released);
+  RUN_TEST(test_exhausted_pool_counts_failure);
+  RUN_TEST(test_soak_pool_never_fragments);
+  RUN_TEST(test_soak_without_pool_fragments_main_heap);
+  RUN_TEST(test_second_session_falls_back_to_heap);
+  return UNITY_END();
+}
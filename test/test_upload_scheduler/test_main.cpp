@@ -0,0 +1,156 @@
+// Model link simulasi untuk UploadScheduler: jejak RSSI (bagus -> fading
+// dalam -> pulih), peluang timeout naik tajam di bawah -80 dBm, dan record
+// baru masuk berkala. Scheduler dibandingkan dengan kuras-semua tanpa
+// melihat link (perilaku lama).
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "upload-scheduler.h"
+
+namespace {
+constexpr size_t CAPACITY = 16;
+
+// RSSI per detik: 0-300 s bagus, 300-900 s fading dalam, lalu pulih
+int rssiAt(unsigned long sec) {
+  if (sec < 300) return -60 + (int)(sec % 5);
+  if (sec < 900) return -84 + (int)(sec % 7) - 3;
+  return -62 + (int)(sec % 4);
+}
+
+// Peluang upload gagal (timeout) sebagai fungsi RSSI
+bool uploadFails(int rssi) {
+  int pct = rssi >= -70 ? 2 : rssi >= -78 ? 30 : 90;
+  return rand() % 100 < pct;
+}
+
+struct SimStats {
+  uint32_t attempts = 0;
+  uint32_t timeouts = 0;
+  uint32_t poorAttempts = 0;   // percobaan saat fading
+  uint32_t delivered = 0;
+  uint32_t dropped = 0;        // outbox penuh saat record baru datang
+  size_t maxBatch = 0;
+  size_t queue = 0;
+};
+
+// Satu record tiap 20 s selama 1200 s, lalu 300 s tanpa record baru
+SimStats simulate(bool useScheduler, unsigned seed) {
+  srand(seed);
+  UploadScheduler sched;
+  SimStats s;
+  for (unsigned long sec = 0; sec < 1500; sec++) {
+    unsigned long now = sec * 1000;
+    int rssi = rssiAt(sec);
+    sched.observeRssi(rssi);
+    if (sec % 20 == 0 && sec < 1200) {
+      if (s.queue < CAPACITY) s.queue++;
+      else s.dropped++;
+    }
+
+    size_t budget = useScheduler ? sched.drainBudget(now, s.queue, CAPACITY) : s.queue;
+    if (budget > s.maxBatch) s.maxBatch = budget;
+    for (size_t i = 0; i < budget; i++) {
+      s.attempts++;
+      if (sec >= 300 && sec < 900) s.poorAttempts++;
+      bool fail = uploadFails(rssi);
+      sched.observeResult(!fail);
+      if (fail) { s.timeouts++; break; }   // timeout: sisa batch menunggu giliran berikutnya
+      s.queue--;
+      s.delivered++;
+    }
+  }
+  return s;
+}
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_quality_follows_rssi_and_failures() {
+  UploadScheduler s;
+  TEST_ASSERT_EQUAL(LinkQuality::GOOD, s.quality());   // belum ada sampel
+  s.observeRssi(-60);
+  TEST_ASSERT_EQUAL(LinkQuality::GOOD, s.quality());
+  for (int i = 0; i < 20; i++) s.observeRssi(-72);
+  TEST_ASSERT_EQUAL(LinkQuality::FAIR, s.quality());
+  for (int i = 0; i < 20; i++) s.observeRssi(-82);
+  TEST_ASSERT_EQUAL(LinkQuality::POOR, s.quality());
+
+  UploadScheduler f;
+  f.observeRssi(-55);
+  for (int i = 0; i < 10; i++) f.observeResult(false);
+  TEST_ASSERT_EQUAL(LinkQuality::POOR, f.quality());   // RSSI bagus tapi selalu gagal
+  for (int i = 0; i < 30; i++) f.observeResult(true);
+  TEST_ASSERT_EQUAL(LinkQuality::GOOD, f.quality());
+}
+
+void test_budget_per_quality() {
+  SchedulerPolicy p;
+  UploadScheduler good;
+  good.observeRssi(-60);
+  TEST_ASSERT_EQUAL_UINT8(p.burstBatch, good.drainBudget(0, 12, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(3, good.drainBudget(0, 3, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(0, good.drainBudget(0, 0, CAPACITY));
+
+  UploadScheduler fair;
+  fair.observeRssi(-72);
+  TEST_ASSERT_EQUAL_UINT8(p.fairBatch, fair.drainBudget(0, 4, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(p.fairBatch * 2, fair.drainBudget(0, CAPACITY / 2, CAPACITY));
+}
+
+void test_poor_link_only_probes() {
+  SchedulerPolicy p;
+  UploadScheduler s;
+  s.observeRssi(-85);
+  TEST_ASSERT_EQUAL_UINT8(1, s.drainBudget(1000, 4, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(0, s.drainBudget(2000, 4, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(0, s.drainBudget(1000 + p.poorProbeInterval - 1, 4, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(1, s.drainBudget(1000 + p.poorProbeInterval, 4, CAPACITY));
+  // Outbox >= 3/4 penuh: tidak ditunda lagi, kirim tiap kesempatan
+  unsigned long t = 1000 + p.poorProbeInterval;
+  TEST_ASSERT_EQUAL_UINT8(1, s.drainBudget(t + 1, 12, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(1, s.drainBudget(t + 2, 12, CAPACITY));
+  TEST_ASSERT_EQUAL_UINT8(0, s.drainBudget(t + 3, 11, CAPACITY));
+}
+
+void test_interactive_send_blocked_only_when_link_dead() {
+  UploadScheduler s;
+  s.observeRssi(-85);
+  TEST_ASSERT_TRUE(s.interactiveAllowed());   // RSSI buruk, tapi belum pernah gagal
+  for (int i = 0; i < 20; i++) s.observeResult(false);
+  TEST_ASSERT_FALSE(s.interactiveAllowed());
+}
+
+void test_simulated_link_defers_during_fade_and_drains_after() {
+  SimStats naive = simulate(false, 7);
+  SimStats sched = simulate(true, 7);
+  printf("  kuras-semua: %u percobaan, %u timeout (%u saat fading), %u terkirim, %u hilang\n",
+         (unsigned)naive.attempts, (unsigned)naive.timeouts, (unsigned)naive.poorAttempts,
+         (unsigned)naive.delivered, (unsigned)naive.dropped);
+  printf("  scheduler  : %u percobaan, %u timeout (%u saat fading), %u terkirim, %u hilang, batch maks %u\n",
+         (unsigned)sched.attempts, (unsigned)sched.timeouts, (unsigned)sched.poorAttempts,
+         (unsigned)sched.delivered, (unsigned)sched.dropped, (unsigned)sched.maxBatch);
+
+  TEST_ASSERT_EQUAL_UINT32(0, sched.queue);
+  // Menunda tidak boleh mengorbankan data: tidak ada record hilang
+  TEST_ASSERT_EQUAL_UINT32(0, sched.dropped);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(naive.dropped, sched.dropped);
+  TEST_ASSERT_EQUAL_UINT32(60, sched.delivered);
+  // Fading 600 s dengan 90% gagal: record yang datang tetap harus keluar
+  // sebelum outbox penuh, jadi penghematan datang dari penundaan di awal
+  // fading dan dari tidak mencoba saat antrian masih longgar
+  TEST_ASSERT_LESS_THAN_UINT32(naive.timeouts * 3 / 4, sched.timeouts);
+  TEST_ASSERT_LESS_THAN_UINT32(naive.poorAttempts, sched.poorAttempts);
+  // Setelah pulih antrian dikuras dengan burst
+  TEST_ASSERT_GREATER_THAN_UINT32(2, sched.maxBatch);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_quality_follows_rssi_and_failures);
+  RUN_TEST(test_budget_per_quality);
+  RUN_TEST(test_poor_link_only_probes);
+  RUN_TEST(test_interactive_send_blocked_only_when_link_dead);
+  RUN_TEST(test_simulated_link_defers_during_fade_and_drains_after);
+  return UNITY_END();
+}
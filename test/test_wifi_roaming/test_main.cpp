@@ -0,0 +1,187 @@
+// Simulasi lapisan WiFi untuk WifiRoaming: beberapa AP ber-SSID sama, scan
+// yang butuh beberapa tick, dan roamTo yang memindah asosiasi.
+#include <unity.h>
+#include <string.h>
+#include "wifi-roaming.h"
+
+namespace {
+struct SimAp {
+  uint8_t bssid[6];
+  int32_t channel;
+  int32_t rssi;
+};
+
+class SimWifi : public RoamingRadio {
+public:
+  static constexpr int MAX_AP = 4;
+  SimAp aps[MAX_AP];
+  int apCount = 0;
+  int current = 0;          // indeks AP tersambung
+  bool connected = true;
+  int scanTicks = 3;        // poll scanResult() sebelum hasil siap
+  int scanLeft = -1;
+  uint32_t scansStarted = 0;
+  uint32_t roams = 0;
+
+  int addAp(uint8_t id, int32_t channel, int32_t rssi) {
+    SimAp& ap = aps[apCount];
+    memset(ap.bssid, id, sizeof(ap.bssid));
+    ap.channel = channel;
+    ap.rssi = rssi;
+    return apCount++;
+  }
+
+  bool isConnected() override { return connected; }
+  int32_t rssi() override { return aps[current].rssi; }
+  const uint8_t* bssid() override { return aps[current].bssid; }
+  bool startScan() override {
+    if (scanLeft >= 0) return false;
+    scanLeft = scanTicks;
+    scansStarted++;
+    return true;
+  }
+  int scanResult(ApInfo* out, int maxCount) override {
+    if (scanLeft < 0) return 0;
+    if (scanLeft-- > 0) return -1;
+    int n = apCount < maxCount ? apCount : maxCount;
+    for (int i = 0; i < n; i++) {
+      memcpy(out[i].bssid, aps[i].bssid, 6);
+      out[i].channel = aps[i].channel;
+      out[i].rssi = aps[i].rssi;
+    }
+    return n;
+  }
+  void roamTo(const ApInfo& ap) override {
+    for (int i = 0; i < apCount; i++) {
+      if (memcmp(aps[i].bssid, ap.bssid, 6) == 0) current = i;
+    }
+    roams++;
+  }
+};
+
+RoamingPolicy fastPolicy() {
+  RoamingPolicy p;
+  p.sampleInterval = 100;
+  p.scanInterval = 2000;
+  p.roamCooldown = 10000;
+  return p;
+}
+
+// Jalankan tick tiap 10 ms dari `from` sampai `to`
+void run(WifiRoaming& roaming, unsigned long from, unsigned long to, bool idle) {
+  for (unsigned long t = from; t < to; t += 10) roaming.tick(t, idle);
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_roams_to_stronger_ap_when_link_is_weak() {
+  SimWifi wifi;
+  wifi.addAp(1, 1, -82);
+  int strong = wifi.addAp(2, 6, -60);
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  run(roaming, 0, 1500, true);
+  TEST_ASSERT_EQUAL(strong, wifi.current);
+  TEST_ASSERT_EQUAL_UINT32(1, roaming.roamCount());
+  TEST_ASSERT_FALSE(roaming.isWeak());
+}
+
+void test_no_roam_while_weighing() {
+  SimWifi wifi;
+  wifi.addAp(1, 1, -82);
+  wifi.addAp(2, 6, -60);
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  run(roaming, 0, 5000, false);
+  TEST_ASSERT_TRUE(roaming.isWeak());
+  TEST_ASSERT_EQUAL_UINT32(0, wifi.scansStarted);
+  TEST_ASSERT_EQUAL(0, wifi.current);
+}
+
+void test_scan_result_dropped_when_weighing_starts_mid_scan() {
+  SimWifi wifi;
+  wifi.addAp(1, 1, -82);
+  wifi.addAp(2, 6, -60);
+  wifi.scanTicks = 20;
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  unsigned long t = 0;
+  while (!roaming.isScanning() && t < 2000) roaming.tick(t += 10, true);
+  TEST_ASSERT_TRUE(roaming.isScanning());
+  run(roaming, t, t + 1000, false);
+  TEST_ASSERT_EQUAL_UINT32(0, wifi.roams);
+  TEST_ASSERT_EQUAL(0, wifi.current);
+}
+
+void test_hysteresis_blocks_marginal_candidate() {
+  SimWifi wifi;
+  wifi.addAp(1, 1, -80);
+  wifi.addAp(2, 6, -76);   // hanya 4 dB lebih kuat (hysteresis 8 dB)
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  run(roaming, 0, 10000, true);
+  TEST_ASSERT_EQUAL_UINT32(0, wifi.roams);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(2, wifi.scansStarted);
+  // Scan dijarangkan scanInterval walau link tetap lemah
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(10000 / 2000 + 1, wifi.scansStarted);
+}
+
+void test_cooldown_prevents_flapping() {
+  SimWifi wifi;
+  int a = wifi.addAp(1, 1, -82);
+  int b = wifi.addAp(2, 6, -60);
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  run(roaming, 0, 1500, true);
+  TEST_ASSERT_EQUAL(b, wifi.current);
+  // Operator berjalan: AP baru melemah, AP lama menguat lagi
+  wifi.aps[b].rssi = -84;
+  wifi.aps[a].rssi = -58;
+  run(roaming, 1500, 9000, true);
+  TEST_ASSERT_EQUAL_UINT32(1, wifi.roams);   // masih dalam roamCooldown
+  run(roaming, 9000, 14000, true);
+  TEST_ASSERT_EQUAL_UINT32(2, wifi.roams);
+  TEST_ASSERT_EQUAL(a, wifi.current);
+}
+
+void test_disconnect_resets_weak_state() {
+  SimWifi wifi;
+  wifi.addAp(1, 1, -82);
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  run(roaming, 0, 1000, false);
+  TEST_ASSERT_TRUE(roaming.isWeak());
+  wifi.connected = false;
+  roaming.tick(1010, true);
+  TEST_ASSERT_FALSE(roaming.isWeak());
+  TEST_ASSERT_FALSE(roaming.isScanning());
+}
+
+void test_recovered_rssi_clears_weak_only_above_hysteresis() {
+  SimWifi wifi;
+  wifi.addAp(1, 1, -80);
+  WifiRoaming roaming(wifi, fastPolicy());
+
+  run(roaming, 0, 1000, false);
+  TEST_ASSERT_TRUE(roaming.isWeak());
+  wifi.aps[0].rssi = -72;   // di atas ambang, tapi belum +hysteresis
+  run(roaming, 1000, 2000, false);
+  TEST_ASSERT_TRUE(roaming.isWeak());
+  wifi.aps[0].rssi = -65;
+  run(roaming, 2000, 2200, false);
+  TEST_ASSERT_FALSE(roaming.isWeak());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_roams_to_stronger_ap_when_link_is_weak);
+  RUN_TEST(test_no_roam_while_weighing);
+  RUN_TEST(test_scan_result_dropped_when_weighing_starts_mid_scan);
+  RUN_TEST(test_hysteresis_blocks_marginal_candidate);
+  RUN_TEST(test_cooldown_prevents_flapping);
+  RUN_TEST(test_disconnect_resets_weak_state);
+  RUN_TEST(test_recovered_rssi_clears_weak_only_above_hysteresis);
+  return UNITY_END();
+}
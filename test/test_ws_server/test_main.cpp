@@ -0,0 +1,308 @@
+// Listener palsu untuk WsServer: setiap socket punya antrian masuk dan
+// kapasitas tulis per loop (0 = browser macet). Byte keluar diurai kembali
+// menjadi frame WebSocket sehingga frame yang terpotong langsung ketahuan.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ws-server.h"
+
+namespace {
+struct SimSocket {
+  bool open = true;
+  size_t writeBudget = (size_t)-1;   // byte per loop() yang diterima socket
+  size_t budgetLeft = (size_t)-1;
+  std::string in;                    // dari browser
+  std::string out;                   // ke browser
+  size_t parsed = 0;                 // posisi parser frame di `out`
+  bool upgraded = false;
+  std::vector<std::string> frames;   // payload frame biner/pong/close
+  std::vector<uint8_t> opcodes;
+};
+
+class SimListener : public WsListener {
+public:
+  std::vector<SimSocket> sockets;
+  std::vector<int> pending;
+
+  int connect(size_t writeBudget = (size_t)-1) {
+    sockets.push_back(SimSocket());
+    sockets.back().writeBudget = writeBudget;
+    pending.push_back((int)sockets.size() - 1);
+    return (int)sockets.size() - 1;
+  }
+  // Panggil sebelum tiap loop(): isi ulang kapasitas tulis
+  void tick() { for (SimSocket& s : sockets) s.budgetLeft = s.writeBudget; }
+
+  int accept() override {
+    if (pending.empty()) return -1;
+    int h = pending.front();
+    pending.erase(pending.begin());
+    return h;
+  }
+  int write(int h, const uint8_t* data, size_t len) override {
+    SimSocket& s = sockets[h];
+    if (!s.open) return -1;
+    size_t n = len < s.budgetLeft ? len : s.budgetLeft;
+    s.budgetLeft -= n;
+    s.out.append((const char*)data, n);
+    return (int)n;
+  }
+  int read(int h, uint8_t* buf, size_t len) override {
+    SimSocket& s = sockets[h];
+    if (!s.open) return -1;
+    size_t n = len < s.in.size() ? len : s.in.size();
+    memcpy(buf, s.in.data(), n);
+    s.in.erase(0, n);
+    return (int)n;
+  }
+  void close(int h) override { sockets[h].open = false; }
+};
+
+// Urai byte keluar menjadi frame (server tidak pernah me-mask)
+void parseFrames(SimSocket& s) {
+  if (!s.upgraded) {
+    size_t end = s.out.find("\r\n\r\n");
+    if (end == std::string::npos) return;
+    s.upgraded = s.out.compare(0, 12, "HTTP/1.1 101") == 0;
+    s.parsed = end + 4;
+    if (!s.upgraded) return;
+  }
+  while (s.out.size() - s.parsed >= 2) {
+    const uint8_t* p = (const uint8_t*)s.out.data() + s.parsed;
+    TEST_ASSERT_EQUAL_UINT8(0x80, p[0] & 0x80);   // FIN, tidak terfragmentasi
+    TEST_ASSERT_EQUAL_UINT8(0, p[1] & 0x80);      // tanpa mask
+    size_t len = p[1] & 0x7F, header = 2;
+    if (len == 126) {
+      if (s.out.size() - s.parsed < 4) return;
+      len = (size_t)p[2] << 8 | p[3];
+      header = 4;
+    }
+    if (s.out.size() - s.parsed < header + len) return;
+    s.opcodes.push_back(p[0] & 0x0F);
+    s.frames.push_back(s.out.substr(s.parsed + header, len));
+    s.parsed += header + len;
+  }
+}
+
+std::string upgradeRequest(const char* key = "dGhlIHNhbXBsZSBub25jZQ==") {
+  return std::string("GET /ws HTTP/1.1\r\nHost: ecoscale.local\r\nUpgrade: websocket\r\n"
+                     "Connection: Upgrade\r\nSec-WebSocket-Key: ") + key +
+         "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+}
+
+// Frame dari browser (selalu di-mask)
+std::string clientFrame(uint8_t opcode, const std::string& payload) {
+  const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+  std::string f;
+  f += (char)(0x80 | opcode);
+  f += (char)(0x80 | payload.size());
+  f.append((const char*)mask, 4);
+  for (size_t i = 0; i < payload.size(); i++) f += (char)(payload[i] ^ mask[i & 3]);
+  return f;
+}
+
+void step(WsServer& server, SimListener& net, unsigned long now) {
+  net.tick();
+  server.loop(now);
+  for (SimSocket& s : net.sockets) parseFrames(s);
+}
+
+// Frame berat 16 byte: seq + berat, seperti live view
+void weightFrame(uint8_t* frame, uint32_t seq) {
+  memset(frame, 0, 16);
+  memcpy(frame, &seq, sizeof(seq));
+}
+
+const char PAGE[] = "<!doctype html><title>EcoScale</title>";
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_accept_key_matches_rfc6455_example() {
+  char out[32];
+  TEST_ASSERT_TRUE(wsAcceptKey("dGhlIHNhbXBsZSBub25jZQ==", out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=", out);
+  TEST_ASSERT_FALSE(wsAcceptKey("x", out, 28));
+}
+
+void test_serves_page_then_closes() {
+  SimListener net;
+  WsServer server(net);
+  server.setPage(PAGE, sizeof(PAGE) - 1);
+  int h = net.connect(20);   // socket kecil: halaman terkirim dalam beberapa loop
+  net.sockets[h].in = "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+  for (unsigned long t = 0; t < 2000 && net.sockets[h].open; t += 10) step(server, net, t);
+  const std::string& out = net.sockets[h].out;
+  TEST_ASSERT_EQUAL_INT(0, out.compare(0, 15, "HTTP/1.1 200 OK"));
+  TEST_ASSERT_EQUAL_STRING(PAGE, out.substr(out.find("\r\n\r\n") + 4).c_str());
+  TEST_ASSERT_FALSE(net.sockets[h].open);
+}
+
+void test_unknown_path_and_method() {
+  SimListener net;
+  WsServer server(net);
+  int a = net.connect();
+  int b = net.connect();
+  net.sockets[a].in = "GET /x HTTP/1.1\r\n\r\n";
+  net.sockets[b].in = "POST / HTTP/1.1\r\n\r\n";
+  step(server, net, 0);
+  TEST_ASSERT_EQUAL_INT(0, net.sockets[a].out.compare(0, 12, "HTTP/1.1 404"));
+  TEST_ASSERT_EQUAL_INT(0, net.sockets[b].out.compare(0, 12, "HTTP/1.1 405"));
+  TEST_ASSERT_FALSE(net.sockets[a].open);
+}
+
+void test_handshake_and_broadcast() {
+  SimListener net;
+  WsServer server(net);
+  int h = net.connect();
+  net.sockets[h].in = upgradeRequest();
+  step(server, net, 0);
+  TEST_ASSERT_TRUE(net.sockets[h].upgraded);
+  TEST_ASSERT_NOT_EQUAL(std::string::npos, net.sockets[h].out.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo="));
+  TEST_ASSERT_EQUAL_INT(1, server.clientCount());
+
+  uint8_t frame[16];
+  weightFrame(frame, 42);
+  TEST_ASSERT_EQUAL_INT(1, server.broadcastBinary(frame, sizeof(frame)));
+  step(server, net, 10);
+  TEST_ASSERT_EQUAL_UINT32(1, net.sockets[h].frames.size());
+  TEST_ASSERT_EQUAL_UINT8(0x2, net.sockets[h].opcodes[0]);
+  TEST_ASSERT_EQUAL_MEMORY(frame, net.sockets[h].frames[0].data(), sizeof(frame));
+}
+
+void test_slow_client_drops_whole_frames_without_affecting_fast_client() {
+  SimListener net;
+  WsServer server(net);
+  int fast = net.connect();
+  int slow = net.connect(40);   // ~2 frame per loop, sumber 10 frame per loop
+  net.sockets[fast].in = upgradeRequest();
+  net.sockets[slow].in = upgradeRequest("x3JJHMbDL1EzLkh9GBhXDw==");
+  step(server, net, 0);
+
+  const uint32_t FRAMES = 2000;
+  uint32_t seq = 0;
+  unsigned long t = 10;
+  for (; seq < FRAMES; t += 10) {
+    for (int k = 0; k < 10; k++, seq++) {
+      uint8_t frame[16];
+      weightFrame(frame, seq);
+      server.broadcastBinary(frame, sizeof(frame));
+    }
+    step(server, net, t);
+  }
+  for (int i = 0; i < 200; i++, t += 10) step(server, net, t);
+
+  SimSocket& f = net.sockets[fast];
+  SimSocket& s = net.sockets[slow];
+  printf("  cepat: %u frame, lambat: %u frame, dibuang %u\n", (unsigned)f.frames.size(),
+         (unsigned)s.frames.size(), (unsigned)server.stats().framesDropped);
+  TEST_ASSERT_EQUAL_UINT32(FRAMES, f.frames.size());
+  TEST_ASSERT_LESS_THAN_UINT32(FRAMES, s.frames.size());
+  TEST_ASSERT_EQUAL_UINT32(FRAMES - s.frames.size(), server.stats().framesDropped);
+  // Frame yang sampai utuh dan urut; tidak ada byte sisa yang terpotong
+  uint32_t last = 0;
+  for (size_t i = 0; i < s.frames.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT32(16, s.frames[i].size());
+    uint32_t v;
+    memcpy(&v, s.frames[i].data(), sizeof(v));
+    if (i) TEST_ASSERT_GREATER_THAN_UINT32(last, v);
+    last = v;
+  }
+  TEST_ASSERT_EQUAL_UINT32(s.out.size(), s.parsed);
+  TEST_ASSERT_TRUE(s.open);   // lambat tapi tetap menguras: tidak diputus
+}
+
+void test_stalled_client_is_closed() {
+  SimListener net;
+  WsServer server(net);
+  int fast = net.connect();
+  int stuck = net.connect();
+  net.sockets[fast].in = upgradeRequest();
+  net.sockets[stuck].in = upgradeRequest();
+  step(server, net, 0);
+  net.sockets[stuck].writeBudget = 0;   // tab browser dibekukan
+
+  unsigned long t = 10;
+  for (; t < WsServer::STALL_TIMEOUT + 1000; t += 10) {
+    uint8_t frame[16];
+    weightFrame(frame, t);
+    server.broadcastBinary(frame, sizeof(frame));
+    step(server, net, t);
+  }
+  TEST_ASSERT_FALSE(net.sockets[stuck].open);
+  TEST_ASSERT_TRUE(net.sockets[fast].open);
+  TEST_ASSERT_EQUAL_UINT32(1, server.stats().stalledClosed);
+  TEST_ASSERT_EQUAL_INT(1, server.clientCount());
+}
+
+void test_extra_client_gets_503() {
+  SimListener net;
+  WsServer server(net);
+  for (int i = 0; i <= WsServer::MAX_CLIENTS; i++) net.sockets[net.connect()].in = upgradeRequest();
+  step(server, net, 0);
+  TEST_ASSERT_EQUAL_INT(WsServer::MAX_CLIENTS, server.clientCount());
+  SimSocket& extra = net.sockets[WsServer::MAX_CLIENTS];
+  TEST_ASSERT_EQUAL_INT(0, extra.out.compare(0, 12, "HTTP/1.1 503"));
+  TEST_ASSERT_FALSE(extra.open);
+}
+
+void test_ping_pong_and_close() {
+  SimListener net;
+  WsServer server(net);
+  int h = net.connect();
+  net.sockets[h].in = upgradeRequest() + clientFrame(0x9, "hi");   // ping ikut terbaca bersama request
+  step(server, net, 0);
+  step(server, net, 10);
+  SimSocket& s = net.sockets[h];
+  TEST_ASSERT_EQUAL_UINT32(1, s.frames.size());
+  TEST_ASSERT_EQUAL_UINT8(0xA, s.opcodes[0]);
+  TEST_ASSERT_EQUAL_STRING("hi", s.frames[0].c_str());
+
+  s.in = clientFrame(0x8, std::string("\x03\xE8", 2));
+  step(server, net, 20);
+  step(server, net, 30);
+  TEST_ASSERT_EQUAL_UINT8(0x8, s.opcodes.back());
+  TEST_ASSERT_FALSE(s.open);
+  TEST_ASSERT_EQUAL_INT(0, server.clientCount());
+}
+
+void test_unmasked_client_frame_drops_connection() {
+  SimListener net;
+  WsServer server(net);
+  int h = net.connect();
+  net.sockets[h].in = upgradeRequest();
+  step(server, net, 0);
+  net.sockets[h].in = std::string("\x82\x01x", 3);
+  step(server, net, 10);
+  TEST_ASSERT_FALSE(net.sockets[h].open);
+}
+
+void test_incomplete_request_times_out() {
+  SimListener net;
+  WsServer server(net);
+  int h = net.connect();
+  net.sockets[h].in = "GET /ws HTTP/1.1\r\nHost:";
+  step(server, net, 0);
+  step(server, net, WsServer::REQUEST_TIMEOUT);
+  TEST_ASSERT_TRUE(net.sockets[h].open);
+  step(server, net, WsServer::REQUEST_TIMEOUT + 1);
+  TEST_ASSERT_FALSE(net.sockets[h].open);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_accept_key_matches_rfc6455_example);
+  RUN_TEST(test_serves_page_then_closes);
+  RUN_TEST(test_unknown_path_and_method);
+  RUN_TEST(test_handshake_and_broadcast);
+  RUN_TEST(test_slow_client_drops_whole_frames_without_affecting_fast_client);
+  RUN_TEST(test_stalled_client_is_closed);
+  RUN_TEST(test_extra_client_gets_503);
+  RUN_TEST(test_ping_pong_and_close);
+  RUN_TEST(test_unmasked_client_frame_drops_connection);
+  RUN_TEST(test_incomplete_request_times_out);
+  return UNITY_END();
+}
@@ -0,0 +1,253 @@
+/*
+ * PENERIMA CoAP LOKAL (HOST)
+ * Menerima upload CoAP dari timbangan (lihat include/coap-lite.h), cek tag
+ * HMAC PSK, rakit batch Block1, lalu teruskan setiap record ke ingest:
+ *  - dengan --forward: POST form-urlencoded ke endpoint HTTP (misal Laravel
+ *    dev server), api_key ditambahkan di sini karena tidak pernah dikirim alat
+ *  - tanpa --forward: record ditulis ke stdout (ingest stand-in)
+ *
+ * Build (dari root repo):
+ *   g++ -std=c++17 -O2 -I include tools/coap-receiver.cpp src/coap-lite.cpp \
+ *       src/hmac-sha256.cpp src/http-lite.cpp -o coap-receiver
+ * Jalankan:
+ *   ./coap-receiver --psk <rahasia> [--port 5683] [--forward http://127.0.0.1:8000/api/receive-sampah --api-key <key>]
+ */
+
+#include "coap-lite.h"
+#include "hmac-sha256.h"
+#include "http-lite.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr size_t MAX_BODY = 16 * 1024;
+  constexpr int TRANSFER_TIMEOUT_S = 120;
+
+  struct Options {
+    uint16_t port = COAP_DEFAULT_PORT;
+    std::string psk;
+    std::string forwardUrl;
+    std::string apiKey;
+  } opt;
+
+  // Batch Block1 yang sedang dirakit, per (alamat pengirim, token)
+  struct Transfer {
+    std::string body;
+    uint32_t nextBlock = 0;
+    time_t updatedAt = 0;
+  };
+
+  // Response terakhir per pengirim: retransmisi CON dijawab ulang tanpa diproses lagi
+  struct LastExchange {
+    uint16_t messageId;
+    std::vector<uint8_t> response;
+  };
+
+  std::map<std::string, Transfer> transfers;
+  std::map<std::string, LastExchange> lastExchange;
+  HttpEndpoint forwardEndpoint;
+  HttpRequestWriter forwardRequest;
+
+  std::string peerKey(const sockaddr_in& addr) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%s:%u", inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+    return buf;
+  }
+
+  std::vector<uint8_t> buildResponse(const CoapMessage& req, uint8_t code, bool echoBlock, uint32_t block1) {
+    std::vector<uint8_t> out(64);
+    CoapWriter w(out.data(), out.size());
+    w.header(CoapType::ACK, code, req.messageId, req.token, req.tokenLen);
+    if (echoBlock) w.optionUint(CoapOption::BLOCK1, block1);
+    out.resize(w.length());
+    return out;
+  }
+
+  // POST satu record ke endpoint HTTP. true jika server menyimpan (2xx / 409 duplikat).
+  bool forwardHttp(const std::string& line) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_socktype = SOCK_STREAM;
+    char port[8];
+    snprintf(port, sizeof(port), "%u", forwardEndpoint.port);
+    if (getaddrinfo(forwardEndpoint.host, port, &hints, &res) != 0) return false;
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    bool ok = fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) { if (fd >= 0) close(fd); return false; }
+
+    std::string body = "api_key=" + opt.apiKey + "&" + line;
+    std::vector<char> request(1024 + body.size());
+    size_t len = forwardRequest.build(request.data(), request.size(), nullptr, body.data(), body.size());
+    ok = len > 0 && send(fd, request.data(), len, 0) == (ssize_t)len;
+
+    HttpResponseParser parser;
+    parser.reset();
+    uint8_t buf[512];
+    while (ok && !parser.prefixReady()) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) { parser.connectionClosed(); break; }
+      if (parser.feed(buf, n) < 0) ok = false;
+    }
+    close(fd);
+    int status = parser.statusCode();
+    return ok && parser.headersDone() && ((status >= 200 && status < 300) || status == 409);
+  }
+
+  // Satu baris = satu record (skema sama dengan body HTTP firmware)
+  bool ingest(const std::string& keyId, const std::string& body) {
+    bool allOk = true;
+    size_t start = 0;
+    while (start < body.size()) {
+      size_t end = body.find('\n', start);
+      if (end == std::string::npos) end = body.size();
+      std::string line = body.substr(start, end - start);
+      start = end + 1;
+      if (line.empty()) continue;
+
+      if (opt.forwardUrl.empty()) {
+        printf("INGEST %s %s\n", keyId.c_str(), line.c_str());
+        fflush(stdout);
+      } else if (!forwardHttp(line)) {
+        fprintf(stderr, "forward gagal: %s\n", line.c_str());
+        allOk = false;
+      }
+    }
+    return allOk;
+  }
+
+  std::vector<uint8_t> handleRequest(const CoapMessage& msg, const std::string& peer) {
+    // Hanya POST /ingest
+    std::string path;
+    for (uint8_t i = 0; i < msg.optionCount; i++) {
+      if (msg.options[i].number != CoapOption::URI_PATH) continue;
+      if (!path.empty()) path += "/";
+      path.append((const char*)msg.options[i].value, msg.options[i].length);
+    }
+    if (msg.code != CoapCode::POST || path != "ingest") return buildResponse(msg, CoapCode::make(4, 4), false, 0);
+
+    const CoapOptionView* tag = msg.find(CoapOption::AUTH_TAG);
+    const CoapOptionView* key = msg.find(CoapOption::KEY_ID);
+    if (!tag || !key || tag->length != COAP_AUTH_TAG_SIZE || key->length == 0 || key->length > 64) {
+      return buildResponse(msg, CoapCode::UNAUTHORIZED, false, 0);
+    }
+    std::string keyId((const char*)key->value, key->length);
+    bool hasBlock = msg.find(CoapOption::BLOCK1) != nullptr;
+    uint32_t block1 = msg.optionUint(CoapOption::BLOCK1, 0);
+
+    uint8_t expected[COAP_AUTH_TAG_SIZE];
+    coapAuthTag((const uint8_t*)opt.psk.data(), opt.psk.size(), msg.code, msg.messageId,
+                msg.token, msg.tokenLen, keyId.c_str(), hasBlock ? block1 : 0,
+                msg.payload, msg.payloadLen, expected);
+    if (!constantTimeEqual(expected, tag->value, COAP_AUTH_TAG_SIZE)) {
+      fprintf(stderr, "tag HMAC salah dari %s (%s)\n", peer.c_str(), keyId.c_str());
+      return buildResponse(msg, CoapCode::UNAUTHORIZED, false, 0);
+    }
+
+    std::string payload((const char*)msg.payload, msg.payloadLen);
+    if (!hasBlock) {
+      return buildResponse(msg, ingest(keyId, payload) ? CoapCode::CHANGED : CoapCode::SERVER_ERROR, false, 0);
+    }
+
+    std::string transferKey = peer + "/" + std::string((const char*)msg.token, msg.tokenLen);
+    Transfer& t = transfers[transferKey];
+    uint32_t num = coapBlockNum(block1);
+    if (num == 0) t = Transfer();
+    if (num != t.nextBlock) {
+      transfers.erase(transferKey);
+      return buildResponse(msg, CoapCode::INCOMPLETE, false, 0);
+    }
+    if (t.body.size() + payload.size() > MAX_BODY) {
+      transfers.erase(transferKey);
+      return buildResponse(msg, CoapCode::TOO_LARGE, false, 0);
+    }
+    t.body += payload;
+    t.nextBlock++;
+    t.updatedAt = time(nullptr);
+
+    if (coapBlockMore(block1)) return buildResponse(msg, CoapCode::CONTINUE, true, block1);
+
+    std::string body = t.body;
+    transfers.erase(transferKey);
+    uint8_t code = ingest(keyId, body) ? CoapCode::CHANGED : CoapCode::SERVER_ERROR;
+    return buildResponse(msg, code, true, block1 & ~0x08u);
+  }
+
+  void expireTransfers() {
+    time_t now = time(nullptr);
+    for (auto it = transfers.begin(); it != transfers.end(); ) {
+      if (now - it->second.updatedAt > TRANSFER_TIMEOUT_S) it = transfers.erase(it);
+      else ++it;
+    }
+  }
+
+  bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+      std::string a = argv[i];
+      auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+      if (a == "--port") opt.port = (uint16_t)atoi(next());
+      else if (a == "--psk") opt.psk = next();
+      else if (a == "--forward") opt.forwardUrl = next();
+      else if (a == "--api-key") opt.apiKey = next();
+      else return false;
+    }
+    return !opt.psk.empty();
+  }
+}
+
+int main(int argc, char** argv) {
+  if (!parseArgs(argc, argv)) {
+    fprintf(stderr, "usage: %s --psk <secret> [--port 5683] [--forward http://host/path --api-key <key>]\n", argv[0]);
+    return 2;
+  }
+  if (!opt.forwardUrl.empty()) {
+    if (!forwardEndpoint.parse(opt.forwardUrl.c_str()) || forwardEndpoint.tls ||
+        !forwardRequest.begin("POST", forwardEndpoint, "application/x-www-form-urlencoded")) {
+      fprintf(stderr, "URL forward harus http:// yang valid\n");
+      return 2;
+    }
+  }
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(opt.port);
+  if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    perror("bind");
+    return 1;
+  }
+  fprintf(stderr, "CoAP receiver di udp/%u\n", opt.port);
+
+  uint8_t buf[2048];
+  for (;;) {
+    sockaddr_in from = {};
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+    if (n <= 0) continue;
+
+    CoapMessage msg;
+    if (!msg.parse(buf, n) || msg.type != CoapType::CON) continue;
+    std::string peer = peerKey(from);
+
+    auto last = lastExchange.find(peer);
+    std::vector<uint8_t> response;
+    if (last != lastExchange.end() && last->second.messageId == msg.messageId) {
+      response = last->second.response;  // retransmisi: ACK kita hilang
+    } else {
+      response = handleRequest(msg, peer);
+      lastExchange[peer] = { msg.messageId, response };
+    }
+    sendto(fd, response.data(), response.size(), 0, (sockaddr*)&from, fromLen);
+    expireTransfers();
+  }
+}
@@ -0,0 +1,155 @@
+"""
+PROFIL PERANGKAT
+Membaca faktor-kalibrasi.txt (fakultas, faktor kalibrasi, backend) lalu:
+- menulis include/device-profiles.h (tabel constexpr untuk src/main.cpp)
+- menulis ulang blok "; >>> profil" .. "; <<< profil" di platformio.ini
+  dengan satu [env:<fakultas>] per baris tabel
+Gagal jika nama terlalu panjang/ganda atau backend tidak dikenal.
+
+Dari root repo:
+  python3 tools/gen-profiles.py           # tulis ulang kedua file
+  python3 tools/gen-profiles.py --check   # exit 1 jika belum diperbarui (CI)
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TABLE = os.path.join(ROOT, 'faktor-kalibrasi.txt')
+HEADER = os.path.join(ROOT, 'include', 'device-profiles.h')
+INI = os.path.join(ROOT, 'platformio.ini')
+
+NAME = re.compile(r'^[A-Za-z][A-Za-z0-9]{0,6}$')   # muat di char fakultas[8], aman untuk topik MQTT
+BACKEND_FLAGS = {
+    'laravel': [],
+    'coap': ['-DECOSCALE_COAP'],
+    'firebase': ['-DECOSCALE_BACKEND_FIREBASE'],
+}
+FIREBASE_LIB = 'mobizt/Firebase Arduino Client Library for ESP8266 and ESP32@^4.4.17'
+BEGIN_MARK = '; >>> profil'
+END_MARK = '; <<< profil'
+
+
+def fail(lineno, msg):
+    sys.exit('faktor-kalibrasi.txt:%d: %s' % (lineno, msg))
+
+
+def read_table():
+    profiles = []
+    seen = set()
+    with open(TABLE, encoding='utf-8') as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            cols = line.split(None, 3)
+            if len(cols) < 3:
+                fail(lineno, 'butuh kolom fakultas, faktor, backend')
+            name, factor, backend = cols[0], cols[1], cols[2].lower()
+            if not NAME.match(name):
+                fail(lineno, 'nama fakultas "%s" tidak valid (huruf/angka, maks 7)' % name)
+            if name.lower() in seen:
+                fail(lineno, 'fakultas "%s" ganda' % name)
+            try:
+                value = float(factor)
+            except ValueError:
+                fail(lineno, 'faktor "%s" bukan angka' % factor)
+            if not value > 0:
+                fail(lineno, 'faktor harus > 0')
+            if backend not in BACKEND_FLAGS:
+                fail(lineno, 'backend "%s" tidak dikenal (%s)' % (backend, ', '.join(BACKEND_FLAGS)))
+            seen.add(name.lower())
+            profiles.append((name, factor, backend))
+    if not profiles:
+        sys.exit('faktor-kalibrasi.txt: tabel kosong')
+    return profiles
+
+
+def render_header(profiles):
+    rows = '\n'.join('  { "%s", %sf },' % (name, factor) for name, factor, _ in profiles)
+    return '''#pragma once
+#include <stddef.h>
+
+// ==================== PROFIL PERANGKAT ====================
+// DIBUAT OLEH tools/gen-profiles.py DARI faktor-kalibrasi.txt, JANGAN DIEDIT.
+// Profil dipilih saat kompilasi lewat -DECOSCALE_PROFILE="<fakultas>" (satu
+// env PlatformIO per profil); backend ikut flag env yang sama.
+
+struct DeviceProfile {
+  const char* fakultas;
+  float calibration;
+};
+
+namespace DeviceProfiles {
+constexpr DeviceProfile TABLE[] = {
+%s
+};
+constexpr size_t COUNT = sizeof(TABLE) / sizeof(TABLE[0]);
+
+// Rekursif agar tetap constexpr di C++11 (toolchain ESP32)
+constexpr bool equal(const char* a, const char* b) {
+  return *a == *b && (*a == '\\0' || equal(a + 1, b + 1));
+}
+
+// Indeks profil bernama name, COUNT jika tidak ada
+constexpr size_t find(const char* name, size_t i = 0) {
+  return i == COUNT ? COUNT : equal(TABLE[i].fakultas, name) ? i : find(name, i + 1);
+}
+}
+''' % rows
+
+
+def render_envs(profiles):
+    out = [BEGIN_MARK + ': dibuat tools/gen-profiles.py dari faktor-kalibrasi.txt, jangan diedit']
+    for name, _, backend in profiles:
+        flags = ["'-DECOSCALE_PROFILE=\"%s\"'" % name] + BACKEND_FLAGS[backend]
+        out.append('')
+        out.append('[env:%s]' % name.lower())
+        out.append('extends = esp32')
+        out.append('build_flags = ${esp32.build_flags} ' + ' '.join(flags))
+        if backend == 'firebase':
+            out.append('lib_deps = ')
+            out.append('\t${esp32.lib_deps}')
+            out.append('\t' + FIREBASE_LIB)
+    out.append(END_MARK)
+    return '\n'.join(out) + '\n'
+
+
+def render_ini(profiles, ini):
+    start = ini.find(BEGIN_MARK)
+    end = ini.find(END_MARK)
+    if start < 0 or end < start:
+        sys.exit('platformio.ini: penanda "%s" / "%s" tidak ditemukan' % (BEGIN_MARK, END_MARK))
+    end = ini.find('\n', end)
+    end = len(ini) if end < 0 else end + 1
+    return ini[:start] + render_envs(profiles) + ini[end:]
+
+
+def main():
+    check = '--check' in sys.argv[1:]
+    profiles = read_table()
+    with open(INI, encoding='utf-8') as f:
+        ini = f.read()
+    outputs = [(HEADER, render_header(profiles)), (INI, render_ini(profiles, ini))]
+
+    stale = []
+    for path, text in outputs:
+        current = None
+        if os.path.exists(path):
+            with open(path, encoding='utf-8') as f:
+                current = f.read()
+        if current == text:
+            continue
+        stale.append(os.path.relpath(path, ROOT))
+        if not check:
+            with open(path, 'w', encoding='utf-8', newline='\n') as f:
+                f.write(text)
+
+    if check and stale:
+        sys.exit('belum diperbarui: %s (jalankan python3 tools/gen-profiles.py)' % ', '.join(stale))
+    print('%d profil: %s' % (len(profiles), ', '.join(p[0] for p in profiles)))
+
+
+if __name__ == '__main__':
+    main()
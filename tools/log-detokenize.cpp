@@ -0,0 +1,102 @@
+/*
+ * DETOKENIZER LOG (HOST)
+ * Mengembalikan log firmware -DLOG_TOKENIZED ke teks: baris "$<base64>"
+ * di-decode jadi "[detik.ms] L modul: pesan" persis seperti build biasa,
+ * baris lain (bootloader, panic, teks biasa) diteruskan apa adanya.
+ * Database token dibuat tools/log-tokens.py dari source yang sama dengan
+ * firmware; token tak dikenal ditampilkan sebagai "<token xxxxxxxx>".
+ *
+ * Build (dari root repo):
+ *   g++ -std=c++17 -O2 -I include tools/log-detokenize.cpp src/log-token.cpp \
+ *       src/async-log.cpp -o log-detokenize
+ * Jalankan:
+ *   python3 tools/log-tokens.py -o log-tokens.csv
+ *   pio device monitor --raw | ./log-detokenize log-tokens.csv
+ *   ./log-detokenize log-tokens.csv < serial.log
+ */
+
+#include "async-log.h"
+#include "log-token.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+// CSV "token,format"; format boleh dikutip (koma, kutip ganda, newline)
+static bool loadTokens(const char* path, std::map<uint32_t, std::string>& tokens) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) return false;
+  std::stringstream ss;
+  ss << f.rdbuf();
+  const std::string text = ss.str();
+
+  size_t i = 0;
+  while (i < text.size()) {
+    size_t comma = text.find(',', i);
+    if (comma == std::string::npos) break;
+    uint32_t token = (uint32_t)strtoul(text.substr(i, comma - i).c_str(), nullptr, 16);
+    i = comma + 1;
+
+    std::string fmt;
+    if (i < text.size() && text[i] == '"') {
+      for (i++; i < text.size(); i++) {
+        if (text[i] == '"') {
+          if (i + 1 < text.size() && text[i + 1] == '"') { fmt += '"'; i++; }
+          else { i++; break; }
+        } else {
+          fmt += text[i];
+        }
+      }
+    } else {
+      while (i < text.size() && text[i] != '\r' && text[i] != '\n') fmt += text[i++];
+    }
+    while (i < text.size() && (text[i] == '\r' || text[i] == '\n')) i++;
+    tokens[token] = fmt;
+  }
+  return true;
+}
+
+static void printFrame(const std::string& line, const std::map<uint32_t, std::string>& tokens) {
+  uint8_t raw[AsyncLog::FRAME_MAX];
+  LogFrame frame;
+  size_t n = base64Decode(line.data() + 1, line.size() - 1, raw, sizeof(raw));
+  if (n == 0 || !logFrameDecode(raw, n, frame)) {
+    std::cout << line << "\n";   // bukan frame (atau rusak): tampilkan mentah
+    return;
+  }
+
+  char out[AsyncLog::LINE_MAX];
+  size_t p = AsyncLog::formatPrefix(out, sizeof(out), frame.timeMs, frame.level, frame.module);
+  auto it = tokens.find(frame.token);
+  if (it == tokens.end()) {
+    snprintf(out + p, sizeof(out) - p, "<token %08x>", (unsigned)frame.token);
+  } else {
+    logFormatArgs(out + p, sizeof(out) - p, it->second.c_str(), frame.args, frame.argsLen);
+  }
+  std::cout << out << "\n";
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "pakai: %s <log-tokens.csv> < serial.log\n", argv[0]);
+    return 2;
+  }
+  std::map<uint32_t, std::string> tokens;
+  if (!loadTokens(argv[1], tokens)) {
+    fprintf(stderr, "tidak bisa membaca %s\n", argv[1]);
+    return 1;
+  }
+
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty() && line[0] == LogToken::FRAME_PREFIX) printFrame(line, tokens);
+    else std::cout << line << "\n";
+    std::cout.flush();
+  }
+  return 0;
+}
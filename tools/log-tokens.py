@@ -0,0 +1,102 @@
+"""
+DATABASE TOKEN LOG
+Memindai src/ dan include/ untuk pemanggilan LOG_E/W/I/D, menghitung token
+FNV-1a 32-bit dari format string (sama dengan LogToken::hash di
+include/log-token.h), lalu menulis CSV "token,format" untuk
+tools/log-detokenize.cpp. Gagal jika dua format berbeda punya token sama.
+
+Sebagai extra script PlatformIO (ditulis ke .pio/build/<env>/log-tokens.csv):
+  extra_scripts = pre:tools/log-tokens.py
+Standalone (dari root repo):
+  python3 tools/log-tokens.py [-o log-tokens.csv]
+"""
+
+import csv
+import os
+import re
+import sys
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+CALL = re.compile(r'\bLOG_[EWID]\(\s*\w+\s*,\s*((?:"(?:[^"\\]|\\.)*"\s*)+)', re.S)
+LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"', re.S)
+ESCAPES = {'n': 10, 't': 9, 'r': 13, '0': 0, '\\': 92, '"': 34, "'": 39, 'a': 7, 'b': 8, 'f': 12, 'v': 11, '?': 63}
+
+
+def unescape(body):
+    """Isi literal C -> byte, seperti yang disimpan compiler (UTF-8)."""
+    out = bytearray()
+    i = 0
+    while i < len(body):
+        c = body[i]
+        if c != '\\':
+            out += c.encode('utf-8')
+            i += 1
+            continue
+        n = body[i + 1]
+        if n == 'x':
+            m = re.match(r'[0-9a-fA-F]+', body[i + 2:])
+            out.append(int(m.group(0), 16) & 0xFF)
+            i += 2 + len(m.group(0))
+        elif n in '01234567':
+            m = re.match(r'[0-7]{1,3}', body[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        else:
+            out.append(ESCAPES[n])
+            i += 2
+    return bytes(out)
+
+
+def fnv1a(data):
+    h = FNV_OFFSET
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def strip_comments(text):
+    # Komentar dibuang, literal dipertahankan
+    pattern = re.compile(r'//[^\n]*|/\*.*?\*/|"(?:[^"\\]|\\.)*"|\'(?:[^\'\\]|\\.)*\'', re.S)
+    return pattern.sub(lambda m: m.group(0) if m.group(0)[0] in '"\'' else ' ', text)
+
+
+def collect(root):
+    tokens = {}
+    for sub in ('src', 'include'):
+        for dirpath, _, files in os.walk(os.path.join(root, sub)):
+            for name in sorted(files):
+                if not name.endswith(('.cpp', '.h')):
+                    continue
+                path = os.path.join(dirpath, name)
+                with open(path, encoding='utf-8') as f:
+                    text = strip_comments(f.read())
+                for call in CALL.finditer(text):
+                    fmt = b''.join(unescape(lit) for lit in LITERAL.findall(call.group(1)))
+                    token = fnv1a(fmt)
+                    if token in tokens and tokens[token] != fmt:
+                        raise SystemExit('log-tokens: tabrakan token %08x di %s: %r vs %r'
+                                         % (token, path, tokens[token], fmt))
+                    tokens[token] = fmt
+    return tokens
+
+
+def write_csv(tokens, out_path):
+    with open(out_path, 'w', newline='', encoding='utf-8') as f:
+        w = csv.writer(f)
+        for token in sorted(tokens):
+            w.writerow(['%08x' % token, tokens[token].decode('utf-8', 'replace')])
+    print('log-tokens: %d format -> %s' % (len(tokens), out_path))
+
+
+try:
+    Import('env')  # noqa: F821 (disediakan SCons/PlatformIO)
+    build_dir = env.subst('$BUILD_DIR')  # noqa: F821
+    os.makedirs(build_dir, exist_ok=True)
+    write_csv(collect(env.subst('$PROJECT_DIR')), os.path.join(build_dir, 'log-tokens.csv'))  # noqa: F821
+except NameError:
+    if __name__ == '__main__':
+        out = sys.argv[sys.argv.index('-o') + 1] if '-o' in sys.argv else 'log-tokens.csv'
+        root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        write_csv(collect(root), out)
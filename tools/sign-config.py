@@ -0,0 +1,33 @@
+"""
+TANDA TANGAN DOKUMEN CONFIG
+Menambahkan tag HMAC-SHA256 ke dokumen config jarak jauh sesuai
+include/remote-config.h: payload = dokumen + "\\n" + 64 hex
+HMAC-SHA256(PSK, deviceId + "\\n" + dokumen). PSK = CONFIG_PSK di
+credentials.h perangkat tersebut.
+
+  python3 tools/sign-config.py ESP32Scale-A1B2C3D4E5F6 <psk> < config.json
+  ... | mosquitto_pub -r -t undip/feb/ESP32Scale-A1B2C3D4E5F6/config -s
+
+Dokumen dikirim apa adanya (tanpa newline penutup), maks 512 byte.
+"""
+
+import hashlib
+import hmac
+import sys
+
+DOC_MAX = 512
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('pakai: sign-config.py <deviceId> <psk> < dokumen.json')
+    device_id, psk = sys.argv[1].encode(), sys.argv[2].encode()
+    doc = sys.stdin.buffer.read().rstrip(b'\r\n')
+    if len(doc) > DOC_MAX:
+        sys.exit('dokumen %d byte, maks %d' % (len(doc), DOC_MAX))
+    tag = hmac.new(psk, device_id + b'\n' + doc, hashlib.sha256).hexdigest()
+    sys.stdout.buffer.write(doc + b'\n' + tag.encode())
+
+
+if __name__ == '__main__':
+    main()